@@ -0,0 +1,270 @@
+/**
+ * @file
+ * Werkzeug zum Erzeugen des Asset-Archivs.
+ * Packt Texturen mit vollstaendig dekodierter Mipmap-Kette und beliebige
+ * weitere Dateien (z.B. Shader-Quellen) in eine Datei "assets.pack", die
+ * von ueb04 und ueb05 direkt in den Speicher eingeblendet wird. Das Format
+ * ist in pack.h beschrieben.
+ *
+ * Aufruf:
+ *   assetpack <archiv> <content-verzeichnis> [--linear] <datei> ...
+ *
+ * Die Dateien werden relativ zum content-Verzeichnis angegeben und unter
+ * diesem Namen abgelegt. Bilder (.png, .jpg, .jpeg, .bmp, .tga) werden
+ * dekodiert, alle anderen Dateien unveraendert uebernommen. --linear gilt
+ * fuer die naechste Datei und sorgt dafuer, dass deren Mipmaps nicht im
+ * sRGB-Farbraum gefiltert werden (z.B. fuer Normal- und Hoehenkarten).
+ *
+ * Bestandteil einer Uebung im Rahmen des Moduls Praktikum Grundlagen der Computergrafik
+ * an der FH Wedel.
+ *
+ * @author Nicolas Hollmann, Daniel Klintworth
+ */
+
+/* ---- System Header einbinden ---- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ---- Eigene Header einbinden ---- */
+#include "pack.h"
+#include "mipmap.h"
+
+#define STB_IMAGE_STATIC
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb/stb_image.h>
+
+/* ---- Konstanten ---- */
+
+/** Maximale Laenge eines Pfades */
+#define PATH_LENGTH (1024)
+
+/* ---- Interne Funktionen ---- */
+
+/**
+ * Prueft, ob eine Datei anhand ihrer Endung ein Bild ist.
+ *
+ * @param name der Dateiname. (In)
+ *
+ * @return 1, wenn es sich um ein Bild handelt, sonst 0.
+ */
+static int isImage(const char *name)
+{
+	static const char *extensions[] = { ".png", ".jpg", ".jpeg", ".bmp", ".tga" };
+	const char *dot = strrchr(name, '.');
+
+	if (dot != NULL)
+	{
+		for (size_t i = 0; i < sizeof(extensions) / sizeof(extensions[0]); i++)
+		{
+			if (strcmp(dot, extensions[i]) == 0)
+			{
+				return 1;
+			}
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Fuellt die Datei mit Nullen bis zur naechsten Ausrichtungsgrenze auf.
+ *
+ * @param out die Ausgabedatei. (In)
+ *
+ * @return die neue Position in der Datei.
+ */
+static long alignFile(FILE *out)
+{
+	long position = ftell(out);
+
+	while (position % PACK_ALIGNMENT != 0)
+	{
+		fputc(0, out);
+		position++;
+	}
+
+	return position;
+}
+
+/**
+ * Schreibt ein Bild samt Mipmap-Kette in das Archiv.
+ *
+ * @param out die Ausgabedatei. (In)
+ * @param path der volle Pfad des Bildes. (In)
+ * @param srgb ungleich 0, wenn die Farben im sRGB-Farbraum liegen. (In)
+ * @param entry der Eintrag, Groessenangaben werden gesetzt. (InOut)
+ *
+ * @return 1 bei Erfolg, sonst 0.
+ */
+static int writeImage(FILE *out, const char *path, int srgb, PackEntry *entry)
+{
+	int width, height, channels;
+	unsigned char *data = stbi_load(path, &width, &height, &channels, 0);
+
+	if (data == NULL)
+	{
+		fprintf(stderr, "Bild %s konnte nicht geladen werden: %s\n", path, stbi_failure_reason());
+		return 0;
+	}
+
+	unsigned char *chain = mipmap_buildChain(data, width, height, channels, srgb);
+	size_t baseSize = (size_t)width * height * channels;
+	size_t chainSize = mipmap_chainSize(width, height, channels);
+	int ok = chain != NULL
+	         && fwrite(data, 1, baseSize, out) == baseSize
+	         && fwrite(chain, 1, chainSize, out) == chainSize;
+
+	entry->type = PACK_TEXTURE;
+	entry->width = (uint32_t)width;
+	entry->height = (uint32_t)height;
+	entry->channels = (uint32_t)channels;
+	entry->levels = (uint32_t)mipmap_levelCount(width, height);
+	entry->srgb = (uint32_t)(srgb != 0);
+	entry->size = baseSize + chainSize;
+
+	free(chain);
+	stbi_image_free(data);
+
+	return ok;
+}
+
+/**
+ * Kopiert eine Datei unveraendert in das Archiv.
+ *
+ * @param out die Ausgabedatei. (In)
+ * @param path der volle Pfad der Datei. (In)
+ * @param entry der Eintrag, die Groesse wird gesetzt. (InOut)
+ *
+ * @return 1 bei Erfolg, sonst 0.
+ */
+static int writeRaw(FILE *out, const char *path, PackEntry *entry)
+{
+	FILE *in = fopen(path, "rb");
+	char buffer[4096];
+	size_t read;
+
+	if (in == NULL)
+	{
+		fprintf(stderr, "Datei %s konnte nicht geoeffnet werden.\n", path);
+		return 0;
+	}
+
+	entry->type = PACK_RAW;
+	entry->size = 0;
+
+	while ((read = fread(buffer, 1, sizeof(buffer), in)) > 0)
+	{
+		fwrite(buffer, 1, read, out);
+		entry->size += read;
+	}
+
+	fclose(in);
+
+	return 1;
+}
+
+/* ---- Hauptprogramm ---- */
+
+/**
+ * Hauptprogramm.
+ *
+ * @param argc Anzahl der Kommandozeilenparameter (In)
+ * @param argv Kommandozeilenparameter (In)
+ * @return Rueckgabewert im Fehlerfall ungleich Null
+ */
+int main(int argc, char **argv)
+{
+	if (argc < 4)
+	{
+		fprintf(stderr, "Aufruf: %s <archiv> <content-verzeichnis> [--linear] <datei> ...\n", argv[0]);
+		return 1;
+	}
+
+	const char *packName = argv[1];
+	const char *contentDir = argv[2];
+
+	PackEntry *entries = calloc((size_t)argc, sizeof(PackEntry));
+	PackHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC));
+	header.byteOrder = PACK_BYTE_ORDER;
+
+	/* Erst alle Eintraege bestimmen, damit das Inhaltsverzeichnis vor den
+	 * Daten Platz findet. */
+	int srgb = 1;
+	for (int i = 3; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--linear") == 0)
+		{
+			srgb = 0;
+			continue;
+		}
+
+		if (strlen(argv[i]) >= PACK_NAME_LENGTH)
+		{
+			fprintf(stderr, "Name %s ist zu lang.\n", argv[i]);
+			return 1;
+		}
+
+		PackEntry *entry = &entries[header.entryCount++];
+		strcpy(entry->name, argv[i]);
+		entry->srgb = (uint32_t)srgb;
+		srgb = 1;
+	}
+
+	FILE *out = fopen(packName, "wb");
+	if (out == NULL)
+	{
+		fprintf(stderr, "Archiv %s konnte nicht angelegt werden.\n", packName);
+		return 1;
+	}
+
+	/* Kopf und Inhaltsverzeichnis werden am Ende nochmal geschrieben */
+	fwrite(&header, sizeof(header), 1, out);
+	fwrite(entries, sizeof(PackEntry), header.entryCount, out);
+
+	for (uint32_t i = 0; i < header.entryCount; i++)
+	{
+		PackEntry *entry = &entries[i];
+		char path[PATH_LENGTH];
+		int ok;
+
+		snprintf(path, sizeof(path), "%s/%s", contentDir, entry->name);
+		entry->offset = (uint64_t)alignFile(out);
+
+		ok = isImage(entry->name)
+		     ? writeImage(out, path, (int)entry->srgb, entry)
+		     : writeRaw(out, path, entry);
+
+		if (!ok)
+		{
+			fclose(out);
+			remove(packName);
+			return 1;
+		}
+
+		printf("%-32s %10lu Bytes", entry->name, (unsigned long)entry->size);
+		if (entry->type == PACK_TEXTURE)
+		{
+			printf("  %ux%u, %u Kanaele, %u Stufen%s", entry->width, entry->height,
+			       entry->channels, entry->levels, entry->srgb ? "" : ", linear");
+		}
+		printf("\n");
+	}
+
+	fseek(out, 0, SEEK_SET);
+	fwrite(&header, sizeof(header), 1, out);
+	fwrite(entries, sizeof(PackEntry), header.entryCount, out);
+
+	if (fclose(out) != 0)
+	{
+		fprintf(stderr, "Archiv %s konnte nicht geschrieben werden.\n", packName);
+		remove(packName);
+		return 1;
+	}
+
+	free(entries);
+
+	return 0;
+}
@@ -0,0 +1,463 @@
+/**
+ * @file
+ * Mipmap-Modul.
+ * Das Modul erzeugt auf der CPU die vollstaendige Mipmap-Kette eines Bildes.
+ *
+ * Intern wird jede Stufe als lineares RGBA mit 16 Bit pro Kanal gehalten.
+ * Dadurch kann jede Stufe aus der vorherigen berechnet werden, ohne dass
+ * sich Rundungsfehler der 8-Bit-Darstellung aufsummieren, und der Filter
+ * arbeitet unabhaengig von der Kanalanzahl immer auf 8 Byte pro Pixel.
+ *
+ * Bestandteil einer Uebung im Rahmen des Moduls Praktikum Grundlagen der Computergrafik
+ * an der FH Wedel.
+ *
+ * @author Nicolas Hollmann, Daniel Klintworth
+ */
+
+/* ---- System Header einbinden ---- */
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/* ---- Eigene Header einbinden ---- */
+#include "mipmap.h"
+#include "debugGL.h"
+
+/* ---- Typen ---- */
+
+/* Die Berechnung einer Zielstufe aus ihrer Quellstufe */
+typedef struct {
+	int channels;
+
+	/* Umrechnungstabellen fuer die Farbkanaele */
+	const unsigned short *decode;
+	const unsigned char *encode;
+
+	/* Quelle: lineares RGBA16 oder, fuer die erste Stufe, das 8-Bit-Bild */
+	const unsigned short *src;
+	const unsigned char *src8;
+	int srcWidth;
+	int srcHeight;
+
+	/* Platz fuer drei dekodierte Quellzeilen, falls src8 genutzt wird */
+	unsigned short *scratch;
+
+	/* Ziel (lineares RGBA16 und 8-Bit-Ausgabe) */
+	unsigned short *dst;
+	unsigned char *dst8;
+	int dstWidth;
+	int dstHeight;
+} MipmapJob;
+
+/* ---- Globale Daten ---- */
+
+/* Umrechnung von sRGB (8 Bit) nach linear (16 Bit) */
+static unsigned short g_toLinear[256];
+
+/* Umrechnung von linear (16 Bit) nach sRGB (8 Bit) */
+static unsigned char g_toSrgb[65536];
+
+/* Umrechnung von 8 nach 16 Bit ohne Farbraumwechsel */
+static unsigned short g_widen[256];
+
+/* Umrechnung von 16 nach 8 Bit ohne Farbraumwechsel */
+static unsigned char g_narrow[65536];
+
+/* Wurden die Tabellen bereits berechnet? */
+static int g_tablesReady = 0;
+
+/* ---- Interne Funktionen ---- */
+
+/**
+ * Berechnet die Tabellen fuer die Umrechnung zwischen sRGB und linear sowie
+ * zwischen 8 und 16 Bit.
+ */
+static void initTables(void)
+{
+	if (!g_tablesReady)
+	{
+		for (int i = 0; i < 256; i++)
+		{
+			double c = i / 255.0;
+			double l = (c <= 0.04045) ? c / 12.92 : pow((c + 0.055) / 1.055, 2.4);
+			g_toLinear[i] = (unsigned short)(l * 65535.0 + 0.5);
+			g_widen[i] = (unsigned short)(i * 257);
+		}
+
+		for (int i = 0; i < 65536; i++)
+		{
+			g_narrow[i] = (unsigned char)((i * 255u + 32767u) / 65535u);
+		}
+
+		/* Statt 65536-mal pow() aufzurufen, wird fuer jeden 8-Bit-Wert die
+		 * lineare Schwelle berechnet, ab der auf ihn gerundet wird. */
+		int start = 0;
+		for (int i = 0; i < 256; i++)
+		{
+			int end = 65536;
+
+			if (i < 255)
+			{
+				double c = (i + 0.5) / 255.0;
+				double l = (c <= 0.04045) ? c / 12.92 : pow((c + 0.055) / 1.055, 2.4);
+				end = (int)ceil(l * 65535.0);
+			}
+
+			memset(g_toSrgb + start, i, (size_t)(end - start));
+			start = end;
+		}
+
+		g_tablesReady = 1;
+	}
+}
+
+/**
+ * Rechnet eine Zeile eines 8-Bit-Bildes in lineares RGBA16 um.
+ *
+ * @param in die 8-Bit-Zeile. (In)
+ * @param out die lineare Zeile. (Out)
+ * @param width die Breite der Zeile in Pixeln. (In)
+ * @param c die Anzahl der Kanaele der Eingabe. (In)
+ * @param decode die Umrechnungstabelle fuer die Farbkanaele. (In)
+ */
+static void decodeRow(const unsigned char *in, unsigned short *out, int width, int c,
+                      const unsigned short *decode)
+{
+	/* Die Fallunterscheidung steht bewusst ausserhalb der Schleifen */
+	switch (c)
+	{
+		case 1:
+			for (int x = 0; x < width; x++, in += 1, out += 4)
+			{
+				out[0] = out[1] = out[2] = decode[in[0]];
+				out[3] = 65535;
+			}
+			break;
+		case 2:
+			for (int x = 0; x < width; x++, in += 2, out += 4)
+			{
+				out[0] = out[1] = out[2] = decode[in[0]];
+				out[3] = g_widen[in[1]];
+			}
+			break;
+		case 3:
+			for (int x = 0; x < width; x++, in += 3, out += 4)
+			{
+				out[0] = decode[in[0]];
+				out[1] = decode[in[1]];
+				out[2] = decode[in[2]];
+				out[3] = 65535;
+			}
+			break;
+		default:
+			for (int x = 0; x < width; x++, in += 4, out += 4)
+			{
+				out[0] = decode[in[0]];
+				out[1] = decode[in[1]];
+				out[2] = decode[in[2]];
+				out[3] = g_widen[in[3]];
+			}
+			break;
+	}
+}
+
+/**
+ * Rechnet eine Zeile aus linearem RGBA16 zurueck in das 8-Bit-Format.
+ *
+ * @param in die lineare Zeile. (In)
+ * @param out die 8-Bit-Zeile. (Out)
+ * @param width die Breite der Zeile in Pixeln. (In)
+ * @param c die Anzahl der Kanaele der Ausgabe. (In)
+ * @param encode die Umrechnungstabelle fuer die Farbkanaele. (In)
+ */
+static void encodeRow(const unsigned short *in, unsigned char *out, int width, int c,
+                      const unsigned char *encode)
+{
+	switch (c)
+	{
+		case 1:
+			for (int x = 0; x < width; x++, in += 4, out += 1)
+			{
+				out[0] = encode[in[0]];
+			}
+			break;
+		case 2:
+			for (int x = 0; x < width; x++, in += 4, out += 2)
+			{
+				out[0] = encode[in[0]];
+				out[1] = g_narrow[in[3]];
+			}
+			break;
+		case 3:
+			for (int x = 0; x < width; x++, in += 4, out += 3)
+			{
+				out[0] = encode[in[0]];
+				out[1] = encode[in[1]];
+				out[2] = encode[in[2]];
+			}
+			break;
+		default:
+			for (int x = 0; x < width; x++, in += 4, out += 4)
+			{
+				out[0] = encode[in[0]];
+				out[1] = encode[in[1]];
+				out[2] = encode[in[2]];
+				out[3] = g_narrow[in[3]];
+			}
+			break;
+	}
+}
+
+/**
+ * Verkleinert eine Zeile bei gerader Quellbreite. Je 2x2 Pixel werden zu
+ * einem gemittelt, erst vertikal und dann horizontal jeweils mit Rundung.
+ *
+ * @param row0 die obere Quellzeile. (In)
+ * @param row1 die untere Quellzeile. (In)
+ * @param out die Zielzeile. (Out)
+ * @param dstWidth die Breite der Zielzeile in Pixeln. (In)
+ */
+static void reduceRowEven(const unsigned short *row0, const unsigned short *row1,
+                          unsigned short *out, int dstWidth)
+{
+	for (int x = 0; x < dstWidth; x++)
+	{
+		for (int k = 0; k < 4; k++)
+		{
+			unsigned int l = (row0[x * 8 + k] + row1[x * 8 + k] + 1u) >> 1;
+			unsigned int r = (row0[x * 8 + 4 + k] + row1[x * 8 + 4 + k] + 1u) >> 1;
+			out[x * 4 + k] = (unsigned short)((l + r + 1u) >> 1);
+		}
+	}
+}
+
+/**
+ * Bestimmt die Quellindizes, die fuer einen Zielindex gemittelt werden.
+ * Bei ungerader Quellgroesse nimmt der letzte Zielindex drei Quellindizes
+ * auf, damit keine Zeile oder Spalte verloren geht.
+ *
+ * @param i der Zielindex. (In)
+ * @param srcSize die Quellgroesse. (In)
+ * @param dstSize die Zielgroesse. (In)
+ * @param first der erste Quellindex. (Out)
+ *
+ * @return die Anzahl der Quellindizes.
+ */
+static int sourceSpan(int i, int srcSize, int dstSize, int *first)
+{
+	if (srcSize == 1)
+	{
+		*first = 0;
+		return 1;
+	}
+
+	*first = i * 2;
+	return ((srcSize & 1) && i == dstSize - 1) ? 3 : 2;
+}
+
+/**
+ * Liefert eine Quellzeile als lineares RGBA16. Fuer die erste Stufe wird
+ * die Zeile dabei aus dem 8-Bit-Bild in den Zwischenspeicher dekodiert, so
+ * dass das Ausgangsbild nie vollstaendig linear vorliegen muss.
+ *
+ * @param job die zu berechnende Stufe. (In)
+ * @param y die Quellzeile. (In)
+ * @param slot der zu nutzende Platz im Zwischenspeicher (0 bis 2). (In)
+ *
+ * @return die lineare Quellzeile.
+ */
+static const unsigned short *sourceRow(const MipmapJob *job, int y, int slot)
+{
+	if (job->src8 != NULL)
+	{
+		unsigned short *row = job->scratch + (size_t)slot * job->srcWidth * 4;
+		decodeRow(job->src8 + (size_t)y * job->srcWidth * job->channels, row,
+		          job->srcWidth, job->channels, job->decode);
+		return row;
+	}
+
+	return job->src + (size_t)y * job->srcWidth * 4;
+}
+
+/**
+ * Verkleinert eine Zeile fuer beliebige Abmessungen der Quelle.
+ *
+ * @param job die zu berechnende Stufe. (In)
+ * @param rows die beteiligten Quellzeilen. (In)
+ * @param rowCount die Anzahl der Quellzeilen. (In)
+ * @param out die Zielzeile. (Out)
+ */
+static void reduceRowGeneric(const MipmapJob *job, const unsigned short *rows[3], int rowCount,
+                             unsigned short *out)
+{
+	for (int x = 0; x < job->dstWidth; x++)
+	{
+		int firstCol;
+		int cols = sourceSpan(x, job->srcWidth, job->dstWidth, &firstCol);
+		unsigned int count = (unsigned int)(rowCount * cols);
+
+		for (int k = 0; k < 4; k++)
+		{
+			unsigned int sum = 0;
+
+			for (int r = 0; r < rowCount; r++)
+			{
+				for (int s = 0; s < cols; s++)
+				{
+					sum += rows[r][(firstCol + s) * 4 + k];
+				}
+			}
+
+			out[x * 4 + k] = (unsigned short)((sum + count / 2) / count);
+		}
+	}
+}
+
+/**
+ * Berechnet die naechste Stufe und schreibt sie sowohl linear als auch im
+ * 8-Bit-Format.
+ *
+ * @param job die zu berechnende Stufe. (In)
+ */
+static void reduceRows(const MipmapJob *job)
+{
+	int even = !(job->srcWidth & 1) && !(job->srcHeight & 1);
+
+	for (int y = 0; y < job->dstHeight; y++)
+	{
+		unsigned short *out = job->dst + (size_t)y * job->dstWidth * 4;
+		const unsigned short *rows[3];
+		int firstRow;
+		int rowCount = sourceSpan(y, job->srcHeight, job->dstHeight, &firstRow);
+
+		for (int r = 0; r < rowCount; r++)
+		{
+			rows[r] = sourceRow(job, firstRow + r, r);
+		}
+
+		if (even)
+		{
+			reduceRowEven(rows[0], rows[1], out, job->dstWidth);
+		}
+		else
+		{
+			reduceRowGeneric(job, rows, rowCount, out);
+		}
+
+		encodeRow(out, job->dst8 + (size_t)y * job->dstWidth * job->channels,
+		          job->dstWidth, job->channels, job->encode);
+	}
+}
+
+/* ---- Oeffentliche Funktionen ---- */
+
+int mipmap_levelCount(int width, int height)
+{
+	int size = width > height ? width : height;
+	int levels = 1;
+
+	while (size > 1)
+	{
+		size /= 2;
+		levels++;
+	}
+
+	return levels;
+}
+
+void mipmap_levelSize(int level, int *width, int *height)
+{
+	for (int i = 0; i < level; i++)
+	{
+		*width = *width > 1 ? *width / 2 : 1;
+		*height = *height > 1 ? *height / 2 : 1;
+	}
+}
+
+size_t mipmap_chainSize(int width, int height, int channels)
+{
+	int levels = mipmap_levelCount(width, height);
+	size_t size = 0;
+
+	for (int i = 1; i < levels; i++)
+	{
+		mipmap_levelSize(1, &width, &height);
+		size += (size_t)width * height * channels;
+	}
+
+	return size;
+}
+
+unsigned char *mipmap_buildChain(const unsigned char *data, int width, int height, int channels,
+                                 int srgb)
+{
+	int levels = mipmap_levelCount(width, height);
+
+	/* Die 1x1-Stufe hat keine Nachfolger */
+	if (levels < 2)
+	{
+		return malloc(1);
+	}
+
+	unsigned char *chain = malloc(mipmap_chainSize(width, height, channels));
+	unsigned short *scratch = malloc((size_t)3 * width * 4 * sizeof(unsigned short));
+
+	/* Zwei lineare Puffer, zwischen denen pro Stufe gewechselt wird. Der
+	 * erste nimmt Stufe 1 auf, der zweite hoechstens Stufe 2. */
+	unsigned short *current = malloc((size_t)(width / 2 + 1) * (height / 2 + 1) * 4 * sizeof(unsigned short));
+	unsigned short *next = malloc((size_t)(width / 4 + 1) * (height / 4 + 1) * 4 * sizeof(unsigned short));
+
+	if (chain == NULL || scratch == NULL || current == NULL || next == NULL)
+	{
+		INFO(("Speicher fuer Mipmaps konnte nicht reserviert werden!\n"));
+		free(chain);
+		free(scratch);
+		free(current);
+		free(next);
+		return NULL;
+	}
+
+	initTables();
+
+	MipmapJob job;
+	memset(&job, 0, sizeof(job));
+	job.channels = channels;
+	job.decode = srgb ? g_toLinear : g_widen;
+	job.encode = srgb ? g_toSrgb : g_narrow;
+	job.scratch = scratch;
+
+	/* Stufe 1 wird direkt aus dem 8-Bit-Bild berechnet */
+	job.src8 = data;
+	job.dst = current;
+
+	unsigned char *out = chain;
+
+	for (int level = 1; level < levels; level++)
+	{
+		int dstWidth = width;
+		int dstHeight = height;
+		mipmap_levelSize(1, &dstWidth, &dstHeight);
+
+		job.srcWidth = width;
+		job.srcHeight = height;
+		job.dst8 = out;
+		job.dstWidth = dstWidth;
+		job.dstHeight = dstHeight;
+		reduceRows(&job);
+
+		/* Die neue Stufe ist die Quelle der naechsten */
+		job.src8 = NULL;
+		job.src = job.dst;
+		job.dst = (job.dst == current) ? next : current;
+
+		out += (size_t)dstWidth * dstHeight * channels;
+		width = dstWidth;
+		height = dstHeight;
+	}
+
+	free(scratch);
+	free(current);
+	free(next);
+
+	return chain;
+}
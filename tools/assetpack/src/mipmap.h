@@ -0,0 +1,73 @@
+#ifndef __MIPMAP_H__
+#define __MIPMAP_H__
+/**
+ * @file
+ * Schnittstelle des Mipmap-Moduls.
+ * Das Modul erzeugt auf der CPU die vollstaendige Mipmap-Kette eines Bildes.
+ * Gefiltert wird mit einem Box-Filter im linearen Farbraum, die Farbkanaele
+ * werden also vor dem Mitteln aus sRGB umgerechnet und danach wieder
+ * zurueckgerechnet. Der Alphakanal wird direkt gemittelt, ebenso alle
+ * Kanaele von Bildern, die keine Farben enthalten (z.B. Normal-Maps).
+ *
+ * Bestandteil einer Uebung im Rahmen des Moduls Praktikum Grundlagen der Computergrafik
+ * an der FH Wedel.
+ *
+ * @author Nicolas Hollmann, Daniel Klintworth
+ */
+
+/* ---- System Header einbinden ---- */
+#include <stddef.h>
+
+/* ---- Funktionen ---- */
+
+/**
+ * Berechnet die Anzahl der Mipmap-Stufen fuer ein Bild, inklusive der
+ * Basisstufe. Die kleinste Stufe ist 1x1 Pixel gross.
+ *
+ * @param width die Breite des Bildes in Pixeln. (In)
+ * @param height die Hoehe des Bildes in Pixeln. (In)
+ *
+ * @return die Anzahl der Stufen.
+ */
+int mipmap_levelCount(int width, int height);
+
+/**
+ * Berechnet die Breite und Hoehe einer Mipmap-Stufe.
+ *
+ * @param level die Stufe, 0 ist das Ausgangsbild. (In)
+ * @param width die Breite, ein- und ausgehend. (InOut)
+ * @param height die Hoehe, ein- und ausgehend. (InOut)
+ */
+void mipmap_levelSize(int level, int *width, int *height);
+
+/**
+ * Berechnet die Groesse der Mipmap-Kette ab Stufe 1 in Bytes.
+ *
+ * @param width die Breite des Ausgangsbildes. (In)
+ * @param height die Hoehe des Ausgangsbildes. (In)
+ * @param channels die Anzahl der Kanaele (1 bis 4). (In)
+ *
+ * @return die Groesse der Stufen 1 bis n zusammen in Bytes.
+ */
+size_t mipmap_chainSize(int width, int height, int channels);
+
+/**
+ * Erzeugt die Mipmap-Kette eines Bildes. Die Stufen liegen direkt
+ * hintereinander im Ergebnis, beginnend mit Stufe 1. Das Ausgangsbild selbst
+ * ist nicht enthalten, es wird unveraendert als Stufe 0 verwendet. Die
+ * Zeilen jeder Stufe sind dicht gepackt.
+ *
+ * @param data die Pixel des Ausgangsbildes, 8 Bit pro Kanal. (In)
+ * @param width die Breite des Ausgangsbildes. (In)
+ * @param height die Hoehe des Ausgangsbildes. (In)
+ * @param channels die Anzahl der Kanaele (1 bis 4). Bei 2 und 4 Kanaelen
+ *        ist der letzte Kanal ein Alphakanal. (In)
+ * @param srgb ungleich 0, wenn die Farbkanaele im sRGB-Farbraum liegen. (In)
+ *
+ * @return die Mipmap-Kette, muss mit free() freigegeben werden. NULL, wenn
+ *         nicht genug Speicher vorhanden war.
+ */
+unsigned char *mipmap_buildChain(const unsigned char *data, int width, int height, int channels,
+                                 int srgb);
+
+#endif
@@ -0,0 +1,605 @@
+/**
+ * @file
+ * Werkzeug zum Erzeugen von Leveln.
+ * Wuerfelt Level aus Waenden, Sand, Zucker, Wasser und einem Ziel aus und
+ * behaelt nur die, deren kuerzeste Loesung (siehe search.h aus dem Solver)
+ * in einem vorgegebenen Bereich an Schritten liegt. Die Schrittzahl der
+ * kuerzesten Loesung ist damit das Mass fuer die Schwierigkeit. Jedes
+ * behaltene Level wird als Leveldatei geschrieben.
+ *
+ * Aufruf:
+ *   levelgen [--count <n>] [--size BxH] [--steps <min>-<max>] [--threads <n>]
+ *            [--memory <mb>] [--seed <n>] <praefix>
+ *
+ * Die Level heissen <praefix>00001.wml, <praefix>00002.wml usw. Auf
+ * Unix-Systemen pruefen mehrere Threads (Standard: alle Kerne) parallel
+ * Kandidaten, jeder mit einer eigenen, einfaedigen Suche und --memory MB
+ * Speicher (Standard: 16). Ein Kandidat, dessen Pruefung diese Grenze
+ * erreicht, wird verworfen, das begrenzt die Zeit je Kandidat. Der
+ * Kandidat mit der Nummer n haengt nur von --seed und n ab.
+ *
+ * Bestandteil einer Uebung im Rahmen des Moduls Praktikum Grundlagen der Computergrafik
+ * an der FH Wedel.
+ *
+ * @author Nicolas Hollmann, Daniel Klintworth
+ */
+
+/* ---- System Header einbinden ---- */
+#if defined(__unix__) || defined(__APPLE__)
+#define LEVELGEN_THREADS
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+/* ---- Eigene Header einbinden ---- */
+#include "search.h"
+#include "levelfile.h"
+
+/* ---- Konstanten ---- */
+
+/** Standardwerte der Kommandozeile */
+#define DEFAULT_COUNT (100)
+#define DEFAULT_SIZE (12)
+#define DEFAULT_MIN_STEPS (15)
+#define DEFAULT_MAX_STEPS (40)
+#define DEFAULT_MEMORY_MB (16)
+
+/** Kleinste erlaubte Speichergrenze einer Suche in MB */
+#define MIN_MEMORY_MB (16)
+
+/** Kleinste Seitenlaenge eines Levels, inklusive Rand */
+#define MIN_SIZE (5)
+
+/** Anteile der Felder im Inneren in Prozent, der Rest ist frei */
+#define WALL_PERCENT (28)
+#define SAND_PERCENT (8)
+#define SUGAR_PERCENT (6)
+
+/** Innere Felder je Wasserquelle */
+#define CELLS_PER_WATER (150)
+
+/** Hoechstens so viele Kandidaten je gewuenschtem Level, danach wird aufgegeben */
+#define MAX_CANDIDATES_PER_LEVEL (10000)
+
+/** Hoechstzahl an Threads */
+#define LEVELGEN_MAX_THREADS (SEARCH_MAX_THREADS)
+
+/* ---- Typen ---- */
+
+/** Einstellungen und Zaehler des Generators, von allen Threads geteilt */
+typedef struct {
+	/* Einstellungen */
+	const char *prefix;
+	int count;
+	int width, height;
+	int minSteps, maxSteps;
+	int threads;
+	size_t memory;
+	uint64_t seed;
+
+	/* Zaehler, nur unter lock veraendert */
+	unsigned long long candidates;
+	unsigned long long maxCandidates;
+	unsigned long long states;
+	unsigned long long unsolvable; // Unloesbar oder ohne Ziel im Bereich
+	unsigned long long outside;    // Loesung kuerzer oder laenger als erlaubt
+	unsigned long long limited;    // Speichergrenze der Suche erreicht
+	int accepted;
+	int failed;                    // Schreiben einer Datei fehlgeschlagen
+#ifdef LEVELGEN_THREADS
+	pthread_mutex_t lock;
+#endif
+} Generator;
+
+/* ---- Interne Funktionen ---- */
+
+/**
+ * Liefert die naechste Zufallszahl (SplitMix64).
+ *
+ * @param state Zustand des Generators. (InOut)
+ *
+ * @return die Zufallszahl.
+ */
+static uint64_t nextRandom(uint64_t *state)
+{
+	uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+/**
+ * Liefert eine Zufallszahl aus [0, range).
+ *
+ * @param state Zustand des Generators. (InOut)
+ * @param range Obergrenze, groesser 0. (In)
+ *
+ * @return die Zufallszahl.
+ */
+static int randomBelow(uint64_t *state, int range)
+{
+	return (int)(nextRandom(state) % (uint64_t)range);
+}
+
+/**
+ * Sucht ein zufaelliges freies Feld im Inneren des Levels.
+ *
+ * @param level das Level. (In)
+ * @param random Zustand des Zufallsgenerators. (InOut)
+ *
+ * @return der Index des Feldes oder -1, wenn keines gefunden wurde.
+ */
+static int randomFreeCell(const LevelFile *level, uint64_t *random)
+{
+	/* Meist sind die meisten Felder frei, ein paar Versuche genuegen */
+	for (int tries = 0; tries < 64; tries++)
+	{
+		int x = 1 + randomBelow(random, level->width - 2);
+		int y = 1 + randomBelow(random, level->height - 2);
+		int index = y * level->width + x;
+
+		if (level->fields[index] == WM_FREE)
+		{
+			return index;
+		}
+	}
+
+	return -1;
+}
+
+/**
+ * Wuerfelt einen Kandidaten aus. Um das Innere liegt ein Rand aus Waenden.
+ * Das Ziel liegt auf einem Feld, das auf einem Weg um die Waende herum
+ * minSteps bis maxSteps Schritte vom Start entfernt ist, denn eine Loesung
+ * ist nie kuerzer als dieser Weg.
+ *
+ * @param gen der Generator. (In)
+ * @param index die Nummer des Kandidaten. (In)
+ * @param level das Level in der passenden Groesse. (InOut)
+ * @param distance Zwischenspeicher, ein int je Feld. (InOut)
+ * @param queue Zwischenspeicher, ein int je Feld. (InOut)
+ *
+ * @return 0, wenn kein Ziel im Bereich liegt.
+ */
+static int generateCandidate(const Generator *gen, unsigned long long index, LevelFile *level,
+                             int *distance, int *queue)
+{
+	const int width = level->width;
+	const int height = level->height;
+	const int cells = width * height;
+	uint64_t random = gen->seed ^ (index * 0xD1B54A32D192ED03ull);
+
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			wmFieldType field = WM_WALL;
+
+			if (x > 0 && y > 0 && x + 1 < width && y + 1 < height)
+			{
+				int roll = randomBelow(&random, 100);
+
+				if (roll < WALL_PERCENT)
+				{
+					field = WM_WALL;
+				}
+				else if (roll < WALL_PERCENT + SAND_PERCENT)
+				{
+					field = WM_SAND;
+				}
+				else if (roll < WALL_PERCENT + SAND_PERCENT + SUGAR_PERCENT)
+				{
+					field = WM_SUGAR;
+				}
+				else
+				{
+					field = WM_FREE;
+				}
+			}
+
+			level->fields[y * width + x] = (wmField)field;
+		}
+	}
+
+	int start = randomFreeCell(level, &random);
+
+	if (start < 0)
+	{
+		return 0;
+	}
+
+	level->startX = start % width;
+	level->startY = start / width;
+
+	/* Entfernungen vom Start durch alles ausser Waenden */
+	for (int i = 0; i < cells; i++)
+	{
+		distance[i] = -1;
+	}
+
+	int head = 0;
+	int tail = 0;
+	int inRange = 0;
+	const int offsets[4] = { -width, width, -1, 1 };
+
+	distance[start] = 0;
+	queue[tail++] = start;
+
+	while (head < tail)
+	{
+		int cell = queue[head++];
+
+		if (distance[cell] >= gen->minSteps && level->fields[cell] == WM_FREE)
+		{
+			inRange++;
+		}
+
+		if (distance[cell] >= gen->maxSteps)
+		{
+			continue;
+		}
+
+		for (int d = 0; d < 4; d++)
+		{
+			/* Der Rand besteht aus Waenden, Nachbarn liegen also im Level */
+			int next = cell + offsets[d];
+
+			if (distance[next] < 0 && level->fields[next] != WM_WALL)
+			{
+				distance[next] = distance[cell] + 1;
+				queue[tail++] = next;
+			}
+		}
+	}
+
+	if (inRange == 0)
+	{
+		return 0;
+	}
+
+	/* Das Ziel gleichverteilt unter den passenden Feldern waehlen */
+	int pick = randomBelow(&random, inRange);
+
+	for (int i = 0; i < tail; i++)
+	{
+		int cell = queue[i];
+
+		if (distance[cell] >= gen->minSteps && level->fields[cell] == WM_FREE && pick-- == 0)
+		{
+			level->fields[cell] = WM_GOAL;
+			break;
+		}
+	}
+
+	int sources = 1 + (width - 2) * (height - 2) / CELLS_PER_WATER;
+
+	for (int i = 0; i < sources; i++)
+	{
+		int cell = randomFreeCell(level, &random);
+
+		if (cell >= 0 && cell != start)
+		{
+			level->fields[cell] = WM_WATER;
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * Nimmt die Nummer des naechsten Kandidaten.
+ *
+ * @param gen der Generator. (InOut)
+ * @param index die Nummer. (Out)
+ *
+ * @return 0, wenn genug Level erzeugt wurden oder aufgegeben wird.
+ */
+static int takeCandidate(Generator *gen, unsigned long long *index)
+{
+	int more;
+
+#ifdef LEVELGEN_THREADS
+	pthread_mutex_lock(&gen->lock);
+#endif
+	more = gen->accepted < gen->count && !gen->failed && gen->candidates < gen->maxCandidates;
+	if (more)
+	{
+		*index = gen->candidates++;
+	}
+#ifdef LEVELGEN_THREADS
+	pthread_mutex_unlock(&gen->lock);
+#endif
+
+	return more;
+}
+
+/**
+ * Zaehlt das Ergebnis eines Kandidaten und schreibt ihn, wenn er im Bereich
+ * liegt und noch Level fehlen.
+ *
+ * @param gen der Generator. (InOut)
+ * @param level der Kandidat. (In)
+ * @param result das Ergebnis der Suche, NULL ohne Suche. (In)
+ */
+static void reportCandidate(Generator *gen, const LevelFile *level, const SearchResult *result)
+{
+#ifdef LEVELGEN_THREADS
+	pthread_mutex_lock(&gen->lock);
+#endif
+	if (result == NULL || result->status == SEARCH_UNSOLVABLE)
+	{
+		gen->unsolvable++;
+	}
+	else if (result->status == SEARCH_LIMIT && result->length <= gen->maxSteps)
+	{
+		gen->limited++;
+	}
+	else if (result->status == SEARCH_LIMIT || result->length < gen->minSteps)
+	{
+		gen->outside++;
+	}
+	else if (gen->accepted < gen->count && !gen->failed)
+	{
+		char filename[FILENAME_MAX];
+		snprintf(filename, sizeof(filename), "%s%05d.wml", gen->prefix, gen->accepted + 1);
+
+		if (levelfile_save(filename, level))
+		{
+			gen->accepted++;
+			printf("%s: %d Schritte, %llu Zustaende\n", filename, result->length, result->states);
+		}
+		else
+		{
+			gen->failed = 1;
+		}
+	}
+
+	if (result != NULL)
+	{
+		gen->states += result->states;
+	}
+#ifdef LEVELGEN_THREADS
+	pthread_mutex_unlock(&gen->lock);
+#endif
+}
+
+/**
+ * Prueft Kandidaten, bis genug Level erzeugt wurden.
+ *
+ * @param arg der Generator. (InOut)
+ *
+ * @return immer NULL.
+ */
+static void *generateLevels(void *arg)
+{
+	Generator *gen = arg;
+	SearchOptions options = { 1, gen->memory, gen->maxSteps };
+	Search *search = search_create(&options);
+	LevelFile level = EMPTY_LEVEL_FILE;
+	size_t cells = (size_t)gen->width * gen->height;
+	int *distance = malloc(cells * sizeof(int));
+	int *queue = malloc(cells * sizeof(int));
+	unsigned long long index;
+
+	if (search == NULL || distance == NULL || queue == NULL
+	    || !levelfile_create(&level, gen->width, gen->height))
+	{
+		fprintf(stderr, "Kein Speicher fuer einen Thread!\n");
+	}
+	else
+	{
+		while (takeCandidate(gen, &index))
+		{
+			SearchResult result;
+
+			if (generateCandidate(gen, index, &level, distance, queue))
+			{
+				search_run(search, &level, &result);
+				reportCandidate(gen, &level, &result);
+			}
+			else
+			{
+				reportCandidate(gen, &level, NULL);
+			}
+		}
+	}
+
+	levelfile_free(&level);
+	free(queue);
+	free(distance);
+	if (search != NULL)
+	{
+		search_free(search);
+	}
+
+	return NULL;
+}
+
+/**
+ * Erzeugt die Level, auf Unix-Systemen mit gen->threads Threads.
+ *
+ * @param gen der Generator. (InOut)
+ */
+static void runGenerator(Generator *gen)
+{
+#ifdef LEVELGEN_THREADS
+	pthread_t handles[LEVELGEN_MAX_THREADS];
+	int started[LEVELGEN_MAX_THREADS];
+
+	pthread_mutex_init(&gen->lock, NULL);
+
+	/* Der aufrufende Thread arbeitet mit */
+	for (int t = 1; t < gen->threads; t++)
+	{
+		started[t] = pthread_create(&handles[t], NULL, generateLevels, gen) == 0;
+	}
+
+	generateLevels(gen);
+
+	for (int t = 1; t < gen->threads; t++)
+	{
+		if (started[t])
+		{
+			pthread_join(handles[t], NULL);
+		}
+	}
+
+	pthread_mutex_destroy(&gen->lock);
+#else
+	generateLevels(gen);
+#endif
+}
+
+/**
+ * Liefert die Laufzeit seit einem beliebigen, festen Zeitpunkt.
+ *
+ * @return die Zeit in Sekunden.
+ */
+static double now(void)
+{
+#ifdef LEVELGEN_THREADS
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return time.tv_sec + time.tv_nsec * 1e-9;
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+/**
+ * Gibt die Aufrufsyntax aus.
+ */
+static void printUsage(void)
+{
+	fprintf(stderr, "Aufruf: levelgen [--count <n>] [--size BxH] [--steps <min>-<max>] [--threads <n>]\n"
+	                "                [--memory <mb>] [--seed <n>] <praefix>\n");
+}
+
+/* ---- Hauptprogramm ---- */
+
+/**
+ * Hauptprogramm.
+ *
+ * @param argc Anzahl der Argumente. (In)
+ * @param argv die Argumente. (In)
+ *
+ * @return 0, wenn alle gewuenschten Level geschrieben wurden.
+ */
+int main(int argc, char **argv)
+{
+	Generator gen;
+	int first = 1;
+
+	memset(&gen, 0, sizeof(gen));
+	gen.count = DEFAULT_COUNT;
+	gen.width = DEFAULT_SIZE;
+	gen.height = DEFAULT_SIZE;
+	gen.minSteps = DEFAULT_MIN_STEPS;
+	gen.maxSteps = DEFAULT_MAX_STEPS;
+	gen.memory = (size_t)DEFAULT_MEMORY_MB << 20;
+	gen.seed = (uint64_t)time(NULL);
+	gen.threads = 1;
+#ifdef LEVELGEN_THREADS
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	gen.threads = (cpus < 1) ? 1 : (cpus > LEVELGEN_MAX_THREADS ? LEVELGEN_MAX_THREADS : (int)cpus);
+#endif
+
+	while (first + 1 < argc && strncmp(argv[first], "--", 2) == 0)
+	{
+		const char *option = argv[first];
+		const char *value = argv[first + 1];
+		int valid;
+
+		if (strcmp(option, "--count") == 0)
+		{
+			gen.count = atoi(value);
+			valid = gen.count > 0;
+		}
+		else if (strcmp(option, "--size") == 0)
+		{
+			valid = sscanf(value, "%dx%d", &gen.width, &gen.height) == 2
+			        && gen.width >= MIN_SIZE && gen.width <= LEVEL_MAX_SIZE
+			        && gen.height >= MIN_SIZE && gen.height <= LEVEL_MAX_SIZE;
+		}
+		else if (strcmp(option, "--steps") == 0)
+		{
+			valid = sscanf(value, "%d-%d", &gen.minSteps, &gen.maxSteps) == 2
+			        && gen.minSteps > 0 && gen.minSteps <= gen.maxSteps;
+		}
+		else if (strcmp(option, "--threads") == 0)
+		{
+			gen.threads = atoi(value);
+			valid = gen.threads > 0 && gen.threads <= LEVELGEN_MAX_THREADS;
+		}
+		else if (strcmp(option, "--memory") == 0)
+		{
+			int memory = atoi(value);
+			gen.memory = (size_t)memory << 20;
+			valid = memory >= MIN_MEMORY_MB;
+		}
+		else if (strcmp(option, "--seed") == 0)
+		{
+			gen.seed = strtoull(value, NULL, 10);
+			valid = 1;
+		}
+		else
+		{
+			valid = 0;
+		}
+
+		if (!valid)
+		{
+			printUsage();
+			return 1;
+		}
+
+		first += 2;
+	}
+
+	if (first + 1 != argc)
+	{
+		printUsage();
+		return 1;
+	}
+
+	gen.prefix = argv[first];
+	gen.maxCandidates = (unsigned long long)gen.count * MAX_CANDIDATES_PER_LEVEL;
+
+	double start = now();
+	runGenerator(&gen);
+	double seconds = now() - start;
+
+	if (seconds <= 0.0)
+	{
+		seconds = 1e-9;
+	}
+
+	printf("%d Level aus %llu Kandidaten in %.1f s (%.0f Level/h, %.1f Kandidaten/s)\n",
+	       gen.accepted, gen.candidates, seconds, gen.accepted * 3600.0 / seconds, gen.candidates / seconds);
+	printf("  verworfen: %llu unloesbar, %llu ausserhalb von %d-%d Schritten, %llu an der Speichergrenze\n",
+	       gen.unsolvable, gen.outside, gen.minSteps, gen.maxSteps, gen.limited);
+	printf("  %llu Zustaende geprueft (%.0f Zustaende/s), %d Threads\n",
+	       gen.states, gen.states / seconds, gen.threads);
+
+	if (gen.failed)
+	{
+		return 1;
+	}
+
+	if (gen.accepted < gen.count)
+	{
+		fprintf(stderr, "Aufgegeben nach %llu Kandidaten.\n", gen.candidates);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,559 @@
+/**
+ * @file
+ * Werkzeug zum Ausfuehren der Spiellogik ohne Fenster.
+ * Spielt eine Zugfolge mit festem Zeitschritt so schnell wie moeglich gegen
+ * die Spiellogik (logic.c) aus ueb02 bzw. ueb03 ab und gibt die Anzahl der
+ * Logik-Schritte pro Sekunde sowie einen Hash des Endzustands aus. Damit
+ * lassen sich Aenderungen an der Logik ohne Display messen und auf gleiches
+ * Verhalten pruefen. Das Programm wird einmal je Uebung gebaut (logicrun02,
+ * logicrun03).
+ *
+ * Aufruf:
+ *   logicrun [--dt <s>] [--repeat <n>] [--random <n> [--seed <n>]] [--check-water]
+ *            <level> [<zuege>]
+ *
+ * Ein Level ist die Nummer eines eingebauten Levels oder eine Leveldatei.
+ * Die Zuege sind 'u', 'd', 'l', 'r' fuer die Richtungen und '.' fuer einen
+ * Schritt Warten, Gross- und Kleinschreibung ist egal (wie die Ausgabe des
+ * Solvers). Ein Zug wird im ersten Logik-Schritt ausgefuehrt, in dem sich
+ * der Spieler wieder bewegen darf. Mit --random wird stattdessen eine
+ * zufaellige Zugfolge der Laenge n gewuerfelt. Ein Zug ins Wasser wird dabei
+ * durch die naechste Richtung ersetzt, die nicht ins Wasser fuehrt, und nach
+ * Sieg oder Niederlage beginnt das Level von vorn, bis alle Zuege gespielt
+ * sind. --repeat spielt die Folge n-mal ab und prueft, dass der Endzustand
+ * jedes Mal gleich ist. --check-water vergleicht das Level nach jedem
+ * Logik-Schritt mit der Referenz aus waterref.h.
+ *
+ * Bestandteil einer Uebung im Rahmen des Moduls Praktikum Grundlagen der Computergrafik
+ * an der FH Wedel.
+ *
+ * @author Nicolas Hollmann, Daniel Klintworth
+ */
+
+/* ---- System Header einbinden ---- */
+#if defined(__unix__) || defined(__APPLE__)
+#define LOGICRUN_CLOCK
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+
+/* ---- Eigene Header einbinden ---- */
+#include "logic.h"
+#include "headless.h"
+#include "waterref.h"
+
+/* ---- Konstanten ---- */
+
+/* ueb02 exportiert die Sperrzeit nach einem Zug nicht */
+#ifndef PLAYER_COOLDOWN_TIME
+#define PLAYER_COOLDOWN_TIME (0.2f)
+#endif
+
+/** Nachlauf nach dem letzten Zug in Sekunden, laenger als eine Ausbreitung des Wassers */
+#define TAIL_TIME (1.0)
+
+/** Zeichen der Zuege */
+#define MOVE_CHARS "udlr."
+
+/** Anzahl der Richtungen, die ersten Zeichen von MOVE_CHARS */
+#define DIRECTION_COUNT (4)
+
+/* ---- Globale Daten ---- */
+
+/** Wird das Wasser gegen die Referenz geprueft? */
+static int g_checkWater = 0;
+
+/** Nummer des ersten Logik-Schritts, der von der Referenz abweicht, 0 fuer keinen */
+static unsigned long long g_waterMismatch = 0;
+
+/* ---- Interne Funktionen ---- */
+
+/**
+ * Liefert die Laufzeit seit einem beliebigen, festen Zeitpunkt.
+ *
+ * @return die Zeit in Sekunden.
+ */
+static double now(void)
+{
+#ifdef LOGICRUN_CLOCK
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return time.tv_sec + time.tv_nsec * 1e-9;
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+/**
+ * Fuehrt Logik-Schritte aus. Mit --check-water wird jeder Schritt bis zur
+ * ersten Abweichung gegen die Referenz geprueft.
+ *
+ * @param dt der Zeitschritt in Sekunden. (In)
+ * @param count Anzahl der Schritte. (In)
+ * @param ticks Zaehler der Schritte. (InOut)
+ */
+static void tick(double dt, int count, unsigned long long *ticks)
+{
+	Gamestate *state = getGamestate();
+
+	for (int i = 0; i < count && state->stage == stageRunning; i++)
+	{
+		int check = g_checkWater && g_waterMismatch == 0;
+
+		if (check)
+		{
+			waterref_begin(dt);
+		}
+
+		updateLogic(dt);
+		(*ticks)++;
+
+		if (check && !waterref_check(*ticks))
+		{
+			g_waterMismatch = *ticks;
+		}
+
+#ifdef DIRTY_TILES_MAX
+		/* In ueb03 verbraucht die Darstellung die geaenderten Felder je Frame */
+		clearDirtyTiles();
+#endif
+	}
+}
+
+/**
+ * Mischt einen Wert in einen FNV-1a-Hash.
+ *
+ * @param hash der Hash. (InOut)
+ * @param value der Wert. (In)
+ */
+static void hashValue(uint64_t *hash, int64_t value)
+{
+	for (int i = 0; i < 8; i++)
+	{
+		*hash ^= (uint64_t)(value >> (8 * i)) & 0xFF;
+		*hash *= 0x100000001B3ull;
+	}
+}
+
+/**
+ * Mischt eine Zeit in einen Hash. Sie wird auf Mikrosekunden gerundet, damit
+ * gleichwertige Rechenwege denselben Hash liefern.
+ *
+ * @param hash der Hash. (InOut)
+ * @param seconds die Zeit in Sekunden. (In)
+ */
+static void hashTime(uint64_t *hash, double seconds)
+{
+	hashValue(hash, (int64_t)floor(seconds * 1e6 + 0.5));
+}
+
+/**
+ * Berechnet den Hash des Spielzustands: Felder, Spieler, Spielstand, die
+ * Restzeiten der Zuckerwuerfel und die beiden Cooldowns. Die Reihenfolge
+ * der Zuckerwuerfel im Speicher geht nicht ein.
+ *
+ * @return der Hash.
+ */
+static uint64_t hashState(void)
+{
+	Gamestate *state = getGamestate();
+	uint64_t hash = 0xCBF29CE484222325ull;
+
+	hashValue(&hash, state->levelWidth);
+	hashValue(&hash, state->levelHeight);
+
+	for (int y = 0; y < state->levelHeight; y++)
+	{
+		for (int x = 0; x < state->levelWidth; x++)
+		{
+			hashValue(&hash, state->level[y][x]);
+
+			if (state->level[y][x] == WM_TOUCHED_SUGAR)
+			{
+				hashTime(&hash, sugar_get_lifetime(&state->sugarCubes, x, y));
+			}
+		}
+	}
+
+	hashValue(&hash, state->playerX);
+	hashValue(&hash, state->playerY);
+	hashValue(&hash, state->stage);
+	hashTime(&hash, state->playerCooldown);
+	hashTime(&hash, state->updateCooldown);
+
+	return hash;
+}
+
+/**
+ * Liefert die Richtung eines Zugs.
+ *
+ * @param move das Zeichen des Zugs, nicht '.'. (In)
+ *
+ * @return die Richtung.
+ */
+static PlayerDirection directionOf(char move)
+{
+	switch (move | 0x20)
+	{
+		case 'u':
+			return dirUp;
+		case 'd':
+			return dirDown;
+		case 'l':
+			return dirLeft;
+		default:
+			return dirRight;
+	}
+}
+
+/**
+ * Prueft, ob ein Zug den Spieler ins Wasser fuehren wuerde.
+ *
+ * @param move das Zeichen des Zugs, nicht '.'. (In)
+ *
+ * @return 1, wenn das Zielfeld Wasser ist.
+ */
+static int movesIntoWater(char move)
+{
+	Gamestate *state = getGamestate();
+	int x = state->playerX;
+	int y = state->playerY;
+
+	switch (directionOf(move))
+	{
+		case dirUp:
+			y--;
+			break;
+		case dirDown:
+			y++;
+			break;
+		case dirLeft:
+			x--;
+			break;
+		default:
+			x++;
+			break;
+	}
+
+	return x >= 0 && y >= 0 && x < state->levelWidth && y < state->levelHeight
+	       && state->level[y][x] == WM_WATER;
+}
+
+/**
+ * Ersetzt einen zufaelligen Zug ins Wasser durch die naechste Richtung, die
+ * nicht ins Wasser fuehrt. Ist ringsum Wasser, wird gewartet.
+ *
+ * @param move das Zeichen des Zugs, nicht '.'. (In)
+ *
+ * @return das Zeichen des gespielten Zugs.
+ */
+static char avoidWater(char move)
+{
+	const char *start = strchr(MOVE_CHARS, move | 0x20);
+
+	for (int i = 0; i < DIRECTION_COUNT; i++)
+	{
+		char candidate = MOVE_CHARS[(start - MOVE_CHARS + i) % DIRECTION_COUNT];
+
+		if (!movesIntoWater(candidate))
+		{
+			return candidate;
+		}
+	}
+
+	return '.';
+}
+
+/**
+ * Prueft, ob das Spiel weiterlaeuft. Zufaellige Zugfolgen beginnen nach Sieg
+ * oder Niederlage von vorn.
+ *
+ * @param levelId das Level. (In)
+ * @param restart nach dem Ende neu beginnen? (In)
+ * @param restarts Zaehler der Neustarts. (InOut)
+ *
+ * @return 1, wenn weitergespielt wird.
+ */
+static int continueGame(int levelId, int restart, int *restarts)
+{
+	if (getGamestate()->stage == stageRunning)
+	{
+		return 1;
+	}
+
+	if (!restart)
+	{
+		return 0;
+	}
+
+	initLevel(levelId);
+	(*restarts)++;
+
+	return 1;
+}
+
+/**
+ * Spielt eine Zugfolge vom Start des Levels an ab.
+ *
+ * @param levelId das Level. (In)
+ * @param moves die Zuege. (In)
+ * @param random zufaellige Zugfolge: Wasser meiden und nach dem Ende neu beginnen. (In)
+ * @param dt der Zeitschritt in Sekunden. (In)
+ * @param ticks Zaehler der Logik-Schritte. (InOut)
+ * @param played ausgefuehrte Zuege, bis das Spiel endet. (Out)
+ * @param restarts Anzahl der Neustarts. (Out)
+ *
+ * @return der Hash des Endzustands.
+ */
+static uint64_t play(int levelId, const char *moves, int random, double dt, unsigned long long *ticks,
+                     int *played, int *restarts)
+{
+	Gamestate *state = getGamestate();
+	const int waitTicks = (int)ceil(PLAYER_COOLDOWN_TIME / dt);
+
+	initLevel(levelId);
+	*played = 0;
+	*restarts = 0;
+
+	for (const char *move = moves; *move != '\0' && continueGame(levelId, random, restarts); move++)
+	{
+		if (*move == '.')
+		{
+			tick(dt, waitTicks, ticks);
+		}
+		else
+		{
+			/* Warten, bis sich der Spieler wieder bewegen darf */
+			while (state->playerCooldown > 0.0f && state->stage == stageRunning)
+			{
+				tick(dt, 1, ticks);
+			}
+
+			if (!continueGame(levelId, random, restarts))
+			{
+				break;
+			}
+
+			char next = random ? avoidWater(*move) : *move;
+
+			if (next != '.')
+			{
+				movePlayer(directionOf(next));
+			}
+		}
+
+		(*played)++;
+	}
+
+	/* Sieg und Niederlage werden erst mit dem Wasser geprueft */
+	tick(dt, (int)ceil(TAIL_TIME / dt), ticks);
+
+	return hashState();
+}
+
+/**
+ * Gibt die Aufrufsyntax aus.
+ *
+ * @param name Name des Programms. (In)
+ */
+static void printUsage(const char *name)
+{
+	fprintf(stderr, "Aufruf: %s [--dt <s>] [--repeat <n>] [--random <n> [--seed <n>]] [--check-water]\n"
+	                "       <level> [<zuege>]\n", name);
+	fprintf(stderr, "  <level>: 1 bis %d fuer die eingebauten Level oder eine Leveldatei\n", LEVEL_LAST);
+	fprintf(stderr, "  <zuege>: u, d, l, r und . fuer Warten\n");
+}
+
+/* ---- Hauptprogramm ---- */
+
+/**
+ * Hauptprogramm.
+ *
+ * @param argc Anzahl der Argumente. (In)
+ * @param argv die Argumente. (In)
+ *
+ * @return 0, wenn alle Durchlaeufe denselben Endzustand erreichen und das
+ *         Wasser der Referenz entspricht.
+ */
+int main(int argc, char **argv)
+{
+	double dt = HEADLESS_DT;
+	int repeat = 1;
+	int randomMoves = 0;
+	unsigned long long seed = 1;
+	int first = 1;
+
+	while (first < argc && strncmp(argv[first], "--", 2) == 0)
+	{
+		const char *option = argv[first];
+
+		/* Schalter ohne Wert */
+		if (strcmp(option, "--check-water") == 0)
+		{
+			g_checkWater = 1;
+			first++;
+			continue;
+		}
+
+		if (first + 1 >= argc)
+		{
+			printUsage(argv[0]);
+			return 1;
+		}
+
+		const char *value = argv[first + 1];
+		int valid;
+
+		if (strcmp(option, "--dt") == 0)
+		{
+			dt = atof(value);
+			valid = dt > 0.0;
+		}
+		else if (strcmp(option, "--repeat") == 0)
+		{
+			repeat = atoi(value);
+			valid = repeat > 0;
+		}
+		else if (strcmp(option, "--random") == 0)
+		{
+			randomMoves = atoi(value);
+			valid = randomMoves > 0;
+		}
+		else if (strcmp(option, "--seed") == 0)
+		{
+			seed = strtoull(value, NULL, 10);
+			valid = 1;
+		}
+		else
+		{
+			valid = 0;
+		}
+
+		if (!valid)
+		{
+			printUsage(argv[0]);
+			return 1;
+		}
+
+		first += 2;
+	}
+
+	if (first >= argc || first + (randomMoves > 0 ? 1 : 2) != argc)
+	{
+		printUsage(argv[0]);
+		return 1;
+	}
+
+	const char *levelName = argv[first];
+	char *end;
+	long levelId = strtol(levelName, &end, 10);
+
+	if (*end != '\0' || levelId < LEVEL_1 || levelId > LEVEL_LAST)
+	{
+		if (!setLevelFile(levelName))
+		{
+			return 1;
+		}
+		levelId = LEVEL_FILE;
+	}
+
+	char *moves;
+
+	if (randomMoves > 0)
+	{
+		moves = malloc((size_t)randomMoves + 1);
+		if (moves == NULL)
+		{
+			fprintf(stderr, "Kein Speicher fuer die Zuege!\n");
+			return 1;
+		}
+
+		srand((unsigned)seed);
+		for (int i = 0; i < randomMoves; i++)
+		{
+			moves[i] = MOVE_CHARS[rand() % (int)strlen(MOVE_CHARS)];
+		}
+		moves[randomMoves] = '\0';
+	}
+	else
+	{
+		moves = argv[first + 1];
+
+		if (strspn(moves, MOVE_CHARS "UDLR") != strlen(moves))
+		{
+			printUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	/* Die Logik wuerfelt nur die Meldung beim Verlieren aus */
+	srand(0);
+
+	unsigned long long ticks = 0;
+	uint64_t firstHash = 0;
+	int played = 0;
+	int restarts = 0;
+	int stable = 1;
+	double start = now();
+
+	for (int run = 0; run < repeat; run++)
+	{
+		uint64_t hash = play((int)levelId, moves, randomMoves > 0, dt, &ticks, &played, &restarts);
+
+		if (run == 0)
+		{
+			firstHash = hash;
+		}
+		else if (hash != firstHash)
+		{
+			fprintf(stderr, "Durchlauf %d endet mit Hash %016llx statt %016llx!\n", run + 1,
+			        (unsigned long long)hash, (unsigned long long)firstHash);
+			stable = 0;
+		}
+	}
+
+	double seconds = now() - start;
+	Gamestate *state = getGamestate();
+	const char *stage = (state->stage == stageWon) ? "gewonnen"
+	                    : (state->stage == stageLost) ? "verloren" : "laeuft";
+
+	printf("%s: %s nach %d von %d Zuegen, Spieler bei %d,%d, Hash %016llx\n", levelName, stage,
+	       played, (int)strlen(moves), state->playerX, state->playerY, (unsigned long long)firstHash);
+	printf("  %llu Logik-Schritte zu %.4f s in %.3f s (%.0f Schritte/s)\n", ticks, dt, seconds,
+	       seconds > 0.0 ? ticks / seconds : 0.0);
+
+	if (randomMoves > 0)
+	{
+		printf("  %d Neustarts nach Sieg oder Niederlage\n", restarts);
+	}
+
+	if (g_checkWater)
+	{
+		if (g_waterMismatch == 0)
+		{
+			printf("  Wasser in %lu Schritten wie die Referenz\n", waterref_steps());
+		}
+		else
+		{
+			fprintf(stderr, "Das Wasser weicht in Logik-Schritt %llu von der Referenz ab!\n",
+			        g_waterMismatch);
+		}
+		waterref_free();
+	}
+
+	if (randomMoves > 0)
+	{
+		free(moves);
+	}
+	cleanup();
+
+	return (stable && g_waterMismatch == 0) ? 0 : 1;
+}
@@ -0,0 +1,152 @@
+/**
+ * @file
+ * Referenz fuer die Ausbreitung des Wassers.
+ * Die Vorhersage liest nur die Kopie des Levels und den Spielzustand, sie
+ * haengt also weder von der Warteschlange noch von den Bitebenen der
+ * Spiellogik ab.
+ *
+ * Bestandteil einer Uebung im Rahmen des Moduls Praktikum Grundlagen der Computergrafik
+ * an der FH Wedel.
+ *
+ * @author Nicolas Hollmann, Daniel Klintworth
+ */
+
+/* ---- System Header einbinden ---- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ---- Eigene Header einbinden ---- */
+#include "waterref.h"
+#include "logic.h"
+
+/* ---- Globale Daten ---- */
+
+/** Kopie des Levels vor dem Logik-Schritt, zeilenweise */
+static wmField *g_before = NULL;
+static size_t g_capacity = 0;
+static int g_width = 0;
+static int g_height = 0;
+
+/** Breitet sich das Wasser im aktuellen Logik-Schritt aus? */
+static int g_stepDue = 0;
+
+/** Anzahl der geprueften Schritte des Wassers */
+static unsigned long g_steps = 0;
+
+/* ---- Interne Funktionen ---- */
+
+/**
+ * Liefert ein Feld der Kopie, ausserhalb des Levels eine Wand.
+ *
+ * @param x X-Koordinate des Feldes. (In)
+ * @param y Y-Koordinate des Feldes. (In)
+ *
+ * @return der Feldtyp vor dem Logik-Schritt.
+ */
+static wmFieldType fieldBefore(int x, int y)
+{
+	if (x < 0 || y < 0 || x >= g_width || y >= g_height)
+	{
+		return WM_WALL;
+	}
+
+	return (wmFieldType)g_before[(size_t)y * g_width + x];
+}
+
+/**
+ * Sagt ein Feld nach dem Logik-Schritt voraus.
+ *
+ * @param x X-Koordinate des Feldes. (In)
+ * @param y Y-Koordinate des Feldes. (In)
+ *
+ * @return der erwartete Feldtyp.
+ */
+static wmFieldType expectedField(int x, int y)
+{
+	wmFieldType field = fieldBefore(x, y);
+
+	if (g_stepDue && (field == WM_FREE || field == WM_SUGAR)
+	    && (fieldBefore(x - 1, y) == WM_WATER || fieldBefore(x + 1, y) == WM_WATER
+	        || fieldBefore(x, y - 1) == WM_WATER || fieldBefore(x, y + 1) == WM_WATER))
+	{
+		return (field == WM_FREE) ? WM_WATER : WM_TOUCHED_SUGAR;
+	}
+
+	return field;
+}
+
+/* ---- Oeffentliche Funktionen ---- */
+
+void waterref_begin(double dt)
+{
+	Gamestate *state = getGamestate();
+	size_t size = (size_t)state->levelWidth * state->levelHeight;
+
+	if (size > g_capacity)
+	{
+		wmField *before = realloc(g_before, size);
+
+		if (before == NULL)
+		{
+			fprintf(stderr, "Kein Speicher fuer die Kopie des Levels!\n");
+			exit(1);
+		}
+
+		g_before = before;
+		g_capacity = size;
+	}
+
+	g_width = state->levelWidth;
+	g_height = state->levelHeight;
+
+	for (int y = 0; y < g_height; y++)
+	{
+		memcpy(g_before + (size_t)y * g_width, state->level[y], (size_t)g_width);
+	}
+
+	/* Dieselbe Rechnung wie in updateLogic, auch mit float */
+	float rest = state->updateCooldown;
+	rest -= dt;
+	g_stepDue = !state->showHelp && state->stage == stageRunning && rest <= 0.0f;
+}
+
+int waterref_check(unsigned long long tick)
+{
+	Gamestate *state = getGamestate();
+
+	for (int y = 0; y < g_height; y++)
+	{
+		for (int x = 0; x < g_width; x++)
+		{
+			wmFieldType actual = (wmFieldType)state->level[y][x];
+			wmFieldType expected = expectedField(x, y);
+
+			/* Nasser Zucker loest sich unabhaengig vom Wasser auf */
+			if (actual != expected
+			    && !(actual == WM_FREE && fieldBefore(x, y) == WM_TOUCHED_SUGAR))
+			{
+				fprintf(stderr, "Schritt %llu: Feld %d,%d ist %d statt %d (vorher %d)\n", tick, x, y,
+				        (int)actual, (int)expected, (int)fieldBefore(x, y));
+				return 0;
+			}
+		}
+	}
+
+	g_steps += g_stepDue;
+
+	return 1;
+}
+
+unsigned long waterref_steps(void)
+{
+	return g_steps;
+}
+
+void waterref_free(void)
+{
+	free(g_before);
+	g_before = NULL;
+	g_capacity = 0;
+	g_width = g_height = 0;
+}
@@ -0,0 +1,51 @@
+#ifndef __WATERREF_H__
+#define __WATERREF_H__
+/**
+ * @file
+ * Referenz fuer die Ausbreitung des Wassers.
+ * Haelt vor jedem Logik-Schritt eine Kopie des Levels fest und sagt daraus
+ * voraus, wie das Level nach dem Schritt aussehen muss. Die Vorhersage
+ * durchsucht wie die urspruengliche Spiellogik das ganze Level: in einem
+ * Schritt des Wassers wird jedes freie Feld neben Wasser geflutet und jeder
+ * Zucker neben Wasser nass, massgeblich ist das Wasser vor dem Schritt.
+ * Nasser Zucker darf sich zudem jederzeit aufloesen. Alle anderen Felder
+ * bleiben, wie sie sind.
+ *
+ * Bestandteil einer Uebung im Rahmen des Moduls Praktikum Grundlagen der Computergrafik
+ * an der FH Wedel.
+ *
+ * @author Nicolas Hollmann, Daniel Klintworth
+ */
+
+/* ---- Funktionen ---- */
+
+/**
+ * Haelt den Zustand vor einem Logik-Schritt fest.
+ *
+ * @param dt der Zeitschritt, mit dem updateLogic aufgerufen wird. (In)
+ */
+void waterref_begin(double dt);
+
+/**
+ * Vergleicht das Level nach dem Logik-Schritt mit der Vorhersage. Das erste
+ * abweichende Feld wird auf stderr gemeldet.
+ *
+ * @param tick Nummer des Logik-Schritts fuer die Meldung. (In)
+ *
+ * @return 1, wenn das Level der Vorhersage entspricht, sonst 0.
+ */
+int waterref_check(unsigned long long tick);
+
+/**
+ * Liefert die Anzahl der bisher geprueften Schritte des Wassers.
+ *
+ * @return die Anzahl.
+ */
+unsigned long waterref_steps(void);
+
+/**
+ * Gibt den Speicher der Kopie frei.
+ */
+void waterref_free(void);
+
+#endif
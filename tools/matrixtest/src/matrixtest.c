@@ -0,0 +1,1005 @@
+/**
+ * @file
+ * Test- und Messwerkzeug fuer das Matrix-Modul.
+ * Prueft alle Funktionen aus matrix.h gegen Referenzen in doppelter
+ * Genauigkeit, die den Formeln von glFrustum, glOrtho, glTranslate,
+ * glRotate, glScale, gluPerspective und gluLookAt bzw. dem Gauss-Jordan-
+ * Verfahren von gluInvertMatrix (GLU, project.c) folgen. Die Referenzen
+ * brauchen keinen OpenGL-Kontext, das Werkzeug laeuft also auch ohne
+ * Display. Mit --bench werden zusaetzlich Multiplikation und
+ * Batch-Transformation gegen eine skalare Schleife gemessen.
+ *
+ * Das Programm wird einmal je Uebung gebaut (matrixtest03, matrixtest04,
+ * matrixtest05) und einmal fuer ueb03 ohne SSE (matrixtest03-scalar).
+ *
+ * Aufruf:
+ *   matrixtest [--bench]
+ *
+ * Der Rueckgabewert ist 0, wenn alle Pruefungen bestanden wurden, sonst 1.
+ *
+ * Bestandteil einer Uebung im Rahmen des Moduls Praktikum Grundlagen der Computergrafik
+ * an der FH Wedel.
+ *
+ * @author Nicolas Hollmann, Daniel Klintworth
+ */
+
+/* ---- System Header einbinden ---- */
+#if defined(__unix__) || defined(__APPLE__)
+#define MATRIXTEST_CLOCK
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+/* ---- Eigene Header einbinden ---- */
+#include "matrix.h"
+
+/* ---- Konstanten ---- */
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/** Zulaessige Abweichung, relativ zum Betrag des Referenzwerts (mind. 1) */
+#define TOLERANCE (1e-5)
+
+/** Zulaessige Abweichung fuer Inverse und Normalenmatrix */
+#define TOLERANCE_INVERSE (1e-4)
+
+/** Anzahl der Zufallsfaelle je Pruefung */
+#define CASES (1000)
+
+/** Anzahl der Multiplikationen fuer die Messung */
+#define BENCH_MULTIPLIES (4000000)
+
+/** Anzahl der Vektoren fuer die Messung der Batch-Transformation */
+#define BENCH_VECTORS (65536)
+
+/** Anzahl der Durchlaeufe ueber alle Vektoren */
+#define BENCH_ROUNDS (200)
+
+/* ---- Typen ---- */
+
+/** 4x4-Matrix in doppelter Genauigkeit, spaltenweise */
+typedef double RefMatrix[16];
+
+/* ---- Globale Daten ---- */
+
+/** Anzahl der fehlgeschlagenen Pruefungen */
+static int g_failures = 0;
+
+/** Verhindert, dass Messschleifen wegoptimiert werden */
+static volatile float g_sink;
+
+/* ---- Interne Funktionen ---- */
+
+/**
+ * Liefert die Laufzeit seit einem beliebigen, festen Zeitpunkt.
+ *
+ * @return die Zeit in Sekunden.
+ */
+static double now(void)
+{
+#ifdef MATRIXTEST_CLOCK
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return time.tv_sec + time.tv_nsec * 1e-9;
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+/**
+ * Liefert eine Zufallszahl im angegebenen Bereich.
+ *
+ * @param min untere Grenze (In)
+ * @param max obere Grenze (In)
+ *
+ * @return die Zufallszahl.
+ */
+static float randomRange(float min, float max)
+{
+	return min + (max - min) * (float)rand() / (float)RAND_MAX;
+}
+
+/**
+ * Fuellt eine Matrix mit Zufallswerten. Die Diagonale wird verstaerkt,
+ * damit die Matrix gut konditioniert und damit sicher invertierbar ist.
+ *
+ * @param m die Matrix (Out)
+ */
+static void randomMatrix(CGMatrix4f m)
+{
+	for (int i = 0; i < 16; i++)
+	{
+		m[i] = randomRange(-1.0f, 1.0f);
+	}
+
+	for (int i = 0; i < 4; i++)
+	{
+		m[i * 5] += (m[i * 5] < 0.0f) ? -4.0f : 4.0f;
+	}
+}
+
+/**
+ * Wandelt eine Matrix in doppelte Genauigkeit um.
+ *
+ * @param res das Ergebnis (Out)
+ * @param m die Matrix (In)
+ */
+static void toRef(RefMatrix res, const CGMatrix4f m)
+{
+	for (int i = 0; i < 16; i++)
+	{
+		res[i] = m[i];
+	}
+}
+
+/**
+ * Referenz-Multiplikation: res = a * b.
+ *
+ * @param res das Ergebnis, darf nicht a oder b sein (Out)
+ * @param a linker Faktor (In)
+ * @param b rechter Faktor (In)
+ */
+static void refMultiply(RefMatrix res, const RefMatrix a, const RefMatrix b)
+{
+	for (int j = 0; j < 4; j++)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			double sum = 0.0;
+
+			for (int k = 0; k < 4; k++)
+			{
+				sum += a[k * 4 + i] * b[j * 4 + k];
+			}
+
+			res[j * 4 + i] = sum;
+		}
+	}
+}
+
+/**
+ * Multipliziert eine Matrix von rechts an: m = m * b.
+ *
+ * @param m die Matrix (InOut)
+ * @param b der rechte Faktor (In)
+ */
+static void refMultiplyRight(RefMatrix m, const RefMatrix b)
+{
+	RefMatrix tmp;
+	refMultiply(tmp, m, b);
+	memcpy(m, tmp, sizeof(RefMatrix));
+}
+
+/**
+ * Referenz-Einheitsmatrix.
+ *
+ * @param m die Matrix (Out)
+ */
+static void refIdentity(RefMatrix m)
+{
+	memset(m, 0, sizeof(RefMatrix));
+	m[0] = m[5] = m[10] = m[15] = 1.0;
+}
+
+/**
+ * Referenz fuer glTranslate.
+ *
+ * @param m die Matrix (Out)
+ * @param x, y, z die Verschiebung (In)
+ */
+static void refTranslate(RefMatrix m, double x, double y, double z)
+{
+	refIdentity(m);
+	m[12] = x;
+	m[13] = y;
+	m[14] = z;
+}
+
+/**
+ * Referenz fuer glRotate (Formel aus der OpenGL-Spezifikation).
+ *
+ * @param m die Matrix (Out)
+ * @param angle der Winkel in Grad (In)
+ * @param x, y, z die Achse (In)
+ */
+static void refRotate(RefMatrix m, double angle, double x, double y, double z)
+{
+	double length = sqrt(x * x + y * y + z * z);
+	double c = cos(angle * M_PI / 180.0);
+	double s = sin(angle * M_PI / 180.0);
+
+	x /= length;
+	y /= length;
+	z /= length;
+
+	refIdentity(m);
+	m[0] = x * x * (1 - c) + c;
+	m[1] = y * x * (1 - c) + z * s;
+	m[2] = x * z * (1 - c) - y * s;
+	m[4] = x * y * (1 - c) - z * s;
+	m[5] = y * y * (1 - c) + c;
+	m[6] = y * z * (1 - c) + x * s;
+	m[8] = x * z * (1 - c) + y * s;
+	m[9] = y * z * (1 - c) - x * s;
+	m[10] = z * z * (1 - c) + c;
+}
+
+/**
+ * Referenz fuer glScale.
+ *
+ * @param m die Matrix (Out)
+ * @param x, y, z die Faktoren (In)
+ */
+static void refScale(RefMatrix m, double x, double y, double z)
+{
+	refIdentity(m);
+	m[0] = x;
+	m[5] = y;
+	m[10] = z;
+}
+
+/**
+ * Referenz fuer glFrustum.
+ *
+ * @param m die Matrix (Out)
+ * @param l, r, b, t die Grenzen an der nahen Ebene (In)
+ * @param n, f die Clipping-Ebenen (In)
+ */
+static void refFrustum(RefMatrix m, double l, double r, double b, double t, double n, double f)
+{
+	memset(m, 0, sizeof(RefMatrix));
+	m[0] = 2 * n / (r - l);
+	m[5] = 2 * n / (t - b);
+	m[8] = (r + l) / (r - l);
+	m[9] = (t + b) / (t - b);
+	m[10] = -(f + n) / (f - n);
+	m[11] = -1;
+	m[14] = -2 * f * n / (f - n);
+}
+
+/**
+ * Referenz fuer gluPerspective.
+ *
+ * @param m die Matrix (Out)
+ * @param fovy der Oeffnungswinkel in Grad (In)
+ * @param aspect das Seitenverhaeltnis (In)
+ * @param n, f die Clipping-Ebenen (In)
+ */
+static void refPerspective(RefMatrix m, double fovy, double aspect, double n, double f)
+{
+	double cotangent = 1.0 / tan(fovy * M_PI / 360.0);
+
+	memset(m, 0, sizeof(RefMatrix));
+	m[0] = cotangent / aspect;
+	m[5] = cotangent;
+	m[10] = -(f + n) / (f - n);
+	m[11] = -1;
+	m[14] = -2 * n * f / (f - n);
+}
+
+/**
+ * Referenz fuer glOrtho.
+ *
+ * @param m die Matrix (Out)
+ * @param l, r, b, t die Grenzen (In)
+ * @param n, f die Clipping-Ebenen (In)
+ */
+static void refOrtho(RefMatrix m, double l, double r, double b, double t, double n, double f)
+{
+	refIdentity(m);
+	m[0] = 2 / (r - l);
+	m[5] = 2 / (t - b);
+	m[10] = -2 / (f - n);
+	m[12] = -(r + l) / (r - l);
+	m[13] = -(t + b) / (t - b);
+	m[14] = -(f + n) / (f - n);
+}
+
+/**
+ * Referenz fuer gluLookAt: Rotation aus Seiten-, Up- und Blickvektor,
+ * gefolgt von der Verschiebung um den negativen Augpunkt.
+ *
+ * @param m die Matrix (Out)
+ * @param eye der Augpunkt (In)
+ * @param center der betrachtete Punkt (In)
+ * @param up der Up-Vektor (In)
+ */
+static void refLookAt(RefMatrix m, const double eye[3], const double center[3], const double up[3])
+{
+	double f[3] = { center[0] - eye[0], center[1] - eye[1], center[2] - eye[2] };
+	double s[3];
+	double u[3];
+	double length;
+
+	length = sqrt(f[0] * f[0] + f[1] * f[1] + f[2] * f[2]);
+	f[0] /= length;
+	f[1] /= length;
+	f[2] /= length;
+
+	s[0] = f[1] * up[2] - f[2] * up[1];
+	s[1] = f[2] * up[0] - f[0] * up[2];
+	s[2] = f[0] * up[1] - f[1] * up[0];
+	length = sqrt(s[0] * s[0] + s[1] * s[1] + s[2] * s[2]);
+	s[0] /= length;
+	s[1] /= length;
+	s[2] /= length;
+
+	u[0] = s[1] * f[2] - s[2] * f[1];
+	u[1] = s[2] * f[0] - s[0] * f[2];
+	u[2] = s[0] * f[1] - s[1] * f[0];
+
+	refIdentity(m);
+	for (int i = 0; i < 3; i++)
+	{
+		m[i * 4] = s[i];
+		m[i * 4 + 1] = u[i];
+		m[i * 4 + 2] = -f[i];
+	}
+
+	RefMatrix translation;
+	refTranslate(translation, -eye[0], -eye[1], -eye[2]);
+	refMultiplyRight(m, translation);
+}
+
+/**
+ * Referenz fuer die Inversion: Gauss-Jordan mit Spaltenpivotsuche wie
+ * __gluInvertMatrixd in GLU.
+ *
+ * @param res die Inverse (Out)
+ * @param src die Matrix (In)
+ *
+ * @return 0, wenn die Matrix singulaer ist.
+ */
+static int refInvert(RefMatrix res, const RefMatrix src)
+{
+	double temp[4][4];
+
+	refIdentity(res);
+	for (int i = 0; i < 4; i++)
+	{
+		for (int j = 0; j < 4; j++)
+		{
+			temp[i][j] = src[i * 4 + j];
+		}
+	}
+
+	for (int i = 0; i < 4; i++)
+	{
+		/* Zeile mit dem groessten Pivot suchen */
+		int swap = i;
+		for (int j = i + 1; j < 4; j++)
+		{
+			if (fabs(temp[j][i]) > fabs(temp[swap][i]))
+			{
+				swap = j;
+			}
+		}
+
+		if (swap != i)
+		{
+			for (int k = 0; k < 4; k++)
+			{
+				double t = temp[i][k];
+				temp[i][k] = temp[swap][k];
+				temp[swap][k] = t;
+
+				t = res[i * 4 + k];
+				res[i * 4 + k] = res[swap * 4 + k];
+				res[swap * 4 + k] = t;
+			}
+		}
+
+		if (temp[i][i] == 0.0)
+		{
+			return 0;
+		}
+
+		double pivot = temp[i][i];
+		for (int k = 0; k < 4; k++)
+		{
+			temp[i][k] /= pivot;
+			res[i * 4 + k] /= pivot;
+		}
+
+		for (int j = 0; j < 4; j++)
+		{
+			if (j != i)
+			{
+				double factor = temp[j][i];
+				for (int k = 0; k < 4; k++)
+				{
+					temp[j][k] -= temp[i][k] * factor;
+					res[j * 4 + k] -= res[i * 4 + k] * factor;
+				}
+			}
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * Vergleicht Werte mit einer Referenz und meldet die groesste Abweichung.
+ *
+ * @param name der Name der Pruefung (In)
+ * @param caseIndex der Zufallsfall (In)
+ * @param values die berechneten Werte (In)
+ * @param reference die Referenzwerte (In)
+ * @param count die Anzahl der Werte (In)
+ * @param tolerance die zulaessige relative Abweichung (In)
+ *
+ * @return 1, wenn alle Werte innerhalb der Toleranz liegen.
+ */
+static int compare(const char *name, int caseIndex, const float *values, const double *reference,
+                   int count, double tolerance)
+{
+	for (int i = 0; i < count; i++)
+	{
+		double scale = fabs(reference[i]) > 1.0 ? fabs(reference[i]) : 1.0;
+
+		if (!(fabs(values[i] - reference[i]) <= tolerance * scale))
+		{
+			printf("FEHLER %s, Fall %d, Element %d: %g statt %g\n",
+			       name, caseIndex, i, values[i], reference[i]);
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * Gibt das Ergebnis einer Pruefung aus und zaehlt Fehlschlaege.
+ *
+ * @param name der Name der Pruefung (In)
+ * @param passed ob alle Faelle bestanden wurden (In)
+ */
+static void report(const char *name, int passed)
+{
+	printf("%-8s %s\n", passed ? "ok" : "FEHLER", name);
+
+	if (!passed)
+	{
+		g_failures++;
+	}
+}
+
+/**
+ * Prueft Einheitsmatrix und Multiplikation, auch mit res = a und res = b.
+ */
+static void testMultiply(void)
+{
+	int passed = 1;
+
+	CGMatrix4f identity;
+	double refId[16];
+	matrix_identity(identity);
+	refIdentity(refId);
+	passed &= compare("matrix_identity", 0, identity, refId, 16, 0.0);
+
+	for (int n = 0; n < CASES && passed; n++)
+	{
+		CGMatrix4f a, b, res;
+		RefMatrix ra, rb, expected;
+
+		randomMatrix(a);
+		randomMatrix(b);
+		toRef(ra, a);
+		toRef(rb, b);
+		refMultiply(expected, ra, rb);
+
+		matrix_multiply(res, a, b);
+		passed &= compare("matrix_multiply", n, res, expected, 16, TOLERANCE);
+
+		matrix_multiply(a, a, b);
+		passed &= compare("matrix_multiply (res = a)", n, a, expected, 16, TOLERANCE);
+
+		toRef(ra, res);
+		memcpy(a, res, sizeof(CGMatrix4f));
+		refMultiply(expected, rb, ra);
+		matrix_multiply(a, b, a);
+		passed &= compare("matrix_multiply (res = b)", n, a, expected, 16, TOLERANCE);
+	}
+
+	report("matrix_identity, matrix_multiply", passed);
+}
+
+/**
+ * Prueft Verschiebung, Rotation und Skalierung gegen glTranslate, glRotate
+ * und glScale, jeweils von rechts an eine Zufallsmatrix multipliziert.
+ */
+static void testModelTransforms(void)
+{
+	int passed = 1;
+
+	for (int n = 0; n < CASES && passed; n++)
+	{
+		CGMatrix4f m;
+		RefMatrix expected, op;
+		float x = randomRange(-5.0f, 5.0f);
+		float y = randomRange(-5.0f, 5.0f);
+		float z = randomRange(-5.0f, 5.0f);
+		float angle = randomRange(-360.0f, 360.0f);
+
+		randomMatrix(m);
+		toRef(expected, m);
+
+		matrix_translate(m, x, y, z);
+		refTranslate(op, x, y, z);
+		refMultiplyRight(expected, op);
+		passed &= compare("matrix_translate", n, m, expected, 16, TOLERANCE);
+
+		matrix_rotate(m, angle, x, y, z);
+		refRotate(op, angle, x, y, z);
+		refMultiplyRight(expected, op);
+		passed &= compare("matrix_rotate", n, m, expected, 16, TOLERANCE);
+
+		matrix_scale(m, x, y, z);
+		refScale(op, x, y, z);
+		refMultiplyRight(expected, op);
+		passed &= compare("matrix_scale", n, m, expected, 16, TOLERANCE);
+	}
+
+	report("matrix_translate, matrix_rotate, matrix_scale", passed);
+}
+
+/**
+ * Prueft die Projektionen gegen glFrustum, gluPerspective und glOrtho.
+ */
+static void testProjections(void)
+{
+	int passed = 1;
+
+	for (int n = 0; n < CASES && passed; n++)
+	{
+		CGMatrix4f m;
+		RefMatrix expected;
+		float left = randomRange(-3.0f, -0.1f);
+		float right = randomRange(0.1f, 3.0f);
+		float bottom = randomRange(-3.0f, -0.1f);
+		float top = randomRange(0.1f, 3.0f);
+		float znear = randomRange(0.01f, 2.0f);
+		float zfar = znear + randomRange(1.0f, 500.0f);
+		float fovy = randomRange(10.0f, 120.0f);
+		float aspect = randomRange(0.5f, 2.5f);
+
+		matrix_frustum(m, left, right, bottom, top, znear, zfar);
+		refFrustum(expected, left, right, bottom, top, znear, zfar);
+		passed &= compare("matrix_frustum", n, m, expected, 16, TOLERANCE);
+
+		matrix_perspective(m, fovy, aspect, znear, zfar);
+		refPerspective(expected, fovy, aspect, znear, zfar);
+		passed &= compare("matrix_perspective", n, m, expected, 16, TOLERANCE);
+
+		matrix_ortho(m, left, right, bottom, top, znear, zfar);
+		refOrtho(expected, left, right, bottom, top, znear, zfar);
+		passed &= compare("matrix_ortho", n, m, expected, 16, TOLERANCE);
+	}
+
+	report("matrix_frustum, matrix_perspective, matrix_ortho", passed);
+}
+
+/**
+ * Prueft die Kameramatrix gegen gluLookAt.
+ */
+static void testLookAt(void)
+{
+	int passed = 1;
+
+	for (int n = 0; n < CASES && passed; n++)
+	{
+		CGMatrix4f m;
+		RefMatrix expected;
+		float eye[3], center[3], up[3];
+		double refEye[3], refCenter[3], refUp[3];
+
+		for (int i = 0; i < 3; i++)
+		{
+			eye[i] = randomRange(-10.0f, 10.0f);
+			center[i] = randomRange(-10.0f, 10.0f);
+			up[i] = randomRange(-1.0f, 1.0f);
+			refEye[i] = eye[i];
+			refCenter[i] = center[i];
+			refUp[i] = up[i];
+		}
+
+		/* Blickrichtung und Up-Vektor duerfen nicht (fast) parallel sein */
+		double f[3] = { refCenter[0] - refEye[0], refCenter[1] - refEye[1], refCenter[2] - refEye[2] };
+		double cross[3] = { f[1] * refUp[2] - f[2] * refUp[1],
+		                    f[2] * refUp[0] - f[0] * refUp[2],
+		                    f[0] * refUp[1] - f[1] * refUp[0] };
+		double lengthF = sqrt(f[0] * f[0] + f[1] * f[1] + f[2] * f[2]);
+		double lengthUp = sqrt(refUp[0] * refUp[0] + refUp[1] * refUp[1] + refUp[2] * refUp[2]);
+		double lengthCross = sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+		if (lengthCross < 0.1 * lengthF * lengthUp)
+		{
+			continue;
+		}
+
+		matrix_lookAt(m, eye[0], eye[1], eye[2], center[0], center[1], center[2], up[0], up[1], up[2]);
+		refLookAt(expected, refEye, refCenter, refUp);
+		passed &= compare("matrix_lookAt", n, m, expected, 16, TOLERANCE);
+	}
+
+	report("matrix_lookAt", passed);
+}
+
+/**
+ * Prueft Inverse und Normalenmatrix gegen das Gauss-Jordan-Verfahren von
+ * GLU sowie das Verhalten bei singulaeren Matrizen.
+ */
+static void testInverse(void)
+{
+	int passed = 1;
+
+	for (int n = 0; n < CASES && passed; n++)
+	{
+		CGMatrix4f m, inv;
+		RefMatrix rm, expected;
+
+		randomMatrix(m);
+		toRef(rm, m);
+		refInvert(expected, rm);
+
+		passed &= matrix_invert(inv, m);
+		passed &= compare("matrix_invert", n, inv, expected, 16, TOLERANCE_INVERSE);
+
+		passed &= matrix_invert(m, m);
+		passed &= compare("matrix_invert (res = m)", n, m, expected, 16, TOLERANCE_INVERSE);
+
+		/* Normalenmatrix: Inverse-Transponierte des oberen linken 3x3-Teils.
+		 * Bei affiner Matrix ist das der obere linke 3x3-Teil der
+		 * transponierten 4x4-Inversen. */
+		CGMatrix3f normal;
+		double normalExpected[9];
+
+		randomMatrix(m);
+		m[3] = m[7] = m[11] = 0.0f;
+		m[15] = 1.0f;
+		toRef(rm, m);
+		refInvert(expected, rm);
+		for (int i = 0; i < 3; i++)
+		{
+			for (int j = 0; j < 3; j++)
+			{
+				normalExpected[j * 3 + i] = expected[i * 4 + j];
+			}
+		}
+
+		passed &= matrix_normal(normal, m);
+		passed &= compare("matrix_normal", n, normal, normalExpected, 9, TOLERANCE_INVERSE);
+	}
+
+	/* Singulaere Matrix: Rueckgabe 0, Ergebnis bleibt unveraendert */
+	CGMatrix4f singular = { 0 };
+	CGMatrix4f untouched;
+	CGMatrix3f untouched3;
+	double zero[16] = { 0 };
+
+	memset(untouched, 0, sizeof(untouched));
+	memset(untouched3, 0, sizeof(untouched3));
+	passed &= !matrix_invert(untouched, singular);
+	passed &= compare("matrix_invert (singulaer)", 0, untouched, zero, 16, 0.0);
+	passed &= !matrix_normal(untouched3, singular);
+
+	report("matrix_invert, matrix_normal", passed);
+}
+
+/**
+ * Prueft die Ebenen des Sichtvolumens: Fuer Zufallspunkte muss das
+ * Vorzeichen der Abstaende mit dem Clipping im Clip-Space uebereinstimmen,
+ * die Normalen muessen normiert sein und der Abstand zur nahen Ebene muss
+ * euklidisch sein. Geprueft wird mit Projektion * Kamera, also im
+ * Weltsystem.
+ */
+static void testFrustumPlanes(void)
+{
+	int passed = 1;
+
+	for (int n = 0; n < CASES && passed; n++)
+	{
+		CGMatrix4f projection, view, m;
+		CGVector4f planes[PLANE_COUNT];
+		float znear = randomRange(0.1f, 2.0f);
+		float zfar = znear + randomRange(5.0f, 50.0f);
+
+		matrix_perspective(projection, randomRange(30.0f, 90.0f), randomRange(0.5f, 2.0f), znear, zfar);
+		matrix_lookAt(view, randomRange(-5.0f, 5.0f), randomRange(-5.0f, 5.0f), randomRange(-5.0f, 5.0f),
+		              0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+		matrix_multiply(m, projection, view);
+		matrix_frustumPlanes(planes, m);
+
+		for (int p = 0; p < PLANE_COUNT; p++)
+		{
+			double length = sqrt(planes[p][0] * planes[p][0] + planes[p][1] * planes[p][1]
+			                     + planes[p][2] * planes[p][2]);
+			passed &= fabs(length - 1.0) < TOLERANCE;
+		}
+
+		for (int k = 0; k < 100; k++)
+		{
+			CGVector4f point = { randomRange(-60.0f, 60.0f), randomRange(-60.0f, 60.0f),
+			                     randomRange(-60.0f, 60.0f), 1.0f };
+			RefMatrix rm;
+			double clip[4] = { 0.0, 0.0, 0.0, 0.0 };
+
+			toRef(rm, m);
+			for (int i = 0; i < 4; i++)
+			{
+				for (int j = 0; j < 4; j++)
+				{
+					clip[i] += rm[j * 4 + i] * point[j];
+				}
+			}
+
+			double clipDistances[PLANE_COUNT] = {
+				clip[3] + clip[0], clip[3] - clip[0],
+				clip[3] + clip[1], clip[3] - clip[1],
+				clip[3] + clip[2], clip[3] - clip[2]
+			};
+
+			/* Punkte sehr nah an einer Ebene haben kein sicheres Vorzeichen */
+			for (int p = 0; p < PLANE_COUNT; p++)
+			{
+				double distance = planes[p][0] * point[0] + planes[p][1] * point[1]
+				                + planes[p][2] * point[2] + planes[p][3];
+
+				if (fabs(clipDistances[p]) > 1e-3 && (distance > 0.0) != (clipDistances[p] > 0.0))
+				{
+					printf("FEHLER matrix_frustumPlanes, Fall %d, Ebene %d: Vorzeichen falsch\n", n, p);
+					passed = 0;
+				}
+			}
+		}
+
+		/* Im Kamerasystem ist der Abstand eines Punktes auf der Blickachse zur
+		 * nahen Ebene seine Tiefe minus znear */
+		matrix_frustumPlanes(planes, projection);
+		float depth = randomRange(znear, zfar);
+		double nearExpected = depth - znear;
+		float nearDistance = -planes[PLANE_NEAR][2] * depth + planes[PLANE_NEAR][3];
+		passed &= compare("matrix_frustumPlanes (Abstand)", n, &nearDistance, &nearExpected, 1, 1e-4);
+
+		/* Kugeln knapp ausserhalb der nahen Ebene */
+		passed &= matrix_sphereInFrustum(planes, 0.0f, 0.0f, -znear + 0.5f, 0.6f);
+		passed &= !matrix_sphereInFrustum(planes, 0.0f, 0.0f, -znear + 0.5f, 0.4f);
+	}
+
+	report("matrix_frustumPlanes, matrix_sphereInFrustum", passed);
+}
+
+/**
+ * Prueft Einzel- und Batch-Transformation, auch mit res = v.
+ */
+static void testTransform(void)
+{
+	int passed = 1;
+	CGVector4f vectors[17];
+	CGVector4f results[17];
+	double expected[17][4];
+
+	for (int n = 0; n < CASES && passed; n++)
+	{
+		CGMatrix4f m;
+		RefMatrix rm;
+
+		randomMatrix(m);
+		toRef(rm, m);
+
+		for (int v = 0; v < 17; v++)
+		{
+			for (int i = 0; i < 4; i++)
+			{
+				vectors[v][i] = randomRange(-10.0f, 10.0f);
+			}
+
+			for (int i = 0; i < 4; i++)
+			{
+				expected[v][i] = 0.0;
+				for (int j = 0; j < 4; j++)
+				{
+					expected[v][i] += rm[j * 4 + i] * vectors[v][j];
+				}
+			}
+		}
+
+		matrix_transform(results[0], m, vectors[0]);
+		passed &= compare("matrix_transform", n, results[0], expected[0], 4, TOLERANCE);
+
+		/* Ungerade Anzahl, damit auch ein Rest nach ganzen Bloecken vorkommt */
+		matrix_transformArray(results, m, vectors, 17);
+		passed &= compare("matrix_transformArray", n, results[0], expected[0], 17 * 4, TOLERANCE);
+
+		matrix_transformArray(vectors, m, vectors, 17);
+		passed &= compare("matrix_transformArray (res = v)", n, vectors[0], expected[0], 17 * 4, TOLERANCE);
+	}
+
+	report("matrix_transform, matrix_transformArray", passed);
+}
+
+/**
+ * Skalare Multiplikation als Vergleich fuer die Messung.
+ *
+ * @param res das Ergebnis (Out)
+ * @param a linker Faktor (In)
+ * @param b rechter Faktor (In)
+ */
+static void scalarMultiply(CGMatrix4f res, const CGMatrix4f a, const CGMatrix4f b)
+{
+	CGMatrix4f tmp;
+
+	for (int j = 0; j < 4; j++)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			tmp[j * 4 + i] = a[i] * b[j * 4] + a[4 + i] * b[j * 4 + 1]
+			               + a[8 + i] * b[j * 4 + 2] + a[12 + i] * b[j * 4 + 3];
+		}
+	}
+
+	memcpy(res, tmp, sizeof(CGMatrix4f));
+}
+
+/**
+ * Skalare Batch-Transformation als Vergleich fuer die Messung.
+ *
+ * @param res die Ergebnisse (Out)
+ * @param m die Matrix (In)
+ * @param v die Vektoren (In)
+ * @param count die Anzahl (In)
+ */
+static void scalarTransformArray(CGVector4f *res, const CGMatrix4f m, CGVector4f *v, int count)
+{
+	for (int n = 0; n < count; n++)
+	{
+		float x = v[n][0], y = v[n][1], z = v[n][2], w = v[n][3];
+
+		for (int i = 0; i < 4; i++)
+		{
+			res[n][i] = m[i] * x + m[4 + i] * y + m[8 + i] * z + m[12 + i] * w;
+		}
+	}
+}
+
+/**
+ * Misst Multiplikation und Batch-Transformation des Moduls gegen die
+ * skalaren Vergleichsschleifen und gibt die Zeit pro Operation aus.
+ */
+static void benchmark(void)
+{
+	CGMatrix4f a, b, acc;
+	double start;
+
+	randomMatrix(a);
+	randomMatrix(b);
+
+	/* Multiplikation: Jede Runde haengt von der vorherigen ab */
+	for (int variant = 0; variant < 2; variant++)
+	{
+		matrix_identity(acc);
+		start = now();
+		for (int n = 0; n < BENCH_MULTIPLIES; n++)
+		{
+			if (variant == 0)
+			{
+				matrix_multiply(acc, acc, (n & 1) ? a : b);
+			}
+			else
+			{
+				scalarMultiply(acc, acc, (n & 1) ? a : b);
+			}
+
+			/* Werte begrenzen, damit keine Ueberlaeufe gemessen werden */
+			if ((n & 63) == 63)
+			{
+				matrix_identity(acc);
+			}
+		}
+		g_sink = acc[0];
+		printf("%-32s %8.2f ns\n", variant == 0 ? "matrix_multiply" : "skalare Multiplikation",
+		       (now() - start) * 1e9 / BENCH_MULTIPLIES);
+	}
+
+	/* Batch-Transformation */
+	CGVector4f *vectors = malloc(sizeof(CGVector4f) * BENCH_VECTORS);
+	CGVector4f *results = malloc(sizeof(CGVector4f) * BENCH_VECTORS);
+
+	if (vectors == NULL || results == NULL)
+	{
+		free(vectors);
+		free(results);
+		return;
+	}
+
+	for (int n = 0; n < BENCH_VECTORS; n++)
+	{
+		vectors[n][0] = randomRange(-10.0f, 10.0f);
+		vectors[n][1] = randomRange(-10.0f, 10.0f);
+		vectors[n][2] = randomRange(-10.0f, 10.0f);
+		vectors[n][3] = 1.0f;
+	}
+
+	for (int variant = 0; variant < 2; variant++)
+	{
+		start = now();
+		for (int r = 0; r < BENCH_ROUNDS; r++)
+		{
+			if (variant == 0)
+			{
+				matrix_transformArray(results, a, vectors, BENCH_VECTORS);
+			}
+			else
+			{
+				scalarTransformArray(results, a, vectors, BENCH_VECTORS);
+			}
+			g_sink = results[r][0];
+		}
+		printf("%-32s %8.2f ns/Vektor\n",
+		       variant == 0 ? "matrix_transformArray" : "skalare Batch-Transformation",
+		       (now() - start) * 1e9 / ((double)BENCH_ROUNDS * BENCH_VECTORS));
+	}
+
+	free(vectors);
+	free(results);
+}
+
+/* ---- Oeffentliche Funktionen ---- */
+
+/**
+ * Hauptprogramm.
+ *
+ * @param argc Anzahl der Kommandozeilenparameter (In)
+ * @param argv Kommandozeilenparameter (In)
+ *
+ * @return 0, wenn alle Pruefungen bestanden wurden, sonst 1
+ */
+int main(int argc, char **argv)
+{
+	int bench = 0;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--bench") == 0)
+		{
+			bench = 1;
+		}
+		else
+		{
+			fprintf(stderr, "Aufruf: %s [--bench]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	/* Feste Zufallsfolge, damit Fehler reproduzierbar sind */
+	srand(1);
+
+	testMultiply();
+	testModelTransforms();
+	testProjections();
+	testLookAt();
+	testInverse();
+	testFrustumPlanes();
+	testTransform();
+
+	if (bench)
+	{
+		benchmark();
+	}
+
+	if (g_failures > 0)
+	{
+		printf("%d Pruefung(en) fehlgeschlagen\n", g_failures);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,1621 @@
+/**
+ * @file
+ * Suchmodul.
+ * Breitensuche ueber die Spielzustaende eines Levels, Schicht fuer Schicht.
+ *
+ * Ein Zustand besteht aus dem Feld des Spielers, der Phase der Wasseruhr und
+ * je 4 Bit fuer jedes Feld, das sich im Spiel aendern kann (frei, Wasser,
+ * Sand, Zucker, nasser Zucker mit Restzeit). Waende, schwarze Felder und
+ * Ziele liegen nur einmal im Modell des Levels. Jeder Zustand traegt einen
+ * Zobrist-Hash, der beim Aendern eines Feldes per XOR nachgefuehrt wird.
+ *
+ * Die Entfernung des Spielers zum naechsten Ziel, gemessen ohne Sand, Zucker
+ * und Wasser, ist eine untere Schranke h fuer die restlichen Schritte. Die
+ * Breitensuche verwirft daher alle Zustaende mit g + h ueber einer Grenze und
+ * wird mit hoeherer Grenze wiederholt, solange sie dabei erfolglos bleibt.
+ * Die erste Loesung ist so weiterhin eine kuerzeste, die Suche besucht aber
+ * nur Zustaende, von denen aus das Ziel noch rechtzeitig erreichbar ist.
+ *
+ * Besuchte Zustaende stehen in einer Hashtabelle mit offener Adressierung,
+ * die ohne Sperren von allen Threads gefuellt wird: ein Eintrag ist ein
+ * 64-Bit-Wort aus einem Teil des Hashes und einer Referenz auf den Zustand
+ * und wird per Compare-and-Swap gesetzt. Jeder Thread legt seine Zustaende
+ * in eigenen Speicherbloecken ab, die sich nie verschieben. Auf Unix-Systemen
+ * wird jede grosse Schicht der Suche auf mehrere Threads verteilt.
+ *
+ * Bestandteil einer Uebung im Rahmen des Moduls Praktikum Grundlagen der Computergrafik
+ * an der FH Wedel.
+ *
+ * @author Nicolas Hollmann, Daniel Klintworth
+ */
+
+/* ---- System Header einbinden ---- */
+#if defined(__unix__) || defined(__APPLE__)
+#define SEARCH_THREADS
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+/* ---- Eigene Header einbinden ---- */
+#include "search.h"
+
+/* ---- Konstanten ---- */
+
+/** Schritte zwischen zwei Ausbreitungen des Wassers (UPDATE_COOLDOWN_TIME / PLAYER_COOLDOWN_TIME) */
+#define WATER_STEPS (4)
+
+/** Schritte, bis sich nasser Zucker aufloest (SUGAR_LIFETIME / PLAYER_COOLDOWN_TIME) */
+#define WET_STEPS (10)
+
+/* Codes der veraenderlichen Felder, je 4 Bit im Zustand */
+#define CODE_FREE (0)
+#define CODE_WATER (1)
+#define CODE_SAND (2)
+#define CODE_SUGAR (3)
+/* Nasser Zucker, CODE_WET + n hat noch n + 1 Schritte */
+#define CODE_WET (4)
+#define CODE_COUNT (CODE_WET + WET_STEPS)
+
+/** Bytes vor den Feldcodes: Feld des Spielers (4 Byte) und Phase der Wasseruhr */
+#define STATE_HEADER (5)
+
+/** Bytes vor dem Zustand in einem Eintrag: Herkunft, Hash, Platz in der Tabelle */
+#define RECORD_HEADER (3 * sizeof(uint64_t))
+
+/** Hoechstens so viele Zustaende je Speicherblock eines Threads, als Zweierpotenz */
+#define CHUNK_BITS (14)
+
+/** Groesse, ab der ein Speicherblock weniger Zustaende aufnimmt */
+#define CHUNK_MAX_BYTES ((size_t)16 << 20)
+
+/** Bits fuer den Index eines Zustands innerhalb eines Threads */
+#define REF_INDEX_BITS (34)
+
+/** Bits der Referenz in einem Tabelleneintrag, darueber liegt ein Teil des Hashes */
+#define ENTRY_REF_BITS (40)
+
+/** Kleinste Hashtabelle */
+#define TABLE_MIN_SLOTS ((uint64_t)1 << 16)
+
+/** Zustaende, die sich ein Thread auf einmal aus der Front nimmt */
+#define FRONTIER_BLOCK (64)
+
+/** Ab dieser Groesse einer Schicht lohnt sich das Aufteilen auf Threads */
+#define THREAD_MIN_FRONTIER (1024)
+
+/** Zuege: Warten und die vier Richtungen */
+#define MOVE_COUNT (5)
+
+/* ---- Typen ---- */
+
+/* Daten eines Threads */
+typedef struct {
+	unsigned char **chunks; // Speicherbloecke fuer Zustaende
+	uint64_t count;         // Belegte Eintraege in chunks
+	uint64_t *next;         // Neue Zustaende fuer die naechste Schicht
+	size_t nextCount, nextCapacity;
+	int *wet;               // Zwischenspeicher fuer die Ausbreitung des Wassers
+	int *waterSteps;        // Zwischenspeicher fuer estimateSteps: Abstand zum Wasser je Code, sonst -1
+	int *arrival;           // Zwischenspeicher fuer estimateSteps: Ankunft je Code, sonst -1
+	int *queue;             // Zwischenspeicher fuer estimateSteps: Codes mit waterSteps
+	int *touched;           // Zwischenspeicher fuer estimateSteps: Codes mit arrival
+	uint64_t *heap;         // Zwischenspeicher fuer estimateSteps
+	int pruned;             // Kleinstes verworfenes g + h, 0 fuer keines
+} Worker;
+
+struct Search {
+	SearchOptions options;
+	int threads;
+
+	/* Besuchte Zustaende */
+	uint64_t *table;
+	uint64_t mask;
+	uint64_t maxStates;
+	int chunkBits;     // Zustaende je Speicherblock als Zweierpotenz
+	size_t chunkBytes; // Groesse der angelegten Speicherbloecke
+	size_t maxChunks;  // Platz fuer Speicherbloecke je Thread
+	Worker workers[SEARCH_MAX_THREADS];
+
+	/* Modell des aktuellen Levels */
+	int width, height;
+	const wmField *fields;
+	int *dynIndex;        // Je Feld: Index des Codes im Zustand oder -1
+	int *distance;        // Je Feld: Schritte bis zum Ziel ohne Hindernisse, -1 ohne Weg
+	int *dynDistance;     // Je Code: distance des Feldes
+	int (*neighbours)[4]; // Je Code: Indizes der Codes der Nachbarfelder oder -1
+	int dynCount;
+	size_t stateSize, recordSize;
+	uint64_t *keys;       // Zobrist-Schluessel je Code und Wert
+	uint64_t *playerKeys; // Zobrist-Schluessel je Spielerfeld
+	uint64_t phaseKeys[WATER_STEPS];
+
+	/* Aktuelle Schicht */
+	int depth;  // Tiefe g der Schicht
+	int bound;  // Grenze fuer g + h
+	uint64_t *frontier;
+	size_t frontierCount, frontierCapacity;
+	uint64_t cursor;
+
+	/* Gemeinsamer Zustand aller Threads */
+	uint64_t stored; // Anzahl gespeicherter Zustaende
+	uint64_t found;  // Referenz + 1 des ersten geloesten Zustands, sonst 0
+	uint64_t full;   // Speichergrenze erreicht?
+
+	char *moves;
+};
+
+/* Auftrag eines Threads */
+typedef struct {
+	Search *search;
+	int index;
+} WorkerJob;
+
+/* ---- Konstanten - Zuege ---- */
+
+static const int g_moveX[MOVE_COUNT] = { 0, 0, 0, -1, 1 };
+static const int g_moveY[MOVE_COUNT] = { 0, -1, 1, 0, 0 };
+static const char g_moveNames[MOVE_COUNT] = { '.', 'u', 'd', 'l', 'r' };
+
+/* ---- Interne Funktionen - Atomare Operationen ---- */
+
+/**
+ * Liest einen gemeinsam genutzten Wert.
+ *
+ * @param value der Wert. (In)
+ *
+ * @return der Inhalt.
+ */
+static uint64_t atomicLoad(uint64_t *value)
+{
+#ifdef SEARCH_THREADS
+	return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#else
+	return *value;
+#endif
+}
+
+/**
+ * Setzt einen gemeinsam genutzten Wert, falls er noch den erwarteten Inhalt hat.
+ *
+ * @param value der Wert. (InOut)
+ * @param expected der erwartete Inhalt, danach der tatsaechliche. (InOut)
+ * @param desired der neue Inhalt. (In)
+ *
+ * @return 1, wenn der Wert gesetzt wurde.
+ */
+static int atomicSwap(uint64_t *value, uint64_t *expected, uint64_t desired)
+{
+#ifdef SEARCH_THREADS
+	return __atomic_compare_exchange_n(value, expected, desired, 0,
+	                                   __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+#else
+	if (*value != *expected)
+	{
+		*expected = *value;
+		return 0;
+	}
+	*value = desired;
+	return 1;
+#endif
+}
+
+/**
+ * Erhoeht einen gemeinsam genutzten Zaehler.
+ *
+ * @param value der Zaehler. (InOut)
+ * @param add der Summand. (In)
+ *
+ * @return der Zaehler vor dem Erhoehen.
+ */
+static uint64_t atomicAdd(uint64_t *value, uint64_t add)
+{
+#ifdef SEARCH_THREADS
+	return __atomic_fetch_add(value, add, __ATOMIC_ACQ_REL);
+#else
+	uint64_t old = *value;
+	*value += add;
+	return old;
+#endif
+}
+
+/* ---- Interne Funktionen - Zustaende ---- */
+
+/**
+ * Liefert die aktuelle Zeit in Sekunden.
+ *
+ * @return die Zeit.
+ */
+static double now(void)
+{
+#ifdef SEARCH_THREADS
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return time.tv_sec + time.tv_nsec * 1e-9;
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+/**
+ * Liefert die naechste Zahl eines Zufallsgenerators (SplitMix64). Die
+ * Zobrist-Schluessel sind so bei jedem Lauf gleich.
+ *
+ * @param seed der Zustand des Generators. (InOut)
+ *
+ * @return die Zufallszahl.
+ */
+static uint64_t nextRandom(uint64_t *seed)
+{
+	uint64_t z = (*seed += 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+/**
+ * Liefert den Code eines veraenderlichen Feldes.
+ *
+ * @param state der Zustand. (In)
+ * @param dyn der Index des Codes. (In)
+ *
+ * @return der Code.
+ */
+static int getCode(const unsigned char *state, int dyn)
+{
+	unsigned char byte = state[STATE_HEADER + dyn / 2];
+	return (dyn & 1) ? (byte >> 4) : (byte & 0x0f);
+}
+
+/**
+ * Setzt den Code eines veraenderlichen Feldes und fuehrt den Hash nach.
+ *
+ * @param search die Suche. (In)
+ * @param state der Zustand. (InOut)
+ * @param hash der Hash des Zustands. (InOut)
+ * @param dyn der Index des Codes. (In)
+ * @param code der neue Code. (In)
+ */
+static void setCode(const Search *search, unsigned char *state, uint64_t *hash, int dyn, int code)
+{
+	unsigned char *byte = &state[STATE_HEADER + dyn / 2];
+	int old = getCode(state, dyn);
+
+	*byte = (dyn & 1) ? (unsigned char)((*byte & 0x0f) | (code << 4))
+	                  : (unsigned char)((*byte & 0xf0) | code);
+	*hash ^= search->keys[dyn * CODE_COUNT + old] ^ search->keys[dyn * CODE_COUNT + code];
+}
+
+/**
+ * Liefert das Feld des Spielers.
+ *
+ * @param state der Zustand. (In)
+ *
+ * @return der Index des Feldes.
+ */
+static int getPlayer(const unsigned char *state)
+{
+	uint32_t cell;
+	memcpy(&cell, state, sizeof(cell));
+	return (int)cell;
+}
+
+/**
+ * Setzt das Feld des Spielers und fuehrt den Hash nach.
+ *
+ * @param search die Suche. (In)
+ * @param state der Zustand. (InOut)
+ * @param hash der Hash des Zustands. (InOut)
+ * @param cell der Index des Feldes. (In)
+ */
+static void setPlayer(const Search *search, unsigned char *state, uint64_t *hash, int cell)
+{
+	uint32_t value = (uint32_t)cell;
+
+	*hash ^= search->playerKeys[getPlayer(state)] ^ search->playerKeys[cell];
+	memcpy(state, &value, sizeof(value));
+}
+
+/**
+ * Liefert einen gespeicherten Zustand samt Kopf.
+ *
+ * @param search die Suche. (In)
+ * @param ref die Referenz: Thread in den oberen Bits, darunter der Index. (In)
+ *
+ * @return der Eintrag.
+ */
+static unsigned char *getRecord(const Search *search, uint64_t ref)
+{
+	const Worker *worker = &search->workers[ref >> REF_INDEX_BITS];
+	uint64_t index = ref & (((uint64_t)1 << REF_INDEX_BITS) - 1);
+
+	uint64_t mask = ((uint64_t)1 << search->chunkBits) - 1;
+
+	return worker->chunks[index >> search->chunkBits] + (index & mask) * search->recordSize;
+}
+
+/**
+ * Liefert den naechsten freien Eintrag eines Threads und legt bei Bedarf
+ * einen neuen Speicherblock an.
+ *
+ * @param search die Suche. (In)
+ * @param worker der Thread. (InOut)
+ *
+ * @return der Eintrag oder NULL, wenn die Speichergrenze erreicht ist.
+ */
+static unsigned char *reserveRecord(Search *search, Worker *worker)
+{
+	size_t chunk = (size_t)(worker->count >> search->chunkBits);
+	uint64_t mask = ((uint64_t)1 << search->chunkBits) - 1;
+
+	if (chunk >= search->maxChunks)
+	{
+		return NULL;
+	}
+
+	if (worker->chunks[chunk] == NULL)
+	{
+		worker->chunks[chunk] = malloc(search->chunkBytes);
+		if (worker->chunks[chunk] == NULL)
+		{
+			return NULL;
+		}
+	}
+
+	return worker->chunks[chunk] + (worker->count & mask) * search->recordSize;
+}
+
+/**
+ * Traegt den zuletzt reservierten Eintrag eines Threads in die Tabelle der
+ * besuchten Zustaende ein, falls der Zustand neu ist.
+ *
+ * @param search die Suche. (InOut)
+ * @param workerIndex der Index des Threads. (In)
+ * @param record der Eintrag, Herkunft und Zustand sind gesetzt. (InOut)
+ * @param hash der Hash des Zustands. (In)
+ * @param ref die Referenz des neuen Zustands. (Out)
+ *
+ * @return 1, wenn der Zustand neu ist, 0 wenn er schon besucht wurde.
+ */
+static int insertRecord(Search *search, int workerIndex, unsigned char *record, uint64_t hash,
+                        uint64_t *ref)
+{
+	Worker *worker = &search->workers[workerIndex];
+	uint64_t *head = (uint64_t *)record;
+	uint64_t tag = hash >> ENTRY_REF_BITS;
+	uint64_t slot = hash & search->mask;
+
+	*ref = ((uint64_t)workerIndex << REF_INDEX_BITS) | worker->count;
+	head[1] = hash;
+
+	for (;;)
+	{
+		uint64_t entry = atomicLoad(&search->table[slot]);
+
+		if (entry == 0)
+		{
+			head[2] = slot;
+			if (atomicSwap(&search->table[slot], &entry, (tag << ENTRY_REF_BITS) | (*ref + 1)))
+			{
+				worker->count++;
+				if (atomicAdd(&search->stored, 1) + 1 >= search->maxStates)
+				{
+					atomicSwap(&search->full, &(uint64_t){0}, 1);
+				}
+				return 1;
+			}
+			/* Ein anderer Thread war schneller, entry ist jetzt sein Eintrag */
+		}
+
+		if ((entry >> ENTRY_REF_BITS) == tag)
+		{
+			const unsigned char *other = getRecord(search, (entry & (((uint64_t)1 << ENTRY_REF_BITS) - 1)) - 1);
+			if (memcmp(other + RECORD_HEADER, record + RECORD_HEADER, search->stateSize) == 0)
+			{
+				return 0;
+			}
+		}
+
+		slot = (slot + 1) & search->mask;
+	}
+}
+
+/**
+ * Fuehrt einen Zug des Spielers nach den Regeln von handleMovement aus.
+ *
+ * @param search die Suche. (In)
+ * @param state der Zustand. (InOut)
+ * @param hash der Hash des Zustands. (InOut)
+ * @param move der Zug, nicht Warten. (In)
+ * @param pushed 1, wenn ein Sandsack geschoben wurde. (Out)
+ *
+ * @return 1, wenn der Zug moeglich war.
+ */
+static int applyMove(const Search *search, unsigned char *state, uint64_t *hash, int move, int *pushed)
+{
+	int player = getPlayer(state);
+	int fstX = player % search->width + g_moveX[move];
+	int fstY = player / search->width + g_moveY[move];
+	int sndX = fstX + g_moveX[move];
+	int sndY = fstY + g_moveY[move];
+
+	if (fstX < 0 || fstX >= search->width || fstY < 0 || fstY >= search->height)
+	{
+		return 0;
+	}
+
+	int fst = fstY * search->width + fstX;
+	int fstDyn = search->dynIndex[fst];
+
+	*pushed = 0;
+
+	if (fstDyn < 0)
+	{
+		/* Von den festen Feldern ist nur das Ziel begehbar */
+		if (search->fields[fst] != WM_GOAL)
+		{
+			return 0;
+		}
+	}
+	else if (getCode(state, fstDyn) == CODE_SAND)
+	{
+		/* Sand laesst sich auf freie Felder und ins Wasser schieben */
+		if (sndX < 0 || sndX >= search->width || sndY < 0 || sndY >= search->height)
+		{
+			return 0;
+		}
+
+		int sndDyn = search->dynIndex[sndY * search->width + sndX];
+		int sndCode = (sndDyn >= 0) ? getCode(state, sndDyn) : -1;
+
+		if (sndCode != CODE_FREE && sndCode != CODE_WATER)
+		{
+			return 0;
+		}
+
+		setCode(search, state, hash, fstDyn, CODE_FREE);
+		setCode(search, state, hash, sndDyn, CODE_SAND);
+		*pushed = 1;
+	}
+	else if (getCode(state, fstDyn) != CODE_FREE)
+	{
+		return 0;
+	}
+
+	setPlayer(search, state, hash, fst);
+
+	return 1;
+}
+
+/**
+ * Laesst einen Schritt Zeit vergehen: nasser Zucker loest sich weiter auf,
+ * bei jedem WATER_STEPS-ten Schritt breitet sich das Wasser aus wie in
+ * updateWater.
+ *
+ * @param search die Suche. (In)
+ * @param worker der Thread, fuer den Zwischenspeicher. (InOut)
+ * @param state der Zustand. (InOut)
+ * @param hash der Hash des Zustands. (InOut)
+ *
+ * @return 0, wenn der Spieler dabei ertrinkt.
+ */
+static int advanceTime(const Search *search, Worker *worker, unsigned char *state, uint64_t *hash)
+{
+	int phase = state[STATE_HEADER - 1];
+	int next = (phase + 1) % WATER_STEPS;
+	size_t codeBytes = search->stateSize - STATE_HEADER;
+
+	state[STATE_HEADER - 1] = (unsigned char)next;
+	*hash ^= search->phaseKeys[phase] ^ search->phaseKeys[next];
+
+	/* Nasser Zucker, je Byte zwei Codes */
+	for (size_t i = 0; i < codeBytes; i++)
+	{
+		unsigned char byte = state[STATE_HEADER + i];
+
+		if ((byte & 0x0f) >= CODE_WET || (byte >> 4) >= CODE_WET)
+		{
+			for (int dyn = (int)i * 2; dyn < (int)i * 2 + 2 && dyn < search->dynCount; dyn++)
+			{
+				int code = getCode(state, dyn);
+				if (code >= CODE_WET)
+				{
+					setCode(search, state, hash, dyn, (code == CODE_WET) ? CODE_FREE : code - 1);
+				}
+			}
+		}
+	}
+
+	if (next != 0)
+	{
+		return 1;
+	}
+
+	/* Erst alle neuen Wasserfelder bestimmen, dann setzen */
+	int count = 0;
+
+	for (int dyn = 0; dyn < search->dynCount; dyn++)
+	{
+		int code = getCode(state, dyn);
+
+		if (code == CODE_FREE || code == CODE_SUGAR)
+		{
+			for (int n = 0; n < 4; n++)
+			{
+				int neighbour = search->neighbours[dyn][n];
+				if (neighbour >= 0 && getCode(state, neighbour) == CODE_WATER)
+				{
+					worker->wet[count++] = dyn;
+					break;
+				}
+			}
+		}
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		int dyn = worker->wet[i];
+		setCode(search, state, hash, dyn,
+		        (getCode(state, dyn) == CODE_FREE) ? CODE_WATER : CODE_WET + WET_STEPS - 1);
+	}
+
+	int playerDyn = search->dynIndex[getPlayer(state)];
+
+	return playerDyn < 0 || getCode(state, playerDyn) != CODE_WATER;
+}
+
+/**
+ * Legt einen Eintrag auf einen Min-Heap.
+ *
+ * @param heap der Heap. (InOut)
+ * @param count die Anzahl der Eintraege. (InOut)
+ * @param value der Eintrag. (In)
+ */
+static void heapPush(uint64_t *heap, int *count, uint64_t value)
+{
+	int i = (*count)++;
+
+	while (i > 0 && heap[(i - 1) / 2] > value)
+	{
+		heap[i] = heap[(i - 1) / 2];
+		i = (i - 1) / 2;
+	}
+	heap[i] = value;
+}
+
+/**
+ * Nimmt den kleinsten Eintrag von einem Min-Heap.
+ *
+ * @param heap der Heap, nicht leer. (InOut)
+ * @param count die Anzahl der Eintraege. (InOut)
+ *
+ * @return der Eintrag.
+ */
+static uint64_t heapPop(uint64_t *heap, int *count)
+{
+	uint64_t top = heap[0];
+	uint64_t last = heap[--(*count)];
+	int i = 0;
+
+	for (;;)
+	{
+		int child = 2 * i + 1;
+
+		if (child >= *count)
+		{
+			break;
+		}
+		if (child + 1 < *count && heap[child + 1] < heap[child])
+		{
+			child++;
+		}
+		if (heap[child] >= last)
+		{
+			break;
+		}
+		heap[i] = heap[child];
+		i = child;
+	}
+	heap[i] = last;
+
+	return top;
+}
+
+/**
+ * Bestimmt fuer alle Felder, nach wie vielen Ausbreitungen das Wasser sie
+ * fruehestens erreicht, wenn ausser Waenden nichts aufhaelt. Gerechnet wird
+ * nur bis zu einer Hoechstzahl, weiter entfernte Felder bleiben bei -1.
+ *
+ * @param search die Suche. (In)
+ * @param worker der Thread, Ergebnis in waterSteps, gesetzte Codes in queue. (InOut)
+ * @param state der Zustand. (In)
+ * @param maxSteps die Hoechstzahl der Ausbreitungen. (In)
+ *
+ * @return die Anzahl der gesetzten Codes.
+ */
+static int computeWaterSteps(const Search *search, Worker *worker, const unsigned char *state, int maxSteps)
+{
+	int *waterSteps = worker->waterSteps;
+	size_t codeBytes = search->stateSize - STATE_HEADER;
+	int head = 0, tail = 0;
+
+	for (size_t i = 0; i < codeBytes; i++)
+	{
+		unsigned char byte = state[STATE_HEADER + i];
+
+		if ((byte & 0x0f) == CODE_WATER)
+		{
+			waterSteps[i * 2] = 0;
+			worker->queue[tail++] = (int)i * 2;
+		}
+		if ((byte >> 4) == CODE_WATER)
+		{
+			waterSteps[i * 2 + 1] = 0;
+			worker->queue[tail++] = (int)i * 2 + 1;
+		}
+	}
+
+	while (head < tail)
+	{
+		int dyn = worker->queue[head++];
+
+		if (waterSteps[dyn] >= maxSteps)
+		{
+			break;
+		}
+
+		for (int n = 0; n < 4; n++)
+		{
+			int neighbour = search->neighbours[dyn][n];
+			if (neighbour >= 0 && waterSteps[neighbour] < 0)
+			{
+				waterSteps[neighbour] = waterSteps[dyn] + 1;
+				worker->queue[tail++] = neighbour;
+			}
+		}
+	}
+
+	return tail;
+}
+
+/**
+ * Schaetzt die Schritte bis zum Ziel nach unten ab. Sand und Wasser gelten
+ * als begehbar, Zucker erst, wenn er sich fruehestens aufgeloest haben kann:
+ * trockener Zucker wird nass, sobald das Wasser ihn ueber alle Felder ausser
+ * Waenden erreichen kann, und loest sich WET_STEPS Schritte spaeter auf.
+ * Der kuerzeste Weg unter diesen Bedingungen wird per A* mit der Entfernung
+ * ohne Hindernisse als Schaetzung bestimmt.
+ *
+ * @param search die Suche. (In)
+ * @param worker der Thread, fuer die Zwischenspeicher. (InOut)
+ * @param state der Zustand, der Spieler steht nicht auf dem Ziel. (In)
+ * @param limit ab dieser Schranke darf die Rechnung abbrechen. (In)
+ *
+ * @return die Schranke, ein Wert ueber limit oder -1, wenn das Ziel unerreichbar ist.
+ */
+static int estimateSteps(const Search *search, Worker *worker, const unsigned char *state, int limit)
+{
+	int distance = search->distance[getPlayer(state)];
+	int sugar = 0;
+	size_t codeBytes = search->stateSize - STATE_HEADER;
+
+	if (distance < 0 || distance > limit)
+	{
+		return distance;
+	}
+
+	for (size_t i = 0; i < codeBytes && !sugar; i++)
+	{
+		sugar = (state[STATE_HEADER + i] & 0x0f) >= CODE_SUGAR || (state[STATE_HEADER + i] >> 4) >= CODE_SUGAR;
+	}
+
+	/* Ohne Zucker gibt es nichts zu warten */
+	if (!sugar)
+	{
+		return distance;
+	}
+
+	/* Zucker, der sich erst nach der Schranke aufloesen kann, bleibt zu */
+	int firstWater = WATER_STEPS - state[STATE_HEADER - 1];
+	int maxWaterSteps = (limit - 1 - firstWater - WET_STEPS) / WATER_STEPS + 1;
+	int waterCount = -1;
+	int cut = 0;
+
+	/* Eintraege sind ((Ankunft + Entfernung) << 32) | Code */
+	int playerDyn = search->dynIndex[getPlayer(state)];
+	int count = 0;
+	int touched = 0;
+	int result = -1;
+
+	worker->arrival[playerDyn] = 0;
+	worker->touched[touched++] = playerDyn;
+	heapPush(worker->heap, &count, ((uint64_t)distance << 32) | (uint64_t)playerDyn);
+
+	while (count > 0)
+	{
+		uint64_t top = heapPop(worker->heap, &count);
+		int estimate = (int)(top >> 32);
+		int dyn = (int)(top & 0xffffffff);
+		int time = estimate - search->dynDistance[dyn];
+
+		if (time != worker->arrival[dyn])
+		{
+			continue;
+		}
+
+		/* Spaetere Eintraege kommen nicht frueher ans Ziel */
+		if (estimate > limit || search->dynDistance[dyn] == 1)
+		{
+			result = estimate;
+			break;
+		}
+
+		for (int n = 0; n < 4; n++)
+		{
+			int neighbour = search->neighbours[dyn][n];
+
+			if (neighbour < 0 || search->dynDistance[neighbour] < 0)
+			{
+				continue;
+			}
+
+			int code = getCode(state, neighbour);
+			int open = 0;
+
+			if (code == CODE_SUGAR)
+			{
+				if (waterCount < 0)
+				{
+					waterCount = computeWaterSteps(search, worker, state, maxWaterSteps);
+				}
+				if (worker->waterSteps[neighbour] < 0)
+				{
+					cut = 1;
+					continue;
+				}
+				open = firstWater + WATER_STEPS * (worker->waterSteps[neighbour] - 1) + WET_STEPS;
+			}
+			else if (code >= CODE_WET)
+			{
+				open = code - CODE_WET + 1;
+			}
+
+			int arrive = ((time > open) ? time : open) + 1;
+
+			if (worker->arrival[neighbour] < 0 || arrive < worker->arrival[neighbour])
+			{
+				if (worker->arrival[neighbour] < 0)
+				{
+					worker->touched[touched++] = neighbour;
+				}
+				worker->arrival[neighbour] = arrive;
+				heapPush(worker->heap, &count,
+				         ((uint64_t)(arrive + search->dynDistance[neighbour]) << 32) | (uint64_t)neighbour);
+			}
+		}
+	}
+
+	if (result < 0 && cut)
+	{
+		result = limit + 1;
+	}
+
+	/* Zwischenspeicher fuer den naechsten Aufruf zuruecksetzen */
+	for (int i = 0; i < touched; i++)
+	{
+		worker->arrival[worker->touched[i]] = -1;
+	}
+	for (int i = 0; i < waterCount; i++)
+	{
+		worker->waterSteps[worker->queue[i]] = -1;
+	}
+
+	return result;
+}
+
+/**
+ * Erzeugt alle Nachfolger eines Zustands und traegt die neuen ein.
+ *
+ * @param search die Suche. (InOut)
+ * @param workerIndex der Index des Threads. (In)
+ * @param parentRef die Referenz des Zustands. (In)
+ *
+ * @return 0, wenn die Speichergrenze erreicht ist.
+ */
+static int expandState(Search *search, int workerIndex, uint64_t parentRef)
+{
+	Worker *worker = &search->workers[workerIndex];
+	const unsigned char *parent = getRecord(search, parentRef);
+	uint64_t parentHash = ((const uint64_t *)parent)[1];
+
+	for (int move = 0; move < MOVE_COUNT; move++)
+	{
+		unsigned char *record = reserveRecord(search, worker);
+
+		if (record == NULL)
+		{
+			return 0;
+		}
+
+		unsigned char *state = record + RECORD_HEADER;
+		uint64_t hash = parentHash;
+		uint64_t ref;
+		int pushed = 0;
+
+		memcpy(state, parent + RECORD_HEADER, search->stateSize);
+
+		/* Ein blockierter Zug ist dasselbe wie Warten */
+		if (move > 0 && !applyMove(search, state, &hash, move, &pushed))
+		{
+			continue;
+		}
+
+		((uint64_t *)record)[0] = (parentRef << 4) | ((uint64_t)pushed << 3) | (uint64_t)move;
+
+		if (search->distance[getPlayer(state)] == 0)
+		{
+			/* Auf dem Ziel ist der Spieler sicher, die Suche ist fertig */
+			if (insertRecord(search, workerIndex, record, hash, &ref))
+			{
+				atomicSwap(&search->found, &(uint64_t){0}, ref + 1);
+			}
+			continue;
+		}
+
+		if (!advanceTime(search, worker, state, &hash))
+		{
+			continue;
+		}
+
+		/* Zustaende, von denen das Ziel nicht innerhalb der Grenze erreichbar ist */
+		int limit = search->bound - search->depth - 1;
+		int estimate = estimateSteps(search, worker, state, limit);
+
+		if (estimate < 0)
+		{
+			continue;
+		}
+
+		if (estimate > limit)
+		{
+			estimate += search->depth + 1;
+			if (worker->pruned == 0 || estimate < worker->pruned)
+			{
+				worker->pruned = estimate;
+			}
+			continue;
+		}
+
+		if (insertRecord(search, workerIndex, record, hash, &ref))
+		{
+			if (worker->nextCount == worker->nextCapacity)
+			{
+				size_t capacity = worker->nextCapacity ? worker->nextCapacity * 2 : 1024;
+				uint64_t *next = realloc(worker->next, capacity * sizeof(uint64_t));
+				if (next == NULL)
+				{
+					return 0;
+				}
+				worker->next = next;
+				worker->nextCapacity = capacity;
+			}
+			worker->next[worker->nextCount++] = ref;
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * Arbeitet Bloecke der aktuellen Schicht ab, bis sie leer ist, eine Loesung
+ * gefunden oder die Speichergrenze erreicht wurde.
+ *
+ * @param search die Suche. (InOut)
+ * @param workerIndex der Index des Threads. (In)
+ */
+static void runWorker(Search *search, int workerIndex)
+{
+	for (;;)
+	{
+		size_t start = (size_t)atomicAdd(&search->cursor, FRONTIER_BLOCK);
+		size_t end = start + FRONTIER_BLOCK;
+
+		if (start >= search->frontierCount || atomicLoad(&search->found) || atomicLoad(&search->full))
+		{
+			return;
+		}
+
+		if (end > search->frontierCount)
+		{
+			end = search->frontierCount;
+		}
+
+		for (size_t i = start; i < end; i++)
+		{
+			if (!expandState(search, workerIndex, search->frontier[i]))
+			{
+				atomicSwap(&search->full, &(uint64_t){0}, 1);
+				return;
+			}
+		}
+	}
+}
+
+#ifdef SEARCH_THREADS
+/**
+ * Einstiegspunkt eines Threads.
+ *
+ * @param arg der Auftrag (WorkerJob). (In)
+ *
+ * @return immer NULL.
+ */
+static void *workerThread(void *arg)
+{
+	WorkerJob *job = arg;
+	runWorker(job->search, job->index);
+	return NULL;
+}
+
+/**
+ * Liefert die Anzahl der nutzbaren Prozessorkerne.
+ *
+ * @return die Anzahl, mindestens 1.
+ */
+static int coreCount(void)
+{
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	return (cpus < 1) ? 1 : (cpus > SEARCH_MAX_THREADS ? SEARCH_MAX_THREADS : (int)cpus);
+}
+#endif
+
+/**
+ * Erzeugt die naechste Schicht aus der aktuellen. Grosse Schichten werden
+ * auf mehrere Threads verteilt, sonst arbeitet nur der aufrufende Thread.
+ *
+ * @param search die Suche. (InOut)
+ */
+static void expandFrontier(Search *search)
+{
+	search->cursor = 0;
+
+#ifdef SEARCH_THREADS
+	if (search->threads > 1 && search->frontierCount >= THREAD_MIN_FRONTIER)
+	{
+		pthread_t handles[SEARCH_MAX_THREADS];
+		WorkerJob jobs[SEARCH_MAX_THREADS];
+		int started[SEARCH_MAX_THREADS];
+
+		/* Den ersten Teil erledigt der aufrufende Thread selbst */
+		for (int t = 1; t < search->threads; t++)
+		{
+			jobs[t].search = search;
+			jobs[t].index = t;
+			started[t] = pthread_create(&handles[t], NULL, workerThread, &jobs[t]) == 0;
+		}
+
+		runWorker(search, 0);
+
+		for (int t = 1; t < search->threads; t++)
+		{
+			if (started[t])
+			{
+				pthread_join(handles[t], NULL);
+			}
+		}
+
+		return;
+	}
+#endif
+
+	runWorker(search, 0);
+}
+
+/**
+ * Ersetzt die aktuelle Schicht durch die neuen Zustaende aller Threads.
+ *
+ * @param search die Suche. (InOut)
+ *
+ * @return 0, wenn kein Speicher frei ist.
+ */
+static int swapFrontier(Search *search)
+{
+	size_t total = 0;
+
+	for (int t = 0; t < search->threads; t++)
+	{
+		total += search->workers[t].nextCount;
+	}
+
+	if (total > search->frontierCapacity)
+	{
+		uint64_t *frontier = realloc(search->frontier, total * sizeof(uint64_t));
+		if (frontier == NULL)
+		{
+			return 0;
+		}
+		search->frontier = frontier;
+		search->frontierCapacity = total;
+	}
+
+	search->frontierCount = 0;
+	for (int t = 0; t < search->threads; t++)
+	{
+		Worker *worker = &search->workers[t];
+		memcpy(search->frontier + search->frontierCount, worker->next, worker->nextCount * sizeof(uint64_t));
+		search->frontierCount += worker->nextCount;
+		worker->nextCount = 0;
+	}
+
+	return 1;
+}
+
+/**
+ * Gibt das Modell des aktuellen Levels frei.
+ *
+ * @param search die Suche. (InOut)
+ */
+static void freeModel(Search *search)
+{
+	free(search->dynIndex);
+	free(search->distance);
+	free(search->dynDistance);
+	free(search->neighbours);
+	free(search->keys);
+	free(search->playerKeys);
+	search->dynIndex = NULL;
+	search->distance = NULL;
+	search->dynDistance = NULL;
+	search->neighbours = NULL;
+	search->keys = NULL;
+	search->playerKeys = NULL;
+
+	for (int t = 0; t < SEARCH_MAX_THREADS; t++)
+	{
+		Worker *worker = &search->workers[t];
+		free(worker->wet);
+		free(worker->waterSteps);
+		free(worker->arrival);
+		free(worker->queue);
+		free(worker->touched);
+		free(worker->heap);
+		worker->wet = NULL;
+		worker->waterSteps = NULL;
+		worker->arrival = NULL;
+		worker->queue = NULL;
+		worker->touched = NULL;
+		worker->heap = NULL;
+	}
+}
+
+/**
+ * Baut das Modell eines Levels auf: welche Felder veraenderlich sind, deren
+ * Nachbarn, die Entfernungen zum Ziel und die Zobrist-Schluessel. Der
+ * Startzustand wird nach state geschrieben.
+ *
+ * @param search die Suche. (InOut)
+ * @param level das Level. (In)
+ * @param state Platz fuer den Startzustand, stateSize Bytes. (Out)
+ * @param hash der Hash des Startzustands. (Out)
+ *
+ * @return 0, wenn kein Speicher frei ist.
+ */
+static int buildModel(Search *search, const LevelFile *level, unsigned char *state, uint64_t *hash)
+{
+	size_t cells = (size_t)level->width * level->height;
+	uint64_t seed = 0;
+
+	search->width = level->width;
+	search->height = level->height;
+	search->fields = level->fields;
+	search->dynCount = 0;
+
+	for (size_t i = 0; i < cells; i++)
+	{
+		wmField field = level->fields[i];
+		search->dynIndex[i] = (field == WM_WALL || field == WM_BLACK || field == WM_GOAL)
+		                      ? -1 : search->dynCount++;
+	}
+
+	/* Entfernungen zum naechsten Ziel, nur Waende und schwarze Felder halten auf */
+	int *queue = malloc(cells * sizeof(int));
+	size_t head = 0, tail = 0;
+
+	if (queue == NULL)
+	{
+		return 0;
+	}
+
+	for (size_t i = 0; i < cells; i++)
+	{
+		search->distance[i] = -1;
+		if (level->fields[i] == WM_GOAL)
+		{
+			search->distance[i] = 0;
+			queue[tail++] = (int)i;
+		}
+	}
+
+	while (head < tail)
+	{
+		int cell = queue[head++];
+		int x = cell % level->width;
+		int y = cell / level->width;
+		int next[4] = { (x > 0) ? cell - 1 : -1, (x + 1 < level->width) ? cell + 1 : -1,
+		                (y > 0) ? cell - level->width : -1,
+		                (y + 1 < level->height) ? cell + level->width : -1 };
+
+		for (int n = 0; n < 4; n++)
+		{
+			if (next[n] >= 0 && search->distance[next[n]] < 0 && search->dynIndex[next[n]] >= 0)
+			{
+				search->distance[next[n]] = search->distance[cell] + 1;
+				queue[tail++] = next[n];
+			}
+		}
+	}
+
+	free(queue);
+
+	search->stateSize = STATE_HEADER + ((size_t)search->dynCount + 1) / 2;
+	search->recordSize = (RECORD_HEADER + search->stateSize + 7) & ~(size_t)7;
+	search->neighbours = malloc((size_t)(search->dynCount > 0 ? search->dynCount : 1) * sizeof(*search->neighbours));
+	search->keys = malloc((size_t)(search->dynCount > 0 ? search->dynCount : 1) * CODE_COUNT * sizeof(uint64_t));
+	search->playerKeys = malloc(cells * sizeof(uint64_t));
+
+	if (search->neighbours == NULL || search->keys == NULL || search->playerKeys == NULL)
+	{
+		return 0;
+	}
+
+	size_t dynCount = (size_t)(search->dynCount > 0 ? search->dynCount : 1);
+
+	search->dynDistance = malloc(dynCount * sizeof(int));
+	if (search->dynDistance == NULL)
+	{
+		return 0;
+	}
+
+	for (size_t i = 0; i < cells; i++)
+	{
+		if (search->dynIndex[i] >= 0)
+		{
+			search->dynDistance[search->dynIndex[i]] = search->distance[i];
+		}
+	}
+
+	for (int t = 0; t < search->threads; t++)
+	{
+		Worker *worker = &search->workers[t];
+		worker->wet = malloc(dynCount * sizeof(int));
+		worker->waterSteps = malloc(dynCount * sizeof(int));
+		worker->arrival = malloc(dynCount * sizeof(int));
+		worker->queue = malloc(dynCount * sizeof(int));
+		worker->touched = malloc(dynCount * sizeof(int));
+		worker->heap = malloc((4 * dynCount + 1) * sizeof(uint64_t));
+		if (worker->wet == NULL || worker->waterSteps == NULL || worker->arrival == NULL
+		    || worker->queue == NULL || worker->touched == NULL || worker->heap == NULL)
+		{
+			return 0;
+		}
+
+		/* estimateSteps setzt nur beruehrte Eintraege zurueck */
+		for (size_t i = 0; i < dynCount; i++)
+		{
+			worker->waterSteps[i] = -1;
+			worker->arrival[i] = -1;
+		}
+	}
+
+	/* Zobrist-Schluessel, freie Felder tragen nichts zum Hash bei */
+	for (int dyn = 0; dyn < search->dynCount; dyn++)
+	{
+		search->keys[dyn * CODE_COUNT + CODE_FREE] = 0;
+		for (int code = CODE_FREE + 1; code < CODE_COUNT; code++)
+		{
+			search->keys[dyn * CODE_COUNT + code] = nextRandom(&seed);
+		}
+	}
+	for (size_t i = 0; i < cells; i++)
+	{
+		search->playerKeys[i] = nextRandom(&seed);
+	}
+	for (int p = 0; p < WATER_STEPS; p++)
+	{
+		search->phaseKeys[p] = nextRandom(&seed);
+	}
+
+	/* Startzustand und Nachbarn */
+	memset(state, 0, search->stateSize);
+	*hash = search->playerKeys[0] ^ search->phaseKeys[0];
+	setPlayer(search, state, hash, level->startY * level->width + level->startX);
+
+	for (int y = 0; y < level->height; y++)
+	{
+		for (int x = 0; x < level->width; x++)
+		{
+			int cell = y * level->width + x;
+			int dyn = search->dynIndex[cell];
+
+			if (dyn < 0)
+			{
+				continue;
+			}
+
+			search->neighbours[dyn][0] = (x > 0) ? search->dynIndex[cell - 1] : -1;
+			search->neighbours[dyn][1] = (x + 1 < level->width) ? search->dynIndex[cell + 1] : -1;
+			search->neighbours[dyn][2] = (y > 0) ? search->dynIndex[cell - level->width] : -1;
+			search->neighbours[dyn][3] = (y + 1 < level->height) ? search->dynIndex[cell + level->width] : -1;
+
+			switch (level->fields[cell])
+			{
+				case WM_WATER:
+					setCode(search, state, hash, dyn, CODE_WATER);
+					break;
+				case WM_SAND:
+					setCode(search, state, hash, dyn, CODE_SAND);
+					break;
+				case WM_SUGAR:
+					setCode(search, state, hash, dyn, CODE_SUGAR);
+					break;
+				case WM_TOUCHED_SUGAR:
+					setCode(search, state, hash, dyn, CODE_WET + WET_STEPS - 1);
+					break;
+				default:
+					break;
+			}
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * Bestimmt die Speichergrenze fuer die Zustaende des aktuellen Levels und
+ * richtet die Speicherbloecke darauf ein. Vorhandene Bloecke werden
+ * weiterverwendet, solange sie gross genug sind.
+ *
+ * @param search die Suche, das Modell ist aufgebaut. (InOut)
+ *
+ * @return 0, wenn kein Speicher frei ist.
+ */
+static int prepareChunks(Search *search)
+{
+	/* Der Rest des Speichers fuer Zustaende und Schichten */
+	size_t tableBytes = (size_t)(search->mask + 1) * sizeof(uint64_t);
+	size_t rest = (search->options.memory > tableBytes) ? search->options.memory - tableBytes : 0;
+
+	search->maxStates = rest / (search->recordSize + 2 * sizeof(uint64_t));
+	if (search->maxStates > (search->mask + 1) / 2)
+	{
+		search->maxStates = (search->mask + 1) / 2;
+	}
+
+	/* Grosse Zustaende in kleineren Bloecken */
+	search->chunkBits = CHUNK_BITS;
+	while (search->chunkBits > 0 && (search->recordSize << search->chunkBits) > CHUNK_MAX_BYTES)
+	{
+		search->chunkBits--;
+	}
+
+	size_t chunkBytes = search->recordSize << search->chunkBits;
+	size_t maxChunks = (size_t)(search->maxStates >> search->chunkBits) + 2;
+
+	if (chunkBytes <= search->chunkBytes && maxChunks <= search->maxChunks)
+	{
+		return 1;
+	}
+
+	for (int t = 0; t < search->threads; t++)
+	{
+		Worker *worker = &search->workers[t];
+
+		if (worker->chunks != NULL)
+		{
+			for (size_t c = 0; c < search->maxChunks; c++)
+			{
+				free(worker->chunks[c]);
+			}
+		}
+		free(worker->chunks);
+		worker->chunks = calloc(maxChunks, sizeof(unsigned char *));
+	}
+
+	search->chunkBytes = (chunkBytes > search->chunkBytes) ? chunkBytes : search->chunkBytes;
+	search->maxChunks = maxChunks;
+
+	for (int t = 0; t < search->threads; t++)
+	{
+		if (search->workers[t].chunks == NULL)
+		{
+			/* Beim naechsten Mal neu anlegen */
+			search->maxChunks = 0;
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * Entfernt alle Zustaende der letzten Suche aus der Tabelle. Jeder Eintrag
+ * kennt seinen Platz, die Tabelle muss also nicht ganz geleert werden.
+ *
+ * @param search die Suche. (InOut)
+ */
+static void clearStates(Search *search)
+{
+	for (int t = 0; t < SEARCH_MAX_THREADS; t++)
+	{
+		Worker *worker = &search->workers[t];
+
+		for (uint64_t i = 0; i < worker->count; i++)
+		{
+			const uint64_t *head = (const uint64_t *)getRecord(search, ((uint64_t)t << REF_INDEX_BITS) | i);
+			search->table[head[2]] = 0;
+		}
+
+		worker->count = 0;
+		worker->nextCount = 0;
+		worker->pruned = 0;
+	}
+
+	search->stored = 0;
+	search->found = 0;
+	search->full = 0;
+	search->frontierCount = 0;
+}
+
+/**
+ * Durchsucht alle Zustaende mit g + h <= search->bound Schicht fuer Schicht.
+ * Die erste gefundene Loesung ist eine kuerzeste.
+ *
+ * @param search die Suche, die Tabelle ist leer. (InOut)
+ * @param root der Startzustand. (In)
+ * @param hash der Hash des Startzustands. (In)
+ * @param result Status und erreichte Tiefe. (Out)
+ *
+ * @return das kleinste verworfene g + h oder 0, wenn nichts verworfen wurde.
+ */
+static int searchBounded(Search *search, const unsigned char *root, uint64_t hash, SearchResult *result)
+{
+	Worker *first = &search->workers[0];
+	unsigned char *record = reserveRecord(search, first);
+	uint64_t ref;
+	int pruned = 0;
+
+	result->status = SEARCH_LIMIT;
+	result->length = 0;
+
+	if (first->nextCapacity == 0)
+	{
+		first->next = malloc(1024 * sizeof(uint64_t));
+		first->nextCapacity = (first->next != NULL) ? 1024 : 0;
+	}
+
+	if (record == NULL || first->nextCapacity == 0)
+	{
+		return 0;
+	}
+
+	((uint64_t *)record)[0] = 0;
+	memcpy(record + RECORD_HEADER, root, search->stateSize);
+	insertRecord(search, 0, record, hash, &ref);
+	first->next[first->nextCount++] = ref;
+
+	for (search->depth = 0; ; search->depth++)
+	{
+		if (!swapFrontier(search))
+		{
+			search->full = 1;
+		}
+
+		if (search->found)
+		{
+			result->status = SEARCH_SOLVED;
+			break;
+		}
+
+		if (search->full)
+		{
+			break;
+		}
+
+		if (search->frontierCount == 0)
+		{
+			result->status = SEARCH_UNSOLVABLE;
+			break;
+		}
+
+		expandFrontier(search);
+	}
+
+	result->length = search->depth;
+
+	for (int t = 0; t < search->threads; t++)
+	{
+		int workerPruned = search->workers[t].pruned;
+		if (workerPruned > 0 && (pruned == 0 || workerPruned < pruned))
+		{
+			pruned = workerPruned;
+		}
+	}
+
+	return pruned;
+}
+
+/* ---- Oeffentliche Funktionen ---- */
+
+Search *search_create(const SearchOptions *options)
+{
+	Search *search = calloc(1, sizeof(Search));
+
+	if (search == NULL)
+	{
+		return NULL;
+	}
+
+	search->options = *options;
+	search->threads = 1;
+#ifdef SEARCH_THREADS
+	search->threads = (options->threads > 0) ? options->threads : coreCount();
+	if (search->threads > SEARCH_MAX_THREADS)
+	{
+		search->threads = SEARCH_MAX_THREADS;
+	}
+#endif
+
+	/* Ein Viertel des Speichers fuer die Tabelle, hoechstens halb gefuellt */
+	uint64_t slots = TABLE_MIN_SLOTS;
+	while (slots * 2 * sizeof(uint64_t) <= options->memory / 4)
+	{
+		slots *= 2;
+	}
+
+	search->table = calloc((size_t)slots, sizeof(uint64_t));
+	search->mask = slots - 1;
+
+	if (search->table == NULL)
+	{
+		search_free(search);
+		return NULL;
+	}
+
+	return search;
+}
+
+void search_run(Search *search, const LevelFile *level, SearchResult *result)
+{
+	clearStates(search);
+	freeModel(search);
+	free(search->moves);
+	search->moves = NULL;
+
+	double start = now();
+
+	result->status = SEARCH_LIMIT;
+	result->length = 0;
+	result->states = 0;
+
+	size_t cells = (size_t)level->width * level->height;
+	search->dynIndex = malloc(cells * sizeof(int));
+	search->distance = malloc(cells * sizeof(int));
+	unsigned char *root = malloc(STATE_HEADER + (cells + 1) / 2);
+	uint64_t hash;
+
+	if (search->dynIndex == NULL || search->distance == NULL || root == NULL
+	    || !buildModel(search, level, root, &hash))
+	{
+		free(root);
+		result->seconds = now() - start;
+		return;
+	}
+
+	if (!prepareChunks(search))
+	{
+		free(root);
+		result->seconds = now() - start;
+		return;
+	}
+
+	/* Grenze fuer g + h anheben, bis eine Loesung gefunden ist oder nichts
+	 * mehr verworfen wurde */
+	search->bound = search->distance[level->startY * level->width + level->startX];
+	result->status = (search->bound < 0) ? SEARCH_UNSOLVABLE : SEARCH_LIMIT;
+
+	while (search->bound >= 0)
+	{
+		/* Jede Loesung ist mindestens so lang wie die Grenze */
+		int minLength = search->bound;
+
+		if (search->options.maxDepth > 0 && search->bound > search->options.maxDepth)
+		{
+			result->status = SEARCH_LIMIT;
+			result->length = minLength;
+			break;
+		}
+
+		int pruned = searchBounded(search, root, hash, result);
+		result->states += search->stored;
+
+		if (result->status == SEARCH_LIMIT)
+		{
+			result->length = minLength;
+		}
+
+		if (result->status != SEARCH_UNSOLVABLE || pruned == 0)
+		{
+			break;
+		}
+
+		search->bound = pruned;
+		clearStates(search);
+	}
+
+	free(root);
+	result->seconds = now() - start;
+
+	if (result->status == SEARCH_UNSOLVABLE)
+	{
+		result->length = 0;
+	}
+
+	if (result->status == SEARCH_SOLVED)
+	{
+		search->moves = malloc((size_t)result->length + 1);
+		if (search->moves != NULL)
+		{
+			uint64_t current = search->found - 1;
+
+			search->moves[result->length] = '\0';
+			for (int i = result->length - 1; i >= 0; i--)
+			{
+				uint64_t link = ((const uint64_t *)getRecord(search, current))[0];
+				char name = g_moveNames[link & 7];
+
+				search->moves[i] = (link & 8) ? (char)(name - 'a' + 'A') : name;
+				current = link >> 4;
+			}
+		}
+	}
+}
+
+const char *search_moves(const Search *search)
+{
+	return (search->moves != NULL) ? search->moves : "";
+}
+
+void search_free(Search *search)
+{
+	if (search == NULL)
+	{
+		return;
+	}
+
+	for (int t = 0; t < SEARCH_MAX_THREADS; t++)
+	{
+		Worker *worker = &search->workers[t];
+
+		if (worker->chunks != NULL)
+		{
+			for (size_t c = 0; c < search->maxChunks; c++)
+			{
+				free(worker->chunks[c]);
+			}
+		}
+		free(worker->chunks);
+		free(worker->next);
+	}
+
+	freeModel(search);
+	free(search->frontier);
+	free(search->table);
+	free(search->moves);
+	free(search);
+}
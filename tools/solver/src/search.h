@@ -0,0 +1,97 @@
+#ifndef __SEARCH_H__
+#define __SEARCH_H__
+/**
+ * @file
+ * Schnittstelle des Suchmoduls.
+ * Das Modul sucht per Breitensuche ueber alle Spielzustaende eine kuerzeste
+ * Loesung fuer ein Level. Die Zeit laeuft dabei in Schritten zu
+ * PLAYER_COOLDOWN_TIME: in jedem Schritt geht der Spieler in eine Richtung
+ * oder wartet, alle vier Schritte (UPDATE_COOLDOWN_TIME) breitet sich das
+ * Wasser aus, nasser Zucker loest sich nach SUGAR_LIFETIME auf. Ein Level ist
+ * geloest, sobald der Spieler ein Zielfeld erreicht, denn dort kann ihn kein
+ * Wasser mehr erreichen.
+ *
+ * Findet die Suche keine Loesung, ohne an eine Grenze zu stossen, wurden alle
+ * erreichbaren Zustaende besucht: das Level ist dann nachweislich unloesbar.
+ *
+ * Bestandteil einer Uebung im Rahmen des Moduls Praktikum Grundlagen der Computergrafik
+ * an der FH Wedel.
+ *
+ * @author Nicolas Hollmann, Daniel Klintworth
+ */
+
+/* ---- System Header einbinden ---- */
+#include <stddef.h>
+
+/* ---- Eigene Header einbinden ---- */
+#include "levelfile.h"
+
+/* ---- Konstanten ---- */
+
+/** Hoechstzahl an Threads einer Suche */
+#define SEARCH_MAX_THREADS (64)
+
+/* ---- Typen ---- */
+
+/** Ergebnis einer Suche */
+typedef enum {
+	SEARCH_SOLVED,     // Kuerzeste Loesung gefunden
+	SEARCH_UNSOLVABLE, // Alle erreichbaren Zustaende besucht, keine Loesung
+	SEARCH_LIMIT       // Speicher- oder Tiefengrenze erreicht, Ergebnis offen
+} SearchStatus;
+
+/** Einstellungen einer Suche */
+typedef struct {
+	int threads;       // Anzahl Threads, 0 fuer alle Kerne
+	size_t memory;     // Speichergrenze fuer Zustaende in Bytes
+	int maxDepth;      // Laengste gesuchte Loesung in Schritten, 0 fuer unbegrenzt
+} SearchOptions;
+
+/** Ergebnis einer Suche */
+typedef struct {
+	SearchStatus status;
+	int length;        // Schritte der Loesung, bei SEARCH_LIMIT die Mindestlaenge einer Loesung
+	unsigned long long states; // Anzahl besuchter Zustaende
+	double seconds;    // Laufzeit der Suche
+} SearchResult;
+
+/** Eine Suche mit ihrem Speicher, kann fuer mehrere Level genutzt werden */
+typedef struct Search Search;
+
+/* ---- Funktionen ---- */
+
+/**
+ * Legt eine Suche an und reserviert den Speicher fuer die Zustaende.
+ *
+ * @param options die Einstellungen (In)
+ * @return die Suche oder NULL, wenn kein Speicher frei ist
+ */
+Search *search_create(const SearchOptions *options);
+
+/**
+ * Sucht eine kuerzeste Loesung fuer ein Level.
+ *
+ * @param search die Suche (InOut)
+ * @param level das Level (In)
+ * @param result das Ergebnis (Out)
+ */
+void search_run(Search *search, const LevelFile *level, SearchResult *result);
+
+/**
+ * Liefert die Zuege der zuletzt gefundenen Loesung: 'u', 'd', 'l', 'r' fuer
+ * einen Schritt nach oben, unten, links und rechts, Grossbuchstaben, wenn
+ * dabei ein Sandsack geschoben wird, '.' fuer Warten.
+ *
+ * @param search die Suche (In)
+ * @return die Zuege als Zeichenkette, gueltig bis zur naechsten Suche
+ */
+const char *search_moves(const Search *search);
+
+/**
+ * Gibt eine Suche und ihren Speicher frei.
+ *
+ * @param search die Suche (InOut)
+ */
+void search_free(Search *search);
+
+#endif
@@ -0,0 +1,196 @@
+/**
+ * @file
+ * Werkzeug zum Pruefen der Level.
+ * Sucht fuer jedes angegebene Level eine kuerzeste Loesung (siehe search.h)
+ * und gibt sie aus, oder weist nach, dass das Level unloesbar ist. Die
+ * eingebauten Level werden ueber die Spiellogik aus ueb03 geladen.
+ *
+ * Aufruf:
+ *   solver [--threads <n>] [--memory <mb>] [--depth <n>] <level> ...
+ *
+ * Ein Level ist entweder die Nummer eines eingebauten Levels (1 bis 4) oder
+ * der Name einer Leveldatei. --threads legt die Anzahl der Threads fest
+ * (Standard: alle Kerne), --memory die Speichergrenze fuer Zustaende in MB
+ * (Standard: 1024), --depth die laengste gesuchte Loesung in Schritten.
+ * Der Rueckgabewert ist 0, wenn alle Level loesbar sind.
+ *
+ * Bestandteil einer Uebung im Rahmen des Moduls Praktikum Grundlagen der Computergrafik
+ * an der FH Wedel.
+ *
+ * @author Nicolas Hollmann, Daniel Klintworth
+ */
+
+/* ---- System Header einbinden ---- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ---- Eigene Header einbinden ---- */
+#include "search.h"
+#include "levelfile.h"
+#include "logic.h"
+
+/* ---- Konstanten ---- */
+
+/** Standardgrenze fuer den Speicher der Zustaende in MB */
+#define DEFAULT_MEMORY_MB (1024)
+
+/** Kleinste erlaubte Speichergrenze in MB */
+#define MIN_MEMORY_MB (16)
+
+/* ---- Interne Funktionen ---- */
+
+/**
+ * Gibt die Aufrufsyntax aus.
+ */
+static void printUsage(void)
+{
+	fprintf(stderr, "Aufruf: solver [--threads <n>] [--memory <mb>] [--depth <n>] <level> ...\n");
+	fprintf(stderr, "  <level>: 1 bis %d fuer die eingebauten Level oder eine Leveldatei\n", LEVEL_LAST);
+}
+
+/**
+ * Laedt ein Level anhand seiner Angabe auf der Kommandozeile.
+ *
+ * @param name die Nummer eines eingebauten Levels oder ein Dateiname. (In)
+ * @param level das geladene Level. (Out)
+ *
+ * @return 1 bei Erfolg.
+ */
+static int loadLevel(const char *name, LevelFile *level)
+{
+	char *end;
+	long id = strtol(name, &end, 10);
+
+	if (*end != '\0' || id < LEVEL_1 || id > LEVEL_LAST)
+	{
+		return levelfile_load(name, level);
+	}
+
+	/* Eingebaute Level kennt nur die Spiellogik */
+	initLevel((int)id);
+	Gamestate *state = getGamestate();
+
+	if (!levelfile_create(level, state->levelWidth, state->levelHeight))
+	{
+		fprintf(stderr, "Kein Speicher fuer das Level!\n");
+		return 0;
+	}
+
+	for (int y = 0; y < state->levelHeight; y++)
+	{
+		memcpy(level->fields + (size_t)y * level->width, state->level[y], (size_t)level->width);
+	}
+	level->startX = state->playerX;
+	level->startY = state->playerY;
+
+	return 1;
+}
+
+/**
+ * Gibt das Ergebnis einer Suche aus.
+ *
+ * @param name die Angabe des Levels. (In)
+ * @param search die Suche. (In)
+ * @param result das Ergebnis. (In)
+ */
+static void printResult(const char *name, const Search *search, const SearchResult *result)
+{
+	switch (result->status)
+	{
+		case SEARCH_SOLVED:
+			printf("%s: geloest in %d Schritten (%.1f s): %s\n", name, result->length,
+			       result->length * PLAYER_COOLDOWN_TIME, search_moves(search));
+			break;
+		case SEARCH_UNSOLVABLE:
+			printf("%s: unloesbar\n", name);
+			break;
+		case SEARCH_LIMIT:
+			printf("%s: keine Aussage, Grenze erreicht (Loesung hat mindestens %d Schritte)\n", name,
+			       result->length);
+			break;
+	}
+
+	printf("  %llu Zustaende in %.3f s (%.0f Zustaende/s)\n", result->states, result->seconds,
+	       result->seconds > 0.0 ? result->states / result->seconds : 0.0);
+}
+
+/* ---- Hauptprogramm ---- */
+
+/**
+ * Hauptprogramm.
+ *
+ * @param argc Anzahl der Argumente. (In)
+ * @param argv die Argumente. (In)
+ *
+ * @return 0, wenn alle Level loesbar sind.
+ */
+int main(int argc, char **argv)
+{
+	SearchOptions options = { 0, (size_t)DEFAULT_MEMORY_MB << 20, 0 };
+	int first = 1;
+
+	while (first + 1 < argc && strncmp(argv[first], "--", 2) == 0)
+	{
+		int value = atoi(argv[first + 1]);
+
+		if (strcmp(argv[first], "--threads") == 0 && value > 0)
+		{
+			options.threads = value;
+		}
+		else if (strcmp(argv[first], "--memory") == 0 && value >= MIN_MEMORY_MB)
+		{
+			options.memory = (size_t)value << 20;
+		}
+		else if (strcmp(argv[first], "--depth") == 0 && value > 0)
+		{
+			options.maxDepth = value;
+		}
+		else
+		{
+			printUsage();
+			return 1;
+		}
+
+		first += 2;
+	}
+
+	if (first >= argc)
+	{
+		printUsage();
+		return 1;
+	}
+
+	Search *search = search_create(&options);
+
+	if (search == NULL)
+	{
+		fprintf(stderr, "Kein Speicher fuer die Suche!\n");
+		return 1;
+	}
+
+	int allSolved = 1;
+
+	for (int i = first; i < argc; i++)
+	{
+		LevelFile level = EMPTY_LEVEL_FILE;
+		SearchResult result;
+
+		if (!loadLevel(argv[i], &level))
+		{
+			allSolved = 0;
+			continue;
+		}
+
+		search_run(search, &level, &result);
+		printResult(argv[i], search, &result);
+
+		allSolved = allSolved && result.status == SEARCH_SOLVED;
+		levelfile_free(&level);
+	}
+
+	search_free(search);
+	cleanup();
+
+	return allSolved ? 0 : 1;
+}
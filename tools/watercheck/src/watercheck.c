@@ -0,0 +1,259 @@
+/**
+ * @file
+ * Werkzeug zur Pruefung der Wasserdarstellung von ueb03.
+ * ueb03 laesst die Seiten zwischen zwei Wasserfeldern weg und gibt am
+ * Programmende die Anzahl der Wasserfaces je Seite aus. Dieses Werkzeug
+ * schreibt ein festes Testlevel und vergleicht diese Ausgabe mit den Zahlen,
+ * die sich aus dem Level selbst ergeben:
+ *
+ *   ohne Weglassen   jede Seite einmal je Wasserfeld
+ *   mit Weglassen    oben und unten einmal je Wasserfeld, vorne und hinten
+ *                    je senkrecht benachbartem Paar eines weniger, links
+ *                    und rechts je waagerecht benachbartem Paar eines weniger
+ *
+ * Im Testlevel ist das Wasser ringsum von Waenden eingeschlossen und breitet
+ * sich nicht aus, der Start liegt nicht am Wasser. Die Zahlen gelten daher
+ * fuer jeden Frame.
+ *
+ * Aufruf:
+ *   watercheck --write <level>
+ *   watercheck <level> <ausgabe-mit-weglassen> <ausgabe-ohne-weglassen>
+ *
+ * Der Rueckgabewert ist 0, wenn alle Zahlen stimmen, sonst 1.
+ *
+ * Bestandteil einer Uebung im Rahmen des Moduls Praktikum Grundlagen der Computergrafik
+ * an der FH Wedel.
+ *
+ * @author Nicolas Hollmann, Daniel Klintworth
+ */
+
+/* ---- System Header einbinden ---- */
+#include <stdio.h>
+#include <string.h>
+
+/* ---- Eigene Header einbinden ---- */
+#include "levelfile.h"
+
+/* ---- Konstanten ---- */
+
+/** Anzahl der Seiten eines Wasserfeldes, Reihenfolge wie WaterSide in water.h */
+#define SIDE_COUNT (6)
+
+/** Maximale Laenge einer Zeile der Ausgabe von ueb03 */
+#define LINE_LENGTH (1024)
+
+/** Kennung der Zeile mit den Faces je Seite in der Ausgabe von ueb03 */
+#define SIDES_PREFIX "Seiten:"
+
+/** Groesse des Testlevels */
+#define TEST_WIDTH (12)
+#define TEST_HEIGHT (8)
+
+/** Das Testlevel: # Wand, ~ Wasser, . frei, S Start */
+static const char *g_testLevel[TEST_HEIGHT] = {
+	"############",
+	"#~~~#~##~~~#",
+	"#~~~#####~##",
+	"#~~~##~~~~~#",
+	"######~#####",
+	"#.S.#~~~~###",
+	"#...#~#~~###",
+	"############",
+};
+
+/** Namen der Seiten fuer Meldungen */
+static const char *g_sideNames[SIDE_COUNT] = {
+	"oben", "unten", "vorne", "hinten", "links", "rechts"
+};
+
+/* ---- Interne Funktionen ---- */
+
+/**
+ * Schreibt das Testlevel in eine Datei.
+ *
+ * @param filename Name der Datei (In)
+ * @return 1 bei Erfolg, sonst 0
+ */
+static int writeTestLevel(const char *filename)
+{
+	LevelFile level = EMPTY_LEVEL_FILE;
+	int success = levelfile_create(&level, TEST_WIDTH, TEST_HEIGHT);
+
+	for (int y = 0; success && y < TEST_HEIGHT; y++)
+	{
+		for (int x = 0; x < TEST_WIDTH; x++)
+		{
+			wmField *field = &level.fields[y * TEST_WIDTH + x];
+
+			switch (g_testLevel[y][x])
+			{
+				case '#':
+					*field = WM_WALL;
+					break;
+				case '~':
+					*field = WM_WATER;
+					break;
+				case 'S':
+					level.startX = x;
+					level.startY = y;
+					*field = WM_FREE;
+					break;
+				default:
+					*field = WM_FREE;
+					break;
+			}
+		}
+	}
+
+	success = success && levelfile_save(filename, &level);
+	levelfile_free(&level);
+
+	return success;
+}
+
+/**
+ * Berechnet aus einem Level die erwartete Anzahl der Wasserfaces je Seite.
+ *
+ * @param level das Level (In)
+ * @param culled werden Seiten zwischen Wasserfeldern weggelassen? (In)
+ * @param sides Anzahl je Seite (Out)
+ */
+static void expectedSides(const LevelFile *level, int culled, int sides[SIDE_COUNT])
+{
+	int water = 0, verticalPairs = 0, horizontalPairs = 0;
+
+	for (int y = 0; y < level->height; y++)
+	{
+		for (int x = 0; x < level->width; x++)
+		{
+			const wmField *field = &level->fields[y * level->width + x];
+
+			if (*field == WM_WATER)
+			{
+				water++;
+				horizontalPairs += (x + 1 < level->width && field[1] == WM_WATER);
+				verticalPairs += (y + 1 < level->height && field[level->width] == WM_WATER);
+			}
+		}
+	}
+
+	sides[0] = sides[1] = water;
+	sides[2] = sides[3] = water - (culled ? verticalPairs : 0);
+	sides[4] = sides[5] = water - (culled ? horizontalPairs : 0);
+}
+
+/**
+ * Liest die Anzahl der Wasserfaces je Seite aus der Ausgabe von ueb03.
+ *
+ * @param filename Datei mit der Ausgabe (In)
+ * @param sides Anzahl je Seite (Out)
+ * @return 1, wenn die Zeile gefunden wurde, sonst 0
+ */
+static int readSides(const char *filename, int sides[SIDE_COUNT])
+{
+	FILE *file = fopen(filename, "r");
+	char line[LINE_LENGTH];
+	int found = 0;
+
+	if (file == NULL)
+	{
+		fprintf(stderr, "%s kann nicht gelesen werden.\n", filename);
+		return 0;
+	}
+
+	/* Die letzte passende Zeile zaehlt */
+	while (fgets(line, sizeof(line), file) != NULL)
+	{
+		const char *start = strstr(line, SIDES_PREFIX);
+
+		if (start != NULL)
+		{
+			found = sscanf(start, SIDES_PREFIX " %d oben, %d unten, %d vorne, %d hinten, %d links, %d rechts",
+			               &sides[0], &sides[1], &sides[2], &sides[3], &sides[4], &sides[5]) == SIDE_COUNT;
+		}
+	}
+
+	fclose(file);
+
+	if (!found)
+	{
+		fprintf(stderr, "%s enthaelt keine Faces je Seite.\n", filename);
+	}
+
+	return found;
+}
+
+/**
+ * Vergleicht die Ausgabe eines Laufs mit den erwarteten Zahlen.
+ *
+ * @param level das Level des Laufs (In)
+ * @param filename Datei mit der Ausgabe (In)
+ * @param culled wurden Seiten zwischen Wasserfeldern weggelassen? (In)
+ * @return 1, wenn alle Zahlen stimmen, sonst 0
+ */
+static int checkRun(const LevelFile *level, const char *filename, int culled)
+{
+	int expected[SIDE_COUNT], actual[SIDE_COUNT];
+	int success = readSides(filename, actual);
+
+	expectedSides(level, culled, expected);
+
+	for (int i = 0; success && i < SIDE_COUNT; i++)
+	{
+		if (actual[i] != expected[i])
+		{
+			fprintf(stderr, "%s: %d Faces %s, erwartet %d\n", filename, actual[i], g_sideNames[i], expected[i]);
+			success = 0;
+		}
+	}
+
+	if (success)
+	{
+		printf("%s %s: %d/%d/%d/%d/%d/%d Faces wie erwartet\n", culled ? "mit Weglassen" : "ohne Weglassen",
+		       filename, actual[0], actual[1], actual[2], actual[3], actual[4], actual[5]);
+	}
+
+	return success;
+}
+
+/* ---- Oeffentliche Funktionen ---- */
+
+/**
+ * Hauptprogramm.
+ *
+ * @param argc Anzahl der Kommandozeilenparameter (In)
+ * @param argv Kommandozeilenparameter (In)
+ *
+ * @return 0 bei Erfolg, sonst 1
+ */
+int main(int argc, char **argv)
+{
+	if (argc == 3 && strcmp(argv[1], "--write") == 0)
+	{
+		return writeTestLevel(argv[2]) ? 0 : 1;
+	}
+
+	if (argc != 4)
+	{
+		fprintf(stderr, "Aufruf: %s --write <level>\n"
+		                "       %s <level> <ausgabe-mit-weglassen> <ausgabe-ohne-weglassen>\n",
+		        argv[0], argv[0]);
+		return 1;
+	}
+
+	LevelFile level = EMPTY_LEVEL_FILE;
+	int success = levelfile_load(argv[1], &level);
+
+	if (success)
+	{
+		/* Beide Laeufe pruefen, auch wenn der erste schon abweicht */
+		int culledOk = checkRun(&level, argv[2], 1);
+		int allOk = checkRun(&level, argv[3], 0);
+
+		success = culledOk && allOk;
+	}
+
+	levelfile_free(&level);
+
+	return success ? 0 : 1;
+}
@@ -0,0 +1,464 @@
+/**
+ * @file
+ * Frametime-Modul.
+ * Das Modul misst die Dauer jedes einzelnen Frames mit einem hochaufloesenden
+ * Timer und wertet die Messungen beim Programmende aus.
+ *
+ * Gemessen werden drei Groessen:
+ *  - Frame: Abstand zwischen zwei aufeinanderfolgenden Buffer-Tauschen, also
+ *    das, was der Betrachter als Ruckeln wahrnimmt.
+ *  - CPU: Zeit vom Beginn des Display-Callbacks bis nach dem Buffer-Tausch.
+ *  - GPU: Ausfuehrungszeit der OpenGL-Befehle des Frames (nur mit FRAMETIME_GPU).
+ *
+ * Die Histogramme haben eine feste Klassenbreite, Perzentile sind also auf
+ * FRAMETIME_BUCKET_NS genau. Das Maximum wird exakt mitgefuehrt.
+ *
+ * Bestandteil einer Uebung im Rahmen des Moduls Praktikum Grundlagen der Computergrafik
+ * an der FH Wedel.
+ *
+ * @author Nicolas Hollmann, Daniel Klintworth
+ */
+
+/* ---- System Header einbinden ---- */
+#ifdef WIN32
+#include <windows.h>
+#else
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+#include <time.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef FRAMETIME_GPU
+#include <GL/glew.h>
+#endif
+
+/* ---- Eigene Header einbinden ---- */
+#include "frametime.h"
+
+/* ---- Konstanten ---- */
+
+/** Klassenbreite der Histogramme in Nanosekunden (10 Mikrosekunden) */
+#define FRAMETIME_BUCKET_NS (10000)
+
+/** Anzahl der Klassen, deckt 0 bis 200 ms ab. Laengere Frames landen in der letzten Klasse. */
+#define FRAMETIME_BUCKETS (20000)
+
+/** Anzahl der GPU-Queries im Ring, so viele Frames darf die GPU hinterherhaengen */
+#define FRAMETIME_QUERIES (4)
+
+/** Zeitraum fuer die Mittelung der Framerate in Nanosekunden */
+#define FRAMETIME_FPS_WINDOW (1000000000ull)
+
+/** Kennzeichnet einen nicht gemessenen Wert */
+#define FRAMETIME_NONE (UINT64_MAX)
+
+/* ---- Typen ---- */
+
+/** Die gemessenen Groessen */
+typedef enum {
+	MEASURE_FRAME = 0,
+	MEASURE_CPU,
+	MEASURE_GPU,
+
+	MEASURE_COUNT
+} Measure;
+
+/** Histogramm einer Groesse */
+typedef struct {
+	uint32_t buckets[FRAMETIME_BUCKETS];
+	uint64_t count;
+	uint64_t max;
+} Histogram;
+
+/** Werte eines einzelnen Frames fuer die CSV-Ausgabe */
+typedef struct {
+	uint64_t values[MEASURE_COUNT];
+} FrameRecord;
+
+/* ---- Globale Daten ---- */
+
+/** Histogramme aller Groessen */
+static Histogram g_histograms[MEASURE_COUNT];
+
+/** Name der CSV-Datei oder NULL */
+static const char *g_csvFilename = NULL;
+
+/** Werte aller Frames, nur wenn eine CSV-Datei geschrieben wird */
+static FrameRecord *g_records = NULL;
+
+/** Anzahl und Kapazitaet von g_records */
+static uint64_t g_recordCount = 0;
+static uint64_t g_recordCapacity = 0;
+
+/** Nummer des aktuellen Frames */
+static uint64_t g_frame = 0;
+
+/** Beginn des aktuellen Frames */
+static uint64_t g_frameBegin = 0;
+
+/** Ende des letzten Frames, 0 vor dem ersten Frame */
+static uint64_t g_lastFrameEnd = 0;
+
+/** Beginn des aktuellen FPS-Zeitraums und Anzahl der Frames darin */
+static uint64_t g_fpsBase = 0;
+static int g_fpsFrames = 0;
+
+/** Zuletzt berechnete Framerate */
+static float g_fps = 0.0f;
+
+#ifdef FRAMETIME_GPU
+/** Ring der GPU-Queries */
+static GLuint g_queries[FRAMETIME_QUERIES];
+
+/** Frame, zu dem eine Query gehoert, FRAMETIME_NONE wenn frei */
+static uint64_t g_queryFrames[FRAMETIME_QUERIES];
+
+/** Startzeitpunkt (CPU) der Queries zur Plausibilitaetspruefung */
+static uint64_t g_queryBegin[FRAMETIME_QUERIES];
+
+/** 1 wenn Queries verfuegbar sind, -1 wenn nicht, 0 wenn noch nicht geprueft */
+static int g_gpuState = 0;
+#endif
+
+/* ---- Interne Funktionen ---- */
+
+/**
+ * Traegt einen Messwert in ein Histogramm ein.
+ *
+ * @param histogram das Histogramm (InOut)
+ * @param value der Messwert in Nanosekunden (In)
+ */
+static void addSample(Histogram *histogram, uint64_t value)
+{
+	uint64_t bucket = value / FRAMETIME_BUCKET_NS;
+
+	if (bucket >= FRAMETIME_BUCKETS)
+	{
+		bucket = FRAMETIME_BUCKETS - 1;
+	}
+
+	histogram->buckets[bucket]++;
+	histogram->count++;
+
+	if (value > histogram->max)
+	{
+		histogram->max = value;
+	}
+}
+
+/**
+ * Bestimmt ein Perzentil aus einem Histogramm. Geliefert wird die obere
+ * Grenze der Klasse, in der das Perzentil liegt.
+ *
+ * @param histogram das Histogramm (In)
+ * @param percent das Perzentil zwischen 0 und 100 (In)
+ *
+ * @return der Wert in Nanosekunden
+ */
+static uint64_t percentile(const Histogram *histogram, double percent)
+{
+	uint64_t rank = (uint64_t)(histogram->count * percent / 100.0 + 0.5);
+	uint64_t sum = 0;
+
+	if (rank == 0)
+	{
+		rank = 1;
+	}
+
+	for (int i = 0; i < FRAMETIME_BUCKETS - 1; i++)
+	{
+		sum += histogram->buckets[i];
+
+		if (sum >= rank)
+		{
+			uint64_t upper = (uint64_t)(i + 1) * FRAMETIME_BUCKET_NS;
+			return upper < histogram->max ? upper : histogram->max;
+		}
+	}
+
+	return histogram->max;
+}
+
+/**
+ * Speichert einen Messwert fuer die CSV-Ausgabe.
+ *
+ * @param frame der Frame (In)
+ * @param measure die Groesse (In)
+ * @param value der Messwert in Nanosekunden (In)
+ */
+static void recordValue(uint64_t frame, Measure measure, uint64_t value)
+{
+	if (g_csvFilename == NULL)
+	{
+		return;
+	}
+
+	while (frame >= g_recordCapacity)
+	{
+		uint64_t capacity = g_recordCapacity ? g_recordCapacity * 2 : 4096;
+		FrameRecord *records = realloc(g_records, capacity * sizeof(FrameRecord));
+
+		if (records == NULL)
+		{
+			/* Ohne Speicher wird die CSV-Datei nicht geschrieben */
+			free(g_records);
+			g_records = NULL;
+			g_csvFilename = NULL;
+			return;
+		}
+
+		for (uint64_t i = g_recordCapacity; i < capacity; i++)
+		{
+			for (int m = 0; m < MEASURE_COUNT; m++)
+			{
+				records[i].values[m] = FRAMETIME_NONE;
+			}
+		}
+
+		g_records = records;
+		g_recordCapacity = capacity;
+	}
+
+	g_records[frame].values[measure] = value;
+
+	if (frame >= g_recordCount)
+	{
+		g_recordCount = frame + 1;
+	}
+}
+
+/**
+ * Traegt einen Messwert in Histogramm und CSV-Daten ein.
+ *
+ * @param frame der Frame (In)
+ * @param measure die Groesse (In)
+ * @param value der Messwert in Nanosekunden (In)
+ */
+static void addMeasurement(uint64_t frame, Measure measure, uint64_t value)
+{
+	addSample(&g_histograms[measure], value);
+	recordValue(frame, measure, value);
+}
+
+#ifdef FRAMETIME_GPU
+/**
+ * Liest das Ergebnis einer GPU-Query aus, falls diese belegt ist.
+ *
+ * @param slot die Position im Ring (In)
+ */
+static void collectQuery(int slot)
+{
+	if (g_queryFrames[slot] != FRAMETIME_NONE)
+	{
+		GLuint64 elapsed = 0;
+
+		/* Nach FRAMETIME_QUERIES Frames ist das Ergebnis in aller Regel
+		 * verfuegbar, das Lesen blockiert also nicht */
+		glGetQueryObjectui64v(g_queries[slot], GL_QUERY_RESULT, &elapsed);
+
+		/* Die GPU kann nicht laenger gerechnet haben als seit dem Start der
+		 * Query vergangen ist. Manche Treiber (z.B. llvmpipe) liefern bei der
+		 * ersten Query Unsinn, solche Werte werden verworfen. */
+		if ((uint64_t)elapsed <= frametime_now() - g_queryBegin[slot])
+		{
+			addMeasurement(g_queryFrames[slot], MEASURE_GPU, (uint64_t)elapsed);
+		}
+		g_queryFrames[slot] = FRAMETIME_NONE;
+	}
+}
+
+/**
+ * Legt beim ersten Aufruf die GPU-Queries an, sofern der Kontext sie unterstuetzt.
+ *
+ * @return 1, wenn GPU-Zeiten gemessen werden koennen
+ */
+static int gpuAvailable(void)
+{
+	if (g_gpuState == 0)
+	{
+		g_gpuState = -1;
+
+		if (GLEW_VERSION_3_3 || GLEW_ARB_timer_query)
+		{
+			glGenQueries(FRAMETIME_QUERIES, g_queries);
+
+			for (int i = 0; i < FRAMETIME_QUERIES; i++)
+			{
+				g_queryFrames[i] = FRAMETIME_NONE;
+			}
+
+			g_gpuState = 1;
+		}
+	}
+
+	return g_gpuState == 1;
+}
+#endif
+
+/**
+ * Schreibt die Werte aller Frames in die CSV-Datei.
+ */
+static void writeCsv(void)
+{
+	FILE *file = fopen(g_csvFilename, "w");
+
+	if (file == NULL)
+	{
+		fprintf(stderr, "CSV-Datei %s konnte nicht angelegt werden.\n", g_csvFilename);
+		return;
+	}
+
+	fprintf(file, "frame,frame_ms,cpu_ms,gpu_ms\n");
+
+	for (uint64_t i = 0; i < g_recordCount; i++)
+	{
+		fprintf(file, "%llu", (unsigned long long)i);
+
+		for (int m = 0; m < MEASURE_COUNT; m++)
+		{
+			if (g_records[i].values[m] == FRAMETIME_NONE)
+			{
+				fprintf(file, ",");
+			}
+			else
+			{
+				fprintf(file, ",%.4f", g_records[i].values[m] / 1e6);
+			}
+		}
+
+		fprintf(file, "\n");
+	}
+
+	fclose(file);
+}
+
+/**
+ * Gibt die Statistik aus und schreibt gegebenenfalls die CSV-Datei.
+ * Wird beim Programmende ueber atexit aufgerufen.
+ */
+static void report(void)
+{
+	static const char *names[MEASURE_COUNT] = { "Frame", "CPU", "GPU" };
+
+	/* Noch ausstehende GPU-Queries werden verworfen, da beim Beenden nicht
+	 * sicher ein Kontext aktiv ist */
+	printf("Frametimes ueber %llu Frames [ms]:\n", (unsigned long long)g_frame);
+	printf("%-6s %9s %9s %9s %9s\n", "", "p50", "p95", "p99", "max");
+
+	for (int m = 0; m < MEASURE_COUNT; m++)
+	{
+		const Histogram *histogram = &g_histograms[m];
+
+		if (histogram->count > 0)
+		{
+			printf("%-6s %9.3f %9.3f %9.3f %9.3f\n", names[m],
+			       percentile(histogram, 50.0) / 1e6,
+			       percentile(histogram, 95.0) / 1e6,
+			       percentile(histogram, 99.0) / 1e6,
+			       histogram->max / 1e6);
+		}
+	}
+
+	if (g_csvFilename != NULL)
+	{
+		writeCsv();
+	}
+
+	free(g_records);
+	g_records = NULL;
+}
+
+/* ---- Oeffentliche Funktionen ---- */
+
+void frametime_init(const char *csvFilename)
+{
+	g_csvFilename = csvFilename;
+	g_fpsBase = frametime_now();
+
+	atexit(report);
+}
+
+void frametime_beginFrame(void)
+{
+	g_frameBegin = frametime_now();
+
+#ifdef FRAMETIME_GPU
+	if (gpuAvailable())
+	{
+		int slot = (int)(g_frame % FRAMETIME_QUERIES);
+
+		collectQuery(slot);
+		glBeginQuery(GL_TIME_ELAPSED, g_queries[slot]);
+		g_queryFrames[slot] = g_frame;
+		g_queryBegin[slot] = g_frameBegin;
+	}
+#endif
+}
+
+void frametime_endFrame(void)
+{
+	uint64_t end = frametime_now();
+
+#ifdef FRAMETIME_GPU
+	if (g_gpuState == 1)
+	{
+		glEndQuery(GL_TIME_ELAPSED);
+	}
+#endif
+
+	addMeasurement(g_frame, MEASURE_CPU, end - g_frameBegin);
+
+	/* Der erste Frame hat keinen Vorgaenger */
+	if (g_lastFrameEnd != 0)
+	{
+		addMeasurement(g_frame, MEASURE_FRAME, end - g_lastFrameEnd);
+	}
+
+	g_lastFrameEnd = end;
+	g_frame++;
+
+	/* Framerate ueber den letzten Zeitraum mitteln */
+	g_fpsFrames++;
+	if (end - g_fpsBase > FRAMETIME_FPS_WINDOW)
+	{
+		g_fps = (float)(g_fpsFrames * 1e9 / (double)(end - g_fpsBase));
+		g_fpsBase = end;
+		g_fpsFrames = 0;
+	}
+}
+
+float frametime_fps(void)
+{
+	return g_fps;
+}
+
+uint64_t frametime_now(void)
+{
+#ifdef WIN32
+	static LARGE_INTEGER frequency;
+	LARGE_INTEGER counter;
+
+	if (frequency.QuadPart == 0)
+	{
+		QueryPerformanceFrequency(&frequency);
+	}
+
+	QueryPerformanceCounter(&counter);
+
+	/* In zwei Schritten rechnen, damit nichts ueberlaeuft */
+	uint64_t seconds = (uint64_t)(counter.QuadPart / frequency.QuadPart);
+	uint64_t rest = (uint64_t)(counter.QuadPart % frequency.QuadPart);
+
+	return seconds * 1000000000ull + rest * 1000000000ull / (uint64_t)frequency.QuadPart;
+#else
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+#endif
+}
@@ -0,0 +1,338 @@
+/**
+ * @file
+ * Headless-Modul.
+ * Das Modul erzeugt ohne Fenster einen OpenGL-Kontext ueber EGL und rendert
+ * in ein Framebuffer-Objekt mit Farb- und Tiefen-/Stencil-Renderbuffer.
+ * Bevorzugt wird Mesas surfaceless-Plattform, die weder X11 noch ein
+ * DRM-Geraet benoetigt und damit auch auf reinen CPU-Rechnern (llvmpipe)
+ * funktioniert.
+ *
+ * Die Funktionen fuer Framebuffer-Objekte gehoeren nicht zu OpenGL 1.1 und
+ * werden deshalb ueber eglGetProcAddress geladen.
+ *
+ * Bestandteil einer Uebung im Rahmen des Moduls Praktikum Grundlagen der Computergrafik
+ * an der FH Wedel.
+ *
+ * @author Nicolas Hollmann, Daniel Klintworth
+ */
+
+/* ---- System Header einbinden ---- */
+#ifdef HEADLESS_EGL
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#define EGL_NO_X11
+#define MESA_EGL_NO_X11_HEADERS
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GL/gl.h>
+#include <GL/glext.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* ---- Eigene Header einbinden ---- */
+#include "headless.h"
+
+/* ---- Konstanten ---- */
+
+/** Maximale Laenge eines Dateinamens fuer Bilder */
+#define HEADLESS_PATH_LENGTH (1024)
+
+/* ---- Globale Daten ---- */
+
+/** Wird gerade ohne Fenster gerendert? */
+static int g_active = 0;
+
+#ifdef HEADLESS_EGL
+/** EGL-Display und -Kontext */
+static EGLDisplay g_display = EGL_NO_DISPLAY;
+static EGLContext g_context = EGL_NO_CONTEXT;
+
+/** Framebuffer-Objekt und seine Renderbuffer (Farbe, Tiefe/Stencil) */
+static GLuint g_framebuffer = 0;
+static GLuint g_renderbuffers[2] = { 0, 0 };
+
+/** Groesse des Bildes */
+static int g_width = 0;
+static int g_height = 0;
+
+/** Zwischenspeicher fuer das ausgelesene Bild */
+static unsigned char *g_pixels = NULL;
+
+/** Per eglGetProcAddress geladene Funktionen */
+static PFNGLGENFRAMEBUFFERSPROC genFramebuffers = NULL;
+static PFNGLBINDFRAMEBUFFERPROC bindFramebuffer = NULL;
+static PFNGLDELETEFRAMEBUFFERSPROC deleteFramebuffers = NULL;
+static PFNGLFRAMEBUFFERRENDERBUFFERPROC framebufferRenderbuffer = NULL;
+static PFNGLCHECKFRAMEBUFFERSTATUSPROC checkFramebufferStatus = NULL;
+static PFNGLGENRENDERBUFFERSPROC genRenderbuffers = NULL;
+static PFNGLBINDRENDERBUFFERPROC bindRenderbuffer = NULL;
+static PFNGLDELETERENDERBUFFERSPROC deleteRenderbuffers = NULL;
+static PFNGLRENDERBUFFERSTORAGEPROC renderbufferStorage = NULL;
+#endif
+
+/* ---- Interne Funktionen ---- */
+
+#ifdef HEADLESS_EGL
+/**
+ * Oeffnet ein EGL-Display. Bevorzugt die surfaceless-Plattform von Mesa und
+ * faellt sonst auf das Standard-Display zurueck.
+ *
+ * @return das initialisierte Display oder EGL_NO_DISPLAY
+ */
+static EGLDisplay openDisplay(void)
+{
+	EGLDisplay display = EGL_NO_DISPLAY;
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+		(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+	if (getPlatformDisplay != NULL)
+	{
+		display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+	}
+
+	if (display == EGL_NO_DISPLAY)
+	{
+		display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	}
+
+	if (display != EGL_NO_DISPLAY && !eglInitialize(display, NULL, NULL))
+	{
+		display = EGL_NO_DISPLAY;
+	}
+
+	return display;
+}
+
+/**
+ * Erzeugt einen OpenGL-Kontext auf dem Display.
+ *
+ * @param major, minor gewuenschte Version, 0 fuer beliebig (In)
+ * @param core ungleich 0 fuer ein Kern-Profil (In)
+ *
+ * @return der Kontext oder EGL_NO_CONTEXT
+ */
+static EGLContext createContext(int major, int minor, int core)
+{
+	/* Ohne Angabe werden nur Configs fuer Fenster gesucht, die es hier nicht gibt */
+	EGLint configAttributes[] = {
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_NONE
+	};
+	EGLint contextAttributes[] = {
+		EGL_CONTEXT_MAJOR_VERSION, major,
+		EGL_CONTEXT_MINOR_VERSION, minor,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK,
+		core ? EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT : EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT,
+		EGL_NONE
+	};
+	EGLConfig config;
+	EGLint configCount = 0;
+
+	if (!eglBindAPI(EGL_OPENGL_API)
+	    || !eglChooseConfig(g_display, configAttributes, &config, 1, &configCount)
+	    || configCount < 1)
+	{
+		return EGL_NO_CONTEXT;
+	}
+
+	return eglCreateContext(g_display, config, EGL_NO_CONTEXT,
+	                        major > 0 ? contextAttributes : NULL);
+}
+
+/**
+ * Laedt die Funktionen fuer Framebuffer-Objekte.
+ *
+ * @return 1, wenn alle Funktionen vorhanden sind
+ */
+static int loadFunctions(void)
+{
+	genFramebuffers = (PFNGLGENFRAMEBUFFERSPROC)eglGetProcAddress("glGenFramebuffers");
+	bindFramebuffer = (PFNGLBINDFRAMEBUFFERPROC)eglGetProcAddress("glBindFramebuffer");
+	deleteFramebuffers = (PFNGLDELETEFRAMEBUFFERSPROC)eglGetProcAddress("glDeleteFramebuffers");
+	framebufferRenderbuffer = (PFNGLFRAMEBUFFERRENDERBUFFERPROC)eglGetProcAddress("glFramebufferRenderbuffer");
+	checkFramebufferStatus = (PFNGLCHECKFRAMEBUFFERSTATUSPROC)eglGetProcAddress("glCheckFramebufferStatus");
+	genRenderbuffers = (PFNGLGENRENDERBUFFERSPROC)eglGetProcAddress("glGenRenderbuffers");
+	bindRenderbuffer = (PFNGLBINDRENDERBUFFERPROC)eglGetProcAddress("glBindRenderbuffer");
+	deleteRenderbuffers = (PFNGLDELETERENDERBUFFERSPROC)eglGetProcAddress("glDeleteRenderbuffers");
+	renderbufferStorage = (PFNGLRENDERBUFFERSTORAGEPROC)eglGetProcAddress("glRenderbufferStorage");
+
+	return genFramebuffers && bindFramebuffer && deleteFramebuffers
+	       && framebufferRenderbuffer && checkFramebufferStatus
+	       && genRenderbuffers && bindRenderbuffer && deleteRenderbuffers
+	       && renderbufferStorage;
+}
+
+/**
+ * Legt das Framebuffer-Objekt an und bindet es.
+ *
+ * @return 1 bei Erfolg, sonst 0
+ */
+static int createFramebuffer(void)
+{
+	genRenderbuffers(2, g_renderbuffers);
+
+	bindRenderbuffer(GL_RENDERBUFFER, g_renderbuffers[0]);
+	renderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, g_width, g_height);
+
+	bindRenderbuffer(GL_RENDERBUFFER, g_renderbuffers[1]);
+	renderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, g_width, g_height);
+
+	bindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	genFramebuffers(1, &g_framebuffer);
+	bindFramebuffer(GL_FRAMEBUFFER, g_framebuffer);
+	framebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, g_renderbuffers[0]);
+	framebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, g_renderbuffers[1]);
+
+	return checkFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+}
+
+/**
+ * Schreibt das aktuelle Bild als PPM-Datei.
+ *
+ * @param filename der Dateiname (In)
+ */
+static void writePPM(const char *filename)
+{
+	size_t rowSize = (size_t)g_width * 3;
+	FILE *file = fopen(filename, "wb");
+
+	if (file == NULL)
+	{
+		fprintf(stderr, "Bild %s konnte nicht geschrieben werden.\n", filename);
+		return;
+	}
+
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, g_width, g_height, GL_RGB, GL_UNSIGNED_BYTE, g_pixels);
+
+	fprintf(file, "P6\n%d %d\n255\n", g_width, g_height);
+
+	/* OpenGL liefert die unterste Zeile zuerst */
+	for (int y = g_height - 1; y >= 0; y--)
+	{
+		fwrite(g_pixels + (size_t)y * rowSize, 1, rowSize, file);
+	}
+
+	fclose(file);
+}
+#endif
+
+/* ---- Oeffentliche Funktionen ---- */
+
+int headless_init(int width, int height, int major, int minor, int core)
+{
+#ifdef HEADLESS_EGL
+	g_width = width;
+	g_height = height;
+
+	g_display = openDisplay();
+	if (g_display == EGL_NO_DISPLAY)
+	{
+		fprintf(stderr, "Kein EGL-Display verfuegbar.\n");
+		return 0;
+	}
+
+	g_context = createContext(major, minor, core);
+	if (g_context == EGL_NO_CONTEXT
+	    || !eglMakeCurrent(g_display, EGL_NO_SURFACE, EGL_NO_SURFACE, g_context))
+	{
+		fprintf(stderr, "OpenGL-Kontext ohne Fenster konnte nicht erzeugt werden.\n");
+		headless_cleanup();
+		return 0;
+	}
+
+	g_pixels = malloc((size_t)width * height * 3);
+
+	if (g_pixels == NULL || !loadFunctions() || !createFramebuffer())
+	{
+		fprintf(stderr, "Framebuffer-Objekt konnte nicht angelegt werden.\n");
+		headless_cleanup();
+		return 0;
+	}
+
+	glViewport(0, 0, width, height);
+	g_active = 1;
+
+	return 1;
+#else
+	(void)width;
+	(void)height;
+	(void)major;
+	(void)minor;
+	(void)core;
+
+	fprintf(stderr, "Headless-Modus nicht verfuegbar, das Programm wurde ohne EGL gebaut.\n");
+
+	return 0;
+#endif
+}
+
+void headless_finishFrame(void)
+{
+#ifdef HEADLESS_EGL
+	glFinish();
+#endif
+}
+
+void headless_dumpFrame(const char *dumpDir, int frame)
+{
+#ifdef HEADLESS_EGL
+	char filename[HEADLESS_PATH_LENGTH];
+
+	if (frame == 0)
+	{
+		/* Existiert das Verzeichnis schon, schlaegt das still fehl */
+		mkdir(dumpDir, 0755);
+	}
+
+	snprintf(filename, sizeof(filename), "%s/frame_%05d.ppm", dumpDir, frame);
+	writePPM(filename);
+#else
+	(void)dumpDir;
+	(void)frame;
+#endif
+}
+
+void headless_cleanup(void)
+{
+#ifdef HEADLESS_EGL
+	if (g_framebuffer != 0)
+	{
+		bindFramebuffer(GL_FRAMEBUFFER, 0);
+		deleteFramebuffers(1, &g_framebuffer);
+		deleteRenderbuffers(2, g_renderbuffers);
+		g_framebuffer = 0;
+	}
+
+	if (g_context != EGL_NO_CONTEXT)
+	{
+		eglMakeCurrent(g_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		eglDestroyContext(g_display, g_context);
+		g_context = EGL_NO_CONTEXT;
+	}
+
+	if (g_display != EGL_NO_DISPLAY)
+	{
+		eglTerminate(g_display);
+		g_display = EGL_NO_DISPLAY;
+	}
+
+	free(g_pixels);
+	g_pixels = NULL;
+#endif
+
+	g_active = 0;
+}
+
+int headless_active(void)
+{
+	return g_active;
+}
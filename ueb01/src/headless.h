@@ -0,0 +1,72 @@
+#ifndef __HEADLESS_H__
+#define __HEADLESS_H__
+/**
+ * @file
+ * Schnittstelle des Headless-Moduls.
+ * Das Modul erzeugt ohne Fenster einen OpenGL-Kontext (EGL mit Mesas
+ * surfaceless-Plattform) und rendert in ein Framebuffer-Objekt. Damit koennen
+ * die Programme auf Rechnern ohne Display, z.B. fuer Performance-Messungen,
+ * eine feste Anzahl an Frames rendern und diese als PPM-Bilder ablegen.
+ *
+ * Der Modus steht nur zur Verfuegung, wenn beim Bauen EGL gefunden wurde
+ * (HEADLESS_EGL), sonst schlaegt headless_init immer fehl.
+ *
+ * Bestandteil einer Uebung im Rahmen des Moduls Praktikum Grundlagen der Computergrafik
+ * an der FH Wedel.
+ *
+ * @author Nicolas Hollmann, Daniel Klintworth
+ */
+
+/* ---- Konstanten ---- */
+
+/** Zeitschritt pro Frame im Headless-Modus in Sekunden */
+#define HEADLESS_DT (1.0 / 60.0)
+
+/** Anzahl der Frames, wenn keine angegeben wird */
+#define HEADLESS_DEFAULT_FRAMES (300)
+
+/* ---- Funktionen ---- */
+
+/**
+ * Erzeugt einen OpenGL-Kontext ohne Fenster samt Framebuffer-Objekt der
+ * angegebenen Groesse und macht beides aktuell. Der Viewport wird auf das
+ * ganze Bild gesetzt.
+ *
+ * @param width Breite des Bildes (In)
+ * @param height Hoehe des Bildes (In)
+ * @param major, minor gewuenschte OpenGL-Version, 0 fuer beliebig (In)
+ * @param core ungleich 0, wenn ein Kern-Profil angefordert werden soll (In)
+ *
+ * @return 1 bei Erfolg, sonst 0
+ */
+int headless_init(int width, int height, int major, int minor, int core);
+
+/**
+ * Schliesst einen Frame ab und wartet, bis die GPU alle Befehle ausgefuehrt hat.
+ */
+void headless_finishFrame(void);
+
+/**
+ * Schreibt das aktuelle Bild als PPM-Datei (frame_00000.ppm, ...) in ein
+ * Verzeichnis. Das Verzeichnis wird beim ersten Frame bei Bedarf angelegt.
+ *
+ * @param dumpDir Zielverzeichnis (In)
+ * @param frame Nummer des Frames (In)
+ */
+void headless_dumpFrame(const char *dumpDir, int frame);
+
+/**
+ * Gibt Framebuffer und Kontext wieder frei.
+ */
+void headless_cleanup(void);
+
+/**
+ * Prueft, ob gerade ohne Fenster gerendert wird. Funktionen von GLUT, die
+ * ein Fenster voraussetzen (z.B. Bitmap-Schriften), duerfen dann nicht
+ * aufgerufen werden.
+ *
+ * @return 1, wenn der Headless-Modus aktiv ist
+ */
+int headless_active(void);
+
+#endif
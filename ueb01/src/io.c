@@ -26,6 +26,9 @@
 #include "types.h"
 #include "logic.h"
 #include "scene.h"
+#include "frametime.h"
+#include "headless.h"
+#include "replay.h"
 #include "debugGL.h"
 
 /* ---- Konstanten ---- */
@@ -84,6 +87,13 @@ static void toggleFullscreen (void)
 	/* Zwischenspeicher: Fenstergroesse */
 	static int windowSize[2];
 
+	/* Ohne Fenster gibt es nichts umzuschalten (z.B. bei der Wiedergabe im
+	 * Headless-Modus) */
+	if (headless_active())
+	{
+		return;
+	}
+
 	/* Modus wechseln */
 	fullscreen = !fullscreen;
 
@@ -253,6 +263,20 @@ static void handleKeyboardEvent(int key, int status, GLboolean isSpecialKey, int
 	}
 }
 
+/**
+ * Leitet ein aufgezeichnetes oder live eingetroffenes Tastaturereignis an die
+ * Ereignisbehandlung weiter.
+ *
+ * @param key Taste (In)
+ * @param status Status der Taste (In)
+ * @param isSpecialKey ungleich 0 bei Spezialtasten (In)
+ * @param x, y Position des Mauszeigers (In)
+ */
+static void onKeyboardEvent(int key, int status, int isSpecialKey, int x, int y)
+{
+	handleKeyboardEvent(key, status, (GLboolean)isSpecialKey, x, y);
+}
+
 /**
  * Callback fuer Tastendruck.
  * Ruft Ereignisbehandlung fuer Tastaturereignis auf.
@@ -263,7 +287,7 @@ static void handleKeyboardEvent(int key, int status, GLboolean isSpecialKey, int
  */
 static void cbKeyboard(unsigned char key, int x, int y)
 {
-	handleKeyboardEvent(key, GLUT_DOWN, GL_FALSE, x, y);
+	replay_keyboardEvent(key, GLUT_DOWN, GL_FALSE, x, y);
 }
 
 /**
@@ -276,7 +300,7 @@ static void cbKeyboard(unsigned char key, int x, int y)
  */
 static void cbKeyboardUp(unsigned char key, int x, int y)
 {
-	handleKeyboardEvent(key, GLUT_UP, GL_FALSE, x, y);
+	replay_keyboardEvent(key, GLUT_UP, GL_FALSE, x, y);
 }
 
 /**
@@ -289,7 +313,7 @@ static void cbKeyboardUp(unsigned char key, int x, int y)
  */
 static void cbSpecial(int key, int x, int y)
 {
-	handleKeyboardEvent(key, GLUT_DOWN, GL_TRUE, x, y);
+	replay_keyboardEvent(key, GLUT_DOWN, GL_TRUE, x, y);
 }
 
 /**
@@ -302,7 +326,25 @@ static void cbSpecial(int key, int x, int y)
  */
 static void cbSpecialUp(int key, int x, int y)
 {
-	handleKeyboardEvent(key, GLUT_UP, GL_TRUE, x, y);
+	replay_keyboardEvent(key, GLUT_UP, GL_TRUE, x, y);
+}
+
+/**
+ * Berechnet die aktuelle Position und Farben fuer einen Zeitschritt.
+ * 
+ * @param interval seit dem letzten Schritt vergangene Zeit in Sekunden (In)
+ */
+static void stepLogic(double interval)
+{
+	if (g_paused) {
+		interval = 0.0;
+	}
+
+	/* neue Position berechnen (zeitgesteuert) */
+	calcBall(interval);
+
+	/* neue Farbwerte fuer die Eckpunkte berechnen (zeitgesteuert) */
+	calcPaddles(interval);
 }
 
 /**
@@ -321,15 +363,14 @@ static void cbTimer(int lastCallTime)
 	/* Seit dem letzten Funktionsaufruf vergangene Zeit in Sekunden */
 	double interval = (double)(thisCallTime - lastCallTime) / 1000.0f;
 
-	if (g_paused) {
-		interval = 0.0;
+	/* Eine Wiedergabe ist mit dem letzten aufgezeichneten Schritt beendet */
+	if (replay_finished())
+	{
+		exit(0);
 	}
 
-	/* neue Position berechnen (zeitgesteuert) */
-	calcBall(interval);
-
-	/* neue Farbwerte fuer die Eckpunkte berechnen (zeitgesteuert) */
-	calcPaddles(interval);
+	/* Bei Aufzeichnung/Wiedergabe laeuft der Zeitschritt ueber das Replay-Modul */
+	stepLogic(replay_tick(interval));
 
 	/* Wieder als Timer-Funktion registrieren */
 	glutTimerFunc(1000 / TIMER_CALLS_PS, cbTimer, thisCallTime);
@@ -355,11 +396,9 @@ static void cbReshape(int w, int h)
 }
 
 /**
- * Zeichen-Callback.
- * Loescht die Buffer, ruft das Zeichnen der Szene auf und tauscht den Front-
- * und Backbuffer.
+ * Zeichnet einen Frame in den aktuellen Framebuffer.
  */
-static void cbDisplay(void)
+static void drawFrame(void)
 {
 	/* Buffer zuruecksetzen */
 	glClear(GL_COLOR_BUFFER_BIT);
@@ -372,9 +411,24 @@ static void cbDisplay(void)
 
 	/* Szene zeichnen */
 	drawScene();
+}
+
+/**
+ * Zeichen-Callback.
+ * Loescht die Buffer, ruft das Zeichnen der Szene auf und tauscht den Front-
+ * und Backbuffer.
+ */
+static void cbDisplay(void)
+{
+	frametime_beginFrame();
+
+	drawFrame();
 
 	/* Objekt anzeigen */
 	glutSwapBuffers();
+
+	/* Dauer des Frames messen */
+	frametime_endFrame();
 }
 
 /**
@@ -464,7 +518,8 @@ int initAndStartIO(char *title, int width, int height)
 			INFO(("...fertig.\n\n"));
 			INFO(("Initialisiere Zufallsgenerator...\n"));
 
-			srand(time(0));
+			srand(replay_seed((unsigned)time(0)));
+			replay_setHandlers(onKeyboardEvent, NULL);
 
 			INFO(("...fertig.\n\n"));
 			INFO(("Initialisiere Logik...\n"));
@@ -496,3 +551,69 @@ int initAndStartIO(char *title, int width, int height)
 
 	return windowID;
 }
+
+int runHeadless(int frames, int width, int height, const char *dumpDir)
+{
+	int success = 0;
+
+	INFO(("Erzeuge Kontext ohne Fenster...\n"));
+
+	if (headless_init(width, height, 0, 0, 0))
+	{
+		INFO(("...fertig.\n\n"));
+		INFO(("Initialisiere Szene...\n"));
+
+		if (initScene())
+		{
+			INFO(("...fertig.\n\n"));
+			INFO(("Initialisiere Logik...\n"));
+
+			/* Feste Saat, damit jeder Lauf dieselben Bilder liefert */
+			srand(replay_seed(0));
+			replay_setHandlers(onKeyboardEvent, NULL);
+			initRound(sideLeft);
+
+			INFO(("...fertig.\n\n"));
+
+			cbReshape(width, height);
+
+			uint64_t start = frametime_now();
+
+			int frame;
+
+			/* Bei einer Wiedergabe endet der Lauf mit der Aufzeichnung */
+			for (frame = 0; frame < frames && !replay_finished(); frame++)
+			{
+				stepLogic(replay_tick(HEADLESS_DT));
+
+				frametime_beginFrame();
+				drawFrame();
+				headless_finishFrame();
+				frametime_endFrame();
+
+				if (dumpDir != NULL)
+				{
+					headless_dumpFrame(dumpDir, frame);
+				}
+			}
+
+			double seconds = (frametime_now() - start) / 1e9;
+			printf("%d Frames (%dx%d) in %.3f s, %.2f FPS\n",
+			       frame, width, height, seconds, frame / seconds);
+
+			success = 1;
+		}
+		else
+		{
+			INFO(("...fehlgeschlagen.\n\n"));
+		}
+
+		headless_cleanup();
+	}
+	else
+	{
+		INFO(("...fehlgeschlagen.\n\n"));
+	}
+
+	return success;
+}
@@ -39,6 +39,10 @@
 /** Die Beschleunigung des Balls bei einem Schlaegerkontakt */
 #define BALL_ACCELERATION 0.1f
 
+/** Maximale Anzahl an Stoessen des Balls innerhalb eines Zeitschritts.
+    Ein darueber hinaus verbleibender Rest des Zeitschritts verfaellt. */
+#define BALL_MAX_BOUNCES 8
+
 /** Die Rotationsgeschwindigkeit des Balls */
 #define BALL_ROTATION_SPEED 60.0f
 
@@ -91,45 +95,65 @@ static GLboolean g_paddleGuideDrawing = GL_FALSE;
 /* ---- Interne Funktionen ---- */
 
 /**
- * Prueft, ob der Spielball mit dem Rahmen kollidiert ist.
+ * Prueft fuer eine Achse, ob der Ball sich auf eine Begrenzung zubewegt, und
+ * uebernimmt deren Beruehrzeitpunkt, wenn er nicht spaeter als der bisher
+ * frueheste liegt.
  * 
- * @return Rahmenseite, mit der kollidiert wurde
+ * @param position Koordinate des Ballmittelpunkts auf der Achse (In)
+ * @param velocity Geschwindigkeit des Balls auf der Achse (In)
+ * @param limit Koordinate, die der Ballmittelpunkt nicht ueberschreiten darf (In)
+ * @param outward Richtung der Begrenzung aus Sicht des Spielfelds, 1 oder -1 (In)
+ * @param side die zugehoerige Rahmenseite (In)
+ * @param hit bisher zuerst beruehrte Rahmenseite (InOut)
+ * @param time Zeitpunkt der bisher fruehesten Beruehrung (InOut)
  */
-static CGSide checkBorderCollision(void)
+static void sweepBorderAxis(GLfloat position, GLfloat velocity, GLfloat limit, GLfloat outward,
+							CGSide side, CGSide *hit, GLfloat *time)
 {
-	CGSide res = sideNone;
-
-	/* Ball fliegt nach rechts und
-		 die rechte Seite des Balls ueberschreitet den rechten Rand */
-	if (g_ball.direction[0] > 0.0f &&
-		g_ball.position[0] + BALL_SIZE >= 1.0)
+	/* Nur die Begrenzung in Bewegungsrichtung ist relevant */
+	if (velocity * outward > 0.0f)
 	{
-		res = sideRight;
-	}
+		/* Ein bereits ueberschrittener Rand wird sofort beruehrt */
+		GLfloat t = (limit - position) / velocity;
+		if (t < 0.0f)
+		{
+			t = 0.0f;
+		}
 
-	/* Ball fliegt nach links und
-		 die linke Seite des Balls ueberschreitet den linken Rand */
-	else if (g_ball.direction[0] < 0.0f &&
-			 g_ball.position[0] - BALL_SIZE <= -1.0)
-	{
-		res = sideLeft;
+		if (t <= *time)
+		{
+			*hit = side;
+			*time = t;
+		}
 	}
+}
 
-	/* Ball fliegt nach oben und
-		 die obere Seite des Balls ueberschreitet den oberen Rand */
-	else if (g_ball.direction[1] > 0.0f &&
-			 g_ball.position[1] + BALL_SIZE >= BORDER_TOP - BORDER_THICKNESS / 2)
-	{
-		res = sideTop;
-	}
+/**
+ * Bestimmt, ob und wann der Spielball bei gleichbleibender Bewegung innerhalb
+ * des angegebenen Zeitraums zuerst den Rahmen beruehrt.
+ * 
+ * @param velocity Geschwindigkeitsvektor des Balls (In)
+ * @param time maximaler Zeitraum; bei Kollision der Zeitpunkt der
+ *   Beruehrung (InOut)
+ * @return Rahmenseite, mit der kollidiert wird, sonst sideNone
+ */
+static CGSide sweepBorder(CGVector2f velocity, GLfloat *time)
+{
+	CGSide res = sideNone;
 
-	/* Ball fliegt nach unten und
-		 die untere Seite des Ball ueberschreitet den unteren Rand */
-	else if (g_ball.direction[1] < 0.0f &&
-			 g_ball.position[1] - BALL_SIZE <= BORDER_BOTTOM + BORDER_THICKNESS / 2)
-	{
-		res = sideBottom;
-	}
+	/* Der rechte und linke Rand liegen bei 1 bzw. -1 */
+	sweepBorderAxis(g_ball.position[0], velocity[0], 1.0f - BALL_SIZE, 1.0f,
+					sideRight, &res, time);
+	sweepBorderAxis(g_ball.position[0], velocity[0], -1.0f + BALL_SIZE, -1.0f,
+					sideLeft, &res, time);
+
+	/* Oben und unten zaehlt die Innenkante der Spielfeldbegrenzung */
+	sweepBorderAxis(g_ball.position[1], velocity[1],
+					BORDER_TOP - BORDER_THICKNESS / 2 - BALL_SIZE, 1.0f,
+					sideTop, &res, time);
+	sweepBorderAxis(g_ball.position[1], velocity[1],
+					BORDER_BOTTOM + BORDER_THICKNESS / 2 + BALL_SIZE, -1.0f,
+					sideBottom, &res, time);
 
 	return res;
 }
@@ -313,21 +337,37 @@ static void handlePaddleCollision(Player *player, CGPoint2f intersection, CGVect
 }
 
 /**
- * Berechnet, ob es eine Kollision des Balls mit dem Schlaeger eines Spielers gab.
- * Wenn ja, wird darauf direkt reagiert.
+ * Bestimmt, ob und wann der Spielball bei gleichbleibender Bewegung innerhalb
+ * des angegebenen Zeitraums auf die aktive Kante eines Schlaegers trifft.
+ * Wie bei der bisherigen Pruefung trifft der Ball, sobald sein Mittelpunkt
+ * hoechstens BALL_SIZE von der Kante entfernt ist und sein Lotfusspunkt auf
+ * der Kante liegt. Gesucht wird der frueheste Zeitpunkt, zu dem beides gilt.
  * 
  * @param player der Spieler, fuer den die Berechnung durchgefuehrt werden soll (In)
+ * @param velocity Geschwindigkeitsvektor des Balls (In)
+ * @param time maximaler Zeitraum; bei Kollision der Zeitpunkt des
+ *   Treffers (InOut)
+ * @param intersection der Kollisionspunkt auf der Kante (Out)
+ * @param playerNormal die Normale des Schlaegers (Out)
+ * @return GL_TRUE, wenn der Ball innerhalb des Zeitraums trifft
  */
-static void calcPaddleCollision(Player *player) 
+static GLboolean sweepPaddle(Player *player, CGVector2f velocity, GLfloat *time,
+							 CGPoint2f intersection, CGVector2f playerNormal)
 {
 	// Normale des Schlaegers berechnen (Vektor)
-	CGVector2f playerNormal = VECTOR_ZERO;
 	vector_circle(playerNormal, TO_RADIANS(player->paddleRotation));
 	if (!player->isHuman) 
 	{
 		vector_mul(playerNormal, -1.0f);
 	}
 
+	// Nur ein Ball, der sich auf die Kante zubewegt, kann treffen
+	GLfloat approach = vector_dot(velocity, playerNormal);
+	if (approach >= 0.0f)
+	{
+		return GL_FALSE;
+	}
+
 	// aktive Kante des Schlaegers berechnen (Vektor)
 	CGVector2f playerRotation = VECTOR_ZERO;
 	vector_circle(playerRotation, TO_RADIANS(player->paddleRotation + 90));
@@ -338,21 +378,48 @@ static void calcPaddleCollision(Player *player)
 	vector_mul(playerPaddle, PADDLE_THICKNESS / 2);
 	vector_add(playerPaddle, player->paddlePosition);
 
-	// Schnittpunkt Schlaegerkante mit Schlaegernormale vom Ball aus (jeweils unendlich).
-	CGPoint2f intersection = POINT_ZERO;
-	vector_intersect(intersection, playerPaddle, playerRotation, g_ball.position, playerNormal);
-
-	// Abstand Ball - Schlaegerkante
-	GLfloat distBall = point_distance(g_ball.position, intersection);
+	// Lage des Balls relativ zur Kantenmitte: Abstand entlang der Normalen
+	// und Position entlang der Kante
+	CGVector2f offset = VECTOR_ZERO;
+	vector_add(offset, g_ball.position);
+	vector_sub(offset, playerPaddle);
+	GLfloat dist = vector_dot(offset, playerNormal);
+	GLfloat along = vector_dot(offset, playerRotation);
+
+	// Zeitraum, in dem der Abstand zur Kante hoechstens BALL_SIZE betraegt
+	GLfloat start = (dist - BALL_SIZE) / -approach;
+	GLfloat end = (dist + BALL_SIZE) / -approach;
+
+	// Zeitraum, in dem der Lotfusspunkt auf der Kante liegt
+	GLfloat drift = vector_dot(velocity, playerRotation);
+	if (drift != 0.0f)
+	{
+		GLfloat enter = (-PADDLE_HEIGHT / 2 - along) / drift;
+		GLfloat leave = (PADDLE_HEIGHT / 2 - along) / drift;
+		start = fmaxf(start, fminf(enter, leave));
+		end = fminf(end, fmaxf(enter, leave));
+	}
+	else if (fabsf(along) > PADDLE_HEIGHT / 2)
+	{
+		return GL_FALSE;
+	}
 
-	// Abstand Schnittpunkt - Schlaegerkantenmitte
-	GLfloat distIntersection = point_distance(playerPaddle, intersection);
+	// Ein bereits anliegender Ball trifft sofort
+	start = fmaxf(start, 0.0f);
 
-	// Kollisionspruefung
-	if (distBall <= BALL_SIZE && distIntersection <= PADDLE_HEIGHT / 2) 
+	if (start > end || start > *time)
 	{
-		handlePaddleCollision(player, intersection, playerNormal);
+		return GL_FALSE;
 	}
+
+	// Lotfusspunkt des Balls auf der Kante zum Zeitpunkt des Treffers
+	vector_set(intersection, playerRotation);
+	vector_mul(intersection, along + drift * start);
+	vector_add(intersection, playerPaddle);
+
+	*time = start;
+
+	return GL_TRUE;
 }
 
 /**
@@ -431,25 +498,56 @@ static void calcBotPaddle(double interval)
 
 void calcBall(double interval)
 {
-	CGSide side = sideNone;
-	side = checkBorderCollision();
+	GLfloat remaining = (GLfloat)interval;
+	int bounces = 0;
 
-	if (side != sideNone)
+	/* Der Ball wird jeweils bis zum naechsten Stoss bewegt, sodass er auch bei
+	   hoher Geschwindigkeit oder langen Zeitschritten nicht durch Schlaeger
+	   oder Rahmen hindurchfliegt. */
+	while (remaining > 0.0f && bounces < BALL_MAX_BOUNCES)
 	{
-		handleCollision(side);
-	}
+		CGVector2f velocity = VECTOR_ZERO;
+		vector_set(velocity, g_ball.direction);
+		vector_mul(velocity, g_ball.speed);
+
+		/* Fruehesten Stoss innerhalb des verbleibenden Zeitraums suchen */
+		GLfloat time = remaining;
+		CGSide side = sweepBorder(velocity, &time);
+
+		Player *player = NULL;
+		CGPoint2f intersection = POINT_ZERO;
+		CGVector2f playerNormal = VECTOR_ZERO;
+		if (sweepPaddle(getHumanPlayer(), velocity, &time, intersection, playerNormal))
+		{
+			player = getHumanPlayer();
+		}
+		else if (sweepPaddle(getBotPlayer(), velocity, &time, intersection, playerNormal))
+		{
+			player = getBotPlayer();
+		}
 
-	if (g_ball.direction[0] < 0.0f) 
-	{
-		calcPaddleCollision(getHumanPlayer());
-	} 
-	else 
-	{
-		calcPaddleCollision(getBotPlayer());
-	}
+		/* Ball bis zum Stoss bzw. bis zum Ende des Zeitraums bewegen */
+		vector_mul(velocity, time);
+		vector_add(g_ball.position, velocity);
+		remaining -= time;
 
-	g_ball.position[0] += g_ball.direction[0] * g_ball.speed * (float)interval;
-	g_ball.position[1] += g_ball.direction[1] * g_ball.speed * (float)interval;
+		if (player != NULL)
+		{
+			handlePaddleCollision(player, intersection, playerNormal);
+			bounces++;
+		}
+		else if (side != sideNone)
+		{
+			handleCollision(side);
+			bounces++;
+
+			/* Nach einem Punkt beginnt eine neue Runde */
+			if (side == sideLeft || side == sideRight)
+			{
+				remaining = 0.0f;
+			}
+		}
+	}
 
 	g_ball.rotation += BALL_ROTATION_SPEED * (float)interval;
 }
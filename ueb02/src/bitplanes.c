@@ -0,0 +1,257 @@
+/**
+ * @file
+ * Bitebenen-Modul.
+ * Haelt ein Level als eine Bitmenge je Feldtyp und berechnet die Ausbreitung
+ * des Wassers wortweise.
+ *
+ * Bestandteil einer Uebung im Rahmen des Moduls Praktikum Grundlagen der Computergrafik
+ * an der FH Wedel.
+ *
+ * @author Nicolas Hollmann, Daniel Klintworth
+ */
+
+/* ---- System Header einbinden ---- */
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+/* ---- Eigene Header einbinden ---- */
+#include "bitplanes.h"
+
+/* ---- Konstanten ---- */
+
+/** Anzahl Felder je Wort */
+#define BITS_PER_WORD (64)
+
+/* ---- Interne Funktionen ---- */
+
+/**
+ * Bestimmt die Ebene eines Feldtyps.
+ *
+ * @param field der Feldtyp (In)
+ * @return die Ebene oder PLANE_COUNT, wenn der Typ in keiner Ebene liegt
+ */
+static BitPlane planeOf(wmFieldType field)
+{
+    switch (field)
+    {
+        case WM_FREE:
+            return PLANE_FREE;
+        case WM_WALL:
+            return PLANE_WALL;
+        case WM_GOAL:
+            return PLANE_GOAL;
+        case WM_WATER:
+            return PLANE_WATER;
+        case WM_SAND:
+            return PLANE_SAND;
+        case WM_SUGAR:
+            return PLANE_SUGAR;
+        default:
+            return PLANE_COUNT;
+    }
+}
+
+/**
+ * Liefert den Index des niedrigsten gesetzten Bits.
+ *
+ * @param bits die Bits, ungleich 0 (In)
+ * @return der Index
+ */
+static int lowestBit(uint64_t bits)
+{
+#ifdef __GNUC__
+    return __builtin_ctzll(bits);
+#else
+    int index = 0;
+    while (!(bits & 1))
+    {
+        bits >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+/* ---- Oeffentliche Funktionen ---- */
+
+int bitplanes_init(BitPlanes *planes, wmField **level, int width, int height)
+{
+    assert(planes != NULL);
+
+    bitplanes_free(planes);
+
+    planes->width = width;
+    planes->height = height;
+    planes->wordsPerRow = (width + BITS_PER_WORD - 1) / BITS_PER_WORD;
+
+    size_t words = (size_t)planes->wordsPerRow * height;
+
+    for (int p = 0; p < PLANE_COUNT; p++)
+    {
+        planes->planes[p] = calloc(words, sizeof(uint64_t));
+    }
+    planes->spread = calloc(words, sizeof(uint64_t));
+    planes->rowChanged = calloc(height, 1);
+    planes->rowSpread = calloc(height, 1);
+
+    for (int p = 0; p < PLANE_COUNT; p++)
+    {
+        if (planes->planes[p] == NULL || planes->spread == NULL
+            || planes->rowChanged == NULL || planes->rowSpread == NULL)
+        {
+            bitplanes_free(planes);
+            return 0;
+        }
+    }
+
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            bitplanes_set(planes, x, y, (wmFieldType)level[y][x]);
+        }
+    }
+
+    return 1;
+}
+
+void bitplanes_set(BitPlanes *planes, int x, int y, wmFieldType field)
+{
+    size_t word = (size_t)y * planes->wordsPerRow + x / BITS_PER_WORD;
+    uint64_t bit = (uint64_t)1 << (x % BITS_PER_WORD);
+    BitPlane plane = planeOf(field);
+
+    for (int p = 0; p < PLANE_COUNT; p++)
+    {
+        planes->planes[p][word] &= ~bit;
+    }
+
+    if (plane != PLANE_COUNT)
+    {
+        planes->planes[plane][word] |= bit;
+    }
+
+    planes->rowChanged[y] = 1;
+}
+
+int bitplanes_test(const BitPlanes *planes, BitPlane plane, int x, int y)
+{
+    if (x < 0 || x >= planes->width || y < 0 || y >= planes->height)
+    {
+        return 0;
+    }
+
+    size_t word = (size_t)y * planes->wordsPerRow + x / BITS_PER_WORD;
+
+    return (planes->planes[plane][word] >> (x % BITS_PER_WORD)) & 1;
+}
+
+int bitplanes_spreadWater(BitPlanes *planes)
+{
+    assert(planes != NULL);
+
+    const int wordsPerRow = planes->wordsPerRow;
+    const uint64_t *water = planes->planes[PLANE_WATER];
+    const uint64_t *dry = planes->planes[PLANE_FREE];
+    const uint64_t *sugar = planes->planes[PLANE_SUGAR];
+    const unsigned char *changed = planes->rowChanged;
+    uint64_t any = 0;
+
+    for (int y = 0; y < planes->height; y++)
+    {
+        /* Ohne Aenderung in der Naehe grenzt hier kein trockenes Feld an Wasser */
+        if (!changed[y] && (y == 0 || !changed[y - 1])
+            && (y + 1 == planes->height || !changed[y + 1]))
+        {
+            planes->rowSpread[y] = 0;
+            continue;
+        }
+
+        const uint64_t *row = water + (size_t)y * wordsPerRow;
+        const uint64_t *above = (y > 0) ? row - wordsPerRow : NULL;
+        const uint64_t *below = (y + 1 < planes->height) ? row + wordsPerRow : NULL;
+        uint64_t rowAny = 0;
+
+        for (int i = 0; i < wordsPerRow; i++)
+        {
+            size_t word = (size_t)y * wordsPerRow + i;
+
+            /* Wasser links und rechts, ueber die Wortgrenzen hinweg */
+            uint64_t fromLeft = (row[i] << 1) | ((i > 0) ? row[i - 1] >> (BITS_PER_WORD - 1) : 0);
+            uint64_t fromRight = (row[i] >> 1) | ((i + 1 < wordsPerRow) ? row[i + 1] << (BITS_PER_WORD - 1) : 0);
+            uint64_t wet = fromLeft | fromRight
+                           | (above != NULL ? above[i] : 0)
+                           | (below != NULL ? below[i] : 0);
+
+            /* Nur freie Felder und Zucker werden nass. Bits hinter dem
+             * Zeilenende liegen in keiner Ebene. */
+            planes->spread[word] = wet & (dry[word] | sugar[word]);
+            rowAny |= planes->spread[word];
+        }
+
+        planes->rowSpread[y] = (rowAny != 0);
+        any |= rowAny;
+    }
+
+    memset(planes->rowChanged, 0, planes->height);
+
+    return any != 0;
+}
+
+int bitplanes_nextSpread(BitPlanes *planes, int *word, int *x, int *y)
+{
+    const int wordsPerRow = planes->wordsPerRow;
+
+    while (*word < wordsPerRow * planes->height)
+    {
+        if (!planes->rowSpread[*word / wordsPerRow])
+        {
+            /* Leere Zeile ueberspringen */
+            *word = (*word / wordsPerRow + 1) * wordsPerRow;
+        }
+        else if (planes->spread[*word] == 0)
+        {
+            (*word)++;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if (*word >= wordsPerRow * planes->height)
+    {
+        return 0;
+    }
+
+    uint64_t *bits = &planes->spread[*word];
+    int bit = lowestBit(*bits);
+    *bits &= *bits - 1;
+
+    *x = (*word % wordsPerRow) * BITS_PER_WORD + bit;
+    *y = *word / wordsPerRow;
+
+    return 1;
+}
+
+void bitplanes_free(BitPlanes *planes)
+{
+    assert(planes != NULL);
+
+    for (int p = 0; p < PLANE_COUNT; p++)
+    {
+        free(planes->planes[p]);
+        planes->planes[p] = NULL;
+    }
+    free(planes->spread);
+    free(planes->rowChanged);
+    free(planes->rowSpread);
+    planes->spread = NULL;
+    planes->rowChanged = NULL;
+    planes->rowSpread = NULL;
+
+    planes->width = 0;
+    planes->height = 0;
+    planes->wordsPerRow = 0;
+}
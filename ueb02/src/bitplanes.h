@@ -0,0 +1,114 @@
+#ifndef __BITPLANES_H__
+#define __BITPLANES_H__
+/**
+ * @file
+ * Schnittstelle des Bitebenen-Moduls.
+ * Das Modul haelt ein Level zusaetzlich als Bitebenen: je Feldtyp eine
+ * Bitmenge mit einem Bit pro Feld, 64 Felder je Wort, jede Zeile beginnt mit
+ * einem neuen Wort. Regeln, die das ganze Level betreffen (z.B. die
+ * Ausbreitung des Wassers), werden so mit Schiebe- und Bitoperationen auf
+ * ganzen Woertern berechnet. Zeilen, in deren Naehe sich seit dem letzten
+ * Schritt nichts geaendert hat, werden dabei uebersprungen.
+ *
+ * Bestandteil einer Uebung im Rahmen des Moduls Praktikum Grundlagen der Computergrafik
+ * an der FH Wedel.
+ *
+ * @author Nicolas Hollmann, Daniel Klintworth
+ */
+
+/* ---- System Header einbinden ---- */
+#include <stdint.h>
+
+/* ---- Eigene Header einbinden ---- */
+#include "types.h"
+
+/* ---- Typedeklarationen ---- */
+
+/** Die Bitebenen, Felder anderer Typen liegen in keiner Ebene */
+typedef enum {
+    PLANE_FREE,
+    PLANE_WALL,
+    PLANE_GOAL,
+    PLANE_WATER, // Wasser und neues Wasser
+    PLANE_SAND,
+    PLANE_SUGAR,
+    PLANE_COUNT
+} BitPlane;
+
+/** Ein Level als Bitebenen */
+typedef struct {
+    int width, height;
+    int wordsPerRow;
+    uint64_t *planes[PLANE_COUNT];
+    uint64_t *spread; // Ergebnis von bitplanes_spreadWater
+    unsigned char *rowChanged; // Zeile seit dem letzten Schritt geaendert?
+    unsigned char *rowSpread; // Zeile enthaelt Bits in spread?
+} BitPlanes;
+
+/* Konstante fuer leere Bitebenen */
+#define EMPTY_BIT_PLANES {0, 0, 0, {NULL}, NULL, NULL, NULL}
+
+/* ---- Funktionen ---- */
+
+/**
+ * Legt die Bitebenen fuer ein Level an und fuellt sie aus den Feldern.
+ * Vorher gehaltene Ebenen werden freigegeben.
+ *
+ * @param planes die Bitebenen (InOut)
+ * @param level Zeilen des Levels (In)
+ * @param width, height Groesse des Levels (In)
+ * @return 1 bei Erfolg, 0 wenn kein Speicher frei ist
+ */
+int bitplanes_init(BitPlanes *planes, wmField **level, int width, int height);
+
+/**
+ * Traegt einen neuen Feldtyp fuer ein Feld ein.
+ *
+ * @param planes die Bitebenen (InOut)
+ * @param x, y Position des Feldes (In)
+ * @param field der neue Feldtyp (In)
+ */
+void bitplanes_set(BitPlanes *planes, int x, int y, wmFieldType field);
+
+/**
+ * Prueft, ob ein Feld in einer Ebene liegt. Felder ausserhalb des Levels
+ * liegen in keiner Ebene.
+ *
+ * @param planes die Bitebenen (In)
+ * @param plane die Ebene (In)
+ * @param x, y Position des Feldes (In)
+ * @return 1, wenn das Feld in der Ebene liegt
+ */
+int bitplanes_test(const BitPlanes *planes, BitPlane plane, int x, int y);
+
+/**
+ * Berechnet einen Schritt der Wasserausbreitung: alle freien Felder und
+ * Zuckerfelder, die an Wasser grenzen. Das Ergebnis steht danach in
+ * planes->spread, die Ebenen selbst bleiben unveraendert. Es genuegt, die
+ * Zeilen um geaenderte Zeilen neu zu berechnen: nach einem vollstaendig
+ * uebernommenen Schritt grenzt sonst kein trockenes Feld mehr an Wasser.
+ *
+ * @param planes die Bitebenen (InOut)
+ * @return 1, wenn sich das Wasser ausbreitet
+ */
+int bitplanes_spreadWater(BitPlanes *planes);
+
+/**
+ * Liefert das naechste Feld aus planes->spread und loescht dessen Bit. Die
+ * Felder kommen zeilenweise von oben links.
+ *
+ * @param planes die Bitebenen (InOut)
+ * @param word Wort in planes->spread, ab dem gesucht wird, beim ersten Aufruf 0 (InOut)
+ * @param x, y Position des Feldes (Out)
+ * @return 1, wenn ein Feld gefunden wurde, 0 am Ende
+ */
+int bitplanes_nextSpread(BitPlanes *planes, int *word, int *x, int *y);
+
+/**
+ * Gibt den Speicher der Bitebenen frei.
+ *
+ * @param planes die Bitebenen (InOut)
+ */
+void bitplanes_free(BitPlanes *planes);
+
+#endif
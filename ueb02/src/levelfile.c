@@ -0,0 +1,304 @@
+/**
+ * @file
+ * Leveldatei-Modul.
+ * Liest und schreibt Level im Binaerformat aus levelfile.h. Unter POSIX wird
+ * die Datei per mmap eingeblendet, sonst komplett eingelesen.
+ *
+ * Bestandteil einer Uebung im Rahmen des Moduls Praktikum Grundlagen der Computergrafik
+ * an der FH Wedel.
+ *
+ * @author Nicolas Hollmann, Daniel Klintworth
+ */
+
+/* ---- System Header einbinden ---- */
+#ifndef WIN32
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ---- Eigene Header einbinden ---- */
+#include "levelfile.h"
+
+/* ---- Konstanten ---- */
+
+/** Kennung am Anfang einer Leveldatei */
+#define LEVELFILE_MAGIC "WMLV"
+
+/* ---- Interne Funktionen ---- */
+
+/**
+ * Liest eine 16-Bit-Zahl (little-endian) aus dem Kopf.
+ *
+ * @param bytes Zeiger auf das erste Byte (In)
+ * @return die Zahl
+ */
+static int readU16(const unsigned char *bytes)
+{
+	return bytes[0] | (bytes[1] << 8);
+}
+
+/**
+ * Schreibt eine 16-Bit-Zahl (little-endian) in den Kopf.
+ *
+ * @param bytes Zeiger auf das erste Byte (Out)
+ * @param value die Zahl (In)
+ */
+static void writeU16(unsigned char *bytes, int value)
+{
+	bytes[0] = (unsigned char)(value & 0xff);
+	bytes[1] = (unsigned char)((value >> 8) & 0xff);
+}
+
+/**
+ * Prueft, ob ein Feldtyp in einer Leveldatei stehen darf. Erlaubt sind nur
+ * die Feldtypen, mit denen ein Level beginnt, alle anderen entstehen erst
+ * waehrend des Spiels. Der Start steht im Kopf.
+ *
+ * @param field der Feldtyp (In)
+ * @return 1, wenn der Feldtyp erlaubt ist
+ */
+static int isValidField(wmField field)
+{
+	switch (field)
+	{
+		case WM_FREE:
+		case WM_BLACK:
+		case WM_WALL:
+		case WM_GOAL:
+		case WM_WATER:
+		case WM_SAND:
+		case WM_SUGAR:
+			return 1;
+		default:
+			return 0;
+	}
+}
+
+/**
+ * Prueft Kopf und Felder eines geladenen Levels und traegt die Groesse ein.
+ *
+ * @param filename Name der Datei fuer Meldungen (In)
+ * @param level das Level, data und size sind gesetzt (InOut)
+ * @return 1, wenn das Level gueltig ist
+ */
+static int parseLevel(const char *filename, LevelFile *level)
+{
+	const unsigned char *header = level->data;
+
+	if (level->size < LEVELFILE_HEADER_SIZE
+	    || memcmp(header, LEVELFILE_MAGIC, strlen(LEVELFILE_MAGIC)) != 0)
+	{
+		fprintf(stderr, "%s ist keine Leveldatei.\n", filename);
+		return 0;
+	}
+
+	if (readU16(header + 4) != LEVELFILE_VERSION)
+	{
+		fprintf(stderr, "%s hat eine unbekannte Version (%d).\n", filename, readU16(header + 4));
+		return 0;
+	}
+
+	level->width = readU16(header + 6);
+	level->height = readU16(header + 8);
+	level->startX = readU16(header + 10);
+	level->startY = readU16(header + 12);
+	level->fields = (wmField *)level->data + LEVELFILE_HEADER_SIZE;
+
+	if (level->width < 1 || level->width > LEVEL_MAX_SIZE
+	    || level->height < 1 || level->height > LEVEL_MAX_SIZE)
+	{
+		fprintf(stderr, "%s: ungueltige Groesse %dx%d.\n", filename, level->width, level->height);
+		return 0;
+	}
+
+	size_t count = (size_t)level->width * level->height;
+
+	if (level->size < LEVELFILE_HEADER_SIZE + count)
+	{
+		fprintf(stderr, "%s ist unvollstaendig.\n", filename);
+		return 0;
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		if (!isValidField(level->fields[i]))
+		{
+			fprintf(stderr, "%s: ungueltiges Feld %d bei %d,%d.\n", filename, level->fields[i],
+			        (int)(i % level->width), (int)(i / level->width));
+			return 0;
+		}
+	}
+
+	if (level->startX >= level->width || level->startY >= level->height
+	    || level->fields[level->startY * level->width + level->startX] != WM_FREE)
+	{
+		fprintf(stderr, "%s: Startposition %d,%d ist kein freies Feld.\n", filename,
+		        level->startX, level->startY);
+		return 0;
+	}
+
+	return 1;
+}
+
+/* ---- Oeffentliche Funktionen ---- */
+
+int levelfile_create(LevelFile *level, int width, int height)
+{
+	levelfile_free(level);
+
+	if (width < 1 || width > LEVEL_MAX_SIZE || height < 1 || height > LEVEL_MAX_SIZE)
+	{
+		return 0;
+	}
+
+	level->size = LEVELFILE_HEADER_SIZE + (size_t)width * height;
+	level->data = calloc(level->size, 1);
+
+	if (level->data == NULL)
+	{
+		level->size = 0;
+		return 0;
+	}
+
+	level->width = width;
+	level->height = height;
+	level->startX = 0;
+	level->startY = 0;
+	level->fields = (wmField *)level->data + LEVELFILE_HEADER_SIZE;
+	memset(level->fields, WM_BLACK, (size_t)width * height);
+
+	return 1;
+}
+
+int levelfile_load(const char *filename, LevelFile *level)
+{
+	levelfile_free(level);
+
+#ifndef WIN32
+	int fd = open(filename, O_RDONLY);
+	struct stat info;
+
+	if (fd < 0 || fstat(fd, &info) != 0)
+	{
+		fprintf(stderr, "Leveldatei %s konnte nicht geoeffnet werden.\n", filename);
+		if (fd >= 0)
+		{
+			close(fd);
+		}
+		return 0;
+	}
+
+	level->size = (size_t)info.st_size;
+
+	/* Private Kopie: Aenderungen im Spiel landen nicht in der Datei */
+	level->data = (level->size > 0)
+	              ? mmap(NULL, level->size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0)
+	              : MAP_FAILED;
+	close(fd);
+
+	if (level->data == MAP_FAILED)
+	{
+		fprintf(stderr, "Leveldatei %s konnte nicht eingeblendet werden.\n", filename);
+		level->data = NULL;
+		level->size = 0;
+		return 0;
+	}
+
+	level->mapped = 1;
+#else
+	FILE *file = fopen(filename, "rb");
+
+	if (file == NULL)
+	{
+		fprintf(stderr, "Leveldatei %s konnte nicht geoeffnet werden.\n", filename);
+		return 0;
+	}
+
+	fseek(file, 0, SEEK_END);
+	level->size = (size_t)ftell(file);
+	fseek(file, 0, SEEK_SET);
+	level->data = malloc(level->size > 0 ? level->size : 1);
+
+	if (level->data == NULL || fread(level->data, 1, level->size, file) != level->size)
+	{
+		fprintf(stderr, "Leveldatei %s konnte nicht gelesen werden.\n", filename);
+		fclose(file);
+		levelfile_free(level);
+		return 0;
+	}
+
+	fclose(file);
+#endif
+
+	if (!parseLevel(filename, level))
+	{
+		levelfile_free(level);
+		return 0;
+	}
+
+	return 1;
+}
+
+int levelfile_save(const char *filename, const LevelFile *level)
+{
+	unsigned char header[LEVELFILE_HEADER_SIZE] = {0};
+	size_t count = (size_t)level->width * level->height;
+	FILE *file = fopen(filename, "wb");
+
+	if (file == NULL)
+	{
+		fprintf(stderr, "Leveldatei %s konnte nicht angelegt werden.\n", filename);
+		return 0;
+	}
+
+	memcpy(header, LEVELFILE_MAGIC, strlen(LEVELFILE_MAGIC));
+	writeU16(header + 4, LEVELFILE_VERSION);
+	writeU16(header + 6, level->width);
+	writeU16(header + 8, level->height);
+	writeU16(header + 10, level->startX);
+	writeU16(header + 12, level->startY);
+
+	int success = fwrite(header, 1, sizeof(header), file) == sizeof(header)
+	              && fwrite(level->fields, 1, count, file) == count;
+
+	if (fclose(file) != 0 || !success)
+	{
+		fprintf(stderr, "Leveldatei %s konnte nicht geschrieben werden.\n", filename);
+		return 0;
+	}
+
+	return 1;
+}
+
+void levelfile_free(LevelFile *level)
+{
+	if (level->data != NULL)
+	{
+#ifndef WIN32
+		if (level->mapped)
+		{
+			munmap(level->data, level->size);
+		}
+		else
+#endif
+		{
+			free(level->data);
+		}
+	}
+
+	level->width = 0;
+	level->height = 0;
+	level->fields = NULL;
+	level->data = NULL;
+	level->size = 0;
+	level->mapped = 0;
+}
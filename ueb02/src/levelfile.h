@@ -0,0 +1,96 @@
+#ifndef __LEVELFILE_H__
+#define __LEVELFILE_H__
+/**
+ * @file
+ * Schnittstelle des Leveldatei-Moduls.
+ * Das Modul liest und schreibt Level beliebiger Groesse (bis LEVEL_MAX_SIZE
+ * in jeder Richtung) in einem kompakten Binaerformat. Auf einen Kopf von
+ * LEVELFILE_HEADER_SIZE Bytes folgt ein Byte (wmFieldType) je Feld,
+ * zeilenweise von oben links.
+ *
+ * Kopf, alle Zahlen als 16 Bit little-endian:
+ *    0  "WMLV"     Kennung
+ *    4  Version    (LEVELFILE_VERSION)
+ *    6  Breite
+ *    8  Hoehe
+ *   10  Start X    Startposition des Spielers, das Feld muss frei sein
+ *   12  Start Y
+ *   14  reserviert (0)
+ *
+ * Geladen wird per mmap als private Kopie. Nur die Seiten, die das Spiel
+ * veraendert, werden kopiert, die Datei selbst bleibt unveraendert.
+ *
+ * Bestandteil einer Uebung im Rahmen des Moduls Praktikum Grundlagen der Computergrafik
+ * an der FH Wedel.
+ *
+ * @author Nicolas Hollmann, Daniel Klintworth
+ */
+
+/* ---- System Header einbinden ---- */
+#include <stddef.h>
+
+/* ---- Eigene Header einbinden ---- */
+#include "types.h"
+
+/* ---- Konstanten ---- */
+
+/** Groesse des Kopfes in Bytes */
+#define LEVELFILE_HEADER_SIZE (16)
+
+/** Aktuelle Version des Formats */
+#define LEVELFILE_VERSION (1)
+
+/* ---- Typen ---- */
+
+/** Ein geladenes oder neu angelegtes Level */
+typedef struct {
+    int width, height; // Groesse in Feldern
+    int startX, startY; // Startposition des Spielers
+    wmField *fields; // Felder, zeilenweise, beschreibbar
+    void *data; // Anfang des Speicherbereichs (intern)
+    size_t size; // Groesse des Speicherbereichs in Bytes (intern)
+    int mapped; // Speicherbereich per mmap eingeblendet? (intern)
+} LevelFile;
+
+/* Konstante fuer ein leeres Level */
+#define EMPTY_LEVEL_FILE {0, 0, 0, 0, NULL, NULL, 0, 0}
+
+/* ---- Funktionen ---- */
+
+/**
+ * Legt ein leeres Level der angegebenen Groesse im Speicher an. Alle Felder
+ * sind WM_BLACK. Ein vorher gehaltenes Level wird freigegeben.
+ *
+ * @param level das Level (InOut)
+ * @param width, height Groesse in Feldern, 1 bis LEVEL_MAX_SIZE (In)
+ * @return 1 bei Erfolg, sonst 0
+ */
+int levelfile_create(LevelFile *level, int width, int height);
+
+/**
+ * Laedt ein Level aus einer Datei und prueft es auf Gueltigkeit. Ein vorher
+ * gehaltenes Level wird freigegeben.
+ *
+ * @param filename Name der Datei (In)
+ * @param level das Level (InOut)
+ * @return 1 bei Erfolg, sonst 0 (mit Meldung auf stderr)
+ */
+int levelfile_load(const char *filename, LevelFile *level);
+
+/**
+ * Schreibt ein Level in eine Datei.
+ *
+ * @param filename Name der Datei (In)
+ * @param level das Level (In)
+ * @return 1 bei Erfolg, sonst 0 (mit Meldung auf stderr)
+ */
+int levelfile_save(const char *filename, const LevelFile *level);
+
+/**
+ * Gibt den Speicher eines Levels frei bzw. blendet die Datei aus.
+ *
+ * @param level das Level (InOut)
+ */
+void levelfile_free(LevelFile *level);
+
+#endif
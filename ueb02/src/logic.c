@@ -19,10 +19,8 @@
 
 /* ---- Eigene Header einbinden ---- */
 #include "logic.h"
-
-/* ---- Makros ---- */
-
-#define CHECK_BOUNDARY(x) ((x) >= 0 && (x) < (LEVELSIZE))
+#include "levelfile.h"
+#include "bitplanes.h"
 
 /* ---- Konstanten ---- */
 
@@ -92,8 +90,87 @@ const wmLevel level4 =
 /* Spielzustand */
 static Gamestate g_gamestate = EMPTY_GAMESTATE;
 
+/* Speicher des aktuellen Levels, g_gamestate.level zeigt auf dessen Zeilen */
+static LevelFile g_levelData = EMPTY_LEVEL_FILE;
+
+/* Per setLevelFile festgelegte Leveldatei, NULL wenn keine */
+static const char *g_levelFilename = NULL;
+
+/* Das aktuelle Level als Bitebenen, wird mit jedem Feld aktualisiert */
+static BitPlanes g_planes = EMPTY_BIT_PLANES;
+
 /* ---- Interne Funktionen ---- */
 
+/**
+ * Setzt ein Feld des Levels und traegt es in die Bitebenen ein.
+ * 
+ * @param x X-Koordinate des Feldes (In)
+ * @param y Y-Koordinate des Feldes (In)
+ * @param field der neue Feldtyp (In)
+ */
+static void setField(int x, int y, wmFieldType field)
+{
+	g_gamestate.level[y][x] = field;
+	bitplanes_set(&g_planes, x, y, field);
+}
+
+/**
+ * Uebernimmt g_levelData als aktuelles Level und legt die Zeilenzeiger an.
+ * 
+ * @return 1 bei Erfolg, 0 wenn kein Speicher frei ist
+ */
+static int useLevelData(void)
+{
+	wmField **rows = realloc(g_gamestate.level, g_levelData.height * sizeof(wmField *));
+
+	if (rows == NULL)
+	{
+		return 0;
+	}
+
+	for (int y = 0; y < g_levelData.height; y++)
+	{
+		rows[y] = g_levelData.fields + (size_t)y * g_levelData.width;
+	}
+
+	g_gamestate.level = rows;
+	g_gamestate.levelWidth = g_levelData.width;
+	g_gamestate.levelHeight = g_levelData.height;
+	g_gamestate.playerX = g_levelData.startX;
+	g_gamestate.playerY = g_levelData.startY;
+
+	return 1;
+}
+
+/**
+ * Legt eines der eingebauten Level im Speicher an.
+ * 
+ * @param levelSource das Level (In)
+ * @return 1 bei Erfolg, 0 wenn kein Speicher frei ist
+ */
+static int loadBuiltinLevel(wmLevelPointer levelSource)
+{
+	if (!levelfile_create(&g_levelData, LEVELSIZE, LEVELSIZE))
+	{
+		return 0;
+	}
+
+	for (int y = 0; y < LEVELSIZE; y++)
+	{
+		for (int x = 0; x < LEVELSIZE; x++)
+		{
+			g_levelData.fields[y * LEVELSIZE + x] = (wmField)levelSource[y][x];
+			if (levelSource[y][x] == WM_START) {
+				g_levelData.startX = x;
+				g_levelData.startY = y;
+				g_levelData.fields[y * LEVELSIZE + x] = WM_FREE;
+			}
+		}
+	}
+
+	return useLevelData();
+}
+
 /**
  * Behandelt die Bewegung des Spielers.
  * 
@@ -106,23 +183,25 @@ static void handleMovement(int offsetX, int offsetY)
 	GLboolean canMove = GL_FALSE;
 
 	/* Das Feld, auf das der Spieler sich bewegen moechte. */
-	wmFieldType fstField = g_gamestate.level[g_gamestate.playerY + offsetY]
-											[g_gamestate.playerX + offsetX];
+	int fstX = g_gamestate.playerX + offsetX;
+	int fstY = g_gamestate.playerY + offsetY;
 
-	/* Das darauf folgende Feld. Relevant, wenn das erste Feld ein Sandsack ist. */
-	wmFieldType sndField = g_gamestate.level[g_gamestate.playerY + offsetY * 2]
-											[g_gamestate.playerX + offsetX * 2];
+	/* Das darauf folgende Feld. Relevant, wenn das erste Feld ein Sandsack ist.
+	 * Ausserhalb des Levels liegt in keiner Ebene, wirkt also wie eine Wand. */
+	int sndX = g_gamestate.playerX + offsetX * 2;
+	int sndY = g_gamestate.playerY + offsetY * 2;
 
-	if (fstField == WM_FREE || fstField == WM_GOAL) {
+	if (bitplanes_test(&g_planes, PLANE_FREE, fstX, fstY) ||
+	    bitplanes_test(&g_planes, PLANE_GOAL, fstX, fstY)) {
 		canMove = GL_TRUE;
-	} else if (fstField == WM_SAND && (
-			   sndField == WM_FREE || 
-			   sndField == WM_WATER )) {
+	} else if (bitplanes_test(&g_planes, PLANE_SAND, fstX, fstY) && (
+			   bitplanes_test(&g_planes, PLANE_FREE, sndX, sndY) || 
+			   bitplanes_test(&g_planes, PLANE_WATER, sndX, sndY) )) {
 
-		g_gamestate.level[g_gamestate.playerY + offsetY    ]
-						 [g_gamestate.playerX + offsetX    ] = WM_FREE;
-		g_gamestate.level[g_gamestate.playerY + offsetY * 2]
-						 [g_gamestate.playerX + offsetX * 2] = WM_SAND;
+		setField(g_gamestate.playerX + offsetX,
+				 g_gamestate.playerY + offsetY, WM_FREE);
+		setField(g_gamestate.playerX + offsetX * 2,
+				 g_gamestate.playerY + offsetY * 2, WM_SAND);
 
 		canMove = GL_TRUE;
 	}
@@ -141,10 +220,7 @@ static void handleMovement(int offsetX, int offsetY)
  */
 static void checkLosingCondition(void)
 {
-	wmFieldType playerField = g_gamestate.level[g_gamestate.playerY]
-											   [g_gamestate.playerX];
-	
-	if (playerField == WM_WATER) {
+	if (bitplanes_test(&g_planes, PLANE_WATER, g_gamestate.playerX, g_gamestate.playerY)) {
 		g_gamestate.stage = stageLost;
 	}
 }
@@ -154,64 +230,37 @@ static void checkLosingCondition(void)
  */
 static void checkVictoryCondition(void)
 {
-	wmFieldType playerField = g_gamestate.level[g_gamestate.playerY]
-											   [g_gamestate.playerX];
-
-	if (playerField == WM_GOAL) {
+	if (bitplanes_test(&g_planes, PLANE_GOAL, g_gamestate.playerX, g_gamestate.playerY)) {
 		g_gamestate.stage = stageWon;
 	}
 }
 
 /**
- * Aktualisiert die Expansion eines einzelnen Wasserfeldes. 
- * Anliegende Zuckerfelder werden nass.
- * 
- * @param x X-Koordinate des Wasserfeldes (In)
- * @param y Y-Koordinate des Wasserfeldes (In)
- */
-static void updateWaterTile(int y, int x)
-{
-	if (CHECK_BOUNDARY(x) && CHECK_BOUNDARY(y)) 
-	{
-		if (g_gamestate.level[y][x] == WM_FREE) 
-		{
-			g_gamestate.level[y][x] = WM_NEWWATER;
-		} 
-		else if (g_gamestate.level[y][x] == WM_SUGAR) 
-		{
-			g_gamestate.level[y][x] = WM_TOUCHED_SUGAR;
-			sugar_add(&g_gamestate.sugarCubes, x, y);
-		}
-	} 
-}
-
-/**
- * Aktualisiert die Expansion aller Wasserfelder.
+ * Aktualisiert die Expansion aller Wasserfelder. Die Bitebenen liefern alle
+ * freien Felder und Zuckerfelder neben Wasser auf einmal. Neues Wasser
+ * breitet sich so erst im naechsten Schritt aus, ohne Zwischenzustand fuer
+ * neues Wasser. Anliegende Zuckerfelder werden nass.
  */
 static void updateWater()
 {
-	/* Alle Felder einzeln aktualisieren. */
-	for (int y = 0; y < LEVELSIZE; y++)
+	int word = 0;
+	int x, y;
+
+	if (!bitplanes_spreadWater(&g_planes))
 	{
-		for (int x = 0; x < LEVELSIZE; x++)
-		{
-			if (g_gamestate.level[y][x] == WM_WATER) {
-				updateWaterTile(y,     x - 1);
-				updateWaterTile(y,     x + 1);
-				updateWaterTile(y + 1, x);
-				updateWaterTile(y - 1, x);
-			}
-		}
+		return;
 	}
 
-	/* Neue Felder in normale umwandeln. */
-	for (int y = 0; y < LEVELSIZE; y++)
+	while (bitplanes_nextSpread(&g_planes, &word, &x, &y))
 	{
-		for (int x = 0; x < LEVELSIZE; x++)
+		if (g_gamestate.level[y][x] == WM_FREE) 
 		{
-			if (g_gamestate.level[y][x] == WM_NEWWATER) {
-				g_gamestate.level[y][x] = WM_WATER;
-			}
+			setField(x, y, WM_WATER);
+		} 
+		else
+		{
+			setField(x, y, WM_TOUCHED_SUGAR);
+			sugar_add(&g_gamestate.sugarCubes, x, y);
 		}
 	}
 }
@@ -223,7 +272,7 @@ static void updateWater()
  */
 static void dissolveSugar(int x, int y)
 {
-	g_gamestate.level[y][x] = WM_FREE;
+	setField(x, y, WM_FREE);
 }
 
 /* ---- Oeffentliche Funktionen ---- */
@@ -284,6 +333,16 @@ void initLevel(int levelId)
 	wmLevelPointer levelSource = NULL;
 	switch (levelId)
 	{
+		case LEVEL_FILE:
+			/* Datei erneut einblenden, das verwirft alle Aenderungen */
+			if (g_levelFilename != NULL && levelfile_load(g_levelFilename, &g_levelData)
+			    && useLevelData())
+			{
+				break;
+			}
+			levelId = LEVEL_1;
+			levelSource = level1;
+			break;
 		case LEVEL_1:
 			levelSource = level1;
 			break;
@@ -299,17 +358,10 @@ void initLevel(int levelId)
 	}
 
 	/* Leveldaten und Spielerposition laden. */
-	for (int y = 0; y < LEVELSIZE; y++)
+	if (levelSource != NULL && !loadBuiltinLevel(levelSource))
 	{
-		for (int x = 0; x < LEVELSIZE; x++)
-		{
-			g_gamestate.level[y][x] = levelSource[y][x];
-			if (levelSource[y][x] == WM_START) {
-				g_gamestate.playerX = x;
-				g_gamestate.playerY = y;
-				g_gamestate.level[y][x] = WM_FREE;
-			}
-		}
+		fprintf(stderr, "Kein Speicher fuer das Level!\n");
+		exit(1);
 	}
 
 	/* Spielzustand Initialisieren */
@@ -320,9 +372,37 @@ void initLevel(int levelId)
 	g_gamestate.updateCooldown = UPDATE_COOLDOWN_TIME;
 	g_gamestate.loseMessageId = rand() % LOSE_MESSAGE_COUNT;
 
+	/* Bitebenen aus den Feldern aufbauen */
+	if (!bitplanes_init(&g_planes, g_gamestate.level, g_gamestate.levelWidth,
+	                    g_gamestate.levelHeight))
+	{
+		fprintf(stderr, "Kein Speicher fuer das Level!\n");
+		exit(1);
+	}
+
 	sugar_free(&g_gamestate.sugarCubes);
 }
 
+int setLevelFile(const char *filename)
+{
+	LevelFile probe = EMPTY_LEVEL_FILE;
+	int valid = levelfile_load(filename, &probe);
+
+	levelfile_free(&probe);
+
+	if (valid)
+	{
+		g_levelFilename = filename;
+	}
+
+	return valid;
+}
+
+int getFirstLevel(void)
+{
+	return (g_levelFilename != NULL) ? LEVEL_FILE : LEVEL_1;
+}
+
 Gamestate* getGamestate(void)
 {
 	return &g_gamestate;
@@ -356,4 +436,10 @@ void pressedActionKey(void)
 void cleanup(void)
 {
 	sugar_free(&g_gamestate.sugarCubes);
+
+	bitplanes_free(&g_planes);
+
+	free(g_gamestate.level);
+	g_gamestate.level = NULL;
+	levelfile_free(&g_levelData);
 }
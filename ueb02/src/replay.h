@@ -0,0 +1,117 @@
+#ifndef __REPLAY_H__
+#define __REPLAY_H__
+/**
+ * @file
+ * Schnittstelle des Replay-Moduls.
+ * Das Modul zeichnet alle Eingabeereignisse zusammen mit dem Logik-Schritt
+ * auf, in dem sie eingetroffen sind, und spielt sie spaeter mit denselben
+ * Zeitschritten wieder ab. Zusammen mit der Saat des Zufallsgenerators und
+ * der Fenstergroesse laeuft eine Sitzung so exakt gleich ab, z.B. fuer
+ * wiederholbare Performance-Messungen.
+ *
+ * Alle Eingaben laufen ueber replay_keyboardEvent bzw. replay_mouseEvent,
+ * alle Zeitschritte ueber replay_tick. Ohne Aufzeichnung oder Wiedergabe
+ * reicht das Modul beides unveraendert durch.
+ *
+ * Die Aufzeichnung ist eine Textdatei mit einer Zeile pro Eintrag:
+ *   CGREPLAY 1                      Kennung und Version
+ *   size <b> <h>                    Fenstergroesse
+ *   seed <s>                        Saat des Zufallsgenerators
+ *   K <schritt> <taste> <status> <spezial> <x> <y>
+ *   M <schritt> <x> <y> <art> <taste> <status>
+ *   T <schritt> <dt>                Zeitschritt in Sekunden
+ *
+ * Bestandteil einer Uebung im Rahmen des Moduls Praktikum Grundlagen der Computergrafik
+ * an der FH Wedel.
+ *
+ * @author Nicolas Hollmann, Daniel Klintworth
+ */
+
+/* ---- Typen ---- */
+
+/** Behandlung eines Tastaturereignisses (Taste, Status, Spezialtaste, x, y) */
+typedef void (*ReplayKeyboardHandler)(int key, int status, int isSpecialKey, int x, int y);
+
+/** Behandlung eines Mausereignisses (x, y, Art, Taste, Status) */
+typedef void (*ReplayMouseHandler)(int x, int y, int eventType, int button, int state);
+
+/* ---- Funktionen ---- */
+
+/**
+ * Legt fest, wohin Eingabeereignisse weitergeleitet werden.
+ *
+ * @param keyboard Behandlung der Tastaturereignisse (In)
+ * @param mouse Behandlung der Mausereignisse, NULL wenn es keine gibt (In)
+ */
+void replay_setHandlers(ReplayKeyboardHandler keyboard, ReplayMouseHandler mouse);
+
+/**
+ * Startet die Aufzeichnung in eine Datei. Die Datei wird beim Programmende
+ * geschlossen.
+ *
+ * @param filename Name der Datei (In)
+ * @param width, height Groesse des Fensters (In)
+ * @return 1 bei Erfolg, sonst 0
+ */
+int replay_startRecording(const char *filename, int width, int height);
+
+/**
+ * Laedt eine Aufzeichnung vollstaendig in den Speicher und startet die
+ * Wiedergabe. Live-Eingaben werden ab jetzt ignoriert.
+ *
+ * @param filename Name der Datei (In)
+ * @param width, height Groesse des Fensters bei der Aufzeichnung (Out)
+ * @return 1 bei Erfolg, sonst 0
+ */
+int replay_startPlayback(const char *filename, int *width, int *height);
+
+/**
+ * Liefert die Saat fuer den Zufallsgenerator. Bei der Wiedergabe ist das die
+ * aufgezeichnete Saat, sonst der uebergebene Wert (der ggf. aufgezeichnet
+ * wird).
+ *
+ * @param seed gewuenschte Saat (In)
+ * @return zu verwendende Saat
+ */
+unsigned replay_seed(unsigned seed);
+
+/**
+ * Leitet ein Tastaturereignis weiter und zeichnet es ggf. auf. Waehrend der
+ * Wiedergabe wird es verworfen.
+ *
+ * @param key Taste (In)
+ * @param status GLUT_DOWN oder GLUT_UP (In)
+ * @param isSpecialKey ungleich 0 bei Spezialtasten (In)
+ * @param x, y Position des Mauszeigers (In)
+ */
+void replay_keyboardEvent(int key, int status, int isSpecialKey, int x, int y);
+
+/**
+ * Leitet ein Mausereignis weiter und zeichnet es ggf. auf. Waehrend der
+ * Wiedergabe wird es verworfen.
+ *
+ * @param x, y Position des Mauszeigers (In)
+ * @param eventType Art des Ereignisses (In)
+ * @param button Maustaste (In)
+ * @param state Status der Maustaste (In)
+ */
+void replay_mouseEvent(int x, int y, int eventType, int button, int state);
+
+/**
+ * Beginnt einen Logik-Schritt. Bei der Aufzeichnung wird der Zeitschritt
+ * gespeichert, bei der Wiedergabe werden zuerst die Ereignisse des Schritts
+ * ausgeloest und dann der aufgezeichnete Zeitschritt geliefert.
+ *
+ * @param interval gemessener Zeitschritt in Sekunden (In)
+ * @return zu verwendender Zeitschritt in Sekunden
+ */
+double replay_tick(double interval);
+
+/**
+ * Prueft, ob eine Wiedergabe alle aufgezeichneten Schritte abgespielt hat.
+ *
+ * @return 1, wenn die Wiedergabe zu Ende ist, sonst (auch ohne Wiedergabe) 0
+ */
+int replay_finished(void);
+
+#endif
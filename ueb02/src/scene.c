@@ -31,8 +31,9 @@
 
 /* ---- Konstanten ---- */
 
-/* Die Groesse einer einzelnen Kachel */
-#define TILE_SIZE (2.0f / LEVELSIZE)
+/* Hoechstens so viele Kacheln werden je Richtung angezeigt, bei groesseren
+ * Leveln folgt der Ausschnitt dem Spieler */
+#define VIEW_TILES (32)
 
 /* Die Farbe Weiss */
 #define COLOR_WHITE { 1.0f, 1.0f, 1.0f }
@@ -71,6 +72,37 @@ const char * lose_messages[LOSE_MESSAGE_COUNT][3] = {
 
 /* ---- Interne Funktionen ---- */
 
+/**
+ * Bestimmt den anzuzeigenden Ausschnitt eines Levels. Kleine Level werden
+ * ganz angezeigt, bei grossen folgt ein Ausschnitt von VIEW_TILES Kacheln
+ * dem Spieler. Der Aufwand beim Zeichnen haengt so nicht von der
+ * Levelgroesse ab.
+ * 
+ * @param gamestage der Spielzustand (In)
+ * @param start Erste Kachel des Ausschnitts in x- und y-Richtung (Out)
+ * @param size Anzahl Kacheln des Ausschnitts in x- und y-Richtung (Out)
+ */
+static void getViewWindow(Gamestate *gamestate, int start[2], int size[2])
+{
+	int levelSize[2] = { gamestate->levelWidth, gamestate->levelHeight };
+	int player[2] = { gamestate->playerX, gamestate->playerY };
+
+	for (int i = 0; i < 2; i++)
+	{
+		size[i] = (levelSize[i] < VIEW_TILES) ? levelSize[i] : VIEW_TILES;
+		start[i] = player[i] - size[i] / 2;
+
+		if (start[i] > levelSize[i] - size[i])
+		{
+			start[i] = levelSize[i] - size[i];
+		}
+		if (start[i] < 0)
+		{
+			start[i] = 0;
+		}
+	}
+}
+
 /**
  * Zeichnet das Level. Die zu zeichnenden Objekte werden hierzu in Form 
  * einer Displayliste aus renderObjects bezogen.
@@ -79,22 +111,28 @@ const char * lose_messages[LOSE_MESSAGE_COUNT][3] = {
  */
 static void drawLevel(Gamestate *gamestate)
 {
+	int start[2], size[2];
+	getViewWindow(gamestate, start, size);
+
+	/* Die Groesse einer einzelnen Kachel */
+	float tileSize = 2.0f / ((size[0] > size[1]) ? size[0] : size[1]);
+
 	glPushMatrix();
 	{
 		/* Skalierung und Positionierung des Spielfelds. */
 		glTranslatef(0.0f, 0.1f, 0.0f);
 		glScalef(0.9f, 0.9f, 1.0f);
-		for (int y = 0; y < LEVELSIZE; y++) 
+		for (int y = start[1]; y < start[1] + size[1]; y++) 
 		{
-			for (int x = 0; x < LEVELSIZE; x++) 
+			for (int x = start[0]; x < start[0] + size[0]; x++) 
 			{
 				glPushMatrix();
 				{
 					/* Kachel an Position x,y zeichnen. */
-					float xOffset = -1.0 + ((float) x * (float) TILE_SIZE);
-					float yOffset =  1.0 - ((float) y * (float) TILE_SIZE);
-					glTranslatef(xOffset + TILE_SIZE / 2.0f, yOffset - TILE_SIZE / 2.0f, 0.0f);
-					glScalef(TILE_SIZE - 0.01f, TILE_SIZE - 0.01f, 1.0f);
+					float xOffset = -1.0 + ((float) (x - start[0]) * tileSize);
+					float yOffset =  1.0 - ((float) (y - start[1]) * tileSize);
+					glTranslatef(xOffset + tileSize / 2.0f, yOffset - tileSize / 2.0f, 0.0f);
+					glScalef(tileSize - 0.01f, tileSize - 0.01f, 1.0f);
 
 					wmFieldType field = gamestate->level[y][x];
 					switch (field) {
@@ -110,7 +148,6 @@ static void drawLevel(Gamestate *gamestate)
 						case WM_GOAL:
 							renderObject(RO_GOAL);
 							break;
-						case WM_NEWWATER: // Sollte nie gerendert werden
 						case WM_WATER:
 							renderObject(RO_WATER);
 							break;
@@ -165,6 +202,9 @@ static void drawLevelNumber(Gamestate *gamestate)
  */
 static void drawOverlay(void)
 {
+	/* Bisherige Texte liegen unter dem Overlay */
+	flushStringBatch();
+
 	glPushMatrix();
 	{
 		glEnable(GL_BLEND);
@@ -243,6 +283,10 @@ void drawScene(void)
 	Gamestate *gamestate = getGamestate();
 
 	drawLevel(gamestate);
+
+	/* Alle Texte sammeln und moeglichst mit einem Aufruf zeichnen */
+	beginStringBatch();
+
 	drawLevelNumber(gamestate);
 
 	switch (gamestate->stage) {
@@ -262,6 +306,8 @@ void drawScene(void)
 		drawHelp();
 	}
 
+	endStringBatch();
+
 	/* DEBUG-Ausgabe */
 	GLSTATE;
 }
@@ -1,6 +1,8 @@
 /**
  * @file
  * Verwaltet die Animationszustaende fuer Zuckerwuerfel als dynamisches Array.
+ * Aufgeloeste Wuerfel werden durch den letzten ersetzt, die Hashtabelle nutzt
+ * lineares Sondieren und rueckt beim Entfernen nach (ohne Grabsteine).
  *
  * Bestandteil einer Uebung im Rahmen des Moduls Praktikum Grundlagen der Computergrafik 
  * an der FH Wedel.
@@ -16,53 +18,196 @@
 #include "debugGL.h"
 #include "sugar.h"
 
+/* ---- Konstanten ---- */
+
+/** Anfangsgroesse des Arrays */
+#define SUGAR_MIN_CAPACITY (16)
+
+/* ---- Interne Funktionen ---- */
+
+/**
+ * Berechnet den Hashwert einer Position.
+ *
+ * @param x die X-Koordinate (In)
+ * @param y die Y-Koordinate (In)
+ * @return der Hashwert
+ */
+static unsigned hashPosition(int x, int y)
+{
+    return ((unsigned)x * 73856093u) ^ ((unsigned)y * 19349663u);
+}
+
+/**
+ * Sucht den Platz einer Position in der Hashtabelle.
+ *
+ * @param list Das Zuckerwuerfel Array mit Hashtabelle (In)
+ * @param x die X-Koordinate (In)
+ * @param y die Y-Koordinate (In)
+ * @return der Platz des Wuerfels oder der freie Platz, an den er gehoert
+ */
+static int findSlot(const SugarList *list, int x, int y)
+{
+    int mask = list->slotCount - 1;
+    int slot = hashPosition(x, y) & mask;
+
+    while (list->slots[slot] != 0)
+    {
+        const Sugar *sugar = &list->list[list->slots[slot] - 1];
+        if (sugar->x == x && sugar->y == y)
+        {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+/**
+ * Legt die Hashtabelle mit neuer Groesse an und traegt alle Wuerfel ein.
+ *
+ * @param list Das zu verandernde Array (InOut)
+ * @param slotCount die neue Groesse, eine Zweierpotenz (In)
+ */
+static void rehash(SugarList *list, int slotCount)
+{
+    free(list->slots);
+    list->slots = (int *) calloc(slotCount, sizeof(int));
+    list->slotCount = slotCount;
+
+    if (list->slots == NULL) {
+        CG_ERROR(("Cannot resize sugar hash table!"));
+    }
+
+    for (int i = 0; i < list->count; i++)
+    {
+        list->slots[findSlot(list, list->list[i].x, list->list[i].y)] = i + 1;
+    }
+}
+
+/**
+ * Entfernt einen Platz aus der Hashtabelle. Nachfolgende Eintraege derselben
+ * Sondierungskette ruecken auf, damit sie weiter gefunden werden.
+ *
+ * @param list Das zu verandernde Array (InOut)
+ * @param slot der zu leerende Platz (In)
+ */
+static void removeSlot(SugarList *list, int slot)
+{
+    int mask = list->slotCount - 1;
+    int hole = slot;
+
+    for (int next = (slot + 1) & mask; list->slots[next] != 0; next = (next + 1) & mask)
+    {
+        const Sugar *sugar = &list->list[list->slots[next] - 1];
+        int home = hashPosition(sugar->x, sugar->y) & mask;
+
+        /* Nur aufruecken, wenn das Loch nicht vor dem Ursprung des Eintrags liegt */
+        if (((next - home) & mask) >= ((next - hole) & mask))
+        {
+            list->slots[hole] = list->slots[next];
+            hole = next;
+        }
+    }
+
+    list->slots[hole] = 0;
+}
+
+/**
+ * Entfernt einen Wuerfel. Der letzte Wuerfel rueckt an seine Stelle.
+ *
+ * @param list Das zu verandernde Array (InOut)
+ * @param index der Index des Wuerfels (In)
+ */
+static void removeSugar(SugarList *list, int index)
+{
+    int last = list->count - 1;
+
+    removeSlot(list, findSlot(list, list->list[index].x, list->list[index].y));
+
+    if (index != last)
+    {
+        list->list[index] = list->list[last];
+        list->slots[findSlot(list, list->list[index].x, list->list[index].y)] = index + 1;
+    }
+
+    list->count--;
+}
+
 /* ---- Oeffentliche Funktionen ---- */
 
 void sugar_add(SugarList *list, int x, int y)
 {
     assert(list != NULL);
 
-    list->count++;
-    list->list = (Sugar *) realloc(list->list, list->count * sizeof(Sugar));
+    /* Hashtabelle hoechstens halb voll halten */
+    if ((list->count + 1) * 2 > list->slotCount)
+    {
+        rehash(list, list->slotCount > 0 ? list->slotCount * 2 : SUGAR_MIN_CAPACITY * 2);
+    }
+
+    int slot = findSlot(list, x, y);
 
-    if (list->list == NULL) {
-        CG_ERROR("Cannot resize sugar list!");
+    if (list->slots[slot] != 0)
+    {
+        list->list[list->slots[slot] - 1].lifetime = SUGAR_LIFETIME;
+        return;
+    }
+
+    if (list->count == list->capacity)
+    {
+        list->capacity = list->capacity > 0 ? list->capacity * 2 : SUGAR_MIN_CAPACITY;
+        list->list = (Sugar *) realloc(list->list, list->capacity * sizeof(Sugar));
+
+        if (list->list == NULL) {
+            CG_ERROR(("Cannot resize sugar list!"));
+        }
     }
-    
-    list->list[list->count - 1].lifetime = SUGAR_LIFETIME;
-    list->list[list->count - 1].x = x;
-    list->list[list->count - 1].y = y;
+
+    list->list[list->count].lifetime = SUGAR_LIFETIME;
+    list->list[list->count].x = x;
+    list->list[list->count].y = y;
+    list->count++;
+    list->slots[slot] = list->count;
 }
 
-float sugar_get_lifetime(SugarList *list, int x, int y) 
+float sugar_get_lifetime(SugarList *list, int x, int y)
 {
     assert(list != NULL);
 
-    float lifetime = 0.0f;
-    for (int i = 0; i < list->count; i++) 
+    if (list->count == 0)
     {
-        if (list->list[i].x == x && list->list[i].y == y)
-        {
-            lifetime = list->list[i].lifetime;
-        }
+        return 0.0f;
     }
 
-    return lifetime > 0.0f ? lifetime : 0.0f;
+    int slot = findSlot(list, x, y);
+
+    return list->slots[slot] != 0 ? list->list[list->slots[slot] - 1].lifetime : 0.0f;
 }
 
 void sugar_update(SugarList *list, SugarDissolved callback, float interval)
 {
     assert(list != NULL);
 
-    for (int i = 0; i < list->count; i++) 
+    int i = 0;
+    while (i < list->count)
     {
-        if (list->list[i].lifetime > 0.0f) 
+        Sugar *sugar = &list->list[i];
+
+        sugar->lifetime -= interval;
+        if (sugar->lifetime <= 0.0f)
+        {
+            int x = sugar->x;
+            int y = sugar->y;
+
+            /* Erst entfernen, das Callback darf neue Wuerfel anlegen. Der
+             * nachgerueckte Wuerfel steht jetzt bei i. */
+            removeSugar(list, i);
+            callback(x, y);
+        }
+        else
         {
-            list->list[i].lifetime -= interval;
-            if (list->list[i].lifetime <= 0.0f) 
-            {
-                callback(list->list[i].x, list->list[i].y);
-            }
+            i++;
         }
     }
 }
@@ -72,6 +217,10 @@ void sugar_free(SugarList *list)
     assert(list != NULL);
 
     free(list->list);
-    list->list = NULL; 
+    free(list->slots);
+    list->list = NULL;
+    list->slots = NULL;
     list->count = 0;
+    list->capacity = 0;
+    list->slotCount = 0;
 }
@@ -3,8 +3,11 @@
 /**
  * @file
  * Verwaltet die Animationszustaende fuer Zuckerwuerfel als dynamisches Array.
+ * Das Array enthaelt nur die sich aufloesenden Wuerfel, aufgeloeste werden
+ * entfernt. Eine Hashtabelle ueber die Position liefert die Lebenszeit eines
+ * Feldes in konstanter Zeit.
  *
- * Bestandteil einer Uebung im Rahmen des Moduls Praktikum Grundlagen der Computergrafik 
+ * Bestandteil einer Uebung im Rahmen des Moduls Praktikum Grundlagen der Computergrafik
  * an der FH Wedel.
  *
  * @author Nicolas Hollmann, Daniel Klintworth
@@ -30,20 +33,24 @@ typedef struct {
 
 /** Dynamisches Array aus Zuckerwuerfeln */
 typedef struct {
-    int count;
-    Sugar *list;
+    int count; // Anzahl der Wuerfel in list
+    int capacity; // Platz in list
+    Sugar *list; // Die Wuerfel, ohne Luecken
+    int *slots; // Hashtabelle ueber die Position: Index in list + 1, 0 fuer frei
+    int slotCount; // Groesse der Hashtabelle, eine Zweierpotenz
 } SugarList;
 
 
-#define EMPTY_SUGAR_LIST {0, NULL}
+#define EMPTY_SUGAR_LIST {0, 0, NULL, NULL, 0}
 
 /* ---- Funktionen ---- */
 
 /**
- * Fuegt einen neuen Zuckerwuerfel mit gegebener Position 
- * zu einem dynamischen Array hinzu. Die Lbenszeit wird dabei mit
- * SUGAR_LIFETIME initialisiert.
- * 
+ * Fuegt einen neuen Zuckerwuerfel mit gegebener Position
+ * zu einem dynamischen Array hinzu. Die Lebenszeit wird dabei mit
+ * SUGAR_LIFETIME initialisiert. Liegt an der Position schon ein Wuerfel,
+ * beginnt dessen Lebenszeit von vorn.
+ *
  * @param list Das zu verandernde Array (InOut)
  * @param x die X-Koordinate (In)
  * @param y die Y-Koordinate (In)
@@ -52,18 +59,19 @@ void sugar_add(SugarList *list, int x, int y);
 
 /**
  * Ruft die verbleibende Lebenszeit eines Zuckerwuerfels ab.
- * 
+ *
  * @param list Das Zuckerwuerfel Array (In)
  * @param x die X-Koordinate (In)
  * @param y die Y-Koordinate (In)
- * @return die verbleibende Lebenszeit in Sekunden
+ * @return die verbleibende Lebenszeit in Sekunden, 0 ohne Wuerfel
  */
 float sugar_get_lifetime(SugarList *list, int x, int y);
 
 /**
  * Aktualisiert die Lebenszeiten aller Zuckerwuerfel in einem Array.
- * Wenn ein Wuerfel sich aufloest wird ein Callback aufgerufen.
- * 
+ * Wenn ein Wuerfel sich aufloest wird ein Callback aufgerufen und der
+ * Wuerfel entfernt. Die Reihenfolge der Wuerfel aendert sich dabei.
+ *
  * @param list Das zu verandernde Array (InOut)
  * @param callback das Aufloesungs-Callback (In)
  * @param interval die Zeit, die seit dem letzten Update vergangen ist (In)
@@ -72,7 +80,7 @@ void sugar_update(SugarList *list, SugarDissolved callback, float interval);
 
 /**
  * Gibt den Speicher des dynamischen Arrays wieder frei.
- * 
+ *
  * @param list Das zu loeschende Array (InOut)
  */
 void sugar_free(SugarList *list);
@@ -38,9 +38,12 @@
 
 /* ---- Typedeklarationen - Level ---- */
 
-/* Hoehe/Breite des (quadratischen) Levels */
+/* Hoehe/Breite der (quadratischen) eingebauten Level */
 #define LEVELSIZE (9)
 
+/* Groesste Hoehe/Breite eines aus einer Datei geladenen Levels */
+#define LEVEL_MAX_SIZE (4096)
+
 /*
  * Art von Levelfeldern
  * 
@@ -49,7 +52,6 @@
  * WM_WALL: Unzerstörbares Feld
  * WM_GOAL: Zielfeld
  * WM_WATER : Wasser
- * WM_NEWWATER: Neu erzeugtes Wasserfeld
  * WM_SAND : Sandsack, bewegbares Feld
  * WM_SUGAR : Zuckerstück, bewegbares Feld
  * WM_TOUCHED_SUGAR: Nasser Zucker
@@ -61,21 +63,22 @@ typedef enum {
     WM_WALL, 
     WM_GOAL,
     WM_WATER, 
-    WM_NEWWATER, 
-    WM_SAND, 
+    /* 5 bleibt frei, damit vorhandene Leveldateien gueltig bleiben */
+    WM_SAND = 6, 
     WM_SUGAR, 
     WM_TOUCHED_SUGAR, 
     WM_START
 } wmFieldType;
 
-/* Spielfeld */
+/* Ein Feld eines Levels zur Laufzeit, ein Byte mit einem Wert aus wmFieldType */
+typedef unsigned char wmField;
+
+/* Eingebautes Spielfeld */
 typedef wmFieldType wmLevel[LEVELSIZE][LEVELSIZE];
 
-/* Zeiger auf ein Spielfeld */
+/* Zeiger auf ein eingebautes Spielfeld */
 typedef const wmFieldType (*wmLevelPointer)[LEVELSIZE];
 
-#define EMPTY_LEVEL {{0}, {0}, {0}, {0}, {0}, {0}, {0}, {0}, {0}}
-
 
 /* ---- Typedeklarationen - Player ---- */
 
@@ -99,7 +102,8 @@ typedef enum {
 /** Zusammenfassung aller fuer das Spiel relevanter Daten */
 typedef struct {
     int playerX, playerY; // Spielerposition
-    wmLevel level; // Leveldaten
+    int levelWidth, levelHeight; // Groesse des Levels in Feldern
+    wmField **level; // Leveldaten als Zeiger auf die Zeilen, Zugriff per level[y][x]
     int levelId; // ID des Levels
     Gamestage stage; // Spielzustand
     GLboolean showHelp; // Wird die Hilfe angezeigt?
@@ -109,6 +113,6 @@ typedef struct {
     SugarList sugarCubes; // Dynamisches Array mit allen nassen Zuckerwuerfeln
 } Gamestate;
 
-#define EMPTY_GAMESTATE {0, 0, EMPTY_LEVEL, 0, stageRunning, GL_FALSE, 0.0f, 0.0f, 0, EMPTY_SUGAR_LIST}
+#define EMPTY_GAMESTATE {0, 0, 0, 0, NULL, 0, stageRunning, GL_FALSE, 0.0f, 0.0f, 0, EMPTY_SUGAR_LIST}
 
 #endif
@@ -80,6 +80,9 @@ static void drawLevelNumber(Gamestate *gamestate)
  */
 static void drawOverlay(void)
 {
+	/* Bisherige Texte liegen unter dem Overlay */
+	flushStringBatch();
+
 	glPushMatrix();
 	{
 		glEnable(GL_BLEND);
@@ -131,7 +134,7 @@ static void drawHelp(void)
 
 	GLfloat textColor[3] = COLOR_WHITE;
 
-	float height = 0.05f;
+	float height = 0.01f;
 
 	#define DRAW_HELP(text) drawString(0.15f, height += 0.04f, textColor, (text))
 
@@ -155,6 +158,8 @@ static void drawHelp(void)
 	DRAW_HELP("F8          - Taschenlampe an/aus");
 	DRAW_HELP("a/A         - Animation");
 	DRAW_HELP("c/C         - Kamera");
+	DRAW_HELP("o/O         - Wasser OIT/sortiert");
+	DRAW_HELP("p/P         - Licht pro Pixel/Vertex");
 	DRAW_HELP("q/Q/ESC     - Beenden");
 
 	#undef DRAW_HELP
@@ -168,6 +173,9 @@ void drawHUD(void)
 
     glDisable(GL_DEPTH_TEST);
 
+	/* Alle Texte sammeln und moeglichst mit einem Aufruf zeichnen */
+	beginStringBatch();
+
 	drawLevelNumber(gamestate);
 
 	switch (gamestate->stage) {
@@ -187,6 +195,8 @@ void drawHUD(void)
 		drawHelp();
 	}
 
+	endStringBatch();
+
 	/* DEBUG-Ausgabe */
 	GLSTATE;
 }
@@ -21,6 +21,7 @@
 #include "input.h"
 #include "logic.h"
 #include "scene.h"
+#include "headless.h"
 
 /* ---- Konstanten ---- */
 
@@ -58,6 +59,13 @@ static void toggleFullscreen(void)
 	/* Zwischenspeicher: Fenstergroesse */
 	static int windowSize[2];
 
+	/* Ohne Fenster gibt es nichts umzuschalten (z.B. bei der Wiedergabe im
+	 * Headless-Modus) */
+	if (headless_active())
+	{
+		return;
+	}
+
 	/* Modus wechseln */
 	fullscreen = !fullscreen;
 
@@ -260,6 +268,16 @@ void handleKeyboardEvent(int key, int status, GLboolean isSpecialKey, int x, int
 			case 'C':
 				toggleFirstPerson();
 				break;
+			/* Reihenfolgeunabhaengige Transparenz an/aus */
+			case 'o':
+			case 'O':
+				toggleOrderIndependent();
+				break;
+			/* Beleuchtung pro Pixel/Vertex */
+			case 'p':
+			case 'P':
+				togglePerPixelLighting();
+				break;
 			/* Programm beenden */
 			case 'q':
 			case 'Q':
@@ -15,6 +15,9 @@
 #include <stdio.h>
 #include <time.h>
 
+/* Stellt Framebuffer-Objekte und Shader bereit, muss vor gl.h stehen */
+#include <GL/glew.h>
+
 #ifdef __APPLE__
 #include <GLUT/glut.h>
 #else
@@ -28,6 +31,11 @@
 #include "logic.h"
 #include "scene.h"
 #include "hud.h"
+#include "matrix.h"
+#include "frametime.h"
+#include "stringOutput.h"
+#include "headless.h"
+#include "replay.h"
 #include "debugGL.h"
 
 /* ---- Konstanten ---- */
@@ -59,10 +67,13 @@ static void set3DViewport(GLint x, GLint y, GLint width, GLint height)
 	glViewport(x, y, width, height);
 
 	/* Perspektivische Darstellung */
-	gluPerspective(70, 		/* Oeffnungswinkel */
-				   aspect,  /* Seitenverhaeltnis */
-				   0.05,	/* nahe Clipping-Ebene */
-				   100);	/* ferne Clipping-Ebene */
+	CGMatrix4f projection;
+	matrix_perspective(projection,
+	                   FIELD_OF_VIEW, /* Oeffnungswinkel */
+	                   (float)aspect, /* Seitenverhaeltnis */
+	                   0.05f,         /* nahe Clipping-Ebene */
+	                   100.0f);       /* ferne Clipping-Ebene */
+	glMultMatrixf(projection);
 
 	/* Folge Operationen beeinflussen die Modelviewmatrix */
 	glMatrixMode(GL_MODELVIEW);
@@ -110,6 +121,34 @@ static void set2DViewport(GLint x, GLint y, GLint width, GLint height)
 	glLoadIdentity();
 }
 
+/**
+ * Leitet ein aufgezeichnetes oder live eingetroffenes Tastaturereignis an die
+ * Ereignisbehandlung weiter.
+ *
+ * @param key Taste (In)
+ * @param status Status der Taste (In)
+ * @param isSpecialKey ungleich 0 bei Spezialtasten (In)
+ * @param x, y Position des Mauszeigers (In)
+ */
+static void onKeyboardEvent(int key, int status, int isSpecialKey, int x, int y)
+{
+	handleKeyboardEvent(key, status, (GLboolean)isSpecialKey, x, y);
+}
+
+/**
+ * Leitet ein aufgezeichnetes oder live eingetroffenes Mausereignis an die
+ * Ereignisbehandlung weiter.
+ *
+ * @param x, y Position des Mauszeigers (In)
+ * @param eventType Art des Ereignisses (In)
+ * @param button Maustaste (In)
+ * @param state Status der Maustaste (In)
+ */
+static void onMouseEvent(int x, int y, int eventType, int button, int state)
+{
+	handleMouseEvent(x, y, (CGMouseEventType)eventType, button, state);
+}
+
 /**
  * Mouse-Button-Callback.
  * @param button Taste, die den Callback ausgeloest hat.
@@ -119,7 +158,7 @@ static void set2DViewport(GLint x, GLint y, GLint width, GLint height)
  */
 static void cbMouseButton (int button, int state, int x, int y)
 {
-	handleMouseEvent(x, y, mouseButton, button, state);
+	replay_mouseEvent(x, y, mouseButton, button, state);
 }
 
 /**
@@ -129,7 +168,7 @@ static void cbMouseButton (int button, int state, int x, int y)
  */
 static void cbMouseMotion (int x, int y)
 {
-	handleMouseEvent(x, y, mouseMotion, 0, 0);
+	replay_mouseEvent(x, y, mouseMotion, 0, 0);
 }
 
 /**
@@ -140,7 +179,7 @@ static void cbMouseMotion (int x, int y)
 static void
 cbMousePassiveMotion (int x, int y)
 {
-	handleMouseEvent(x, y, mousePassiveMotion, 0, 0);
+	replay_mouseEvent(x, y, mousePassiveMotion, 0, 0);
 }
 
 /**
@@ -153,7 +192,7 @@ cbMousePassiveMotion (int x, int y)
  */
 static void cbKeyboard(unsigned char key, int x, int y)
 {
-	handleKeyboardEvent(key, GLUT_DOWN, GL_FALSE, x, y);
+	replay_keyboardEvent(key, GLUT_DOWN, GL_FALSE, x, y);
 }
 
 /**
@@ -166,7 +205,7 @@ static void cbKeyboard(unsigned char key, int x, int y)
  */
 static void cbKeyboardUp(unsigned char key, int x, int y)
 {
-	handleKeyboardEvent(key, GLUT_UP, GL_FALSE, x, y);
+	replay_keyboardEvent(key, GLUT_UP, GL_FALSE, x, y);
 }
 
 /**
@@ -179,7 +218,7 @@ static void cbKeyboardUp(unsigned char key, int x, int y)
  */
 static void cbSpecial(int key, int x, int y)
 {
-	handleKeyboardEvent(key, GLUT_DOWN, GL_TRUE, x, y);
+	replay_keyboardEvent(key, GLUT_DOWN, GL_TRUE, x, y);
 }
 
 /**
@@ -192,7 +231,23 @@ static void cbSpecial(int key, int x, int y)
  */
 static void cbSpecialUp(int key, int x, int y)
 {
-	handleKeyboardEvent(key, GLUT_UP, GL_TRUE, x, y);
+	replay_keyboardEvent(key, GLUT_UP, GL_TRUE, x, y);
+}
+
+/**
+ * Aktualisiert die Spiellogik um einen Zeitschritt.
+ * 
+ * @param interval seit dem letzten Schritt vergangene Zeit in Sekunden (In)
+ */
+static void stepLogic(double interval)
+{
+	if (isPaused())
+	{
+		interval = 0.0;
+	}
+
+	/* Spiellogik updaten */
+	updateLogic(interval);
 }
 
 /**
@@ -211,13 +266,14 @@ static void cbTimer(int lastCallTime)
 	/* Seit dem letzten Funktionsaufruf vergangene Zeit in Sekunden */
 	double interval = (double)(thisCallTime - lastCallTime) / 1000.0f;
 
-	if (isPaused())
+	/* Eine Wiedergabe ist mit dem letzten aufgezeichneten Schritt beendet */
+	if (replay_finished())
 	{
-		interval = 0.0;
+		exit(0);
 	}
 
-	/* Spiellogik updaten */
-	updateLogic(interval);
+	/* Bei Aufzeichnung/Wiedergabe laeuft der Zeitschritt ueber das Replay-Modul */
+	stepLogic(replay_tick(interval));
 
 	/* Wieder als Timer-Funktion registrieren */
 	glutTimerFunc(1000 / TIMER_CALLS_PS, cbTimer, thisCallTime);
@@ -227,21 +283,25 @@ static void cbTimer(int lastCallTime)
 }
 
 /**
- * Zeichen-Callback.
- * Loescht die Buffer, ruft das Zeichnen der Szene auf und tauscht den Front-
- * und Backbuffer.
+ * Zeichnet einen Frame in den aktuellen Framebuffer.
+ * 
+ * @param width Breite des Framebuffers (In)
+ * @param height Hoehe des Framebuffers (In)
  */
-static void cbDisplay(void)
+static void drawFrame(int width, int height)
 {
-	/* Fensterdimensionen auslesen */
-	int width = glutGet(GLUT_WINDOW_WIDTH);
-	int height = glutGet(GLUT_WINDOW_HEIGHT);
+	/* Schriftatlas einmalig im sichtbaren Fenster rastern, vor dem Loeschen */
+	initStringOutput();
 
 	/* Buffer zuruecksetzen */
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	/* 3D Ansicht */
 	set3DViewport(0, 0, width, height);
+
+	/* Kamera, Ausschnitt und Wasser einmal fuer beide Augen bestimmen */
+	prepareScene3D();
+
 	if (getAnaglyphMode() == ANAGLYPH_OFF)
 	{
 		drawScene3D(EYE_CENTER);
@@ -265,9 +325,25 @@ static void cbDisplay(void)
 	/* HUD */
 	set2DViewport(0, 0, width, height);
 	drawHUD();
+}
+
+/**
+ * Zeichen-Callback.
+ * Loescht die Buffer, ruft das Zeichnen der Szene auf und tauscht den Front-
+ * und Backbuffer.
+ */
+static void cbDisplay(void)
+{
+	frametime_beginFrame();
+
+	/* Fensterdimensionen auslesen */
+	drawFrame(glutGet(GLUT_WINDOW_WIDTH), glutGet(GLUT_WINDOW_HEIGHT));
 
 	/* Objekt anzeigen */
 	glutSwapBuffers();
+
+	/* Dauer des Frames messen */
+	frametime_endFrame();
 }
 
 /**
@@ -317,6 +393,34 @@ static void registerCallbacks(void)
 	glutDisplayFunc(cbDisplay);
 }
 
+/**
+ * Initialisiert GLEW fuer den aktuellen OpenGL-Kontext. Schlaegt das fehl,
+ * bleiben alle GLEW-Versionsabfragen 0 und Transparenz sowie Beleuchtung
+ * fallen auf die Varianten ohne Shader zurueck.
+ *
+ * @return 1, wenn GLEW initialisiert werden konnte, sonst 0
+ */
+static int initGlew(void)
+{
+	/* Wenn glewExperimental auf GL_TRUE gesetzt wird, laedt GLEW auch
+	 * Funktionen, die der Treiber nicht als Erweiterung ausweist */
+	glewExperimental = GL_TRUE;
+	GLenum error = glewInit();
+
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+	/* Ohne X11 kann GLEW nur die GLX-Erweiterungen nicht laden, die
+	 * OpenGL-Funktionen stehen trotzdem zur Verfuegung */
+	if (error == GLEW_ERROR_NO_GLX_DISPLAY)
+	{
+		error = GLEW_OK;
+	}
+#endif
+
+	GLGETERROR; // Verschluckt OpenGL Fehlermeldung durch glewExperimental
+
+	return error == GLEW_OK;
+}
+
 /* ---- Oeffentliche Funktionen ---- */
 
 /**
@@ -358,9 +462,21 @@ int initAndStartIO(char *title, int width, int height)
 		INFO(("...fertig.\n\n"));
 		INFO(("Initialisiere Zufallsgenerator...\n"));
 
-		srand(time(0));
+		srand(replay_seed((unsigned)time(0)));
+		replay_setHandlers(onKeyboardEvent, onMouseEvent);
 
 		INFO(("...fertig.\n\n"));
+		INFO(("Initialisiere GLEW...\n"));
+
+		if (initGlew())
+		{
+			INFO(("...fertig.\n\n"));
+		}
+		else
+		{
+			INFO(("...fehlgeschlagen, weiter ohne Shader.\n\n"));
+		}
+
 		INFO(("Initialisiere Szene...\n"));
 
 		if (initScene())
@@ -368,7 +484,7 @@ int initAndStartIO(char *title, int width, int height)
 			INFO(("...fertig.\n\n"));
 			INFO(("Initialisiere Logik...\n"));
 
-			initLevel(LEVEL_1);
+			initLevel(getFirstLevel());
 
 			INFO(("...fertig.\n\n"));
 			INFO(("Registriere Callbacks...\n"));
@@ -395,3 +511,82 @@ int initAndStartIO(char *title, int width, int height)
 
 	return windowID;
 }
+
+int runHeadless(int frames, int width, int height, const char *dumpDir)
+{
+	int success = 0;
+
+	INFO(("Erzeuge Kontext ohne Fenster...\n"));
+
+	if (headless_init(width, height, 0, 0, 0))
+	{
+		INFO(("...fertig.\n\n"));
+		INFO(("Initialisiere Zufallsgenerator...\n"));
+
+		/* Feste Saat, damit jeder Lauf dieselben Bilder liefert */
+		srand(replay_seed(0));
+		replay_setHandlers(onKeyboardEvent, onMouseEvent);
+
+		INFO(("...fertig.\n\n"));
+		INFO(("Initialisiere GLEW...\n"));
+
+		if (initGlew())
+		{
+			INFO(("...fertig.\n\n"));
+		}
+		else
+		{
+			INFO(("...fehlgeschlagen, weiter ohne Shader.\n\n"));
+		}
+
+		INFO(("Initialisiere Szene...\n"));
+
+		if (initScene())
+		{
+			INFO(("...fertig.\n\n"));
+			INFO(("Initialisiere Logik...\n"));
+
+			initLevel(getFirstLevel());
+
+			INFO(("...fertig.\n\n"));
+
+			uint64_t start = frametime_now();
+
+			int frame;
+
+			/* Bei einer Wiedergabe endet der Lauf mit der Aufzeichnung */
+			for (frame = 0; frame < frames && !replay_finished(); frame++)
+			{
+				stepLogic(replay_tick(HEADLESS_DT));
+
+				frametime_beginFrame();
+				drawFrame(width, height);
+				headless_finishFrame();
+				frametime_endFrame();
+
+				if (dumpDir != NULL)
+				{
+					headless_dumpFrame(dumpDir, frame);
+				}
+			}
+
+			double seconds = (frametime_now() - start) / 1e9;
+			printf("%d Frames (%dx%d) in %.3f s, %.2f FPS\n",
+			       frame, width, height, seconds, frame / seconds);
+
+			success = 1;
+		}
+		else
+		{
+			INFO(("...fehlgeschlagen.\n\n"));
+		}
+
+		headless_cleanup();
+	}
+	else
+	{
+		INFO(("...fehlgeschlagen.\n\n"));
+	}
+
+	return success;
+}
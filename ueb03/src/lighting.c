@@ -0,0 +1,212 @@
+/**
+ * @file
+ * Beleuchtungs-Modul.
+ * Vertex- und Fragment-Shader, die das Beleuchtungsmodell der festen
+ * Pipeline pro Pixel auswerten. Der Vertex-Shader reicht Position und
+ * Normale im Kamerakoordinatensystem weiter, der Fragment-Shader rechnet
+ * damit die Formel der festen Pipeline: globales Umgebungslicht plus je
+ * Lichtquelle Umgebungs-, diffusen und Glanzanteil, beim Spotlicht mit
+ * dem Spot-Faktor gewichtet.
+ *
+ * GLSL 1.10 kennt den Schalter glEnable(GL_LIGHTi) nicht, er wird als
+ * Uniform uebergeben.
+ *
+ * Bestandteil einer Uebung im Rahmen des Moduls Praktikum Grundlagen der Computergrafik
+ * an der FH Wedel.
+ *
+ * @author Nicolas Hollmann, Daniel Klintworth
+ */
+
+/* ---- System Header einbinden ---- */
+#include <stdio.h>
+
+/* Stellt Shader bereit, muss vor gl.h stehen */
+#include <GL/glew.h>
+
+#ifdef __APPLE__
+#include <OpenGL/gl.h>
+#else
+#include <GL/gl.h>
+#endif
+
+/* ---- Eigene Header einbinden ---- */
+#include "lighting.h"
+#include "debugGL.h"
+
+/* ---- Konstanten ---- */
+
+/** Anzahl der beruecksichtigten Lichtquellen, ab GL_LIGHT0 */
+#define LIGHT_COUNT (2)
+
+/** Setzt den Wert eines Makros als String in den Shader-Quelltext ein */
+#define SHADER_VALUE(x) SHADER_STRING(x)
+#define SHADER_STRING(x) #x
+
+/** Vertex-Shader: Position und Normale im Kamerakoordinatensystem */
+static const char *VERTEX_SHADER =
+	"#version 110\n"
+	"varying vec3 position;\n"
+	"varying vec3 normal;\n"
+	"void main()\n"
+	"{\n"
+	"	position = vec3(gl_ModelViewMatrix * gl_Vertex);\n"
+	"	normal = gl_NormalMatrix * gl_Normal;\n"
+	"	gl_Position = ftransform();\n"
+	"}\n";
+
+/** Fragment-Shader: Beleuchtungsformel der festen Pipeline */
+static const char *FRAGMENT_SHADER =
+	"#version 110\n"
+	"uniform float lightEnabled[" SHADER_VALUE(LIGHT_COUNT) "];\n"
+	"varying vec3 position;\n"
+	"varying vec3 normal;\n"
+	"void main()\n"
+	"{\n"
+	"	vec3 n = normalize(normal);\n"
+	"	vec4 color = gl_FrontLightModelProduct.sceneColor;\n"
+	"	for (int i = 0; i < " SHADER_VALUE(LIGHT_COUNT) "; i++)\n"
+	"	{\n"
+	"		vec4 lightPosition = gl_LightSource[i].position;\n"
+	"		vec3 l = normalize(lightPosition.w == 0.0 ? lightPosition.xyz\n"
+	"		                                          : lightPosition.xyz - position);\n"
+	"		float spot = 1.0;\n"
+	"		if (gl_LightSource[i].spotCutoff <= 90.0)\n"
+	"		{\n"
+	"			float cosAngle = dot(-l, normalize(gl_LightSource[i].spotDirection));\n"
+	"			spot = cosAngle >= gl_LightSource[i].spotCosCutoff\n"
+	"			       ? pow(max(cosAngle, 0.0), gl_LightSource[i].spotExponent) : 0.0;\n"
+	"		}\n"
+	"		float diffuse = max(dot(n, l), 0.0);\n"
+	"		vec4 light = gl_FrontLightProduct[i].ambient + diffuse * gl_FrontLightProduct[i].diffuse;\n"
+	"		if (diffuse > 0.0)\n"
+	"		{\n"
+	"			vec3 h = normalize(l + vec3(0.0, 0.0, 1.0));\n"
+	"			light += pow(max(dot(n, h), 1e-4), gl_FrontMaterial.shininess)\n"
+	"			         * gl_FrontLightProduct[i].specular;\n"
+	"		}\n"
+	"		color += lightEnabled[i] * spot * light;\n"
+	"	}\n"
+	"	gl_FragColor = vec4(clamp(color.rgb, 0.0, 1.0), gl_FrontMaterial.diffuse.a);\n"
+	"}\n";
+
+/* ---- Globale Daten ---- */
+
+/** Steht die Beleuchtung pro Pixel zur Verfuegung? */
+static int g_available = 0;
+
+/** Shader-Programm */
+static GLuint g_program = 0;
+
+/** Position des Uniforms lightEnabled */
+static GLint g_lightEnabledLocation = -1;
+
+/* ---- Interne Funktionen ---- */
+
+/**
+ * Uebersetzt einen Shader.
+ *
+ * @param type GL_VERTEX_SHADER oder GL_FRAGMENT_SHADER (In)
+ * @param source Quelltext des Shaders (In)
+ * @return der Shader, 0 im Fehlerfall
+ */
+static GLuint compileShader(GLenum type, const char *source)
+{
+	GLuint shader = glCreateShader(type);
+	GLint status = GL_FALSE;
+	char log[1024];
+
+	glShaderSource(shader, 1, &source, NULL);
+	glCompileShader(shader);
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+
+	if (!status)
+	{
+		glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+		fprintf(stderr, "Beleuchtungs-Shader konnte nicht uebersetzt werden:\n%s\n", log);
+		glDeleteShader(shader);
+		shader = 0;
+	}
+
+	return shader;
+}
+
+/**
+ * Uebersetzt beide Shader und bindet sie in ein Programm.
+ *
+ * @return das Programm, 0 im Fehlerfall
+ */
+static GLuint createProgram(void)
+{
+	GLuint vertexShader = compileShader(GL_VERTEX_SHADER, VERTEX_SHADER);
+	GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, FRAGMENT_SHADER);
+	GLuint program = 0;
+	GLint status = GL_FALSE;
+	char log[1024];
+
+	if (vertexShader && fragmentShader)
+	{
+		program = glCreateProgram();
+		glAttachShader(program, vertexShader);
+		glAttachShader(program, fragmentShader);
+		glLinkProgram(program);
+		glGetProgramiv(program, GL_LINK_STATUS, &status);
+
+		if (!status)
+		{
+			glGetProgramInfoLog(program, sizeof(log), NULL, log);
+			fprintf(stderr, "Beleuchtungs-Shader konnte nicht gelinkt werden:\n%s\n", log);
+			glDeleteProgram(program);
+			program = 0;
+		}
+	}
+
+	/* Werden erst mit dem Programm wirklich freigegeben */
+	glDeleteShader(vertexShader);
+	glDeleteShader(fragmentShader);
+
+	return program;
+}
+
+/* ---- Oeffentliche Funktionen ---- */
+
+int lighting_init(void)
+{
+	g_available = GLEW_VERSION_2_0;
+
+	if (g_available)
+	{
+		g_program = createProgram();
+		g_lightEnabledLocation = glGetUniformLocation(g_program, "lightEnabled");
+		g_available = g_program && g_lightEnabledLocation >= 0 && GLGETERROR == GL_NO_ERROR;
+	}
+
+	if (!g_available)
+	{
+		printf("Beleuchtung pro Pixel nicht verfuegbar, Kacheln werden unterteilt.\n");
+	}
+
+	return g_available;
+}
+
+int lighting_available(void)
+{
+	return g_available;
+}
+
+void lighting_begin(void)
+{
+	GLfloat enabled[LIGHT_COUNT];
+
+	for (int i = 0; i < LIGHT_COUNT; i++)
+	{
+		enabled[i] = glIsEnabled(GL_LIGHT0 + i) ? 1.0f : 0.0f;
+	}
+
+	glUseProgram(g_program);
+	glUniform1fv(g_lightEnabledLocation, LIGHT_COUNT, enabled);
+}
+
+void lighting_end(void)
+{
+	glUseProgram(0);
+}
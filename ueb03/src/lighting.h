@@ -0,0 +1,51 @@
+#ifndef __LIGHTING_H__
+#define __LIGHTING_H__
+/**
+ * @file
+ * Schnittstelle des Beleuchtungs-Moduls.
+ * Das Modul berechnet die Beleuchtung der festen Pipeline pro Pixel statt
+ * pro Vertex. Der Shader liest Lichtquellen, Material und Lichtmodell aus
+ * dem OpenGL-Zustand (gl_LightSource, gl_FrontMaterial), die Szene setzt
+ * beides also weiter mit glLight und glMaterial. Beruecksichtigt werden
+ * GL_LIGHT0 und GL_LIGHT1 als Punkt- oder Spotlicht mit Exponent und
+ * Cutoff, ohne Abschwaechung und mit unendlich entferntem Betrachter, wie
+ * in scene.c eingestellt.
+ *
+ * Damit muessen die Kacheln nicht mehr unterteilt werden, damit Lichtkegel
+ * und Glanzlichter auf ihnen sichtbar sind.
+ *
+ * Bestandteil einer Uebung im Rahmen des Moduls Praktikum Grundlagen der Computergrafik
+ * an der FH Wedel.
+ *
+ * @author Nicolas Hollmann, Daniel Klintworth
+ */
+
+/* ---- Funktionen ---- */
+
+/**
+ * Uebersetzt die Shader. Setzt einen aktuellen OpenGL-Kontext und
+ * initialisiertes GLEW voraus.
+ *
+ * @return 1, wenn die Beleuchtung pro Pixel zur Verfuegung steht, sonst 0
+ */
+int lighting_init(void);
+
+/**
+ * Prueft, ob die Beleuchtung pro Pixel zur Verfuegung steht.
+ *
+ * @return 1, wenn sie genutzt werden kann
+ */
+int lighting_available(void);
+
+/**
+ * Aktiviert die Beleuchtung pro Pixel fuer die folgenden Zeichenbefehle.
+ * Ein- und ausgeschaltete Lichtquellen werden dabei uebernommen.
+ */
+void lighting_begin(void);
+
+/**
+ * Kehrt zur festen Pipeline zurueck.
+ */
+void lighting_end(void);
+
+#endif
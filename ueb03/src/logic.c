@@ -19,10 +19,8 @@
 
 /* ---- Eigene Header einbinden ---- */
 #include "logic.h"
-
-/* ---- Makros ---- */
-
-#define CHECK_BOUNDARY(x) ((x) >= 0 && (x) < (LEVELSIZE))
+#include "levelfile.h"
+#include "bitplanes.h"
 
 /* ---- Konstanten ---- */
 
@@ -94,8 +92,131 @@ const wmLevel level4 =
 /* Spielzustand */
 static Gamestate g_gamestate = EMPTY_GAMESTATE;
 
+/* Speicher des aktuellen Levels, g_gamestate.level zeigt auf dessen Zeilen */
+static LevelFile g_levelData = EMPTY_LEVEL_FILE;
+
+/* Per setLevelFile festgelegte Leveldatei, NULL wenn keine */
+static const char *g_levelFilename = NULL;
+
+/* Das aktuelle Level als Bitebenen, wird mit jedem Feld aktualisiert */
+static BitPlanes g_planes = EMPTY_BIT_PLANES;
+
 /* ---- Interne Funktionen ---- */
 
+/**
+ * Uebernimmt g_levelData als aktuelles Level und legt die Zeilenzeiger an.
+ * 
+ * @return 1 bei Erfolg, 0 wenn kein Speicher frei ist
+ */
+static int useLevelData(void)
+{
+	wmField **rows = realloc(g_gamestate.level, g_levelData.height * sizeof(wmField *));
+
+	if (rows == NULL)
+	{
+		return 0;
+	}
+
+	for (int y = 0; y < g_levelData.height; y++)
+	{
+		rows[y] = g_levelData.fields + (size_t)y * g_levelData.width;
+	}
+
+	g_gamestate.level = rows;
+	g_gamestate.levelWidth = g_levelData.width;
+	g_gamestate.levelHeight = g_levelData.height;
+	g_gamestate.playerX = g_levelData.startX;
+	g_gamestate.playerY = g_levelData.startY;
+
+	return 1;
+}
+
+/**
+ * Legt eines der eingebauten Level im Speicher an.
+ * 
+ * @param levelSource das Level (In)
+ * @return 1 bei Erfolg, 0 wenn kein Speicher frei ist
+ */
+static int loadBuiltinLevel(wmLevelPointer levelSource)
+{
+	if (!levelfile_create(&g_levelData, LEVELSIZE, LEVELSIZE))
+	{
+		return 0;
+	}
+
+	for (int y = 0; y < LEVELSIZE; y++)
+	{
+		for (int x = 0; x < LEVELSIZE; x++)
+		{
+			g_levelData.fields[y * LEVELSIZE + x] = (wmField)levelSource[y][x];
+			if (levelSource[y][x] == WM_START) {
+				g_levelData.startX = x;
+				g_levelData.startY = y;
+				g_levelData.fields[y * LEVELSIZE + x] = WM_FREE;
+			}
+		}
+	}
+
+	return useLevelData();
+}
+
+/**
+ * Merkt ein Feld fuer die Darstellung als geaendert vor.
+ * 
+ * @param x X-Koordinate des Feldes (In)
+ * @param y Y-Koordinate des Feldes (In)
+ */
+static void markDirty(int x, int y)
+{
+	DirtyTiles *dirty = &g_gamestate.dirtyTiles;
+
+	if (dirty->count < DIRTY_TILES_MAX) {
+		dirty->x[dirty->count] = x;
+		dirty->y[dirty->count] = y;
+		dirty->count++;
+	} else {
+		dirty->all = GL_TRUE;
+	}
+}
+
+/**
+ * Setzt ein Feld des Levels, traegt es in die Bitebenen ein und merkt es bei
+ * einer Aenderung vor.
+ * 
+ * @param x X-Koordinate des Feldes (In)
+ * @param y Y-Koordinate des Feldes (In)
+ * @param field der neue Feldtyp (In)
+ */
+static void setField(int x, int y, wmFieldType field)
+{
+	if (g_gamestate.level[y][x] != field) {
+		g_gamestate.level[y][x] = field;
+		bitplanes_set(&g_planes, x, y, field);
+		markDirty(x, y);
+	}
+}
+
+/**
+ * Setzt den zuletzt bewegten Sandsack. Dieser wird animiert und daher
+ * gesondert gezeichnet, alte und neue Position sind also geaendert.
+ * 
+ * @param x X-Koordinate des Sandsacks, -1 fuer keinen (In)
+ * @param y Y-Koordinate des Sandsacks, -1 fuer keinen (In)
+ */
+static void setLastSandbag(int x, int y)
+{
+	if (g_gamestate.lastSandbagX >= 0) {
+		markDirty(g_gamestate.lastSandbagX, g_gamestate.lastSandbagY);
+	}
+
+	g_gamestate.lastSandbagX = x;
+	g_gamestate.lastSandbagY = y;
+
+	if (x >= 0) {
+		markDirty(x, y);
+	}
+}
+
 /**
  * Behandelt die Bewegung des Spielers.
  * 
@@ -108,30 +229,30 @@ static void handleMovement(int offsetX, int offsetY)
 	GLboolean canMove = GL_FALSE;
 
 	/* Das Feld, auf das der Spieler sich bewegen moechte. */
-	wmFieldType fstField = g_gamestate.level[g_gamestate.playerY + offsetY]
-											[g_gamestate.playerX + offsetX];
+	int fstX = g_gamestate.playerX + offsetX;
+	int fstY = g_gamestate.playerY + offsetY;
 
-	/* Das darauf folgende Feld. Relevant, wenn das erste Feld ein Sandsack ist. */
-	wmFieldType sndField = g_gamestate.level[g_gamestate.playerY + offsetY * 2]
-											[g_gamestate.playerX + offsetX * 2];
+	/* Das darauf folgende Feld. Relevant, wenn das erste Feld ein Sandsack ist.
+	 * Ausserhalb des Levels liegt in keiner Ebene, wirkt also wie eine Wand. */
+	int sndX = g_gamestate.playerX + offsetX * 2;
+	int sndY = g_gamestate.playerY + offsetY * 2;
 
-	if (fstField == WM_FREE || fstField == WM_GOAL) {
+	if (bitplanes_test(&g_planes, PLANE_FREE, fstX, fstY) ||
+	    bitplanes_test(&g_planes, PLANE_GOAL, fstX, fstY)) {
 		canMove = GL_TRUE;
-		g_gamestate.lastSandbagX = -1;
-		g_gamestate.lastSandbagY = -1;
-	} else if (fstField == WM_SAND && (
-			   sndField == WM_FREE || 
-			   sndField == WM_WATER )) {
-
-		g_gamestate.level[g_gamestate.playerY + offsetY    ]
-						 [g_gamestate.playerX + offsetX    ] = WM_FREE;
-		g_gamestate.level[g_gamestate.playerY + offsetY * 2]
-						 [g_gamestate.playerX + offsetX * 2] = WM_SAND;
+		setLastSandbag(-1, -1);
+	} else if (bitplanes_test(&g_planes, PLANE_SAND, fstX, fstY) && (
+			   bitplanes_test(&g_planes, PLANE_FREE, sndX, sndY) || 
+			   bitplanes_test(&g_planes, PLANE_WATER, sndX, sndY) )) {
 
+		setField(g_gamestate.playerX + offsetX,
+				 g_gamestate.playerY + offsetY, WM_FREE);
+		setField(g_gamestate.playerX + offsetX * 2,
+				 g_gamestate.playerY + offsetY * 2, WM_SAND);
 
 		canMove = GL_TRUE;
-		g_gamestate.lastSandbagX = g_gamestate.playerX + offsetX * 2;
-		g_gamestate.lastSandbagY = g_gamestate.playerY + offsetY * 2;
+		setLastSandbag(g_gamestate.playerX + offsetX * 2,
+					   g_gamestate.playerY + offsetY * 2);
 	}
 
 	/* Bewegung wenn erlaubt ausfuehren. */
@@ -148,10 +269,7 @@ static void handleMovement(int offsetX, int offsetY)
  */
 static void checkLosingCondition(void)
 {
-	wmFieldType playerField = g_gamestate.level[g_gamestate.playerY]
-											   [g_gamestate.playerX];
-	
-	if (playerField == WM_WATER) {
+	if (bitplanes_test(&g_planes, PLANE_WATER, g_gamestate.playerX, g_gamestate.playerY)) {
 		g_gamestate.stage = stageLost;
 	}
 }
@@ -161,64 +279,37 @@ static void checkLosingCondition(void)
  */
 static void checkVictoryCondition(void)
 {
-	wmFieldType playerField = g_gamestate.level[g_gamestate.playerY]
-											   [g_gamestate.playerX];
-
-	if (playerField == WM_GOAL) {
+	if (bitplanes_test(&g_planes, PLANE_GOAL, g_gamestate.playerX, g_gamestate.playerY)) {
 		g_gamestate.stage = stageWon;
 	}
 }
 
 /**
- * Aktualisiert die Expansion eines einzelnen Wasserfeldes. 
- * Anliegende Zuckerfelder werden nass.
- * 
- * @param x X-Koordinate des Wasserfeldes (In)
- * @param y Y-Koordinate des Wasserfeldes (In)
- */
-static void updateWaterTile(int y, int x)
-{
-	if (CHECK_BOUNDARY(x) && CHECK_BOUNDARY(y)) 
-	{
-		if (g_gamestate.level[y][x] == WM_FREE) 
-		{
-			g_gamestate.level[y][x] = WM_NEWWATER;
-		} 
-		else if (g_gamestate.level[y][x] == WM_SUGAR) 
-		{
-			g_gamestate.level[y][x] = WM_TOUCHED_SUGAR;
-			sugar_add(&g_gamestate.sugarCubes, x, y);
-		}
-	} 
-}
-
-/**
- * Aktualisiert die Expansion aller Wasserfelder.
+ * Aktualisiert die Expansion aller Wasserfelder. Die Bitebenen liefern alle
+ * freien Felder und Zuckerfelder neben Wasser auf einmal. Neues Wasser
+ * breitet sich so erst im naechsten Schritt aus, ohne Zwischenzustand fuer
+ * neues Wasser. Anliegende Zuckerfelder werden nass.
  */
 static void updateWater()
 {
-	/* Alle Felder einzeln aktualisieren. */
-	for (int y = 0; y < LEVELSIZE; y++)
+	int word = 0;
+	int x, y;
+
+	if (!bitplanes_spreadWater(&g_planes))
 	{
-		for (int x = 0; x < LEVELSIZE; x++)
-		{
-			if (g_gamestate.level[y][x] == WM_WATER) {
-				updateWaterTile(y,     x - 1);
-				updateWaterTile(y,     x + 1);
-				updateWaterTile(y + 1, x);
-				updateWaterTile(y - 1, x);
-			}
-		}
+		return;
 	}
 
-	/* Neue Felder in normale umwandeln. */
-	for (int y = 0; y < LEVELSIZE; y++)
+	while (bitplanes_nextSpread(&g_planes, &word, &x, &y))
 	{
-		for (int x = 0; x < LEVELSIZE; x++)
+		if (g_gamestate.level[y][x] == WM_FREE) 
 		{
-			if (g_gamestate.level[y][x] == WM_NEWWATER) {
-				g_gamestate.level[y][x] = WM_WATER;
-			}
+			setField(x, y, WM_WATER);
+		} 
+		else
+		{
+			setField(x, y, WM_TOUCHED_SUGAR);
+			sugar_add(&g_gamestate.sugarCubes, x, y);
 		}
 	}
 }
@@ -230,7 +321,7 @@ static void updateWater()
  */
 static void dissolveSugar(int x, int y)
 {
-	g_gamestate.level[y][x] = WM_FREE;
+	setField(x, y, WM_FREE);
 }
 
 /* ---- Oeffentliche Funktionen ---- */
@@ -295,6 +386,16 @@ void initLevel(int levelId)
 	wmLevelPointer levelSource = NULL;
 	switch (levelId)
 	{
+		case LEVEL_FILE:
+			/* Datei erneut einblenden, das verwirft alle Aenderungen */
+			if (g_levelFilename != NULL && levelfile_load(g_levelFilename, &g_levelData)
+			    && useLevelData())
+			{
+				break;
+			}
+			levelId = LEVEL_1;
+			levelSource = level1;
+			break;
 		case LEVEL_1:
 			levelSource = level1;
 			break;
@@ -310,22 +411,15 @@ void initLevel(int levelId)
 	}
 
 	/* Leveldaten und Spielerposition laden. */
-	for (int y = 0; y < LEVELSIZE; y++)
+	if (levelSource != NULL && !loadBuiltinLevel(levelSource))
 	{
-		for (int x = 0; x < LEVELSIZE; x++)
-		{
-			g_gamestate.level[y][x] = levelSource[y][x];
-			if (levelSource[y][x] == WM_START) {
-				g_gamestate.playerX = x;
-				g_gamestate.playerY = y;
-				g_gamestate.level[y][x] = WM_FREE;
-				g_gamestate.lastDirection = dirDown;
-			}
-		}
+		fprintf(stderr, "Kein Speicher fuer das Level!\n");
+		exit(1);
 	}
 
 	/* Spielzustand Initialisieren */
 	g_gamestate.levelId = levelId;
+	g_gamestate.lastDirection = dirDown;
 	g_gamestate.stage = stageRunning;
 	g_gamestate.showHelp = GL_FALSE;
 	g_gamestate.playerCooldown = 0.0f;
@@ -334,9 +428,41 @@ void initLevel(int levelId)
 	g_gamestate.lastSandbagX = -1;
 	g_gamestate.lastSandbagY = -1;
 
+	/* Bitebenen aus den Feldern aufbauen */
+	if (!bitplanes_init(&g_planes, g_gamestate.level, g_gamestate.levelWidth,
+	                    g_gamestate.levelHeight))
+	{
+		fprintf(stderr, "Kein Speicher fuer das Level!\n");
+		exit(1);
+	}
+
+	/* Das ganze Level ist neu */
+	g_gamestate.dirtyTiles.count = 0;
+	g_gamestate.dirtyTiles.all = GL_TRUE;
+
 	sugar_free(&g_gamestate.sugarCubes);
 }
 
+int setLevelFile(const char *filename)
+{
+	LevelFile probe = EMPTY_LEVEL_FILE;
+	int valid = levelfile_load(filename, &probe);
+
+	levelfile_free(&probe);
+
+	if (valid)
+	{
+		g_levelFilename = filename;
+	}
+
+	return valid;
+}
+
+int getFirstLevel(void)
+{
+	return (g_levelFilename != NULL) ? LEVEL_FILE : LEVEL_1;
+}
+
 Gamestate* getGamestate(void)
 {
 	return &g_gamestate;
@@ -398,7 +524,19 @@ void changeCameraOrientation(GLfloat deltaRadius, GLfloat deltaPolar, GLfloat de
 	}
 }
 
+void clearDirtyTiles(void)
+{
+	g_gamestate.dirtyTiles.count = 0;
+	g_gamestate.dirtyTiles.all = GL_FALSE;
+}
+
 void cleanup(void)
 {
 	sugar_free(&g_gamestate.sugarCubes);
+
+	bitplanes_free(&g_planes);
+
+	free(g_gamestate.level);
+	g_gamestate.level = NULL;
+	levelfile_free(&g_levelData);
 }
@@ -25,6 +25,7 @@
 
 /* Im Spiel vorhandene Level. */
 enum e_Level {
+    LEVEL_FILE = 0, // per setLevelFile festgelegte Leveldatei
     LEVEL_1 = 1,
     LEVEL_2,
     LEVEL_3,
@@ -51,12 +52,31 @@ void updateLogic(double interval);
 void movePlayer(PlayerDirection direction);
 
 /**
- * Initialisiert das uebergebene Level neu.
+ * Initialisiert das uebergebene Level neu. LEVEL_FILE laedt die per
+ * setLevelFile festgelegte Datei erneut, schlaegt das fehl, wird LEVEL_1
+ * geladen.
  * 
  * @param levelId Identifikationsnummer des Levels (In)
  */
 void initLevel(int levelId);
 
+/**
+ * Legt eine Leveldatei fest, die als erstes Level und bei LEVEL_FILE geladen
+ * wird. Die Datei wird dabei einmal probehalber geladen.
+ * 
+ * @param filename Name der Datei, muss bis zum Programmende gueltig bleiben (In)
+ * @return 1, wenn die Datei ein gueltiges Level enthaelt, sonst 0
+ */
+int setLevelFile(const char *filename);
+
+/**
+ * Liefert das Level, mit dem das Spiel beginnt: die Leveldatei, wenn eine
+ * festgelegt ist, sonst LEVEL_1.
+ * 
+ * @return Identifikationsnummer des Levels
+ */
+int getFirstLevel(void);
+
 /**
  * Gibt einen Zeiger auf den Spielzustand zurueck.
  * 
@@ -83,6 +103,12 @@ void pressedActionKey(void);
  */
 void changeCameraOrientation(GLfloat deltaRadius, GLfloat deltaPolar, GLfloat deltaAzimuth);
 
+/**
+ * Vergisst alle seit dem letzten Aufruf geaenderten Felder (Gamestate.dirtyTiles).
+ * Wird von der Darstellung aufgerufen, nachdem sie die Aenderungen uebernommen hat.
+ */
+void clearDirtyTiles(void);
+
 /**
  * Beendet das Spiel sauber und gibt reservierten Speicher wieder frei.
  */
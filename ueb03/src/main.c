@@ -10,9 +10,17 @@
 
 /* ---- System Header einbinden ---- */
 #include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <string.h>
 
 /* ---- Eigene Header einbinden ---- */
 #include "io.h"
+#include "frametime.h"
+#include "headless.h"
+#include "replay.h"
+#include "logic.h"
+#include "scene.h"
 
 /* ---- Funktionen ---- */
 
@@ -20,18 +28,130 @@
  * Hauptprogramm.
  * Initialisierung und Starten der Ereignisbehandlung.
  * 
+ * Parameter:
+ *   --csv <datei>  schreibt die Zeiten aller Frames beim Beenden in eine CSV-Datei
+ *   --size BxH     Groesse des Fensters bzw. Bildes
+ *   --headless     rendert ohne Fenster eine feste Anzahl Frames mit festem Zeitschritt
+ *   --frames N     Anzahl der Frames im Headless-Modus
+ *   --dump <verz>  legt im Headless-Modus jeden Frame als PPM-Bild im Verzeichnis ab
+ *   --record <d>   zeichnet alle Eingaben und Zeitschritte in einer Datei auf
+ *   --replay <d>   spielt eine Aufzeichnung ab (Fenstergroesse aus der Aufzeichnung,
+ *                  im Headless-Modus bis zum Ende der Aufzeichnung)
+ *   --level <d>    beginnt mit dem Level aus einer Leveldatei (siehe levelfile.h)
+ *   --no-water-culling  zeichnet auch die Seiten zwischen zwei Wasserfeldern
+ *
  * @param argc Anzahl der Kommandozeilenparameter (In)
  * @param argv Kommandozeilenparameter (In)
  * @return Rueckgabewert im Fehlerfall ungleich Null
  */
 int main(int argc, char **argv)
 {
-	(void)argc;
-	(void)argv;
+	const char *csvFilename = NULL;
+	const char *dumpDir = NULL;
+	const char *recordFilename = NULL;
+	const char *replayFilename = NULL;
+	const char *levelFilename = NULL;
+	int headless = 0;
+	int frames = 0;
+	int width = 500;
+	int height = 500;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc)
+		{
+			csvFilename = argv[++i];
+		}
+		else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc
+		         && sscanf(argv[i + 1], "%dx%d", &width, &height) == 2
+		         && width > 0 && height > 0)
+		{
+			i++;
+		}
+		else if (strcmp(argv[i], "--headless") == 0)
+		{
+			headless = 1;
+		}
+		else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc
+		         && (frames = atoi(argv[i + 1])) > 0)
+		{
+			i++;
+		}
+		else if (strcmp(argv[i], "--dump") == 0 && i + 1 < argc)
+		{
+			dumpDir = argv[++i];
+		}
+		else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+		{
+			recordFilename = argv[++i];
+		}
+		else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+		{
+			replayFilename = argv[++i];
+		}
+		else if (strcmp(argv[i], "--level") == 0 && i + 1 < argc)
+		{
+			levelFilename = argv[++i];
+		}
+		else if (strcmp(argv[i], "--no-water-culling") == 0)
+		{
+			setWaterCulling(GL_FALSE);
+		}
+		else
+		{
+			fprintf(stderr, "Unbekannter Parameter: %s\n", argv[i]);
+			fprintf(stderr, "Aufruf: %s [--csv <datei>] [--size BxH] "
+			                "[--headless [--frames N] [--dump <verz>]] "
+			                "[--record <datei> | --replay <datei>] [--level <datei>] "
+			                "[--no-water-culling]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	/* Leveldatei vorab pruefen, geladen wird sie mit dem ersten Level */
+	if (levelFilename != NULL && !setLevelFile(levelFilename))
+	{
+		return 1;
+	}
+
+	/* Aufzeichnung bzw. Wiedergabe vorbereiten, die Wiedergabe legt auch die
+	 * Fenstergroesse fest */
+	if (replayFilename != NULL)
+	{
+		if (!replay_startPlayback(replayFilename, &width, &height))
+		{
+			return 1;
+		}
+	}
+	else if (recordFilename != NULL && !replay_startRecording(recordFilename, width, height))
+	{
+		return 1;
+	}
+
+	/* Ohne Angabe laeuft eine Wiedergabe bis zum Ende der Aufzeichnung */
+	if (frames == 0)
+	{
+		frames = (replayFilename != NULL) ? INT_MAX : HEADLESS_DEFAULT_FRAMES;
+	}
+
+	/* Zeitmessung der Frames starten */
+	frametime_init(csvFilename);
+
+	if (headless)
+	{
+		/* Ohne Fenster rendern und danach beenden */
+		if (!runHeadless(frames, width, height, dumpDir))
+		{
+			fprintf(stderr, "Initialisierung fehlgeschlagen!\n");
+			return 1;
+		}
+
+		return 0;
+	}
 
 	/* Initialisierung des I/O-Sytems
 	 (inkl. Erzeugung des Fensters und Starten der Ereignisbehandlung) */
-	if (!initAndStartIO("Aufgabe 3: Wasser Marsch 2000! (3D) | Daniel & Nico", 500, 500))
+	if (!initAndStartIO("Aufgabe 3: Wasser Marsch 2000! (3D) | Daniel & Nico", width, height))
 	{
 		fprintf(stderr, "Initialisierung fehlgeschlagen!\n");
 		return 1;
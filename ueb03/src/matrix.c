@@ -0,0 +1,408 @@
+/**
+ * @file
+ * Matrix-Modul.
+ * Das Modul kapselt Rechnungen mit 4x4-Matrizen und homogenen Vektoren.
+ *
+ * Multiplikation und Transformation arbeiten spaltenweise: Spalte j des
+ * Ergebnisses ist die Summe der Spalten von a, gewichtet mit den Elementen
+ * der Spalte j von b. Mit SSE ist das pro Spalte eine Kette aus vier
+ * Multiplikationen und drei Additionen auf ganzen Spalten.
+ *
+ * Bestandteil einer Uebung im Rahmen des Moduls Praktikum Grundlagen der Computergrafik
+ * an der FH Wedel.
+ *
+ * @author Nicolas Hollmann, Daniel Klintworth
+ */
+
+/* ---- System Header einbinden ---- */
+#include <math.h>
+#include <string.h>
+
+/* MATRIX_NO_SSE erzwingt die skalare Variante, z. B. zum Testen */
+#if !defined(MATRIX_NO_SSE) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#define MATRIX_SSE
+#include <xmmintrin.h>
+#endif
+
+/* ---- Eigene Header einbinden ---- */
+#include "matrix.h"
+
+/* ---- Konstanten ---- */
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/* ---- Interne Funktionen ---- */
+
+/**
+ * Normiert eine Ebene, so dass der Normalenanteil die Laenge 1 hat.
+ *
+ * @param plane die Ebene (InOut)
+ */
+static void normalizePlane(CGVector4f plane)
+{
+	float length = sqrtf(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+
+	if (length > 0.0f)
+	{
+		plane[0] /= length;
+		plane[1] /= length;
+		plane[2] /= length;
+		plane[3] /= length;
+	}
+}
+
+/**
+ * Berechnet ein normiertes Kreuzprodukt.
+ *
+ * @param res das Ergebnis (Out)
+ * @param a linker Operand (In)
+ * @param b rechter Operand (In)
+ */
+static void unitCross(float res[3], const float a[3], const float b[3])
+{
+	res[0] = a[1] * b[2] - a[2] * b[1];
+	res[1] = a[2] * b[0] - a[0] * b[2];
+	res[2] = a[0] * b[1] - a[1] * b[0];
+
+	float length = sqrtf(res[0] * res[0] + res[1] * res[1] + res[2] * res[2]);
+
+	if (length > 0.0f)
+	{
+		res[0] /= length;
+		res[1] /= length;
+		res[2] /= length;
+	}
+}
+
+/* ---- Oeffentliche Funktionen ---- */
+
+void matrix_identity(CGMatrix4f m)
+{
+	static const CGMatrix4f identity = {
+		1, 0, 0, 0,
+		0, 1, 0, 0,
+		0, 0, 1, 0,
+		0, 0, 0, 1
+	};
+
+	memcpy(m, identity, sizeof(CGMatrix4f));
+}
+
+void matrix_multiply(CGMatrix4f res, const CGMatrix4f a, const CGMatrix4f b)
+{
+	CGMatrix4f tmp;
+
+#ifdef MATRIX_SSE
+	__m128 a0 = _mm_loadu_ps(a);
+	__m128 a1 = _mm_loadu_ps(a + 4);
+	__m128 a2 = _mm_loadu_ps(a + 8);
+	__m128 a3 = _mm_loadu_ps(a + 12);
+
+	for (int j = 0; j < 4; j++)
+	{
+		__m128 col = _mm_mul_ps(a0, _mm_set1_ps(b[j * 4]));
+		col = _mm_add_ps(col, _mm_mul_ps(a1, _mm_set1_ps(b[j * 4 + 1])));
+		col = _mm_add_ps(col, _mm_mul_ps(a2, _mm_set1_ps(b[j * 4 + 2])));
+		col = _mm_add_ps(col, _mm_mul_ps(a3, _mm_set1_ps(b[j * 4 + 3])));
+		_mm_storeu_ps(tmp + j * 4, col);
+	}
+#else
+	for (int j = 0; j < 4; j++)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			tmp[j * 4 + i] = a[i] * b[j * 4]
+			               + a[4 + i] * b[j * 4 + 1]
+			               + a[8 + i] * b[j * 4 + 2]
+			               + a[12 + i] * b[j * 4 + 3];
+		}
+	}
+#endif
+
+	memcpy(res, tmp, sizeof(CGMatrix4f));
+}
+
+void matrix_translate(CGMatrix4f m, float x, float y, float z)
+{
+	/* Nur die letzte Spalte aendert sich */
+	for (int i = 0; i < 4; i++)
+	{
+		m[12 + i] += m[i] * x + m[4 + i] * y + m[8 + i] * z;
+	}
+}
+
+void matrix_rotate(CGMatrix4f m, float angle, float x, float y, float z)
+{
+	float length = sqrtf(x * x + y * y + z * z);
+
+	if (length == 0.0f)
+	{
+		return;
+	}
+
+	x /= length;
+	y /= length;
+	z /= length;
+
+	float rad = angle * (float)(M_PI / 180.0);
+	float c = cosf(rad);
+	float s = sinf(rad);
+	float t = 1.0f - c;
+
+	CGMatrix4f r = {
+		t * x * x + c,     t * x * y + s * z, t * x * z - s * y, 0,
+		t * x * y - s * z, t * y * y + c,     t * y * z + s * x, 0,
+		t * x * z + s * y, t * y * z - s * x, t * z * z + c,     0,
+		0,                 0,                 0,                 1
+	};
+
+	matrix_multiply(m, m, r);
+}
+
+void matrix_scale(CGMatrix4f m, float x, float y, float z)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		m[i] *= x;
+		m[4 + i] *= y;
+		m[8 + i] *= z;
+	}
+}
+
+void matrix_frustum(CGMatrix4f m, float left, float right, float bottom, float top, float znear, float zfar)
+{
+	memset(m, 0, sizeof(CGMatrix4f));
+
+	m[0]  = 2.0f * znear / (right - left);
+	m[5]  = 2.0f * znear / (top - bottom);
+	m[8]  = (right + left) / (right - left);
+	m[9]  = (top + bottom) / (top - bottom);
+	m[10] = -(zfar + znear) / (zfar - znear);
+	m[11] = -1.0f;
+	m[14] = -2.0f * zfar * znear / (zfar - znear);
+}
+
+void matrix_perspective(CGMatrix4f m, float fovy, float aspect, float znear, float zfar)
+{
+	float top = znear * tanf(fovy * (float)(M_PI / 360.0));
+	float right = top * aspect;
+
+	matrix_frustum(m, -right, right, -top, top, znear, zfar);
+}
+
+void matrix_ortho(CGMatrix4f m, float left, float right, float bottom, float top, float znear, float zfar)
+{
+	memset(m, 0, sizeof(CGMatrix4f));
+
+	m[0]  = 2.0f / (right - left);
+	m[5]  = 2.0f / (top - bottom);
+	m[10] = -2.0f / (zfar - znear);
+	m[12] = -(right + left) / (right - left);
+	m[13] = -(top + bottom) / (top - bottom);
+	m[14] = -(zfar + znear) / (zfar - znear);
+	m[15] = 1.0f;
+}
+
+void matrix_lookAt(CGMatrix4f m,
+                   float eyeX, float eyeY, float eyeZ,
+                   float centerX, float centerY, float centerZ,
+                   float upX, float upY, float upZ)
+{
+	float f[3] = { centerX - eyeX, centerY - eyeY, centerZ - eyeZ };
+	float up[3] = { upX, upY, upZ };
+	float s[3];
+	float u[3];
+
+	float length = sqrtf(f[0] * f[0] + f[1] * f[1] + f[2] * f[2]);
+	if (length > 0.0f)
+	{
+		f[0] /= length;
+		f[1] /= length;
+		f[2] /= length;
+	}
+
+	unitCross(s, f, up);
+	unitCross(u, s, f);
+
+	m[0]  =  s[0];
+	m[1]  =  u[0];
+	m[2]  = -f[0];
+	m[3]  = 0.0f;
+
+	m[4]  =  s[1];
+	m[5]  =  u[1];
+	m[6]  = -f[1];
+	m[7]  = 0.0f;
+
+	m[8]  =  s[2];
+	m[9]  =  u[2];
+	m[10] = -f[2];
+	m[11] = 0.0f;
+
+	m[12] = -(s[0] * eyeX + s[1] * eyeY + s[2] * eyeZ);
+	m[13] = -(u[0] * eyeX + u[1] * eyeY + u[2] * eyeZ);
+	m[14] =  (f[0] * eyeX + f[1] * eyeY + f[2] * eyeZ);
+	m[15] = 1.0f;
+}
+
+int matrix_invert(CGMatrix4f res, const CGMatrix4f m)
+{
+	CGMatrix4f inv;
+
+	/* Adjunkte ueber 2x2-Unterdeterminanten der oberen und unteren Zeilenpaare */
+	float s0 = m[0] * m[5] - m[4] * m[1];
+	float s1 = m[0] * m[9] - m[8] * m[1];
+	float s2 = m[0] * m[13] - m[12] * m[1];
+	float s3 = m[4] * m[9] - m[8] * m[5];
+	float s4 = m[4] * m[13] - m[12] * m[5];
+	float s5 = m[8] * m[13] - m[12] * m[9];
+
+	float c5 = m[10] * m[15] - m[14] * m[11];
+	float c4 = m[6] * m[15] - m[14] * m[7];
+	float c3 = m[6] * m[11] - m[10] * m[7];
+	float c2 = m[2] * m[15] - m[14] * m[3];
+	float c1 = m[2] * m[11] - m[10] * m[3];
+	float c0 = m[2] * m[7] - m[6] * m[3];
+
+	float det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+
+	if (det == 0.0f)
+	{
+		return 0;
+	}
+
+	float invDet = 1.0f / det;
+
+	inv[0]  = ( m[5] * c5 - m[9] * c4 + m[13] * c3) * invDet;
+	inv[4]  = (-m[4] * c5 + m[8] * c4 - m[12] * c3) * invDet;
+	inv[8]  = ( m[7] * s5 - m[11] * s4 + m[15] * s3) * invDet;
+	inv[12] = (-m[6] * s5 + m[10] * s4 - m[14] * s3) * invDet;
+
+	inv[1]  = (-m[1] * c5 + m[9] * c2 - m[13] * c1) * invDet;
+	inv[5]  = ( m[0] * c5 - m[8] * c2 + m[12] * c1) * invDet;
+	inv[9]  = (-m[3] * s5 + m[11] * s2 - m[15] * s1) * invDet;
+	inv[13] = ( m[2] * s5 - m[10] * s2 + m[14] * s1) * invDet;
+
+	inv[2]  = ( m[1] * c4 - m[5] * c2 + m[13] * c0) * invDet;
+	inv[6]  = (-m[0] * c4 + m[4] * c2 - m[12] * c0) * invDet;
+	inv[10] = ( m[3] * s4 - m[7] * s2 + m[15] * s0) * invDet;
+	inv[14] = (-m[2] * s4 + m[6] * s2 - m[14] * s0) * invDet;
+
+	inv[3]  = (-m[1] * c3 + m[5] * c1 - m[9] * c0) * invDet;
+	inv[7]  = ( m[0] * c3 - m[4] * c1 + m[8] * c0) * invDet;
+	inv[11] = (-m[3] * s3 + m[7] * s1 - m[11] * s0) * invDet;
+	inv[15] = ( m[2] * s3 - m[6] * s1 + m[10] * s0) * invDet;
+
+	memcpy(res, inv, sizeof(CGMatrix4f));
+
+	return 1;
+}
+
+int matrix_normal(CGMatrix3f res, const CGMatrix4f m)
+{
+	/* Die Inverse-Transponierte ist die Kofaktormatrix geteilt durch die Determinante */
+	float c00 = m[5] * m[10] - m[9] * m[6];
+	float c01 = m[8] * m[6] - m[4] * m[10];
+	float c02 = m[4] * m[9] - m[8] * m[5];
+
+	float det = m[0] * c00 + m[1] * c01 + m[2] * c02;
+
+	if (det == 0.0f)
+	{
+		return 0;
+	}
+
+	float invDet = 1.0f / det;
+
+	res[0] = c00 * invDet;
+	res[1] = c01 * invDet;
+	res[2] = c02 * invDet;
+
+	res[3] = (m[9] * m[2] - m[1] * m[10]) * invDet;
+	res[4] = (m[0] * m[10] - m[8] * m[2]) * invDet;
+	res[5] = (m[8] * m[1] - m[0] * m[9]) * invDet;
+
+	res[6] = (m[1] * m[6] - m[5] * m[2]) * invDet;
+	res[7] = (m[4] * m[2] - m[0] * m[6]) * invDet;
+	res[8] = (m[0] * m[5] - m[4] * m[1]) * invDet;
+
+	return 1;
+}
+
+void matrix_frustumPlanes(CGVector4f planes[PLANE_COUNT], const CGMatrix4f m)
+{
+	/* Gribb/Hartmann: Ebenen aus Summe/Differenz der vierten mit den
+	 * uebrigen Zeilen der Matrix */
+	for (int i = 0; i < 4; i++)
+	{
+		float row0 = m[i * 4];
+		float row1 = m[i * 4 + 1];
+		float row2 = m[i * 4 + 2];
+		float row3 = m[i * 4 + 3];
+
+		planes[PLANE_LEFT][i]   = row3 + row0;
+		planes[PLANE_RIGHT][i]  = row3 - row0;
+		planes[PLANE_BOTTOM][i] = row3 + row1;
+		planes[PLANE_TOP][i]    = row3 - row1;
+		planes[PLANE_NEAR][i]   = row3 + row2;
+		planes[PLANE_FAR][i]    = row3 - row2;
+	}
+
+	for (int p = 0; p < PLANE_COUNT; p++)
+	{
+		normalizePlane(planes[p]);
+	}
+}
+
+int matrix_sphereInFrustum(CGVector4f planes[PLANE_COUNT], float x, float y, float z, float radius)
+{
+	for (int p = 0; p < PLANE_COUNT; p++)
+	{
+		if (planes[p][0] * x + planes[p][1] * y + planes[p][2] * z + planes[p][3] < -radius)
+		{
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+void matrix_transform(CGVector4f res, const CGMatrix4f m, const CGVector4f v)
+{
+	matrix_transformArray((CGVector4f *)res, m, (CGVector4f *)v, 1);
+}
+
+void matrix_transformArray(CGVector4f *res, const CGMatrix4f m, CGVector4f *v, int count)
+{
+#ifdef MATRIX_SSE
+	__m128 m0 = _mm_loadu_ps(m);
+	__m128 m1 = _mm_loadu_ps(m + 4);
+	__m128 m2 = _mm_loadu_ps(m + 8);
+	__m128 m3 = _mm_loadu_ps(m + 12);
+
+	for (int n = 0; n < count; n++)
+	{
+		__m128 p = _mm_loadu_ps(v[n]);
+		__m128 r = _mm_mul_ps(m0, _mm_shuffle_ps(p, p, _MM_SHUFFLE(0, 0, 0, 0)));
+		r = _mm_add_ps(r, _mm_mul_ps(m1, _mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 1, 1, 1))));
+		r = _mm_add_ps(r, _mm_mul_ps(m2, _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 2, 2))));
+		r = _mm_add_ps(r, _mm_mul_ps(m3, _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 3, 3, 3))));
+		_mm_storeu_ps(res[n], r);
+	}
+#else
+	for (int n = 0; n < count; n++)
+	{
+		float x = v[n][0];
+		float y = v[n][1];
+		float z = v[n][2];
+		float w = v[n][3];
+
+		for (int i = 0; i < 4; i++)
+		{
+			res[n][i] = m[i] * x + m[4 + i] * y + m[8 + i] * z + m[12 + i] * w;
+		}
+	}
+#endif
+}
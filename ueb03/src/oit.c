@@ -0,0 +1,340 @@
+/**
+ * @file
+ * OIT-Modul.
+ * Weighted Blended Order-Independent Transparency mit zwei Durchgaengen fuer
+ * die transparenten Flaechen: Der erste summiert die gewichteten Farben in
+ * einer Float-Textur auf, der zweite multipliziert die Durchlaessigkeit
+ * (Revealage) in einer zweiten Textur. So kommt das Verfahren ohne mehrere
+ * Render-Targets und ohne Blending je Target aus.
+ *
+ * Die Beleuchtung bleibt bei der festen Pipeline: Der Akkumulations-Shader
+ * ist ein reiner Fragment-Shader und bekommt die beleuchtete Farbe ueber
+ * gl_Color.
+ *
+ * Bestandteil einer Uebung im Rahmen des Moduls Praktikum Grundlagen der Computergrafik
+ * an der FH Wedel.
+ *
+ * @author Nicolas Hollmann, Daniel Klintworth
+ */
+
+/* ---- System Header einbinden ---- */
+#include <stdio.h>
+
+/* Stellt Framebuffer-Objekte und Shader bereit, muss vor gl.h stehen */
+#include <GL/glew.h>
+
+#ifdef __APPLE__
+#include <OpenGL/gl.h>
+#else
+#include <GL/gl.h>
+#endif
+
+/* ---- Eigene Header einbinden ---- */
+#include "oit.h"
+#include "debugGL.h"
+
+/* ---- Konstanten ---- */
+
+/** Fragment-Shader fuer die gewichtete Summe (McGuire und Bavoil, Gl. 10) */
+static const char *ACCUMULATION_SHADER =
+	"#version 110\n"
+	"void main()\n"
+	"{\n"
+	"	vec4 color = gl_Color;\n"
+	"	float a = color.a;\n"
+	"	float weight = clamp(pow(min(1.0, a * 10.0) + 0.01, 3.0) * 1e8\n"
+	"	                     * pow(1.0 - gl_FragCoord.z * 0.9, 3.0), 1e-2, 3e3);\n"
+	"	gl_FragColor = vec4(color.rgb * a, a) * weight;\n"
+	"}\n";
+
+/** Fragment-Shader zum Zusammensetzen von Szene und transparenten Flaechen */
+static const char *COMPOSITE_SHADER =
+	"#version 110\n"
+	"uniform sampler2D opaque;\n"
+	"uniform sampler2D accumulation;\n"
+	"uniform sampler2D revealage;\n"
+	"void main()\n"
+	"{\n"
+	"	vec2 uv = gl_TexCoord[0].st;\n"
+	"	vec4 sum = texture2D(accumulation, uv);\n"
+	"	float reveal = texture2D(revealage, uv).r;\n"
+	"	vec3 average = sum.rgb / clamp(sum.a, 1e-4, 5e4);\n"
+	"	gl_FragColor = vec4(mix(average, texture2D(opaque, uv).rgb, reveal), 1.0);\n"
+	"}\n";
+
+/* ---- Typen ---- */
+
+/** Indizes der Render-Targets */
+typedef enum {
+	targetOpaque,
+	targetAccumulation,
+	targetRevealage,
+	targetCount
+} OitTarget;
+
+/* ---- Globale Daten ---- */
+
+/** Steht OIT zur Verfuegung? */
+static int g_available = 0;
+
+/** Shader-Programme */
+static GLuint g_accumulationProgram = 0;
+static GLuint g_compositeProgram = 0;
+
+/** Framebuffer-Objekte und deren Farbtexturen, teilen sich einen Tiefenpuffer */
+static GLuint g_framebuffers[targetCount];
+static GLuint g_textures[targetCount];
+static GLuint g_depthBuffer = 0;
+
+/** Groesse der Puffer, 0 solange noch keine angelegt sind */
+static GLsizei g_width = 0;
+static GLsizei g_height = 0;
+
+/** Vor oit_beginOpaque gebundener Framebuffer */
+static GLint g_previousFramebuffer = 0;
+
+/* ---- Interne Funktionen ---- */
+
+/**
+ * Uebersetzt einen Fragment-Shader und bindet ihn in ein Programm.
+ *
+ * @param source Quelltext des Shaders (In)
+ * @return das Programm, 0 im Fehlerfall
+ */
+static GLuint createProgram(const char *source)
+{
+	GLuint shader = glCreateShader(GL_FRAGMENT_SHADER);
+	GLuint program = 0;
+	GLint status = GL_FALSE;
+	char log[1024];
+
+	glShaderSource(shader, 1, &source, NULL);
+	glCompileShader(shader);
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+
+	if (status)
+	{
+		program = glCreateProgram();
+		glAttachShader(program, shader);
+		glLinkProgram(program);
+		glGetProgramiv(program, GL_LINK_STATUS, &status);
+
+		if (!status)
+		{
+			glGetProgramInfoLog(program, sizeof(log), NULL, log);
+			fprintf(stderr, "OIT-Shader konnte nicht gelinkt werden:\n%s\n", log);
+			glDeleteProgram(program);
+			program = 0;
+		}
+	}
+	else
+	{
+		glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+		fprintf(stderr, "OIT-Shader konnte nicht uebersetzt werden:\n%s\n", log);
+	}
+
+	/* Wird erst mit dem Programm wirklich freigegeben */
+	glDeleteShader(shader);
+
+	return program;
+}
+
+/**
+ * Legt die Puffer in der gewuenschten Groesse (neu) an.
+ *
+ * @param width, height Groesse in Pixeln (In)
+ * @return 1, wenn alle Framebuffer-Objekte vollstaendig sind
+ */
+static int resizeTargets(GLsizei width, GLsizei height)
+{
+	/* Opake Szene mit 8 Bit, Summe und Revealage brauchen mehr Genauigkeit */
+	static const GLint formats[targetCount] = { GL_RGBA8, GL_RGBA16F, GL_RGBA16F };
+	static const GLenum types[targetCount] = { GL_UNSIGNED_BYTE, GL_FLOAT, GL_FLOAT };
+	GLint previousFramebuffer = 0;
+	int complete = 1;
+
+	glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+
+	glBindRenderbuffer(GL_RENDERBUFFER, g_depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	for (int i = 0; i < targetCount; i++)
+	{
+		glBindTexture(GL_TEXTURE_2D, g_textures[i]);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexImage2D(GL_TEXTURE_2D, 0, formats[i], width, height, 0, GL_RGBA, types[i], NULL);
+
+		glBindFramebuffer(GL_FRAMEBUFFER, g_framebuffers[i]);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, g_textures[i], 0);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, g_depthBuffer);
+
+		complete = complete && glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+	}
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+
+	g_width = width;
+	g_height = height;
+
+	return complete;
+}
+
+/**
+ * Bindet ein Render-Target und leert es mit der angegebenen Farbe.
+ *
+ * @param target das Render-Target (In)
+ * @param clearValue Farbe, mit der geleert wird (In)
+ * @param clearDepth soll auch der Tiefenpuffer geleert werden? (In)
+ */
+static void bindTarget(OitTarget target, GLfloat clearValue, GLboolean clearDepth)
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, g_framebuffers[target]);
+	glClearColor(clearValue, clearValue, clearValue, clearValue);
+	glClear(GL_COLOR_BUFFER_BIT | (clearDepth ? GL_DEPTH_BUFFER_BIT : 0));
+}
+
+/* ---- Oeffentliche Funktionen ---- */
+
+int oit_init(void)
+{
+	g_available = GLEW_VERSION_2_0
+	              && (GLEW_VERSION_3_0 || (GLEW_ARB_framebuffer_object && GLEW_ARB_texture_float));
+
+	if (g_available)
+	{
+		g_accumulationProgram = createProgram(ACCUMULATION_SHADER);
+		g_compositeProgram = createProgram(COMPOSITE_SHADER);
+		g_available = g_accumulationProgram && g_compositeProgram;
+	}
+
+	if (g_available)
+	{
+		glUseProgram(g_compositeProgram);
+		glUniform1i(glGetUniformLocation(g_compositeProgram, "opaque"), targetOpaque);
+		glUniform1i(glGetUniformLocation(g_compositeProgram, "accumulation"), targetAccumulation);
+		glUniform1i(glGetUniformLocation(g_compositeProgram, "revealage"), targetRevealage);
+		glUseProgram(0);
+
+		glGenFramebuffers(targetCount, g_framebuffers);
+		glGenTextures(targetCount, g_textures);
+		glGenRenderbuffers(1, &g_depthBuffer);
+
+		/* Nicht jeder Treiber kann in Float-Texturen rendern, die richtige
+		 * Groesse wird im ersten Frame angelegt */
+		g_available = resizeTargets(1, 1) && GLGETERROR == GL_NO_ERROR;
+	}
+
+	if (!g_available)
+	{
+		printf("OIT nicht verfuegbar, Wasser wird sortiert gezeichnet.\n");
+	}
+
+	return g_available;
+}
+
+int oit_available(void)
+{
+	return g_available;
+}
+
+void oit_beginOpaque(void)
+{
+	GLint viewport[4];
+
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	glGetIntegerv(GL_FRAMEBUFFER_BINDING, &g_previousFramebuffer);
+
+	if ((viewport[2] != g_width || viewport[3] != g_height)
+	    && !resizeTargets(viewport[2], viewport[3]))
+	{
+		CG_ERROR(("OIT-Framebuffer unvollstaendig (%dx%d)\n", viewport[2], viewport[3]));
+	}
+
+	/* Farbmaske (Anaglyph), Blending, Tiefenmaske und Viewport werden erst
+	 * beim Zusammensetzen wiederhergestellt */
+	glPushAttrib(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_VIEWPORT_BIT);
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	glViewport(0, 0, g_width, g_height);
+
+	bindTarget(targetOpaque, 0.0f, GL_TRUE);
+}
+
+void oit_beginAccumulation(void)
+{
+	bindTarget(targetAccumulation, 0.0f, GL_FALSE);
+
+	glUseProgram(g_accumulationProgram);
+	glDepthMask(GL_FALSE);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_ONE, GL_ONE);
+}
+
+void oit_beginRevealage(void)
+{
+	bindTarget(targetRevealage, 1.0f, GL_FALSE);
+
+	/* Jede Flaeche multipliziert die Durchlaessigkeit mit (1 - alpha) */
+	glUseProgram(0);
+	glBlendFunc(GL_ZERO, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void oit_composite(void)
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, g_previousFramebuffer);
+	glPopAttrib();
+
+	glPushAttrib(GL_ENABLE_BIT | GL_POLYGON_BIT | GL_TEXTURE_BIT);
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_LIGHTING);
+	glDisable(GL_BLEND);
+	glDisable(GL_CULL_FACE);
+	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+	for (int i = 0; i < targetCount; i++)
+	{
+		glActiveTexture(GL_TEXTURE0 + i);
+		glBindTexture(GL_TEXTURE_2D, g_textures[i]);
+	}
+
+	glUseProgram(g_compositeProgram);
+
+	glMatrixMode(GL_PROJECTION);
+	glPushMatrix();
+	glLoadIdentity();
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glLoadIdentity();
+
+	glBegin(GL_QUADS);
+	{
+		glTexCoord2f(0.0f, 0.0f);
+		glVertex2f(-1.0f, -1.0f);
+		glTexCoord2f(1.0f, 0.0f);
+		glVertex2f(1.0f, -1.0f);
+		glTexCoord2f(1.0f, 1.0f);
+		glVertex2f(1.0f, 1.0f);
+		glTexCoord2f(0.0f, 1.0f);
+		glVertex2f(-1.0f, 1.0f);
+	}
+	glEnd();
+
+	glPopMatrix();
+	glMatrixMode(GL_PROJECTION);
+	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
+
+	glUseProgram(0);
+
+	for (int i = targetCount - 1; i >= 0; i--)
+	{
+		glActiveTexture(GL_TEXTURE0 + i);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	glPopAttrib();
+}
@@ -0,0 +1,69 @@
+#ifndef __OIT_H__
+#define __OIT_H__
+/**
+ * @file
+ * Schnittstelle des OIT-Moduls.
+ * Das Modul setzt reihenfolgeunabhaengige Transparenz (Weighted Blended
+ * Order-Independent Transparency nach McGuire und Bavoil) um. Transparente
+ * Flaechen muessen damit nicht mehr nach ihrem Abstand zur Kamera sortiert
+ * werden.
+ *
+ * Ablauf je Bild:
+ *   oit_beginOpaque        undurchsichtige Szene in ein Framebuffer-Objekt zeichnen
+ *   oit_beginAccumulation  transparente Flaechen gewichtet aufsummieren
+ *   oit_beginRevealage     transparente Flaechen erneut zeichnen, Durchlaessigkeit multiplizieren
+ *   oit_composite          Ergebnis in den vorher gebundenen Framebuffer schreiben
+ *
+ * Benoetigt Framebuffer-Objekte, Float-Texturen und GLSL (OpenGL 3.0 oder
+ * entsprechende Erweiterungen). Fehlt etwas davon, meldet oit_available 0 und
+ * die Szene bleibt bei sortierter Transparenz.
+ *
+ * Bestandteil einer Uebung im Rahmen des Moduls Praktikum Grundlagen der Computergrafik
+ * an der FH Wedel.
+ *
+ * @author Nicolas Hollmann, Daniel Klintworth
+ */
+
+/* ---- Funktionen ---- */
+
+/**
+ * Prueft die benoetigten OpenGL-Funktionen und uebersetzt die Shader.
+ * Setzt einen aktuellen OpenGL-Kontext und initialisiertes GLEW voraus.
+ *
+ * @return 1, wenn OIT zur Verfuegung steht, sonst 0
+ */
+int oit_init(void);
+
+/**
+ * Prueft, ob OIT zur Verfuegung steht.
+ *
+ * @return 1, wenn OIT genutzt werden kann
+ */
+int oit_available(void);
+
+/**
+ * Bindet das Framebuffer-Objekt fuer die undurchsichtige Szene und leert es.
+ * Die Groesse richtet sich nach dem aktuellen Viewport, die Puffer werden bei
+ * Bedarf neu angelegt.
+ */
+void oit_beginOpaque(void);
+
+/**
+ * Bereitet das Zeichnen der transparenten Flaechen in den Akkumulationspuffer
+ * vor (Shader, Blending, keine Tiefenwerte schreiben).
+ */
+void oit_beginAccumulation(void);
+
+/**
+ * Bereitet das erneute Zeichnen der transparenten Flaechen in den Puffer fuer
+ * die Durchlaessigkeit (Revealage) vor.
+ */
+void oit_beginRevealage(void);
+
+/**
+ * Setzt undurchsichtige Szene und transparente Flaechen im zuvor gebundenen
+ * Framebuffer zusammen und stellt den OpenGL-Zustand wieder her.
+ */
+void oit_composite(void);
+
+#endif
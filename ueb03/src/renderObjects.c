@@ -38,23 +38,40 @@
 
 /* ---- Globale Variablen ---- */
 
+/**
+ * Einstellungen, von denen die Objekte abhaengen (RO_VARIANT_...). Nur
+ * diese gehen in die Variante ein, ein Objekt ohne Abhaengigkeiten wird
+ * also nur einmal aufgezeichnet.
+ */
+static const unsigned g_dependencies[RO_SIZE] = {
+	RO_VARIANT_NORMALS,                         /* RO_PLAYER */
+	RO_VARIANT_NORMALS,                         /* RO_CAKE */
+	RO_VARIANT_NORMALS | RO_VARIANT_UNDIVIDED,  /* RO_WALL */
+	RO_VARIANT_NORMALS | RO_VARIANT_UNDIVIDED,  /* RO_FREE */
+	RO_VARIANT_NORMALS | RO_VARIANT_UNDIVIDED,  /* RO_GOAL */
+	RO_VARIANT_NORMALS | RO_VARIANT_UNDIVIDED,  /* RO_WATER */
+	RO_VARIANT_NORMALS,                         /* RO_SANDBAG */
+	RO_VARIANT_NORMALS | RO_VARIANT_UNDIVIDED   /* RO_SUGAR */
+};
+
 /** 
- * Speichert die erste Displayliste und macht
- * damit alle weiteren Zugreifbar.
+ * Displaylisten je Objekt und Variante, 0 solange die Variante
+ * noch nicht aufgezeichnet wurde.
  */
-GLuint g_renderObjects = 0;
+static GLuint g_renderObjects[RO_SIZE][RO_VARIANT_COUNT];
 
 /* ---- Interne Funktionen ---- */
 
 /**
- * Gibt die ID einer Displayliste anhand eines Objektes zurueck.
+ * Gibt die Displayliste eines Objektes fuer die aktuellen Einstellungen zurueck.
  * 
  * @param renderObject das gewuenschte Objekt (In)
- * @return die ID der Displayliste
+ * @return Zeiger auf die ID der Displayliste, die ID ist 0, wenn sie noch
+ *         nicht aufgezeichnet wurde
  */
-static GLuint getRenderObject(RenderObject renderObject)
+static GLuint *getRenderObject(RenderObject renderObject)
 {
-	return g_renderObjects + renderObject;
+	return &g_renderObjects[renderObject][getRenderVariant() & g_dependencies[renderObject]];
 }
 
 /**
@@ -306,7 +323,7 @@ static void drawTileWall(void)
 		setDiffuseMaterial(0.63f, 0.137f, 0.168f);
 		setSpecularMaterial(0.3f, 0.3f, 0.3f, 15.0f);
 
-		drawSquare(TILE_SUBDIVS);
+		drawSquare(getTileSubdivs());
 
 
 		setDiffuseMaterial(0.9f, 0.9f, 0.9f);
@@ -371,7 +388,7 @@ static void drawTileFree(void)
 
 	glPushMatrix();
 	{
-		drawSquare(TILE_SUBDIVS);
+		drawSquare(getTileSubdivs());
 	}
 	glPopMatrix();
 }
@@ -386,7 +403,7 @@ static void drawTileGoal(void)
 
 	glPushMatrix();
 	{
-		drawSquare(TILE_SUBDIVS);
+		drawSquare(getTileSubdivs());
 	}
 	glPopMatrix();
 }
@@ -401,7 +418,7 @@ static void drawTileWater()
 		setDiffuseMaterial(0.2f, 0.5f, 0.8f);
 		setSpecularMaterial(0.4f, 0.4f, 0.4f, 80.0f);
 
-		drawSquare(TILE_SUBDIVS);
+		drawSquare(getTileSubdivs());
 
 		setDiffuseMaterial(0.0f, 0.2f, 0.8f);
 		setSpecularMaterial(0.8f, 0.8f, 1.0f, 120.0f);
@@ -455,7 +472,7 @@ static void drawTileSugar()
 	{
 		setDiffuseMaterial(1.0f, 1.0f, 1.0f);
 		setSpecularMaterial(0.0f, 0.0f, 0.0f, 0.0f);
-		drawSquare(TILE_SUBDIVS);
+		drawSquare(getTileSubdivs());
 
 		setDiffuseMaterial(0.4f, 0.4f, 0.4f);
 		setSpecularMaterial(1.0f, 1.0f, 1.0f, 120.0f);
@@ -475,6 +492,44 @@ static void drawTileSugar()
 	glPopMatrix();
 }
 
+/**
+ * Zeichnet ein Objekt direkt, beim Aufzeichnen seiner Displayliste.
+ * 
+ * @param object das Objekt (In)
+ */
+static void drawRenderObject(RenderObject object)
+{
+	switch (object)
+	{
+		case RO_PLAYER:
+			drawPlayer();
+			break;
+		case RO_CAKE:
+			drawCake();
+			break;
+		case RO_WALL:
+			drawTileWall();
+			break;
+		case RO_FREE:
+			drawTileFree();
+			break;
+		case RO_GOAL:
+			drawTileGoal();
+			break;
+		case RO_WATER:
+			drawTileWater();
+			break;
+		case RO_SANDBAG:
+			drawTileSandbag();
+			break;
+		case RO_SUGAR:
+			drawTileSugar();
+			break;
+		case RO_SIZE:
+			break;
+	}
+}
+
 /* ---- Oeffentliche Funktionen ---- */
 
 void drawSquare(int subDivs)
@@ -525,58 +580,65 @@ void drawWaterWave(float x, float y, float z)
 
 void initDisplayList(void) 
 {
-	if (g_renderObjects != 0)
+	for (int object = 0; object < RO_SIZE; object++)
 	{
-		glDeleteLists(g_renderObjects, (GLsizei) RO_SIZE);
-	}
-
-    // Alle benoetigten Listen auf einmal erzeugen
-	g_renderObjects = glGenLists((GLsizei) RO_SIZE);
-	if (g_renderObjects != 0) {
-		for (GLuint index = 0; index < RO_SIZE; index++)
+		for (int variant = 0; variant < RO_VARIANT_COUNT; variant++)
 		{
-            // Displayliste bereit machen
-			glNewList(g_renderObjects + index, GL_COMPILE);
-			
-			switch (index)
+			if (g_renderObjects[object][variant] != 0)
 			{
-				case RO_PLAYER:
-					drawPlayer();
-					break;
-				case RO_CAKE:
-					drawCake();
-					break;
-				case RO_WALL:
-					drawTileWall();
-					break;
-				case RO_FREE:
-					drawTileFree();
-					break;
-				case RO_GOAL:
-					drawTileGoal();
-					break;
-				case RO_WATER:
-					drawTileWater();
-					break;
-				case RO_SANDBAG:
-					drawTileSandbag();
-					break;
-				case RO_SUGAR:
-					drawTileSugar();
-					break;
+				glDeleteLists(g_renderObjects[object][variant], 1);
+				g_renderObjects[object][variant] = 0;
 			}
+		}
+	}
+}
 
-            // Displayliste abschliessen
-			glEndList();
+unsigned getRenderVariant(void)
+{
+	return (getNormalState() ? RO_VARIANT_NORMALS : 0u)
+	       | (getTileSubdivs() == 0 ? RO_VARIANT_UNDIVIDED : 0u);
+}
+
+void prepareRenderObject(RenderObject object)
+{
+	GLuint *list = getRenderObject(object);
+
+	if (*list == 0)
+	{
+		*list = glGenLists(1);
+		if (*list == 0)
+		{
+			CG_ERROR(("Konnte Displaylisten nicht erzeugen\n"));
 		}
-	} else {
-		CG_ERROR(("Konnte Displaylisten nicht erzeugen\n"));
+
+		glNewList(*list, GL_COMPILE);
+		drawRenderObject(object);
+		glEndList();
 	}
 }
 
 void renderObject(RenderObject object)
 {
-    glCallList(getRenderObject(object));
+	GLuint list = *getRenderObject(object);
+
+	if (list == 0)
+	{
+		GLint recording = 0;
+
+		/* Displaylisten lassen sich nicht verschachtelt aufzeichnen, dann
+		 * landet das Objekt direkt in der gerade aufgezeichneten Liste */
+		glGetIntegerv(GL_LIST_INDEX, &recording);
+		if (recording != 0)
+		{
+			drawRenderObject(object);
+			return;
+		}
+
+		prepareRenderObject(object);
+		list = *getRenderObject(object);
+	}
+
+	glCallList(list);
 }
 
 void setDiffuseMaterialAlpha(float r, float g, float b, float a)
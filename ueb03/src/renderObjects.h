@@ -12,6 +12,15 @@
  * @author Nicolas Hollmann, Daniel Klintworth
  */
 
+/* ---- Konstanten ---- */
+
+/* Einstellungen, von denen Displaylisten abhaengen, als Bitmaske */
+#define RO_VARIANT_NORMALS   (1u << 0) /* Normalen werden angezeigt */
+#define RO_VARIANT_UNDIVIDED (1u << 1) /* Kacheln werden nicht unterteilt */
+
+/* Anzahl der moeglichen Varianten eines Objekts */
+#define RO_VARIANT_COUNT (4)
+
 /* ---- Datentypen ---- */
 
 /* Aufzaehlungstyp fuer alle Objekte in Display Listen */
@@ -46,12 +55,32 @@ void drawSquare(int subDivs);
 void drawWaterWave(float x, float y, float z);
 
 /**
- * Initialisiert die Display Liste mit allen Objekten.
+ * Verwirft alle aufgezeichneten Display Listen. Jedes Objekt wird erst beim
+ * ersten Zeichnen aufgezeichnet, und zwar nur fuer die Einstellungen, von
+ * denen es abhaengt. Die Listen aller Varianten bleiben danach erhalten, ein
+ * Umschalten der Einstellungen zeichnet also nichts neu auf.
  */
 void initDisplayList(void);
 
 /**
- * Rendert ein Objekt aus einer Display Liste.
+ * Ermittelt die Variante der Display Listen fuer die aktuellen Einstellungen.
+ * 
+ * @return die Variante als Bitmaske aus RO_VARIANT_...
+ */
+unsigned getRenderVariant(void);
+
+/**
+ * Zeichnet die Display Liste eines Objekts fuer die aktuellen Einstellungen
+ * auf, falls sie noch fehlt. Darf nicht waehrend einer anderen Aufzeichnung
+ * aufgerufen werden.
+ * 
+ * @param object das Objekt (In)
+ */
+void prepareRenderObject(RenderObject object);
+
+/**
+ * Rendert ein Objekt aus einer Display Liste. Fehlt die Liste fuer die
+ * aktuellen Einstellungen, wird sie vorher aufgezeichnet.
  * 
  * @param object das Objekt, das gerendert werden soll (In)
  */
@@ -28,28 +28,57 @@
 /* ---- Eigene Header einbinden ---- */
 #include "renderObjects3D.h"
 #include "renderObjects.h"
+#include "scene.h"
 #include "types.h"
 #include "debugGL.h"
 
 /* ---- Globale Variablen ---- */
 
+/** Einstellungen, von denen die 3D Objekte abhaengen (RO_VARIANT_...) */
+static const unsigned g_dependencies3D[RO_3D_SIZE] = {
+	RO_VARIANT_NORMALS,                         /* RO_3D_PLAYER */
+	RO_VARIANT_NORMALS | RO_VARIANT_UNDIVIDED,  /* RO_3D_WALL */
+	RO_VARIANT_NORMALS | RO_VARIANT_UNDIVIDED,  /* RO_3D_FREE */
+	RO_VARIANT_NORMALS | RO_VARIANT_UNDIVIDED,  /* RO_3D_GOAL */
+	0,                                          /* RO_3D_WATER */
+	RO_VARIANT_NORMALS | RO_VARIANT_UNDIVIDED,  /* RO_3D_SANDFLOOR */
+	0,                                          /* RO_3D_SANDBAG */
+	RO_VARIANT_NORMALS | RO_VARIANT_UNDIVIDED   /* RO_3D_SUGAR */
+};
+
+/**
+ * 2D Objekte, deren Display Listen die 3D Objekte aufrufen. RO_SIZE, wenn
+ * das 3D Objekt keines nutzt.
+ */
+static const RenderObject g_baseObjects3D[RO_3D_SIZE] = {
+	RO_SIZE,   /* RO_3D_PLAYER */
+	RO_WALL,   /* RO_3D_WALL */
+	RO_FREE,   /* RO_3D_FREE */
+	RO_GOAL,   /* RO_3D_GOAL */
+	RO_SIZE,   /* RO_3D_WATER */
+	RO_SIZE,   /* RO_3D_SANDFLOOR */
+	RO_SIZE,   /* RO_3D_SANDBAG */
+	RO_SUGAR   /* RO_3D_SUGAR */
+};
+
 /** 
- * Speichert die erste Displayliste und macht
- * damit alle weiteren Zugreifbar.
+ * Displaylisten je 3D Objekt und Variante, 0 solange die Variante
+ * noch nicht aufgezeichnet wurde.
  */
-GLuint g_renderObjects3D = 0;
+static GLuint g_renderObjects3D[RO_3D_SIZE][RO_VARIANT_COUNT];
 
 /* ---- Interne Funktionen ---- */
 
 /**
- * Gibt die ID einer Displayliste anhand eines Objektes zurueck.
+ * Gibt die Displayliste eines 3D Objektes fuer die aktuellen Einstellungen zurueck.
  * 
  * @param renderObject das gewuenschte Objekt (In)
- * @return die ID der Displayliste
+ * @return Zeiger auf die ID der Displayliste, die ID ist 0, wenn sie noch
+ *         nicht aufgezeichnet wurde
  */
-static GLuint getRenderObject3D(RenderObject3D renderObject)
+static GLuint *getRenderObject3D(RenderObject3D renderObject)
 {
-	return g_renderObjects3D + renderObject;
+	return &g_renderObjects3D[renderObject][getRenderVariant() & g_dependencies3D[renderObject]];
 }
 
 /* Zeichnet einen Wuerfel mit 6 Oberflaechen. */
@@ -190,7 +219,7 @@ static void drawTileSandfloor(void)
 		glNormal3f(0.0f, 1.0f, 0.0f);
 		glTranslatef(0.0f, -0.5f, 0.0f);
 		glRotatef(-90, 1.0f, 0.0f, 0.0f);
-		drawSquare(TILE_SUBDIVS);
+		drawSquare(getTileSubdivs());
 	}
 	glPopMatrix();
 }
@@ -325,60 +354,120 @@ static void drawTileWater(void)
 	glPopMatrix();
 }
 
-/* ---- Oeffentliche Funktionen ---- */
+/**
+ * Zeichnet ein 3D Objekt direkt, beim Aufzeichnen seiner Displayliste.
+ * 
+ * @param object das 3D Objekt (In)
+ */
+static void drawRenderObject3D(RenderObject3D object)
+{
+	switch (object)
+	{
+		case RO_3D_PLAYER:
+			drawPlayer();
+			break;
+		case RO_3D_WALL:
+			drawTileCube(RO_WALL);
+			break;
+		case RO_3D_FREE:
+			drawTileFloor(RO_FREE);
+			break;
+		case RO_3D_GOAL:
+			drawTileFloor(RO_GOAL);
+			break;
+		case RO_3D_WATER:
+			drawTileWater();
+			break;
+		case RO_3D_SANDFLOOR:
+			drawTileSandfloor();
+			break;
+		case RO_3D_SANDBAG:
+			drawTileSandbag();
+			break;
+		case RO_3D_SUGAR:
+			drawTileCube(RO_SUGAR);
+			break;
+		case RO_3D_SIZE:
+			break;
+	}
+}
 
-void initDisplayList3D(void) 
+/**
+ * Zeichnet die Displayliste eines 3D Objektes fuer die aktuellen
+ * Einstellungen auf, falls sie noch fehlt. Das genutzte 2D Objekt wird
+ * vorher aufgezeichnet, weil Aufzeichnungen nicht verschachtelt werden
+ * koennen.
+ * 
+ * @param object das 3D Objekt (In)
+ */
+static void prepareRenderObject3D(RenderObject3D object)
 {
-	if (g_renderObjects3D != 0)
+	GLuint *list = getRenderObject3D(object);
+
+	if (*list == 0)
 	{
-		glDeleteLists(g_renderObjects3D, (GLsizei) RO_3D_SIZE);
+		if (g_baseObjects3D[object] != RO_SIZE)
+		{
+			prepareRenderObject(g_baseObjects3D[object]);
+		}
+
+		*list = glGenLists(1);
+		if (*list == 0)
+		{
+			CG_ERROR(("Konnte 3D Displaylisten nicht erzeugen\n"));
+		}
+
+		glNewList(*list, GL_COMPILE);
+		drawRenderObject3D(object);
+		glEndList();
 	}
+}
+
+/* ---- Oeffentliche Funktionen ---- */
 
-    // Alle benoetigten Listen auf einmal erzeugen
-	g_renderObjects3D = glGenLists((GLsizei) RO_3D_SIZE);
-	if (g_renderObjects3D != 0) {
-		for (GLuint index = 0; index < RO_3D_SIZE; index++)
+void initDisplayList3D(void) 
+{
+	for (int object = 0; object < RO_3D_SIZE; object++)
+	{
+		for (int variant = 0; variant < RO_VARIANT_COUNT; variant++)
 		{
-            // Displayliste bereit machen
-			glNewList(g_renderObjects3D + index, GL_COMPILE);
-			
-			switch (index)
+			if (g_renderObjects3D[object][variant] != 0)
 			{
-				case RO_3D_PLAYER:
-					drawPlayer();
-					break;
-				case RO_3D_WALL:
-					drawTileCube(RO_WALL);
-					break;
-				case RO_3D_FREE:
-					drawTileFloor(RO_FREE);
-					break;
-				case RO_3D_GOAL:
-					drawTileFloor(RO_GOAL);
-					break;
-				case RO_3D_WATER:
-					drawTileWater();
-					break;
-				case RO_3D_SANDFLOOR:
-					drawTileSandfloor();
-					break;
-				case RO_3D_SANDBAG:
-					drawTileSandbag();
-					break;
-				case RO_3D_SUGAR:
-					drawTileCube(RO_SUGAR);
-					break;
+				glDeleteLists(g_renderObjects3D[object][variant], 1);
+				g_renderObjects3D[object][variant] = 0;
 			}
-
-            // Displayliste abschliessen
-			glEndList();
 		}
-	} else {
-		CG_ERROR(("Konnte 3D Displaylisten nicht erzeugen\n"));
+	}
+}
+
+void prepareDisplayList3D(void)
+{
+	for (int object = 0; object < RO_3D_SIZE; object++)
+	{
+		prepareRenderObject3D((RenderObject3D) object);
 	}
 }
 
 void renderObject3D(RenderObject3D object)
 {
-    glCallList(getRenderObject3D(object));
+	GLuint list = *getRenderObject3D(object);
+
+	if (list == 0)
+	{
+		GLint recording = 0;
+
+		/* Displaylisten lassen sich nicht verschachtelt aufzeichnen, dann
+		 * landet das Objekt direkt in der gerade aufgezeichneten Liste */
+		glGetIntegerv(GL_LIST_INDEX, &recording);
+		if (recording != 0)
+		{
+			drawRenderObject3D(object);
+			return;
+		}
+
+		prepareRenderObject3D(object);
+		list = *getRenderObject3D(object);
+	}
+
+	glCallList(list);
 }
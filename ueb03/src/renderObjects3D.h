@@ -31,12 +31,21 @@ typedef enum {
 /* ---- Funktionen ---- */
 
 /**
- * Initialisiert die 3D Display Liste mit allen Objekten.
+ * Verwirft alle aufgezeichneten 3D Display Listen. Wie bei initDisplayList
+ * wird jedes Objekt erst beim ersten Zeichnen je Variante aufgezeichnet.
  */
 void initDisplayList3D(void);
 
 /**
- * Rendert ein 3D Objekt aus einer Display Liste.
+ * Zeichnet die 3D Display Listen aller Objekte fuer die aktuellen
+ * Einstellungen auf, soweit sie noch fehlen. Muss vor dem Aufzeichnen von
+ * Listen aufgerufen werden, die 3D Objekte nutzen.
+ */
+void prepareDisplayList3D(void);
+
+/**
+ * Rendert ein 3D Objekt aus einer Display Liste. Fehlt die Liste fuer die
+ * aktuellen Einstellungen, wird sie vorher aufgezeichnet.
  * 
  * @param object das 3D Objekt, das gerendert werden soll (In)
  */
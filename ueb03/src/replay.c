@@ -0,0 +1,338 @@
+/**
+ * @file
+ * Replay-Modul.
+ * Zeichnet Eingabeereignisse und Zeitschritte auf und spielt sie wieder ab.
+ * Eine Aufzeichnung wird fuer die Wiedergabe komplett eingelesen, damit
+ * waehrend der Messung keine Dateizugriffe stattfinden.
+ *
+ * Bestandteil einer Uebung im Rahmen des Moduls Praktikum Grundlagen der Computergrafik
+ * an der FH Wedel.
+ *
+ * @author Nicolas Hollmann, Daniel Klintworth
+ */
+
+/* ---- System Header einbinden ---- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ---- Eigene Header einbinden ---- */
+#include "replay.h"
+
+/* ---- Konstanten ---- */
+
+/** Kennung in der ersten Zeile einer Aufzeichnung */
+#define REPLAY_MAGIC "CGREPLAY 1"
+
+/** Maximale Laenge einer Zeile der Aufzeichnung */
+#define REPLAY_LINE_LENGTH (256)
+
+/* ---- Typen ---- */
+
+/** Betriebsart des Moduls */
+typedef enum {
+	modeOff,
+	modeRecord,
+	modePlayback
+} ReplayMode;
+
+/** Art eines aufgezeichneten Ereignisses */
+typedef enum {
+	eventKeyboard,
+	eventMouse
+} ReplayEventType;
+
+/** Ein aufgezeichnetes Ereignis */
+typedef struct {
+	/** Art des Ereignisses */
+	ReplayEventType type;
+	/** Logik-Schritt, vor dem das Ereignis ausgeloest wird */
+	unsigned long tick;
+	/** Parameter in der Reihenfolge der Behandlungsfunktion */
+	int args[5];
+} ReplayEvent;
+
+/* ---- Globale Daten ---- */
+
+/** Aktuelle Betriebsart */
+static ReplayMode g_mode = modeOff;
+
+/** Behandlung der Tastaturereignisse */
+static ReplayKeyboardHandler g_keyboardHandler = NULL;
+
+/** Behandlung der Mausereignisse */
+static ReplayMouseHandler g_mouseHandler = NULL;
+
+/** Anzahl der bisher begonnenen Logik-Schritte */
+static unsigned long g_tick = 0;
+
+/** Datei der laufenden Aufzeichnung */
+static FILE *g_recordFile = NULL;
+
+/** Aufgezeichnete Saat fuer die Wiedergabe */
+static unsigned g_seed = 0;
+
+/** Ereignisse der Wiedergabe */
+static ReplayEvent *g_events = NULL;
+
+/** Anzahl der Ereignisse der Wiedergabe */
+static unsigned long g_eventCount = 0;
+
+/** Naechstes auszuloesendes Ereignis der Wiedergabe */
+static unsigned long g_nextEvent = 0;
+
+/** Zeitschritte der Wiedergabe */
+static double *g_intervals = NULL;
+
+/** Anzahl der Zeitschritte der Wiedergabe */
+static unsigned long g_tickCount = 0;
+
+/* ---- Interne Funktionen ---- */
+
+/**
+ * Schliesst die Aufzeichnung beim Programmende.
+ */
+static void closeRecording(void)
+{
+	if (g_recordFile != NULL)
+	{
+		fclose(g_recordFile);
+		g_recordFile = NULL;
+	}
+}
+
+/**
+ * Gibt die Daten der Wiedergabe beim Programmende frei.
+ */
+static void freePlayback(void)
+{
+	free(g_events);
+	g_events = NULL;
+	free(g_intervals);
+	g_intervals = NULL;
+}
+
+/**
+ * Haengt ein Element an ein dynamisches Array an und vergroessert es bei
+ * Bedarf auf die doppelte Kapazitaet.
+ *
+ * @param array das Array (InOut)
+ * @param count Anzahl der belegten Elemente (InOut)
+ * @param capacity Kapazitaet des Arrays (InOut)
+ * @param size Groesse eines Elements in Bytes (In)
+ * @return Zeiger auf das neue Element, NULL wenn kein Speicher frei ist
+ */
+static void *append(void **array, unsigned long *count, unsigned long *capacity, size_t size)
+{
+	if (*count == *capacity)
+	{
+		unsigned long newCapacity = *capacity ? *capacity * 2 : 1024;
+		void *newArray = realloc(*array, newCapacity * size);
+
+		if (newArray == NULL)
+		{
+			return NULL;
+		}
+
+		*array = newArray;
+		*capacity = newCapacity;
+	}
+
+	return (char *)*array + (*count)++ * size;
+}
+
+/**
+ * Loest ein Ereignis der Wiedergabe aus.
+ *
+ * @param event das Ereignis (In)
+ */
+static void dispatchEvent(const ReplayEvent *event)
+{
+	const int *a = event->args;
+
+	if (event->type == eventKeyboard && g_keyboardHandler != NULL)
+	{
+		g_keyboardHandler(a[0], a[1], a[2], a[3], a[4]);
+	}
+	else if (event->type == eventMouse && g_mouseHandler != NULL)
+	{
+		g_mouseHandler(a[0], a[1], a[2], a[3], a[4]);
+	}
+}
+
+/* ---- Oeffentliche Funktionen ---- */
+
+void replay_setHandlers(ReplayKeyboardHandler keyboard, ReplayMouseHandler mouse)
+{
+	g_keyboardHandler = keyboard;
+	g_mouseHandler = mouse;
+}
+
+int replay_startRecording(const char *filename, int width, int height)
+{
+	g_recordFile = fopen(filename, "w");
+
+	if (g_recordFile == NULL)
+	{
+		fprintf(stderr, "Aufzeichnung %s konnte nicht angelegt werden.\n", filename);
+		return 0;
+	}
+
+	fprintf(g_recordFile, REPLAY_MAGIC "\nsize %d %d\n", width, height);
+
+	g_mode = modeRecord;
+	atexit(closeRecording);
+
+	return 1;
+}
+
+int replay_startPlayback(const char *filename, int *width, int *height)
+{
+	FILE *file = fopen(filename, "r");
+	char line[REPLAY_LINE_LENGTH];
+	unsigned long eventCapacity = 0;
+	unsigned long tickCapacity = 0;
+	int success = 1;
+
+	if (file == NULL)
+	{
+		fprintf(stderr, "Aufzeichnung %s konnte nicht geoeffnet werden.\n", filename);
+		return 0;
+	}
+
+	if (fgets(line, sizeof(line), file) == NULL
+	    || strncmp(line, REPLAY_MAGIC, strlen(REPLAY_MAGIC)) != 0)
+	{
+		fprintf(stderr, "%s ist keine Aufzeichnung.\n", filename);
+		fclose(file);
+		return 0;
+	}
+
+	atexit(freePlayback);
+
+	while (success && fgets(line, sizeof(line), file) != NULL)
+	{
+		ReplayEvent event;
+		unsigned long tick;
+		double interval;
+		int *a = event.args;
+
+		if (sscanf(line, "size %d %d", width, height) == 2
+		    || sscanf(line, "seed %u", &g_seed) == 1)
+		{
+			/* Kopfdaten, nichts weiter zu tun */
+		}
+		else if (sscanf(line, "K %lu %d %d %d %d %d",
+		                &event.tick, &a[0], &a[1], &a[2], &a[3], &a[4]) == 6
+		         || sscanf(line, "M %lu %d %d %d %d %d",
+		                   &event.tick, &a[0], &a[1], &a[2], &a[3], &a[4]) == 6)
+		{
+			ReplayEvent *slot = append((void **)&g_events, &g_eventCount,
+			                           &eventCapacity, sizeof(ReplayEvent));
+
+			event.type = (line[0] == 'K') ? eventKeyboard : eventMouse;
+			success = (slot != NULL);
+
+			if (success)
+			{
+				*slot = event;
+			}
+		}
+		else if (sscanf(line, "T %lu %lf", &tick, &interval) == 2 && tick == g_tickCount)
+		{
+			double *slot = append((void **)&g_intervals, &g_tickCount,
+			                      &tickCapacity, sizeof(double));
+
+			success = (slot != NULL);
+
+			if (success)
+			{
+				*slot = interval;
+			}
+		}
+		else
+		{
+			fprintf(stderr, "Fehlerhafte Zeile in %s: %s", filename, line);
+			success = 0;
+		}
+	}
+
+	fclose(file);
+
+	if (success)
+	{
+		g_mode = modePlayback;
+	}
+
+	return success;
+}
+
+unsigned replay_seed(unsigned seed)
+{
+	if (g_mode == modePlayback)
+	{
+		return g_seed;
+	}
+
+	if (g_mode == modeRecord)
+	{
+		fprintf(g_recordFile, "seed %u\n", seed);
+	}
+
+	return seed;
+}
+
+void replay_keyboardEvent(int key, int status, int isSpecialKey, int x, int y)
+{
+	if (g_mode != modePlayback)
+	{
+		if (g_mode == modeRecord)
+		{
+			fprintf(g_recordFile, "K %lu %d %d %d %d %d\n",
+			        g_tick, key, status, isSpecialKey, x, y);
+		}
+
+		g_keyboardHandler(key, status, isSpecialKey, x, y);
+	}
+}
+
+void replay_mouseEvent(int x, int y, int eventType, int button, int state)
+{
+	if (g_mode != modePlayback)
+	{
+		if (g_mode == modeRecord)
+		{
+			fprintf(g_recordFile, "M %lu %d %d %d %d %d\n",
+			        g_tick, x, y, eventType, button, state);
+		}
+
+		g_mouseHandler(x, y, eventType, button, state);
+	}
+}
+
+double replay_tick(double interval)
+{
+	if (g_mode == modeRecord)
+	{
+		/* 17 signifikante Stellen geben jeden double exakt wieder */
+		fprintf(g_recordFile, "T %lu %.17g\n", g_tick, interval);
+	}
+	else if (g_mode == modePlayback)
+	{
+		while (g_nextEvent < g_eventCount && g_events[g_nextEvent].tick <= g_tick)
+		{
+			dispatchEvent(&g_events[g_nextEvent++]);
+		}
+
+		interval = (g_tick < g_tickCount) ? g_intervals[g_tick] : 0.0;
+	}
+
+	g_tick++;
+
+	return interval;
+}
+
+int replay_finished(void)
+{
+	return g_mode == modePlayback && g_tick >= g_tickCount;
+}
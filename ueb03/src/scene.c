@@ -11,6 +11,8 @@
  */
 
 /* ---- System Header einbinden ---- */
+#include <stdlib.h>
+
 #ifdef WIN32
 #include <windows.h>
 #endif
@@ -27,12 +29,17 @@
 #include "renderObjects3D.h"
 #include "logic.h"
 #include "water.h"
+#include "oit.h"
+#include "lighting.h"
 #include "debugGL.h"
+#include "matrix.h"
+#include "frametime.h"
 
 /* ---- Konstanten ---- */
 
-/* Die Groesse einer einzelnen Kachel */
-#define TILE_SIZE (2.0f / LEVELSIZE)
+/* Hoechstens so viele Kacheln werden in 2D je Richtung angezeigt, bei
+ * groesseren Leveln folgt der Ausschnitt dem Spieler */
+#define VIEW_TILES (32)
 
 /* Das Punktlicht fuer die Beleuchtung der Welt */
 #define LIGHT_WORLD (GL_LIGHT0)
@@ -43,10 +50,83 @@
 /* Konstante fuer die Differenz zum Unterbinden von Z-Fighting */
 #define Z_EPSILON (0.0006f)
 
+/* Kantenlaenge eines Chunks der statischen Levelgeometrie in Kacheln */
+#define CHUNK_SIZE (8)
+
+/* Hoechstens so viele Chunks werden in 3D je Richtung gezeichnet, bei
+ * groesseren Leveln folgt der Ausschnitt dem Spieler */
+#define VIEW_CHUNKS (8)
+
+/* Kantenlaenge des 3D-Ausschnitts in Kacheln */
+#define VIEW_TILES_3D (VIEW_CHUNKS * CHUNK_SIZE)
+
+/* Breite des Bildausschnitts in Pixeln, der von einem Sichtstrahl abgedeckt wird */
+#define VISIBILITY_RAY_PIXELS (4)
+
+/* Mindestanzahl an Sichtstrahlen, auch bei sehr kleinen Fenstern */
+#define VISIBILITY_MIN_RAYS (16)
+
+/* ---- Typen ---- */
+
+/** Einmal je Frame bestimmte Kameradaten, fuer beide Augen gleich. */
+typedef struct {
+    CGMatrix4f view; // Kameramatrix des mittleren Auges
+    float center[2]; // Mitte des 3D-Ausschnitts (x, z)
+    float player[2]; // Position des Spielers samt Animation (x, z)
+    float playerDir[2]; // Blickrichtung des Spielers (x, z)
+    GLboolean orderIndependent; // Wasser per OIT statt sortiert zeichnen?
+} SceneFrame;
+
 /* ---- Globale Daten ---- */
 
 static SceneFlags g_sceneFlags = SCENE_FLAGS_DEFAULT;
 
+/* Kameradaten des aktuellen Frames, siehe prepareScene3D */
+static SceneFrame g_frame;
+
+/* Anzahl der Chunks je Richtung im aktuellen Level */
+static int g_chunkCount[2] = {0, 0};
+
+/* Displaylisten der Chunks (zeilenweise), 0 fuer Chunks ohne Liste */
+static GLuint *g_chunkLists = NULL;
+
+/* Chunks, deren Displayliste neu erzeugt werden muss */
+static GLboolean *g_chunkDirty = NULL;
+
+/* Alle Chunks muessen neu erzeugt werden, z.B. nach dem Neuerzeugen der Objekte */
+static GLboolean g_allChunksDirty = GL_TRUE;
+
+/* 3D-Ausschnitt in Chunks, jeweils erster und hinter letztem in x- und y-Richtung */
+static int g_viewChunkStart[2] = {0, 0};
+static int g_viewChunkEnd[2] = {0, 0};
+
+/* 3D-Ausschnitt des letzten Frames, dessen Chunks haben eine Displayliste */
+static int g_lastChunkStart[2] = {0, 0};
+static int g_lastChunkEnd[2] = {0, 0};
+
+/* 3D-Ausschnitt in Kacheln, erste und hinter letzter */
+static int g_viewStart[2] = {0, 0};
+static int g_viewEnd[2] = {0, 0};
+
+/* Faces aller Wasserfelder im 3D-Ausschnitt, bleibt ueber Frames erhalten und sortiert */
+static WaterFaceList g_waterList = EMPTY_WATER_FACE_LIST;
+
+/* Werden Seiten zwischen zwei Wasserfeldern weggelassen? */
+static GLboolean g_waterCulling = GL_TRUE;
+
+/* Sichtbare Kacheln des 3D-Ausschnitts in der Ego-Perspektive: eine Kachel
+ * ist sichtbar, wenn ihr Eintrag dem aktuellen Durchlauf entspricht (spart
+ * das Leeren) */
+static unsigned g_visibleStamp[VIEW_TILES_3D][VIEW_TILES_3D];
+
+/* Aktueller Durchlauf der Sichtbarkeitsberechnung */
+static unsigned g_visibilityPass = 0;
+
+/* Sichtbare Kacheln in der Reihenfolge ihrer Entdeckung */
+static int g_visibleCount = 0;
+static int g_visibleX[VIEW_TILES_3D * VIEW_TILES_3D];
+static int g_visibleY[VIEW_TILES_3D * VIEW_TILES_3D];
+
 /* ---- Interne Funktionen ---- */
 
 static void initLight(void)
@@ -74,6 +154,37 @@ static void initLight(void)
 	glEnable(LIGHT_SPOTLIGHT);
 }
 
+/**
+ * Bestimmt den in 2D anzuzeigenden Ausschnitt eines Levels. Kleine Level
+ * werden ganz angezeigt, bei grossen folgt ein Ausschnitt von VIEW_TILES
+ * Kacheln dem Spieler. Der Aufwand beim Zeichnen haengt so nicht von der
+ * Levelgroesse ab.
+ * 
+ * @param gamestage der Spielzustand (In)
+ * @param start Erste Kachel des Ausschnitts in x- und y-Richtung (Out)
+ * @param size Anzahl Kacheln des Ausschnitts in x- und y-Richtung (Out)
+ */
+static void getViewWindow(Gamestate *gamestate, int start[2], int size[2])
+{
+	int levelSize[2] = { gamestate->levelWidth, gamestate->levelHeight };
+	int player[2] = { gamestate->playerX, gamestate->playerY };
+
+	for (int i = 0; i < 2; i++)
+	{
+		size[i] = (levelSize[i] < VIEW_TILES) ? levelSize[i] : VIEW_TILES;
+		start[i] = player[i] - size[i] / 2;
+
+		if (start[i] > levelSize[i] - size[i])
+		{
+			start[i] = levelSize[i] - size[i];
+		}
+		if (start[i] < 0)
+		{
+			start[i] = 0;
+		}
+	}
+}
+
 /**
  * Zeichnet das Level. Die zu zeichnenden Objekte werden hierzu in Form 
  * einer Displayliste aus renderObjects bezogen.
@@ -82,22 +193,28 @@ static void initLight(void)
  */
 static void drawLevel(Gamestate *gamestate)
 {
+	int start[2], size[2];
+	getViewWindow(gamestate, start, size);
+
+	/* Die Groesse einer einzelnen Kachel */
+	float tileSize = 2.0f / ((size[0] > size[1]) ? size[0] : size[1]);
+
 	glPushMatrix();
 	{
 		/* Skalierung und Positionierung des Spielfelds. */
 		glTranslatef(0.0f, 0.1f, 0.0f);
 		glScalef(0.9f, 0.9f, 1.0f);
-		for (int y = 0; y < LEVELSIZE; y++) 
+		for (int y = start[1]; y < start[1] + size[1]; y++) 
 		{
-			for (int x = 0; x < LEVELSIZE; x++) 
+			for (int x = start[0]; x < start[0] + size[0]; x++) 
 			{
 				glPushMatrix();
 				{
 					/* Kachel an Position x,y zeichnen. */
-					float xOffset = -1.0 + ((float) x * (float) TILE_SIZE);
-					float yOffset =  1.0 - ((float) y * (float) TILE_SIZE);
-					glTranslatef(xOffset + TILE_SIZE / 2.0f, yOffset - TILE_SIZE / 2.0f, 0.0f);
-					glScalef(TILE_SIZE - 0.01f, TILE_SIZE - 0.01f, 1.0f);
+					float xOffset = -1.0 + ((float) (x - start[0]) * tileSize);
+					float yOffset =  1.0 - ((float) (y - start[1]) * tileSize);
+					glTranslatef(xOffset + tileSize / 2.0f, yOffset - tileSize / 2.0f, 0.0f);
+					glScalef(tileSize - 0.01f, tileSize - 0.01f, 1.0f);
 
 					wmFieldType field = gamestate->level[y][x];
 					switch (field) {
@@ -113,7 +230,6 @@ static void drawLevel(Gamestate *gamestate)
 						case WM_GOAL:
 							renderObject(RO_GOAL);
 							break;
-						case WM_NEWWATER: // Sollte nie gerendert werden
 						case WM_WATER:
 							renderObject(RO_WATER);
 							break;
@@ -153,20 +269,15 @@ static void drawLevel(Gamestate *gamestate)
 }
 
 /**
- * Zeichnet ein Sandsacktile in 3D.
+ * Zeichnet den zuletzt bewegten Sandsack in 3D. Der Sandboden darunter ist
+ * Teil der statischen Geometrie.
  * 
  * @param gamestage der Spielzustand (In)
- * @param x die X-Koordinate des Sandsacks (In)
- * @param y die Y-Koordinate des Sandsacks (In)
  * @param playerAnimationder Fortschritt der Bewegungsanimation (In)
  */
-static void drawSandbag3D(Gamestate *gamestate, int x, int y, float playerAnimation)
+static void drawSandbag3D(Gamestate *gamestate, float playerAnimation)
 {
-	renderObject3D(RO_3D_SANDFLOOR);
-
-	if (g_sceneFlags.animation &&
-		gamestate->lastSandbagY == y &&
-		gamestate->lastSandbagX == x)
+	if (g_sceneFlags.animation)
 	{
 		switch (gamestate->lastDirection)
 		{
@@ -219,99 +330,595 @@ static void drawPlayer3D(Gamestate *gamestate, float playerAnimation)
 }
 
 /**
- * Zeichnet das Level in 3D. Die zu zeichnenden Objekte werden hierzu in Form 
- * einer Displayliste aus renderObjects bezogen.
+ * Verschiebt die Modelviewmatrix auf die Kachel an Position x,y. Die Mitte
+ * des Levels liegt im Ursprung.
  * 
  * @param gamestage der Spielzustand (In)
+ * @param x die X-Koordinate der Kachel (In)
+ * @param y die Y-Koordinate der Kachel (In)
  */
-static void drawLevel3D(Gamestate *gamestate, WaterFaceList *waterList)
+static void translateToTile(Gamestate *gamestate, int x, int y)
 {
-	float playerAnimation = -(gamestate->playerCooldown / PLAYER_COOLDOWN_TIME);
+	glTranslatef((float)(x - gamestate->levelWidth / 2), 0.0f,
+	             (float)(y - gamestate->levelHeight / 2));
+}
+
+/**
+ * Bestimmt den in 3D zu zeichnenden Ausschnitt des Levels. Kleine Level
+ * werden ganz gezeichnet, bei grossen folgt ein Ausschnitt von VIEW_CHUNKS
+ * Chunks dem Spieler. Der Ausschnitt aendert sich so nur beim Wechsel in
+ * einen anderen Chunk.
+ * 
+ * @param gamestage der Spielzustand (In)
+ */
+static void updateViewWindow(Gamestate *gamestate)
+{
+	int levelSize[2] = { gamestate->levelWidth, gamestate->levelHeight };
+	int player[2] = { gamestate->playerX, gamestate->playerY };
+
+	for (int i = 0; i < 2; i++)
+	{
+		int count = (levelSize[i] + CHUNK_SIZE - 1) / CHUNK_SIZE;
+		int start = player[i] / CHUNK_SIZE - VIEW_CHUNKS / 2;
+
+		if (start > count - VIEW_CHUNKS)
+		{
+			start = count - VIEW_CHUNKS;
+		}
+		if (start < 0)
+		{
+			start = 0;
+		}
 
+		g_viewChunkStart[i] = start;
+		g_viewChunkEnd[i] = (start + VIEW_CHUNKS < count) ? start + VIEW_CHUNKS : count;
+		g_viewStart[i] = g_viewChunkStart[i] * CHUNK_SIZE;
+		g_viewEnd[i] = (g_viewChunkEnd[i] * CHUNK_SIZE < levelSize[i])
+		               ? g_viewChunkEnd[i] * CHUNK_SIZE : levelSize[i];
+	}
+}
+
+/**
+ * Prueft, ob eine Kachel im 3D-Ausschnitt liegt.
+ * 
+ * @param x die X-Koordinate der Kachel (In)
+ * @param y die Y-Koordinate der Kachel (In)
+ * @return GL_TRUE, wenn die Kachel im Ausschnitt liegt
+ */
+static GLboolean isInView(int x, int y)
+{
+	return x >= g_viewStart[0] && x < g_viewEnd[0] && y >= g_viewStart[1] && y < g_viewEnd[1];
+}
+
+/**
+ * Zeichnet den unveraenderlichen Teil einer Kachel in 3D. Bewegte oder
+ * animierte Objekte (Spieler, zuletzt bewegter Sandsack, nasser Zucker)
+ * werden gesondert von drawLevel3DDynamic gezeichnet.
+ * 
+ * @param gamestage der Spielzustand (In)
+ * @param x die X-Koordinate der Kachel (In)
+ * @param y die Y-Koordinate der Kachel (In)
+ */
+static void drawStaticTile3D(Gamestate *gamestate, int x, int y)
+{
 	glPushMatrix();
 	{
-		for (int y = 0; y < LEVELSIZE; y++) 
+		translateToTile(gamestate, x, y);
+
+		wmFieldType field = gamestate->level[y][x];
+		switch (field) {
+			case WM_FREE:
+				renderObject3D(RO_3D_FREE);
+				break;
+			case WM_BLACK:
+				// Nichts anzeigen
+				break;
+			case WM_WALL:
+				renderObject3D(RO_3D_WALL);
+				break;
+			case WM_GOAL:
+				renderObject3D(RO_3D_GOAL);
+				break;
+			case WM_WATER:
+				renderObject3D(RO_3D_FREE);
+				renderObject3D(RO_3D_WATER);
+				break;
+			case WM_SAND:
+				renderObject3D(RO_3D_SANDFLOOR);
+				if (gamestate->lastSandbagX != x || gamestate->lastSandbagY != y)
+				{
+					renderObject3D(RO_3D_SANDBAG);
+				}
+				break;
+			case WM_SUGAR:
+				renderObject3D(RO_3D_SUGAR);
+				break;
+			case WM_TOUCHED_SUGAR:
+				/* Der schrumpfende Wuerfel ist dynamisch */
+				renderObject3D(RO_3D_FREE);
+				break;
+			case WM_START:
+				INFO(("WM_START in rendering is not allowed!"));
+				break;
+		}
+	}
+	glPopMatrix();
+}
+
+/**
+ * Gibt die Displaylisten und Verwaltungsdaten aller Chunks frei.
+ */
+static void freeChunks(void)
+{
+	for (int cy = g_lastChunkStart[1]; cy < g_lastChunkEnd[1]; cy++)
+	{
+		for (int cx = g_lastChunkStart[0]; cx < g_lastChunkEnd[0]; cx++)
 		{
-			for (int x = 0; x < LEVELSIZE; x++) 
+			if (g_chunkLists[cy * g_chunkCount[0] + cx] != 0)
 			{
-				glPushMatrix();
+				glDeleteLists(g_chunkLists[cy * g_chunkCount[0] + cx], 1);
+			}
+		}
+	}
+
+	free(g_chunkLists);
+	free(g_chunkDirty);
+	g_chunkLists = NULL;
+	g_chunkDirty = NULL;
+	g_chunkCount[0] = g_chunkCount[1] = 0;
+	g_lastChunkStart[0] = g_lastChunkStart[1] = 0;
+	g_lastChunkEnd[0] = g_lastChunkEnd[1] = 0;
+}
+
+/**
+ * Legt die Verwaltungsdaten der Chunks fuer die aktuelle Levelgroesse an,
+ * falls sich diese geaendert hat.
+ * 
+ * @param gamestage der Spielzustand (In)
+ */
+static void allocateChunks(Gamestate *gamestate)
+{
+	int countX = (gamestate->levelWidth + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	int countY = (gamestate->levelHeight + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+	if (g_chunkLists == NULL || countX != g_chunkCount[0] || countY != g_chunkCount[1])
+	{
+		freeChunks();
+
+		g_chunkLists = calloc((size_t)countX * countY, sizeof(GLuint));
+		g_chunkDirty = calloc((size_t)countX * countY, sizeof(GLboolean));
+		if (g_chunkLists == NULL || g_chunkDirty == NULL)
+		{
+			CG_ERROR(("Kein Speicher fuer die Chunks des Levels\n"));
+		}
+
+		g_chunkCount[0] = countX;
+		g_chunkCount[1] = countY;
+		g_allChunksDirty = GL_TRUE;
+	}
+}
+
+/**
+ * Erzeugt die Displaylisten aller Chunks im 3D-Ausschnitt neu, in denen sich
+ * seit dem letzten Frame Felder geaendert haben oder die neu in den
+ * Ausschnitt gekommen sind. Chunks, die den Ausschnitt verlassen, geben ihre
+ * Displayliste frei.
+ * 
+ * @param gamestage der Spielzustand (In)
+ * @return GL_TRUE, wenn sich seit dem letzten Aufruf etwas geaendert hat
+ */
+static GLboolean updateChunks(Gamestate *gamestate)
+{
+	DirtyTiles *dirty = &gamestate->dirtyTiles;
+
+	allocateChunks(gamestate);
+
+	GLboolean moved = g_viewChunkStart[0] != g_lastChunkStart[0]
+	                  || g_viewChunkStart[1] != g_lastChunkStart[1]
+	                  || g_viewChunkEnd[0] != g_lastChunkEnd[0]
+	                  || g_viewChunkEnd[1] != g_lastChunkEnd[1];
+	GLboolean changed = g_allChunksDirty || dirty->all || dirty->count > 0 || moved;
+
+	/* Geaenderte Felder auf ihre Chunks abbilden */
+	if (g_allChunksDirty || dirty->all)
+	{
+		for (int i = 0; i < g_chunkCount[0] * g_chunkCount[1]; i++)
+		{
+			g_chunkDirty[i] = GL_TRUE;
+		}
+	}
+
+	for (int i = 0; i < dirty->count; i++)
+	{
+		g_chunkDirty[(dirty->y[i] / CHUNK_SIZE) * g_chunkCount[0] + dirty->x[i] / CHUNK_SIZE] = GL_TRUE;
+	}
+
+	g_allChunksDirty = GL_FALSE;
+	clearDirtyTiles();
+
+	/* Chunks, die den Ausschnitt verlassen haben, freigeben */
+	if (moved)
+	{
+		for (int cy = g_lastChunkStart[1]; cy < g_lastChunkEnd[1]; cy++)
+		{
+			for (int cx = g_lastChunkStart[0]; cx < g_lastChunkEnd[0]; cx++)
+			{
+				GLuint *list = &g_chunkLists[cy * g_chunkCount[0] + cx];
+
+				if (*list != 0 && (cx < g_viewChunkStart[0] || cx >= g_viewChunkEnd[0]
+				                   || cy < g_viewChunkStart[1] || cy >= g_viewChunkEnd[1]))
 				{
-					/* Kachel an Position x,y zeichnen. */
-					float xOffset = (float)(x - LEVELSIZE / 2);
-					float zOffset = (float)(y - LEVELSIZE / 2);
-					glTranslatef(xOffset, 0.0f, zOffset);
+					glDeleteLists(*list, 1);
+					*list = 0;
+				}
+			}
+		}
 
-					wmFieldType field = gamestate->level[y][x];
-					switch (field) {
-						case WM_FREE:
-							renderObject3D(RO_3D_FREE);
-							break;
-						case WM_BLACK:
-							// Nichts anzeigen
-							break;
-						case WM_WALL:
-							renderObject3D(RO_3D_WALL);
-							break;
-						case WM_GOAL:
-							renderObject3D(RO_3D_GOAL);
-							break;
-						case WM_NEWWATER: // Sollte nie gerendert werden
-						case WM_WATER:
-							renderObject3D(RO_3D_FREE);
-							renderObject3D(RO_3D_WATER);
-							water_add(waterList, xOffset, zOffset);
-							break;
-						case WM_SAND:
-							drawSandbag3D(gamestate, x, y, playerAnimation);
-							break;
-						case WM_SUGAR:
-							renderObject3D(RO_3D_SUGAR);
-							break;
-						case WM_TOUCHED_SUGAR:
-							/* Bei nassem Zucker muss zusaetzlich zum Rendern die verbleibende Lebenszeit gespeichert werden. */
-							{								
-								renderObject3D(RO_3D_FREE);
-								float sugarSize = sugar_get_lifetime(&gamestate->sugarCubes, x, y) / SUGAR_LIFETIME;
-								glPushMatrix();
-								{
-									glTranslatef(0.0f, (1.0f - sugarSize) / -2.0f, 0.0f);
-									glScalef(sugarSize, sugarSize, sugarSize);
-									renderObject3D(RO_3D_SUGAR);
-								}
-								glPopMatrix();
-							}
-							break;
-						case WM_START:
-							INFO(("WM_START in rendering is not allowed!"));
-							break;
-					}
+		for (int i = 0; i < 2; i++)
+		{
+			g_lastChunkStart[i] = g_viewChunkStart[i];
+			g_lastChunkEnd[i] = g_viewChunkEnd[i];
+		}
+	}
 
-					if (x == gamestate->playerX && y == gamestate->playerY) {
-						drawPlayer3D(gamestate, playerAnimation);
+	/* Die Chunks rufen die Objekte auf, deren Listen muessen also vorher
+	 * aufgezeichnet sein */
+	if (changed)
+	{
+		prepareDisplayList3D();
+	}
+
+	/* Nur die betroffenen oder neuen Chunks im Ausschnitt aufzeichnen */
+	for (int cy = g_viewChunkStart[1]; cy < g_viewChunkEnd[1]; cy++)
+	{
+		for (int cx = g_viewChunkStart[0]; cx < g_viewChunkEnd[0]; cx++)
+		{
+			int chunk = cy * g_chunkCount[0] + cx;
+
+			if (g_chunkLists[chunk] == 0)
+			{
+				g_chunkLists[chunk] = glGenLists(1);
+				if (g_chunkLists[chunk] == 0)
+				{
+					CG_ERROR(("Konnte Displaylisten fuer das Level nicht erzeugen\n"));
+				}
+				g_chunkDirty[chunk] = GL_TRUE;
+			}
+
+			if (g_chunkDirty[chunk])
+			{
+				glNewList(g_chunkLists[chunk], GL_COMPILE);
+				for (int y = cy * CHUNK_SIZE; y < (cy + 1) * CHUNK_SIZE && y < gamestate->levelHeight; y++)
+				{
+					for (int x = cx * CHUNK_SIZE; x < (cx + 1) * CHUNK_SIZE && x < gamestate->levelWidth; x++)
+					{
+						drawStaticTile3D(gamestate, x, y);
 					}
 				}
-				glPopMatrix();
+				glEndList();
+
+				g_chunkDirty[chunk] = GL_FALSE;
+			}
+		}
+	}
+
+	return changed;
+}
+
+/**
+ * Prueft, ob an einer Position ein Wasserfeld liegt. Positionen ausserhalb
+ * des Levels sind kein Wasser.
+ * 
+ * @param gamestage der Spielzustand (In)
+ * @param x die X-Koordinate (In)
+ * @param y die Y-Koordinate (In)
+ * @return GL_TRUE bei Wasser
+ */
+static GLboolean isWater(Gamestate *gamestate, int x, int y)
+{
+	return x >= 0 && x < gamestate->levelWidth && y >= 0 && y < gamestate->levelHeight &&
+		   gamestate->level[y][x] == WM_WATER;
+}
+
+/**
+ * Baut die Liste der Wasserfaces im 3D-Ausschnitt neu auf. Seiten zwischen zwei Wasserfeldern
+ * sind von aussen nicht zu sehen und werden nicht aufgenommen. Die Reihenfolge ist danach
+ * beliebig und wird beim naechsten Sortieren hergestellt.
+ * 
+ * @param gamestage der Spielzustand (In)
+ */
+static void buildWaterList(Gamestate *gamestate)
+{
+	uint64_t start = frametime_now();
+
+	water_clear(&g_waterList);
+
+	for (int y = g_viewStart[1]; y < g_viewEnd[1]; y++)
+	{
+		for (int x = g_viewStart[0]; x < g_viewEnd[0]; x++)
+		{
+			if (isWater(gamestate, x, y))
+			{
+				unsigned hidden = 0;
+
+				if (g_waterCulling)
+				{
+					hidden |= isWater(gamestate, x, y + 1) ? WATER_SIDE_BIT(WFACE_FRONT) : 0;
+					hidden |= isWater(gamestate, x, y - 1) ? WATER_SIDE_BIT(WFACE_BACK) : 0;
+					hidden |= isWater(gamestate, x + 1, y) ? WATER_SIDE_BIT(WFACE_LEFT) : 0;
+					hidden |= isWater(gamestate, x - 1, y) ? WATER_SIDE_BIT(WFACE_RIGHT) : 0;
+				}
+
+				water_add(&g_waterList, (float)(x - gamestate->levelWidth / 2),
+						  (float)(y - gamestate->levelHeight / 2), hidden);
+			}
+		}
+	}
+
+	g_waterList.stats.builds++;
+	g_waterList.stats.buildNs += frametime_now() - start;
+}
+
+/**
+ * Gibt beim Programmende die Statistik der Wasserfaces aus und den Speicher frei.
+ */
+static void cleanupWater(void)
+{
+	water_printStats(&g_waterList);
+	water_free(&g_waterList);
+}
+
+/**
+ * Gibt beim Programmende den Speicher der Chunk-Verwaltung frei. Die
+ * Displaylisten verschwinden mit dem OpenGL-Kontext.
+ */
+static void cleanupChunks(void)
+{
+	free(g_chunkLists);
+	free(g_chunkDirty);
+}
+
+/**
+ * Markiert eine Kachel als sichtbar. Kacheln ausserhalb des 3D-Ausschnitts
+ * werden ignoriert.
+ * 
+ * @param x die X-Koordinate der Kachel (In)
+ * @param y die Y-Koordinate der Kachel (In)
+ */
+static void markVisible(int x, int y)
+{
+	if (isInView(x, y)
+	    && g_visibleStamp[y - g_viewStart[1]][x - g_viewStart[0]] != g_visibilityPass)
+	{
+		g_visibleStamp[y - g_viewStart[1]][x - g_viewStart[0]] = g_visibilityPass;
+		g_visibleX[g_visibleCount] = x;
+		g_visibleY[g_visibleCount] = y;
+		g_visibleCount++;
+	}
+}
+
+/**
+ * Verfolgt einen Sichtstrahl per DDA (Amanatides/Woo) Kachel fuer Kachel
+ * durch das Level, bis er eine Wand trifft oder den 3D-Ausschnitt verlaesst. Die
+ * besuchten Kacheln und ihre direkten Nachbarn werden als sichtbar markiert,
+ * damit auch schraeg angeschnittene Waende und Luecken zwischen zwei
+ * Strahlen abgedeckt sind.
+ * 
+ * @param gamestage der Spielzustand (In)
+ * @param originX, originY Startpunkt in Kachelkoordinaten (In)
+ * @param dirX, dirY Richtung des Strahls (In)
+ */
+static void castVisibilityRay(Gamestate *gamestate, float originX, float originY,
+                              float dirX, float dirY)
+{
+	int x = (int)floorf(originX);
+	int y = (int)floorf(originY);
+	int stepX = (dirX < 0.0f) ? -1 : 1;
+	int stepY = (dirY < 0.0f) ? -1 : 1;
+
+	/* Strahlparameter bis zur naechsten Kachelgrenze und je ganzer Kachel */
+	float deltaX = (dirX != 0.0f) ? fabsf(1.0f / dirX) : INFINITY;
+	float deltaY = (dirY != 0.0f) ? fabsf(1.0f / dirY) : INFINITY;
+	float nextX = (dirX < 0.0f) ? (originX - x) * deltaX : (x + 1.0f - originX) * deltaX;
+	float nextY = (dirY < 0.0f) ? (originY - y) * deltaY : (y + 1.0f - originY) * deltaY;
+
+	while (isInView(x, y))
+	{
+		markVisible(x, y);
+		markVisible(x - 1, y);
+		markVisible(x + 1, y);
+		markVisible(x, y - 1);
+		markVisible(x, y + 1);
+
+		if (gamestate->level[y][x] == WM_WALL)
+		{
+			break;
+		}
+
+		if (nextX < nextY)
+		{
+			x += stepX;
+			nextX += deltaX;
+		}
+		else
+		{
+			y += stepY;
+			nextY += deltaY;
+		}
+	}
+}
+
+/**
+ * Bestimmt die in der Ego-Perspektive sichtbaren Kacheln. Ueber den
+ * horizontalen Oeffnungswinkel wird je VISIBILITY_RAY_PIXELS Pixel Breite
+ * ein Sichtstrahl verfolgt, der Aufwand haengt damit nur vom sichtbaren Teil
+ * des Levels ab.
+ * 
+ * @param gamestage der Spielzustand (In)
+ * @param eyeX, eyeZ Position des Auges in Weltkoordinaten (In)
+ * @param dirX, dirZ Blickrichtung (In)
+ */
+static void updateVisibility(Gamestate *gamestate, float eyeX, float eyeZ,
+                             float dirX, float dirZ)
+{
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+
+	/* Neuer Durchlauf, beim Ueberlauf muessen alte Markierungen weg */
+	if (++g_visibilityPass == 0)
+	{
+		for (int y = 0; y < VIEW_TILES_3D; y++)
+		{
+			for (int x = 0; x < VIEW_TILES_3D; x++)
+			{
+				g_visibleStamp[y][x] = 0;
+			}
+		}
+		g_visibilityPass = 1;
+	}
+	g_visibleCount = 0;
+
+	/* Kachel x reicht in Weltkoordinaten von x - Breite / 2 - 0.5 bis + 0.5 */
+	float originX = eyeX + gamestate->levelWidth / 2 + 0.5f;
+	float originY = eyeZ + gamestate->levelHeight / 2 + 0.5f;
+
+	float aspect = (float)viewport[2] / (float)viewport[3];
+	float halfAngle = atanf(tanf(TO_RADIANS(FIELD_OF_VIEW) / 2.0f) * aspect);
+	int rays = viewport[2] / VISIBILITY_RAY_PIXELS;
+
+	if (rays < VISIBILITY_MIN_RAYS)
+	{
+		rays = VISIBILITY_MIN_RAYS;
+	}
+
+	for (int i = 0; i < rays; i++)
+	{
+		float angle = -halfAngle + 2.0f * halfAngle * i / (rays - 1);
+		float c = cosf(angle);
+		float s = sinf(angle);
+
+		castVisibilityRay(gamestate, originX, originY, dirX * c - dirZ * s, dirX * s + dirZ * c);
+	}
+}
+
+/**
+ * Prueft, ob eine Kachel gezeichnet werden muss. Ausserhalb der
+ * Ego-Perspektive ist der ganze 3D-Ausschnitt sichtbar.
+ * 
+ * @param x die X-Koordinate der Kachel (In)
+ * @param y die Y-Koordinate der Kachel (In)
+ * @return GL_TRUE, wenn die Kachel sichtbar ist
+ */
+static GLboolean isTileVisible(int x, int y)
+{
+	return isInView(x, y) && (!g_sceneFlags.firstPerson
+	       || g_visibleStamp[y - g_viewStart[1]][x - g_viewStart[0]] == g_visibilityPass);
+}
+
+/**
+ * Zeichnet die bewegten und animierten Objekte des Levels in 3D: den Spieler,
+ * den zuletzt bewegten Sandsack und die schrumpfenden nassen Zuckerwuerfel.
+ * 
+ * @param gamestage der Spielzustand (In)
+ */
+static void drawLevel3DDynamic(Gamestate *gamestate)
+{
+	float playerAnimation = -(gamestate->playerCooldown / PLAYER_COOLDOWN_TIME);
+	int sandbagX = gamestate->lastSandbagX;
+	int sandbagY = gamestate->lastSandbagY;
+
+	if (sandbagX >= 0 && gamestate->level[sandbagY][sandbagX] == WM_SAND
+	    && isTileVisible(sandbagX, sandbagY))
+	{
+		glPushMatrix();
+		{
+			translateToTile(gamestate, sandbagX, sandbagY);
+			drawSandbag3D(gamestate, playerAnimation);
+		}
+		glPopMatrix();
+	}
+
+	for (int i = 0; i < gamestate->sugarCubes.count; i++)
+	{
+		Sugar *sugar = &gamestate->sugarCubes.list[i];
+
+		if (sugar->lifetime > 0.0f && gamestate->level[sugar->y][sugar->x] == WM_TOUCHED_SUGAR
+		    && isTileVisible(sugar->x, sugar->y))
+		{
+			float sugarSize = sugar->lifetime / SUGAR_LIFETIME;
+			glPushMatrix();
+			{
+				translateToTile(gamestate, sugar->x, sugar->y);
+				glTranslatef(0.0f, (1.0f - sugarSize) / -2.0f, 0.0f);
+				glScalef(sugarSize, sugarSize, sugarSize);
+				renderObject3D(RO_3D_SUGAR);
 			}
+			glPopMatrix();
 		}
 	}
+
+	glPushMatrix();
+	{
+		translateToTile(gamestate, gamestate->playerX, gamestate->playerY);
+		drawPlayer3D(gamestate, playerAnimation);
+	}
 	glPopMatrix();
 }
 
 /**
- * Zeichnet ein Wassertile in 3D.
+ * Zeichnet den 3D-Ausschnitt des Levels. Die unveraenderlichen Kacheln liegen in einer
+ * Displayliste je Chunk, die prepareScene3D nur bei Aenderungen neu erzeugt. Bewegte
+ * Objekte werden jeden Frame gezeichnet.
+ * In der Ego-Perspektive werden statt der Chunks nur die per updateVisibility
+ * als sichtbar bestimmten Kacheln gezeichnet.
  * 
  * @param gamestage der Spielzustand (In)
+ */
+static void drawLevel3D(Gamestate *gamestate)
+{
+	if (g_sceneFlags.firstPerson)
+	{
+		for (int i = 0; i < g_visibleCount; i++)
+		{
+			drawStaticTile3D(gamestate, g_visibleX[i], g_visibleY[i]);
+		}
+	}
+	else
+	{
+		for (int cy = g_viewChunkStart[1]; cy < g_viewChunkEnd[1]; cy++)
+		{
+			for (int cx = g_viewChunkStart[0]; cx < g_viewChunkEnd[0]; cx++)
+			{
+				glCallList(g_chunkLists[cy * g_chunkCount[0] + cx]);
+			}
+		}
+	}
+
+	drawLevel3DDynamic(gamestate);
+}
+
+/**
+ * Zeichnet die Faces des Wassers in der Reihenfolge der Liste.
+ * 
  * @param waterList ein Array mit allen Faces fuer das Wasser (In)
+ * @param subDivs Unterteilungen je Face (In)
  */
-static void drawLevel3DWater(Gamestate *gamestate, WaterFaceList *waterList)
+static void drawWaterFaces(Gamestate *gamestate, WaterFaceList *waterList, int subDivs)
 {
-	glDisable(GL_CULL_FACE);
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	glPushMatrix();
 	{
 		for (int i = 0; i < waterList->count; i++) 
 		{
+			float tileX, tileZ;
+			water_faceTile(&waterList->list[i], &tileX, &tileZ);
+
+			/* Faces nicht sichtbarer Kacheln (Ego-Perspektive) auslassen */
+			if (!isTileVisible((int)tileX + gamestate->levelWidth / 2,
+			                   (int)tileZ + gamestate->levelHeight / 2))
+			{
+				continue;
+			}
+
 			glPushMatrix();
 			{
 				glTranslatef(waterList->list[i].x, waterList->list[i].y, waterList->list[i].z);
@@ -319,12 +926,13 @@ static void drawLevel3DWater(Gamestate *gamestate, WaterFaceList *waterList)
 				switch (waterList->list[i].side)
 				{
 					case WFACE_TOP:
+						/* Normale nach oben, sonst ist die Oberflaeche unbeleuchtet */
 						glTranslatef(0.0f, -Z_EPSILON, 0.0f);
-						glRotatef(90, 1.0f, 0.0f, 0.0f);
+						glRotatef(-90, 1.0f, 0.0f, 0.0f);
 						break;
 					case WFACE_BOTTOM:
 						glTranslatef(0.0f, -Z_EPSILON, 0.0f);
-						glRotatef(-90, 1.0f, 0.0f, 0.0f);
+						glRotatef(90, 1.0f, 0.0f, 0.0f);
 						break;
 					case WFACE_FRONT:
 						glTranslatef(0.0f, 0.0f, -Z_EPSILON);
@@ -346,12 +954,51 @@ static void drawLevel3DWater(Gamestate *gamestate, WaterFaceList *waterList)
 
 				setDiffuseMaterialAlpha(0.2f, 0.5f, 0.8f, 0.5f);
 				setSpecularMaterial(0.4f, 0.4f, 0.4f, 80.0f);
-				drawSquare(4);
+				drawSquare(subDivs);
 			}
 			glPopMatrix();
 		}
 	}
 	glPopMatrix();
+}
+
+/**
+ * Zeichnet das Wasser in 3D. Mit OIT werden die Faces einmal fuer die
+ * gewichtete Summe und einmal fuer die Durchlaessigkeit gezeichnet, die
+ * Reihenfolge spielt dabei keine Rolle. Sonst muss die Liste von hinten
+ * nach vorne sortiert sein.
+ *
+ * Unterteilt werden die Faces nur, wenn sie pro Vertex beleuchtet werden.
+ * Das gilt auch fuer die gewichtete Summe bei OIT, deren Shader die Farbe
+ * der festen Pipeline uebernimmt. Fuer die Durchlaessigkeit zaehlt nur Alpha.
+ * 
+ * @param gamestage der Spielzustand (In)
+ * @param waterList ein Array mit allen Faces fuer das Wasser (In)
+ * @param orderIndependent mit OIT zeichnen? (In)
+ * @param perPixel ist die Beleuchtung pro Pixel aktiv? (In)
+ */
+static void drawLevel3DWater(Gamestate *gamestate, WaterFaceList *waterList,
+                             GLboolean orderIndependent, GLboolean perPixel)
+{
+	int subDivs = g_sceneFlags.lighting ? TILE_SUBDIVS : 0;
+
+	glDisable(GL_CULL_FACE);
+	glEnable(GL_BLEND);
+
+	if (orderIndependent)
+	{
+		oit_beginAccumulation();
+		drawWaterFaces(gamestate, waterList, subDivs);
+
+		oit_beginRevealage();
+		drawWaterFaces(gamestate, waterList, 0);
+	}
+	else
+	{
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		drawWaterFaces(gamestate, waterList, perPixel ? 0 : subDivs);
+	}
+
 	glDisable(GL_BLEND);
 	glEnable(GL_CULL_FACE);
 }
@@ -369,6 +1016,111 @@ void drawScene2D(void)
 	GLSTATE;
 }
 
+void prepareScene3D(void)
+{
+	Gamestate *gamestate = getGamestate();
+
+	/* Zu zeichnenden Ausschnitt und dessen Mitte bestimmen */
+	updateViewWindow(gamestate);
+	float xCenter = (float)((g_viewStart[0] + g_viewEnd[0]) / 2 - gamestate->levelWidth / 2);
+	float zCenter = (float)((g_viewStart[1] + g_viewEnd[1]) / 2 - gamestate->levelHeight / 2);
+
+	/* Position des Spielers bestimmen */
+	float xPlayerOffset =  (float)(gamestate->playerX - gamestate->levelWidth / 2);
+	float zPlayerOffset =  (float)(gamestate->playerY - gamestate->levelHeight / 2);
+	float xPlayerDir = 0.0f;
+	float zPlayerDir = 0.0f;
+
+	/* Animationsphase des Spielers bestimmen */
+	float playerAnimation = 0.0f;
+	if (g_sceneFlags.animation)
+	{
+		playerAnimation = gamestate->playerCooldown / PLAYER_COOLDOWN_TIME;
+	}
+
+	/* Blickrichtung anhand der letzten Bewegungsrichtung bestimmen */
+	switch (gamestate->lastDirection)
+	{
+		case dirDown:
+			zPlayerDir = 1.0f;
+			zPlayerOffset -= playerAnimation;
+			break;
+		case dirLeft:
+			xPlayerDir = -1.0f;
+			xPlayerOffset += playerAnimation;
+			break;
+		case dirRight:
+			xPlayerDir = 1.0f;
+			xPlayerOffset -= playerAnimation;
+			break;
+		case dirUp:
+			zPlayerDir = -1.0f;
+			zPlayerOffset += playerAnimation;
+			break;
+	}
+
+	/* Position des Auges*/
+	GLfloat eyeX = 0.0f;
+	GLfloat eyeY = 0.0f;
+	GLfloat eyeZ = 0.0f;
+
+	if (g_sceneFlags.firstPerson) 
+	{
+		/* Auskommentierte Werte fuer 3rd Person Ansicht */
+		eyeX = xPlayerOffset; // xPlayerOffset - xPlayerDir * 0.6f;
+		eyeY = 0.05f; // 0.75f; 
+	 	eyeZ = zPlayerOffset; // zPlayerOffset - zPlayerDir * 0.6f;
+
+		matrix_lookAt(g_frame.view,
+		              eyeX,                       eyeY, eyeZ,                       /* Augpunkt */
+		              xPlayerOffset + xPlayerDir, 0.0f, zPlayerOffset + zPlayerDir, /* Mittelpunkt */
+		              0.0f,                       1.0f, 0.0f);                      /* Up-Vektor */
+
+		/* Nur die Kacheln im Sichtfeld zeichnen */
+		updateVisibility(gamestate, eyeX, eyeZ, xPlayerDir, zPlayerDir);
+	}
+	else
+	{
+		GLfloat radius = gamestate->camera.radius;
+		GLfloat polar = TO_RADIANS(gamestate->camera.polarAngle);
+		GLfloat azimuth = TO_RADIANS(gamestate->camera.azimuthAngle);
+
+		/* Die Kamera kreist um die Mitte des Ausschnitts */
+		eyeX = xCenter + radius * sinf(azimuth) * cosf(polar);
+		eyeY = radius * cosf(azimuth);
+		eyeZ = zCenter + radius * sinf(azimuth) * sinf(polar);
+
+		matrix_lookAt(g_frame.view,
+		              eyeX,    eyeY, eyeZ,    /* Augpunkt */
+		              xCenter, 0.0f, zCenter, /* Mittelpunkt */
+		              0.0f,    1.0f, 0.0f);   /* Up-Vektor */
+	}
+
+	g_frame.center[0] = xCenter;
+	g_frame.center[1] = zCenter;
+	g_frame.player[0] = xPlayerOffset;
+	g_frame.player[1] = zPlayerOffset;
+	g_frame.playerDir[0] = xPlayerDir;
+	g_frame.playerDir[1] = zPlayerDir;
+	g_frame.orderIndependent = g_sceneFlags.orderIndependent && oit_available();
+
+	/* Chunks aktualisieren, bei Aenderungen am Level oder am Ausschnitt auch
+	 * die Liste der Wasserfaces neu aufbauen */
+	if (updateChunks(gamestate))
+	{
+		buildWaterList(gamestate);
+	}
+
+	if (!g_frame.orderIndependent)
+	{
+		/* Wasserflaechen nach Abstand zur Kammera sortieren, die Reihenfolge
+		 * des letzten Frames ist dabei meist schon fast richtig. Die Augen
+		 * liegen so dicht an der Mitte, dass die Reihenfolge fuer beide gilt. */
+		water_calcDistances(&g_waterList, eyeX, eyeY, eyeZ);
+		water_sortDistances(&g_waterList);
+	}
+}
+
 void drawScene3D(AnaglyphEye eye)
 {
 	Gamestate *gamestate = getGamestate();
@@ -382,96 +1134,48 @@ void drawScene3D(AnaglyphEye eye)
 	glPushMatrix();
 	{
 		glTranslatef(eye * -0.1f, 0.0f, 0.0f);
+		glMultMatrixf(g_frame.view);
+		
+		/* Position des Welt-Lichts setzen */
+		float worldlightPos[] = {g_frame.center[0], 2.0f, g_frame.center[1], 1.0f};
+		glLightfv(LIGHT_WORLD, GL_POSITION, worldlightPos);
+
+		/* Position und Richtung des Spotlights setzen */
+		float spotlightPos[] = {g_frame.player[0], 0.05f, g_frame.player[1], 1.0};
+		float spotlightDirection[] = {g_frame.playerDir[0], -0.5f, g_frame.playerDir[1]};
+		glLightfv(LIGHT_SPOTLIGHT, GL_SPOT_DIRECTION, spotlightDirection);
+		glLightfv(LIGHT_SPOTLIGHT, GL_POSITION, spotlightPos);
 
-		/* Position des Spielers bestimmen */
-		float xPlayerOffset =  ((float)gamestate->playerX) - ((float)LEVELSIZE) / 2.0f + 0.5f;
-		float zPlayerOffset =  ((float)gamestate->playerY) - ((float)LEVELSIZE) / 2.0f + 0.5f;
-		float xPlayerDir = 0.0f;
-		float zPlayerDir = 0.0f;
+		GLboolean orderIndependent = g_frame.orderIndependent;
+		GLboolean perPixel = g_sceneFlags.lighting && getTileSubdivs() == 0;
 
-		/* Animationsphase des Spielers bestimmen */
-		float playerAnimation = 0.0f;
-		if (g_sceneFlags.animation)
+		/* Level rendern (Opack), mit OIT in ein eigenes Framebuffer-Objekt */
+		if (orderIndependent)
 		{
-			playerAnimation = gamestate->playerCooldown / PLAYER_COOLDOWN_TIME;
+			oit_beginOpaque();
 		}
 
-		/* Blickrichtung anhand der letzten Bewegungsrichtung bestimmen */
-		switch (gamestate->lastDirection)
+		/* Die Lichtpositionen sind gesetzt, der Shader liest sie beim Zeichnen */
+		if (perPixel)
 		{
-			case dirDown:
-				zPlayerDir = 1.0f;
-				zPlayerOffset -= playerAnimation;
-				break;
-			case dirLeft:
-				xPlayerDir = -1.0f;
-				xPlayerOffset += playerAnimation;
-				break;
-			case dirRight:
-				xPlayerDir = 1.0f;
-				xPlayerOffset -= playerAnimation;
-				break;
-			case dirUp:
-				zPlayerDir = -1.0f;
-				zPlayerOffset += playerAnimation;
-				break;
+			lighting_begin();
 		}
 
-		/* Position des Auges*/
-		GLfloat eyeX = 0.0f;
-		GLfloat eyeY = 0.0f;
-		GLfloat eyeZ = 0.0f;
+		drawLevel3D(gamestate);
 
-		if (g_sceneFlags.firstPerson) 
+		/* Wasserflaechen rendern (Transparent), OIT nutzt eigene Shader,
+		 * sonst sind sie von prepareScene3D sortiert */
+		drawLevel3DWater(gamestate, &g_waterList, orderIndependent, perPixel);
+
+		if (orderIndependent)
 		{
-			/* Auskommentierte Werte fuer 3rd Person Ansicht */
-			eyeX = xPlayerOffset; // xPlayerOffset - xPlayerDir * 0.6f;
-			eyeY = 0.05f; // 0.75f; 
-		 	eyeZ = zPlayerOffset; // zPlayerOffset - zPlayerDir * 0.6f;
-
-			gluLookAt(eyeX,                     eyeY, eyeZ,                       /* Augpunkt */ 
-					xPlayerOffset + xPlayerDir, 0.0f, zPlayerOffset + zPlayerDir, /* Mittelpunkt */
-					0.0f,                       1.0f, 0.0f);  	                  /* Up-Vektor */
+			oit_composite();
 		}
-		else
-		{
-			GLfloat radius = gamestate->camera.radius;
-			GLfloat polar = TO_RADIANS(gamestate->camera.polarAngle);
-			GLfloat azimuth = TO_RADIANS(gamestate->camera.azimuthAngle);
-
-			eyeX = radius * sinf(azimuth) * cosf(polar);
-			eyeY = radius * cosf(azimuth);
-			eyeZ = radius * sinf(azimuth) * sinf(polar);
 
-			gluLookAt(eyeX, eyeY, eyeZ, /* Augpunkt */ 
-					0.0f, 0.0f, 0.0f,   /* Mittelpunkt */ 
-					0.0f, 1.0f, 0.0f);  /* Up-Vektor */
+		if (perPixel)
+		{
+			lighting_end();
 		}
-		
-		/* Position des Welt-Lichts setzen */
-		float worldlightPos[] = {0.0, 2.0, 0.0, 1.0};
-		glLightfv(LIGHT_WORLD, GL_POSITION, worldlightPos);
-
-		/* Position und Richtung des Spotlights setzen */
-		float spotlightPos[] = {xPlayerOffset, 0.05f, zPlayerOffset, 1.0};
-		float spotlightDirection[] = {xPlayerDir, -0.5f, zPlayerDir};
-		glLightfv(LIGHT_SPOTLIGHT, GL_SPOT_DIRECTION, spotlightDirection);
-		glLightfv(LIGHT_SPOTLIGHT, GL_POSITION, spotlightPos);
-
-		/* Liste fuer Wasserflaechen */
-		WaterFaceList waterList = EMPTY_WATER_FACE_LIST;
-
-		/* Level rendern (Opack) */
-		drawLevel3D(gamestate, &waterList);
-
-		/* Wasserflaechen nach Abstand zur Kammera sortieren */
-		water_calcDistances(&waterList, eyeX, eyeY, eyeZ);
-		water_sortDistances(&waterList);
-
-		/* Wasserflaechen rendern (Transparent) */
-		drawLevel3DWater(gamestate, &waterList);
-
-		water_free(&waterList);
 	}
 	glPopMatrix();
 
@@ -548,9 +1252,27 @@ void toggleNormal(void)
 {
 	g_sceneFlags.showNormals = !g_sceneFlags.showNormals;
 
-	/* Displaylisten mit/ohne Normalen neu erzeugen */
-	initDisplayList();
-	initDisplayList3D();
+	/* Die Chunks verweisen auf die Listen ohne/mit Normalen, diese werden
+	 * beim ersten Zeichnen aufgezeichnet und bleiben danach erhalten */
+	g_allChunksDirty = GL_TRUE;
+}
+
+void toggleOrderIndependent(void)
+{
+	g_sceneFlags.orderIndependent = !g_sceneFlags.orderIndependent;
+}
+
+void togglePerPixelLighting(void)
+{
+	g_sceneFlags.perPixelLighting = !g_sceneFlags.perPixelLighting;
+
+	/* Die Chunks verweisen auf die Listen mit/ohne unterteilte Kacheln */
+	g_allChunksDirty = GL_TRUE;
+}
+
+void setWaterCulling(GLboolean enabled)
+{
+	g_waterCulling = enabled;
 }
 
 GLboolean getNormalState(void)
@@ -558,6 +1280,11 @@ GLboolean getNormalState(void)
 	return g_sceneFlags.showNormals;
 }
 
+int getTileSubdivs(void)
+{
+	return (g_sceneFlags.perPixelLighting && lighting_available()) ? 0 : TILE_SUBDIVS;
+}
+
 int initScene(void)
 {
 	/* Hintergrundfarbe */
@@ -576,12 +1303,23 @@ int initScene(void)
 	/* Linienbreite */
 	glLineWidth(1.f);
 
-	/* Objekte in Displaylisten rendern */
+	/* Beleuchtung initialisieren */
+	initLight();
+
+	/* Reihenfolgeunabhaengige Transparenz vorbereiten, sonst wird sortiert */
+	oit_init();
+
+	/* Beleuchtung pro Pixel vorbereiten, sonst werden die Kacheln unterteilt */
+	lighting_init();
+
+	/* Objekte werden beim ersten Zeichnen in Displaylisten aufgezeichnet,
+	 * je Variante der Einstellungen, von denen sie abhaengen */
 	initDisplayList();
 	initDisplayList3D();
 
-	/* Beleuchtung initialisieren */
-	initLight();
+	/* Statistik der Wasserfaces beim Beenden ausgeben */
+	atexit(cleanupWater);
+	atexit(cleanupChunks);
 
 	/* Alles in Ordnung? */
 	return (GLGETERROR == GL_NO_ERROR);
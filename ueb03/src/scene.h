@@ -25,10 +25,12 @@ typedef struct
     unsigned char firstPerson : 1;
     unsigned char showNormals : 1;
     unsigned char animation : 1;
+    unsigned char orderIndependent : 1;
+    unsigned char perPixelLighting : 1;
 } SceneFlags;
 
 /* Defaultwerte fuer die Flags der Optionen */
-#define SCENE_FLAGS_DEFAULT {1, 0, 0, 1}
+#define SCENE_FLAGS_DEFAULT {1, 0, 0, 1, 1, 1}
 
 /* ---- Funktionen ---- */
 
@@ -39,11 +41,20 @@ typedef struct
  */
 void drawScene2D(void);
 
+/**
+ * Bereitet den 3D-Frame vor: Kamera, Ausschnitt, in der Ego-Perspektive die
+ * sichtbaren Kacheln, die Displaylisten der Chunks und die Reihenfolge der
+ * Wasserflaechen. Wird einmal je Frame nach dem Setzen des Viewports
+ * aufgerufen, beide Augen des Anaglyph-Renderings nutzen das Ergebnis.
+ */
+void prepareScene3D(void);
+
  /**
  * Zeichen-Funktion fuer 3D.
  * Stellt die Szene dar. Je nach Spielzustand wird ggf. ein Overlay mit
  * der Gewinn-/Verlustnachricht oder die Hilfe angezeigt.
- * 
+ * Setzt einen vorherigen Aufruf von prepareScene3D im selben Frame voraus.
+ *
  * @param eye der Augenabstand fuer das Anaglyph-Rendering.
  */
 void drawScene3D(AnaglyphEye eye);
@@ -83,6 +94,28 @@ void toggleSpotlight(void);
  */
 void toggleNormal(void);
 
+/**
+ * Wechselt zwischen reihenfolgeunabhaengiger und sortierter Transparenz
+ * fuer das Wasser. Ohne OIT-Unterstuetzung wird immer sortiert.
+ */
+void toggleOrderIndependent(void);
+
+/**
+ * Wechselt zwischen Beleuchtung pro Pixel mit unzerteilten Kacheln und
+ * Beleuchtung pro Vertex mit in TILE_SUBDIVS unterteilten Kacheln. Ohne
+ * Shader-Unterstuetzung wird immer pro Vertex beleuchtet.
+ */
+void togglePerPixelLighting(void);
+
+/**
+ * Legt fest, ob Seiten zwischen zwei Wasserfeldern weggelassen werden. Muss
+ * vor dem ersten Frame aufgerufen werden, die Wasserfaces werden erst bei
+ * der naechsten Aenderung des Levels neu aufgebaut.
+ *
+ * @param enabled GL_FALSE zeichnet alle Seiten, etwa zum Vergleich (In)
+ */
+void setWaterCulling(GLboolean enabled);
+
 /**
  * Gibt wieder, ob die Normalen angezeigt werden.
  * 
@@ -90,6 +123,14 @@ void toggleNormal(void);
  */
 GLboolean getNormalState(void);
 
+/**
+ * Gibt wieder, wie oft die Kacheln unterteilt werden: bei Beleuchtung pro
+ * Pixel gar nicht, sonst TILE_SUBDIVS mal.
+ * 
+ * @return die Anzahl der Unterteilungen fuer drawSquare.
+ */
+int getTileSubdivs(void);
+
 /**
  * Initialisierung der Szene (inbesondere der OpenGL-Statusmaschine).
  * Setzt Hintergrund- und Zeichenfarbe.
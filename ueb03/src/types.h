@@ -39,6 +39,9 @@
 /* Anzahl der Subdivisionen aller Tiles. Beeinflusst die Berechneung des Lichtes. */
 #define TILE_SUBDIVS (4)
 
+/* Vertikaler Oeffnungswinkel der 3D-Ansicht in Grad */
+#define FIELD_OF_VIEW (70.0f)
+
 /* ---- Macros ---- */
 
 /* Umrechnung von Grad zu Radian */
@@ -62,9 +65,12 @@ typedef enum {
 
 /* ---- Typedeklarationen - Level ---- */
 
-/* Hoehe/Breite des (quadratischen) Levels */
+/* Hoehe/Breite der (quadratischen) eingebauten Level */
 #define LEVELSIZE (9)
 
+/* Groesste Hoehe/Breite eines aus einer Datei geladenen Levels */
+#define LEVEL_MAX_SIZE (4096)
+
 /*
  * Art von Levelfeldern
  * 
@@ -73,7 +79,6 @@ typedef enum {
  * WM_WALL: Unzerstoerbares Feld
  * WM_GOAL: Zielfeld
  * WM_WATER : Wasser
- * WM_NEWWATER: Neu erzeugtes Wasserfeld
  * WM_SAND : Sandsack, bewegbares Feld
  * WM_SUGAR : Zuckerstueck, bewegbares Feld
  * WM_TOUCHED_SUGAR: Nasser Zucker
@@ -85,21 +90,40 @@ typedef enum {
     WM_WALL, 
     WM_GOAL,
     WM_WATER, 
-    WM_NEWWATER, 
-    WM_SAND, 
+    /* 5 bleibt frei, damit vorhandene Leveldateien gueltig bleiben */
+    WM_SAND = 6, 
     WM_SUGAR, 
     WM_TOUCHED_SUGAR, 
     WM_START
 } wmFieldType;
 
-/* Spielfeld */
+/* Ein Feld eines Levels zur Laufzeit, ein Byte mit einem Wert aus wmFieldType */
+typedef unsigned char wmField;
+
+/* Eingebautes Spielfeld */
 typedef wmFieldType wmLevel[LEVELSIZE][LEVELSIZE];
 
-/* Zeiger auf ein Spielfeld */
+/* Zeiger auf ein eingebautes Spielfeld */
 typedef const wmFieldType (*wmLevelPointer)[LEVELSIZE];
 
-/* Konstante fuer ein leeres Level */
-#define EMPTY_LEVEL {{0}, {0}, {0}, {0}, {0}, {0}, {0}, {0}, {0}}
+/* ---- Typedeklarationen - Geaenderte Felder ---- */
+
+/* Anzahl der Felder, die zwischen zwei Frames einzeln als geaendert gemerkt werden koennen */
+#define DIRTY_TILES_MAX (256)
+
+/*
+ * Felder, deren Darstellung sich seit dem letzten Frame geaendert hat. Laeuft
+ * die Liste ueber, wird stattdessen das ganze Level als geaendert markiert.
+ */
+typedef struct {
+    int count;
+    int x[DIRTY_TILES_MAX];
+    int y[DIRTY_TILES_MAX];
+    GLboolean all;
+} DirtyTiles;
+
+/* Konstante fuer eine leere Liste, zu Beginn ist das ganze Level neu */
+#define EMPTY_DIRTY_TILES {0, {0}, {0}, GL_TRUE}
 
 /* ---- Typedeklarationen - Kamera ---- */
 
@@ -138,7 +162,8 @@ typedef struct {
     int playerX, playerY; // Spielerposition
     PlayerDirection lastDirection; // Letzte Richtung
     int lastSandbagX, lastSandbagY; // Letzter Bewegter Sandsack
-    wmLevel level; // Leveldaten
+    int levelWidth, levelHeight; // Groesse des Levels in Feldern
+    wmField **level; // Leveldaten als Zeiger auf die Zeilen, Zugriff per level[y][x]
     int levelId; // ID des Levels
     Gamestage stage; // Spielzustand
     GLboolean showHelp; // Wird die Hilfe angezeigt?
@@ -146,10 +171,12 @@ typedef struct {
     float playerCooldown; // Verbleibende Zeit bis der Spieler sich wieder bewegen kann
     int loseMessageId; // Die ID der Nachricht, die beim Verlieren des Levels angezeigt wird
     SugarList sugarCubes; // Dynamisches Array mit allen nassen Zuckerwuerfeln
+    DirtyTiles dirtyTiles; // Seit dem letzten Frame geaenderte Felder
 } Gamestate;
 
 /* Konstante fuer einen leeren Spielzustand */
-#define EMPTY_GAMESTATE {EMPTY_CAMERA_ORIENTATION, 0, 0, dirDown, -1, -1, EMPTY_LEVEL, 0, \
-                         stageRunning, GL_FALSE, 0.0f, 0.0f, 0, EMPTY_SUGAR_LIST}
+#define EMPTY_GAMESTATE {EMPTY_CAMERA_ORIENTATION, 0, 0, dirDown, -1, -1, 0, 0, NULL, 0, \
+                         stageRunning, GL_FALSE, 0.0f, 0.0f, 0, EMPTY_SUGAR_LIST, \
+                         EMPTY_DIRTY_TILES}
 
 #endif
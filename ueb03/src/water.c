@@ -9,13 +9,34 @@
  */
 
 /* ---- System Header einbinden ---- */
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
 /* ---- Eigene Header einbinden ---- */
 #include "debugGL.h"
+#include "frametime.h"
 #include "water.h"
 
+/* ---- Konstanten ---- */
+
+/** Anfangskapazitaet des Arrays in Faces */
+#define WATER_INITIAL_CAPACITY (64)
+
+/** Erlaubte Verschiebungen je Face beim Insertion-Sort, bevor vollstaendig sortiert wird */
+#define WATER_MAX_SHIFTS_PER_FACE (8)
+
+/** Position der Faces relativ zum Mittelpunkt des Feldes */
+static const float FACE_OFFSETS[][3] = {
+    [WFACE_TOP]    = { 0.0f,  0.5f,  0.0f},
+    [WFACE_BOTTOM] = { 0.0f, -0.5f,  0.0f},
+    [WFACE_FRONT]  = { 0.0f,  0.0f,  0.5f},
+    [WFACE_BACK]   = { 0.0f,  0.0f, -0.5f},
+    [WFACE_LEFT]   = { 0.5f,  0.0f,  0.0f},
+    [WFACE_RIGHT]  = {-0.5f,  0.0f,  0.0f},
+};
+
 /* ---- Interne Funktionen ---- */
 
 /**
@@ -31,12 +52,16 @@ void water_addFace(WaterFaceList *list, float x, float y, float z, WaterSide sid
 {
     assert(list != NULL);
 
-    list->count++;
-    list->list = (WaterFace *) realloc(list->list, list->count * sizeof(WaterFace));
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : WATER_INITIAL_CAPACITY;
+        list->list = (WaterFace *) realloc(list->list, list->capacity * sizeof(WaterFace));
 
-    if (list->list == NULL) {
-        CG_ERROR("Cannot resize water list!");
+        if (list->list == NULL) {
+            CG_ERROR(("Cannot resize water list!"));
+        }
     }
+
+    list->count++;
     
     list->list[list->count - 1].x = x;
     list->list[list->count - 1].y = y;
@@ -46,43 +71,145 @@ void water_addFace(WaterFaceList *list, float x, float y, float z, WaterSide sid
 }
 
 /**
- * Vergleicht zwei Faces anhand deren Distanz zur Kamera.
+ * Liefert den Sortierschluessel eines Faces. Nicht-negative floats lassen sich
+ * ueber ihr Bitmuster als Ganzzahl vergleichen, das Komplement dreht die
+ * Reihenfolge fuer die absteigende Sortierung um.
  * 
- * @param a die X-Koordinate (In)
- * @param b die Y-Koordinate (In)
+ * @param face das Face (In)
+ * @return der Schluessel, aufsteigend sortiert ist die Distanz absteigend
+ */
+static uint32_t sortKey(const WaterFace *face)
+{
+    uint32_t bits;
+
+    memcpy(&bits, &face->camDistSqr, sizeof(bits));
+
+    return ~bits;
+}
+
+/**
+ * Sortiert per Insertion-Sort absteigend nach der Distanz. Bricht ab, sobald
+ * mehr als maxShifts Faces verschoben werden mussten.
  * 
- * @return 0 bei gleicher Distanz, 1 wenn a naeher an der Kamera ist. Sonst -1.
+ * @param list das Array mit Faces (InOut)
+ * @param maxShifts maximale Anzahl an Verschiebungen (In)
+ * @return 1 wenn das Array sortiert ist, 0 bei Abbruch
  */
-int water_compare(const void *a, const void *b)
+static int insertionSort(WaterFaceList *list, long maxShifts)
 {
-    const WaterFace *waterA = (WaterFace *) a;
-    const WaterFace *waterB = (WaterFace *) b;
+    WaterFace *faces = list->list;
+    long shifts = 0;
 
-    if (waterA->camDistSqr < waterB->camDistSqr)
+    for (int i = 1; i < list->count; i++)
     {
-        return 1;
+        WaterFace face = faces[i];
+        int j = i;
+
+        while (j > 0 && faces[j - 1].camDistSqr < face.camDistSqr)
+        {
+            faces[j] = faces[j - 1];
+            j--;
+        }
+
+        faces[j] = face;
+        shifts += i - j;
+
+        if (shifts > maxShifts)
+        {
+            return 0;
+        }
     }
 
-    if (waterA->camDistSqr > waterB->camDistSqr)
+    return 1;
+}
+
+/**
+ * Sortiert per LSD-Radix-Sort (4 Durchlaeufe zu 8 Bit) absteigend nach der
+ * Distanz. Durchlaeufe, in denen alle Schluessel dasselbe Byte haben, werden
+ * uebersprungen.
+ * 
+ * @param list das Array mit Faces (InOut)
+ */
+static void radixSort(WaterFaceList *list)
+{
+    list->scratch = (WaterFace *) realloc(list->scratch, list->capacity * sizeof(WaterFace));
+
+    if (list->scratch == NULL) {
+        CG_ERROR(("Cannot resize water list!"));
+    }
+
+    WaterFace *src = list->list;
+    WaterFace *dst = list->scratch;
+
+    for (int shift = 0; shift < 32; shift += 8)
     {
-        return -1;
+        int offsets[256] = {0};
+
+        for (int i = 0; i < list->count; i++)
+        {
+            offsets[(sortKey(&src[i]) >> shift) & 0xFF]++;
+        }
+
+        /* Alle im selben Fach, nichts zu tun */
+        if (offsets[(sortKey(&src[0]) >> shift) & 0xFF] == list->count)
+        {
+            continue;
+        }
+
+        for (int bucket = 0, sum = 0; bucket < 256; bucket++)
+        {
+            int count = offsets[bucket];
+            offsets[bucket] = sum;
+            sum += count;
+        }
+
+        for (int i = 0; i < list->count; i++)
+        {
+            dst[offsets[(sortKey(&src[i]) >> shift) & 0xFF]++] = src[i];
+        }
+
+        WaterFace *tmp = src;
+        src = dst;
+        dst = tmp;
     }
 
-    return 0;
+    /* Ergebnis liegt ggf. im Hilfspuffer, Puffer tauschen */
+    if (src != list->list)
+    {
+        list->scratch = list->list;
+        list->list = src;
+    }
 }
 
 /* ---- Oeffentliche Funktionen ---- */
 
-void water_add(WaterFaceList *list, float x, float z)
+void water_clear(WaterFaceList *list)
 {
     assert(list != NULL);
 
-    water_addFace(list, x, 0.5f, z, WFACE_TOP);
-    water_addFace(list, x, -0.5f, z, WFACE_BOTTOM);
-    water_addFace(list, x, 0.0f, z + 0.5f, WFACE_FRONT);
-    water_addFace(list, x, 0.0f, z - 0.5f, WFACE_BACK);
-    water_addFace(list, x + 0.5f, 0.0f, z, WFACE_LEFT);
-    water_addFace(list, x - 0.5f, 0.0f, z, WFACE_RIGHT);
+    list->count = 0;
+}
+
+void water_add(WaterFaceList *list, float x, float z, unsigned hiddenSides)
+{
+    assert(list != NULL);
+
+    for (int side = WFACE_TOP; side <= WFACE_RIGHT; side++)
+    {
+        if (!(hiddenSides & WATER_SIDE_BIT(side)))
+        {
+            water_addFace(list, x + FACE_OFFSETS[side][0], FACE_OFFSETS[side][1],
+                          z + FACE_OFFSETS[side][2], (WaterSide) side);
+        }
+    }
+}
+
+void water_faceTile(const WaterFace *face, float *x, float *z)
+{
+    assert(face != NULL);
+
+    *x = face->x - FACE_OFFSETS[face->side][0];
+    *z = face->z - FACE_OFFSETS[face->side][2];
 }
 
 void water_calcDistances(WaterFaceList *list, float camX, float camY, float camZ)
@@ -103,7 +230,41 @@ void water_sortDistances(WaterFaceList *list)
 {
     assert(list != NULL);
 
-    qsort(list->list, list->count, sizeof(WaterFace), water_compare);
+    uint64_t start = frametime_now();
+
+    if (list->count > 1 &&
+        !insertionSort(list, (long) list->count * WATER_MAX_SHIFTS_PER_FACE))
+    {
+        radixSort(list);
+        list->stats.fullSorts++;
+    }
+
+    list->stats.sorts++;
+    list->stats.sortNs += frametime_now() - start;
+}
+
+void water_printStats(const WaterFaceList *list)
+{
+    assert(list != NULL);
+
+    const WaterStats *stats = &list->stats;
+    /* Mit OIT wird nicht sortiert, daher Mittelwerte je Vorgang statt je Frame */
+    double builds = stats->builds ? (double) stats->builds : 1.0;
+    double sorts = stats->sorts ? (double) stats->sorts : 1.0;
+    int sides[WFACE_RIGHT + 1] = {0, 0, 0, 0, 0, 0};
+
+    for (int i = 0; i < list->count; i++)
+    {
+        sides[list->list[i].side]++;
+    }
+
+    printf("Wasser: %d Faces, %lu Neuaufbauten, %lu Sortierungen (%lu vollstaendig)\n",
+           list->count, stats->builds, stats->sorts, stats->fullSorts);
+    printf("        Aufbau %.3f us/Neuaufbau, Sortierung %.3f us/Sortierung\n",
+           stats->buildNs / builds / 1000.0, stats->sortNs / sorts / 1000.0);
+    printf("        Seiten: %d oben, %d unten, %d vorne, %d hinten, %d links, %d rechts\n",
+           sides[WFACE_TOP], sides[WFACE_BOTTOM], sides[WFACE_FRONT],
+           sides[WFACE_BACK], sides[WFACE_LEFT], sides[WFACE_RIGHT]);
 }
 
 void water_free(WaterFaceList *list)
@@ -111,6 +272,9 @@ void water_free(WaterFaceList *list)
     assert(list != NULL);
 
     free(list->list);
+    free(list->scratch);
     list->list = NULL; 
+    list->scratch = NULL;
     list->count = 0;
+    list->capacity = 0;
 }
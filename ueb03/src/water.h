@@ -10,6 +10,9 @@
  * @author Nicolas Hollmann, Daniel Klintworth
  */
 
+/* ---- System Header einbinden ---- */
+#include <stdint.h>
+
 /* ---- Typedeklarationen - Wasser ---- */
 
 /** Die Position eines Wassertiles auf dem Wuerfel. */
@@ -22,6 +25,9 @@ typedef enum {
     WFACE_RIGHT,
 } WaterSide;
 
+/** Bit einer Seite in der Maske der verdeckten Seiten fuer water_add. */
+#define WATER_SIDE_BIT(side) (1u << (side))
+
 /** Ein einzelnes Wasserface. */
 typedef struct {
     WaterSide side;
@@ -29,25 +35,60 @@ typedef struct {
     float camDistSqr;
 } WaterFace;
 
-/** Eine Kollektion von Wasserfaces. */
+/** Laufzeitstatistik einer Kollektion von Wasserfaces. */
+typedef struct {
+    unsigned long builds; // Anzahl der Neuaufbauten
+    unsigned long sorts; // Anzahl der Sortierungen
+    unsigned long fullSorts; // davon vollstaendige Sortierungen (Radix-Sort)
+    uint64_t buildNs; // Gesamtdauer der Neuaufbauten in Nanosekunden
+    uint64_t sortNs; // Gesamtdauer der Sortierungen in Nanosekunden
+} WaterStats;
+
+/**
+ * Eine Kollektion von Wasserfaces. Der Speicher waechst bei Bedarf auf die
+ * doppelte Groesse und wird bis zum Aufruf von water_free wiederverwendet.
+ */
 typedef struct {
     int count;
+    int capacity;
     WaterFace *list;
+    WaterFace *scratch; // Hilfspuffer fuer den Radix-Sort
+    WaterStats stats;
 } WaterFaceList;
 
 
-#define EMPTY_WATER_FACE_LIST {0, NULL}
+#define EMPTY_WATER_FACE_LIST {0, 0, NULL, NULL, {0, 0, 0, 0, 0}}
 
 /* ---- Funktionen ---- */
 
 /**
- * Fuegt ein neues Wasserfeld mit 6 Faces hinzu.
+ * Leert die Kollektion, der Speicher bleibt fuer den naechsten Aufbau erhalten.
+ * 
+ * @param list Das zu leerende Array (InOut)
+ */
+void water_clear(WaterFaceList *list);
+
+/**
+ * Fuegt ein neues Wasserfeld mit bis zu 6 Faces hinzu. Seiten, an denen ein
+ * weiteres Wasserfeld anliegt, liegen im Inneren des Wassers und werden
+ * weggelassen.
  * 
  * @param list Das Array zum Speichern der Faces (InOut)
  * @param x die X-Koordinate (In)
  * @param z die Z-Koordinate (In)
+ * @param hiddenSides Maske aus WATER_SIDE_BIT der verdeckten Seiten (In)
  */
-void water_add(WaterFaceList *list, float x, float z);
+void water_add(WaterFaceList *list, float x, float z, unsigned hiddenSides);
+
+/**
+ * Liefert die Position des Wasserfeldes, zu dem ein Face gehoert, also die
+ * bei water_add uebergebenen Koordinaten.
+ * 
+ * @param face das Face (In)
+ * @param x die X-Koordinate des Feldes (Out)
+ * @param z die Z-Koordinate des Feldes (Out)
+ */
+void water_faceTile(const WaterFace *face, float *x, float *z);
 
 /**
  * Berechnet fuer alle im Array befindlichen Faces den Abstand zur Kamera.
@@ -63,11 +104,24 @@ void water_calcDistances(WaterFaceList *list, float camX, float camY, float camZ
  * Sortiert die im Array befindlichen Faces absteigend nach der Distanz zur Kamera. 
  * Zuvor muessen per water_calcDistances die Distanzen berechnet worden sein.
  * 
+ * Da sich die Kamera zwischen zwei Frames kaum bewegt, ist die Reihenfolge des
+ * letzten Frames fast richtig. Es wird daher zuerst per Insertion-Sort sortiert.
+ * Muessen dabei zu viele Faces verschoben werden, wird mit einem Radix-Sort
+ * ueber die Distanzen vollstaendig sortiert. Die Dauer geht in list->stats ein.
+ * 
  * @param list das Array mit Faces (InOut)
  */
 void water_sortDistances(WaterFaceList *list);
 
 
+/**
+ * Gibt die Laufzeitstatistik (mittlere Dauer je Aufbau und je Sortierung)
+ * und die Anzahl der aktuellen Faces je Seite auf der Konsole aus.
+ * 
+ * @param list das Array mit Faces (In)
+ */
+void water_printStats(const WaterFaceList *list);
+
 /**
  * Gibt den Speicher des dynamischen Arrays wieder frei.
  * 
@@ -49,6 +49,9 @@ static void drawFPS(Gamestate *gamestate)
  */
 static void drawOverlay(void)
 {
+	/* Bisherige Texte liegen unter dem Overlay */
+	flushStringBatch();
+
 	glPushMatrix();
 	{
 		glEnable(GL_BLEND);
@@ -111,6 +114,9 @@ void drawHUD(void)
 
     glDisable(GL_DEPTH_TEST);
 
+	/* Alle Texte sammeln und moeglichst mit einem Aufruf zeichnen */
+	beginStringBatch();
+
 	drawFPS(gamestate);
 	
 	if (gamestate->showHelp)
@@ -118,6 +124,8 @@ void drawHUD(void)
 		drawHelp();
 	}
 
+	endStringBatch();
+
 	/* DEBUG-Ausgabe */
 	GLSTATE;
 }
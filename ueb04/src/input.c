@@ -21,6 +21,7 @@
 #include "input.h"
 #include "logic.h"
 #include "scene.h"
+#include "headless.h"
 #include "io.h"
 
 /* ---- Konstanten ---- */
@@ -59,6 +60,13 @@ static void toggleFullscreen(void)
 	/* Zwischenspeicher: Fenstergroesse */
 	static int windowSize[2];
 
+	/* Ohne Fenster gibt es nichts umzuschalten (z.B. bei der Wiedergabe im
+	 * Headless-Modus) */
+	if (headless_active())
+	{
+		return;
+	}
+
 	/* Modus wechseln */
 	fullscreen = !fullscreen;
 
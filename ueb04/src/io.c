@@ -29,6 +29,11 @@
 #include "logic.h"
 #include "scene.h"
 #include "hud.h"
+#include "matrix.h"
+#include "frametime.h"
+#include "stringOutput.h"
+#include "headless.h"
+#include "replay.h"
 #include "debugGL.h"
 
 /* ---- Konstanten ---- */
@@ -39,44 +44,12 @@
 /** Anzahl der Aufrufe der Logik-Funktion pro Sekunde */
 #define LOGIC_CALLS_PS 80
 
-/* ---- Interne Funktionen ---- */
-
-/**
- * Berechnung der Frames pro Sekunde.
- * 
- * @return aktuelle Framerate.
- */
-static GLfloat frameRate(void)
-{
-	/* Zeitpunkt der letzten Neuberechnung */
-	static int timebase = 0;
-	/* Anzahl der Aufrufe seit letzter Neuberechnung */
-	static int frameCount = 0;
-	/* Zuletzt berechneter FPS-Wert */
-	static float fps = 0.0;
-	/* aktuelle "Zeit" */
-	static int time = 0;
-
-	/* Diesen Aufruf hinzuzaehlen */
-	frameCount++;
-
-	/* seit dem Start von GLUT vergangene Zeit ermitteln */
-	time = glutGet (GLUT_ELAPSED_TIME);
-
-	/* Eine Sekunde ist vergangen */
-	if (time - timebase > 1000)
-	{
-		/* FPS-Wert neu berechnen */
-		fps = frameCount * 1000.0f / (time - timebase);
+/* ---- Globale Daten ---- */
 
-		/* Zureuecksetzen */
-		timebase = time;
-		frameCount = 0;
-	}
+/** Groesse des zuletzt gezeichneten Bildes, mit und ohne Fenster gueltig */
+static int g_frameSize[2] = {1, 1};
 
-	/* Aktuellen FPS-Wert zurueckgeben */
-	return fps;
-}
+/* ---- Interne Funktionen ---- */
 
 /**
  * Verarbeitung der Picking-Ergebnisse.
@@ -152,10 +125,13 @@ static void set3DViewport(GLint x, GLint y, GLint width, GLint height)
 	glViewport(x, y, width, height);
 
 	/* Perspektivische Darstellung */
-	gluPerspective(70, 		/* Oeffnungswinkel */
-				   aspect,  /* Seitenverhaeltnis */
-				   0.05,	/* nahe Clipping-Ebene */
-				   100);	/* ferne Clipping-Ebene */
+	CGMatrix4f projection;
+	matrix_perspective(projection,
+	                   70.0f,         /* Oeffnungswinkel */
+	                   (float)aspect, /* Seitenverhaeltnis */
+	                   0.05f,         /* nahe Clipping-Ebene */
+	                   100.0f);       /* ferne Clipping-Ebene */
+	glMultMatrixf(projection);
 
 	/* Folge Operationen beeinflussen die Modelviewmatrix */
 	glMatrixMode(GL_MODELVIEW);
@@ -203,6 +179,34 @@ static void set2DViewport(GLint x, GLint y, GLint width, GLint height)
 	glLoadIdentity();
 }
 
+/**
+ * Leitet ein aufgezeichnetes oder live eingetroffenes Tastaturereignis an die
+ * Ereignisbehandlung weiter.
+ *
+ * @param key Taste (In)
+ * @param status Status der Taste (In)
+ * @param isSpecialKey ungleich 0 bei Spezialtasten (In)
+ * @param x, y Position des Mauszeigers (In)
+ */
+static void onKeyboardEvent(int key, int status, int isSpecialKey, int x, int y)
+{
+	handleKeyboardEvent(key, status, (GLboolean)isSpecialKey, x, y);
+}
+
+/**
+ * Leitet ein aufgezeichnetes oder live eingetroffenes Mausereignis an die
+ * Ereignisbehandlung weiter.
+ *
+ * @param x, y Position des Mauszeigers (In)
+ * @param eventType Art des Ereignisses (In)
+ * @param button Maustaste (In)
+ * @param state Status der Maustaste (In)
+ */
+static void onMouseEvent(int x, int y, int eventType, int button, int state)
+{
+	handleMouseEvent(x, y, (CGMouseEventType)eventType, button, state);
+}
+
 /**
  * Mouse-Button-Callback.
  * 
@@ -213,7 +217,7 @@ static void set2DViewport(GLint x, GLint y, GLint width, GLint height)
  */
 static void cbMouseButton (int button, int state, int x, int y)
 {
-	handleMouseEvent(x, y, mouseButton, button, state);
+	replay_mouseEvent(x, y, mouseButton, button, state);
 }
 
 /**
@@ -224,7 +228,7 @@ static void cbMouseButton (int button, int state, int x, int y)
  */
 static void cbMouseMotion (int x, int y)
 {
-	handleMouseEvent(x, y, mouseMotion, 0, 0);
+	replay_mouseEvent(x, y, mouseMotion, 0, 0);
 }
 
 /**
@@ -235,7 +239,7 @@ static void cbMouseMotion (int x, int y)
  */
 static void cbMousePassiveMotion (int x, int y)
 {
-	handleMouseEvent(x, y, mousePassiveMotion, 0, 0);
+	replay_mouseEvent(x, y, mousePassiveMotion, 0, 0);
 }
 
 /**
@@ -248,7 +252,7 @@ static void cbMousePassiveMotion (int x, int y)
  */
 static void cbKeyboard(unsigned char key, int x, int y)
 {
-	handleKeyboardEvent(key, GLUT_DOWN, GL_FALSE, x, y);
+	replay_keyboardEvent(key, GLUT_DOWN, GL_FALSE, x, y);
 }
 
 /**
@@ -261,7 +265,7 @@ static void cbKeyboard(unsigned char key, int x, int y)
  */
 static void cbKeyboardUp(unsigned char key, int x, int y)
 {
-	handleKeyboardEvent(key, GLUT_UP, GL_FALSE, x, y);
+	replay_keyboardEvent(key, GLUT_UP, GL_FALSE, x, y);
 }
 
 /**
@@ -274,7 +278,7 @@ static void cbKeyboardUp(unsigned char key, int x, int y)
  */
 static void cbSpecial(int key, int x, int y)
 {
-	handleKeyboardEvent(key, GLUT_DOWN, GL_TRUE, x, y);
+	replay_keyboardEvent(key, GLUT_DOWN, GL_TRUE, x, y);
 }
 
 /**
@@ -287,7 +291,7 @@ static void cbSpecial(int key, int x, int y)
  */
 static void cbSpecialUp(int key, int x, int y)
 {
-	handleKeyboardEvent(key, GLUT_UP, GL_TRUE, x, y);
+	replay_keyboardEvent(key, GLUT_UP, GL_TRUE, x, y);
 }
 
 /**
@@ -310,21 +314,16 @@ static void cbTimer(int lastCallTime)
 }
 
 /**
- * Idle-Callback.
- * Initiiert Berechnung der aktuellen Position und Farben.
- * Dient als getrennte Update-Schleife.
+ * Schreitet die Spiellogik in festen Schritten von 1 / LOGIC_CALLS_PS
+ * Sekunden voran. Nicht verbrauchte Zeit wird fuer den naechsten Aufruf
+ * aufgehoben.
+ * 
+ * @param interval seit dem letzten Aufruf vergangene Zeit in Sekunden (In)
  */
-static void cbIdle()
+static void stepLogic(double interval)
 {
-	static int lastCallTime = 0;
 	static double accumulator = 0.0;
 
-	/* Seit dem Programmstart vergangene Zeit in Millisekunden */
-	int thisCallTime = glutGet(GLUT_ELAPSED_TIME);
-
-	/* Seit dem letzten Funktionsaufruf vergangene Zeit in Sekunden */
-	double interval = (double)(thisCallTime - lastCallTime) / 1000.0f;
-
 	accumulator += interval;
 	
 	while (accumulator >= 1.0 / LOGIC_CALLS_PS)
@@ -338,20 +337,49 @@ static void cbIdle()
 
 		accumulator -= 1.0 / LOGIC_CALLS_PS;
 	}
+}
+
+/**
+ * Idle-Callback.
+ * Initiiert Berechnung der aktuellen Position und Farben.
+ * Dient als getrennte Update-Schleife.
+ */
+static void cbIdle()
+{
+	static int lastCallTime = 0;
+
+	/* Seit dem Programmstart vergangene Zeit in Millisekunden */
+	int thisCallTime = glutGet(GLUT_ELAPSED_TIME);
+
+	/* Seit dem letzten Funktionsaufruf vergangene Zeit in Sekunden */
+	double interval = (double)(thisCallTime - lastCallTime) / 1000.0f;
+
+	/* Eine Wiedergabe ist mit dem letzten aufgezeichneten Schritt beendet */
+	if (replay_finished())
+	{
+		exit(0);
+	}
+
+	/* Bei Aufzeichnung/Wiedergabe laeuft der Zeitschritt ueber das Replay-Modul */
+	stepLogic(replay_tick(interval));
 
 	lastCallTime = thisCallTime;
 }
 
 /**
- * Zeichen-Callback.
- * Loescht die Buffer, ruft das Zeichnen der Szene auf und tauscht den Front-
- * und Backbuffer.
+ * Zeichnet einen Frame in den aktuellen Framebuffer.
+ * 
+ * @param width Breite des Framebuffers (In)
+ * @param height Hoehe des Framebuffers (In)
  */
-static void cbDisplay(void)
+static void drawFrame(int width, int height)
 {
-	/* Fensterdimensionen auslesen */
-	int width = glutGet(GLUT_WINDOW_WIDTH);
-	int height = glutGet(GLUT_WINDOW_HEIGHT);
+	/* Groesse fuer das Picking merken */
+	g_frameSize[0] = width;
+	g_frameSize[1] = height;
+
+	/* Schriftatlas einmalig im sichtbaren Fenster rastern, vor dem Loeschen */
+	initStringOutput();
 
 	/* Buffer zuruecksetzen */
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -378,12 +406,28 @@ static void cbDisplay(void)
 	/* HUD */
 	set2DViewport(0, 0, width, height);
 	drawHUD();
+}
+
+/**
+ * Zeichen-Callback.
+ * Loescht die Buffer, ruft das Zeichnen der Szene auf und tauscht den Front-
+ * und Backbuffer.
+ */
+static void cbDisplay(void)
+{
+	frametime_beginFrame();
+
+	/* Fensterdimensionen auslesen */
+	drawFrame(glutGet(GLUT_WINDOW_WIDTH), glutGet(GLUT_WINDOW_HEIGHT));
 
 	/* Objekte anzeigen */
 	glutSwapBuffers();
 
+	/* Dauer des Frames messen */
+	frametime_endFrame();
+
 	/* Framerate bestimmen */
-	getGamestate()->fps = frameRate();
+	getGamestate()->fps = frametime_fps();
 }
 
 /**
@@ -443,9 +487,10 @@ void pick(int x, int y, GLboolean leftButton)
 	/** Groesse des Buffers fuer Picking Ergebnisse */
 	#define SELECTBUFSIZE 512
 
-	/* Fensterdimensionen auslesen */
-	int width = glutGet(GLUT_WINDOW_WIDTH);
-	int height = glutGet(GLUT_WINDOW_HEIGHT);
+	/* Dimensionen des zuletzt gezeichneten Bildes, funktioniert auch ohne
+	 * Fenster bei der Wiedergabe im Headless-Modus */
+	int width = g_frameSize[0];
+	int height = g_frameSize[1];
 
 	/* Buffer zuruecksetzen */
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -482,10 +527,13 @@ void pick(int x, int y, GLboolean leftButton)
 	gluPickMatrix(x, height - y, 10, 10, viewport);
 
 	/* Perspektivische Darstellung */
-	gluPerspective(70, 		/* Oeffnungswinkel */
-				   aspect,  /* Seitenverhaeltnis */
-				   0.05,	/* nahe Clipping-Ebene */
-				   100);	/* ferne Clipping-Ebene */
+	CGMatrix4f projection;
+	matrix_perspective(projection,
+	                   70.0f,         /* Oeffnungswinkel */
+	                   (float)aspect, /* Seitenverhaeltnis */
+	                   0.05f,         /* nahe Clipping-Ebene */
+	                   100.0f);       /* ferne Clipping-Ebene */
+	glMultMatrixf(projection);
 
 	/* Folge Operationen beeinflussen die Modelviewmatrix */
 	glMatrixMode(GL_MODELVIEW);
@@ -533,7 +581,8 @@ int initAndStartIO(char *title, int width, int height)
 		INFO(("...fertig.\n\n"));
 		INFO(("Initialisiere Zufallsgenerator...\n"));
 
-		srand(time(0));
+		srand(replay_seed((unsigned)time(0)));
+		replay_setHandlers(onKeyboardEvent, onMouseEvent);
 
 		INFO(("...fertig.\n\n"));
 		INFO(("Initialisiere Szene...\n"));
@@ -583,3 +632,71 @@ int initAndStartIO(char *title, int width, int height)
 
 	return windowID;
 }
+
+int runHeadless(int frames, int width, int height, const char *dumpDir)
+{
+	int success = 0;
+
+	INFO(("Erzeuge Kontext ohne Fenster...\n"));
+
+	if (headless_init(width, height, 0, 0, 0))
+	{
+		INFO(("...fertig.\n\n"));
+		INFO(("Initialisiere Zufallsgenerator...\n"));
+
+		/* Feste Saat, damit jeder Lauf dieselben Bilder liefert */
+		srand(replay_seed(0));
+		replay_setHandlers(onKeyboardEvent, onMouseEvent);
+
+		INFO(("...fertig.\n\n"));
+		INFO(("Initialisiere Szene...\n"));
+
+		if (initScene() && initTextures())
+		{
+			INFO(("...fertig.\n\n"));
+			INFO(("Initialisiere Logik...\n"));
+
+			initLogic();
+
+			INFO(("...fertig.\n\n"));
+
+			uint64_t start = frametime_now();
+
+			int frame;
+
+			/* Bei einer Wiedergabe endet der Lauf mit der Aufzeichnung */
+			for (frame = 0; frame < frames && !replay_finished(); frame++)
+			{
+				stepLogic(replay_tick(HEADLESS_DT));
+
+				frametime_beginFrame();
+				drawFrame(width, height);
+				headless_finishFrame();
+				frametime_endFrame();
+
+				if (dumpDir != NULL)
+				{
+					headless_dumpFrame(dumpDir, frame);
+				}
+			}
+
+			double seconds = (frametime_now() - start) / 1e9;
+			printf("%d Frames (%dx%d) in %.3f s, %.2f FPS\n",
+			       frame, width, height, seconds, frame / seconds);
+
+			success = 1;
+		}
+		else
+		{
+			INFO(("...fehlgeschlagen.\n\n"));
+		}
+
+		headless_cleanup();
+	}
+	else
+	{
+		INFO(("...fehlgeschlagen.\n\n"));
+	}
+
+	return success;
+}
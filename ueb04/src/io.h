@@ -37,4 +37,17 @@ void pick(int x, int y, GLboolean leftButton);
  */
 int initAndStartIO(char *title, int width, int height);
 
+/**
+ * Initialisiert das Programm ohne Fenster und rendert eine feste Anzahl an
+ * Frames mit festem Zeitschritt (HEADLESS_DT). Die Zeitmessung der Frames
+ * wird wie im Fenster-Betrieb beim Programmende ausgegeben.
+ *
+ * @param frames Anzahl der Frames (In)
+ * @param width Breite des Bildes (In)
+ * @param height Hoehe des Bildes (In)
+ * @param dumpDir Verzeichnis fuer die Bilder oder NULL (In)
+ * @return 1 bei Erfolg, 0 im Fehlerfall
+ */
+int runHeadless(int frames, int width, int height, const char *dumpDir);
+
 #endif
@@ -0,0 +1,187 @@
+#ifndef __MATRIX_H__
+#define __MATRIX_H__
+/**
+ * @file
+ * Matrix-Modul.
+ * Das Modul kapselt Rechnungen mit 4x4-Matrizen und homogenen Vektoren.
+ * Matrizen werden wie bei OpenGL spaltenweise gespeichert, koennen also
+ * direkt an glLoadMatrixf, glMultMatrixf oder glUniformMatrix4fv
+ * uebergeben werden. Wo vorhanden, wird mit SSE gerechnet.
+ *
+ * Bestandteil einer Uebung im Rahmen des Moduls Praktikum Grundlagen der Computergrafik
+ * an der FH Wedel.
+ *
+ * @author Nicolas Hollmann, Daniel Klintworth
+ */
+
+/* ---- Typedeklarationen ---- */
+
+/** 4x4-Matrix, spaltenweise gespeichert */
+typedef float CGMatrix4f[16];
+
+/** 3x3-Matrix, spaltenweise gespeichert */
+typedef float CGMatrix3f[9];
+
+/** Homogener Vektor bzw. Ebene (a, b, c, d) mit ax + by + cz + d = 0 */
+typedef float CGVector4f[4];
+
+/** Die sechs Ebenen eines Sichtvolumens */
+typedef enum {
+	PLANE_LEFT = 0,
+	PLANE_RIGHT,
+	PLANE_BOTTOM,
+	PLANE_TOP,
+	PLANE_NEAR,
+	PLANE_FAR,
+
+	PLANE_COUNT
+} FrustumPlane;
+
+/* ---- Funktionen ---- */
+
+/**
+ * Setzt eine Matrix auf die Einheitsmatrix.
+ *
+ * @param m die Matrix (Out)
+ */
+void matrix_identity(CGMatrix4f m);
+
+/**
+ * Multipliziert zwei Matrizen: res = a * b. res darf a oder b sein.
+ *
+ * @param res das Ergebnis (Out)
+ * @param a linker Faktor (In)
+ * @param b rechter Faktor (In)
+ */
+void matrix_multiply(CGMatrix4f res, const CGMatrix4f a, const CGMatrix4f b);
+
+/**
+ * Multipliziert eine Verschiebung von rechts an die Matrix (wie glTranslatef).
+ *
+ * @param m die Matrix (InOut)
+ * @param x, y, z die Verschiebung (In)
+ */
+void matrix_translate(CGMatrix4f m, float x, float y, float z);
+
+/**
+ * Multipliziert eine Rotation von rechts an die Matrix (wie glRotatef).
+ *
+ * @param m die Matrix (InOut)
+ * @param angle der Winkel in Grad (In)
+ * @param x, y, z die Rotationsachse, muss nicht normiert sein (In)
+ */
+void matrix_rotate(CGMatrix4f m, float angle, float x, float y, float z);
+
+/**
+ * Multipliziert eine Skalierung von rechts an die Matrix (wie glScalef).
+ *
+ * @param m die Matrix (InOut)
+ * @param x, y, z die Skalierungsfaktoren (In)
+ */
+void matrix_scale(CGMatrix4f m, float x, float y, float z);
+
+/**
+ * Erzeugt eine perspektivische Projektion (wie glFrustum).
+ *
+ * @param m die Matrix (Out)
+ * @param left, right, bottom, top die Grenzen an der nahen Ebene (In)
+ * @param znear, zfar die Abstaende der Clipping-Ebenen (In)
+ */
+void matrix_frustum(CGMatrix4f m, float left, float right, float bottom, float top, float znear, float zfar);
+
+/**
+ * Erzeugt eine perspektivische Projektion (wie gluPerspective).
+ *
+ * @param m die Matrix (Out)
+ * @param fovy der vertikale Oeffnungswinkel in Grad (In)
+ * @param aspect das Seitenverhaeltnis Breite / Hoehe (In)
+ * @param znear, zfar die Abstaende der Clipping-Ebenen (In)
+ */
+void matrix_perspective(CGMatrix4f m, float fovy, float aspect, float znear, float zfar);
+
+/**
+ * Erzeugt eine orthogonale Projektion (wie glOrtho).
+ *
+ * @param m die Matrix (Out)
+ * @param left, right, bottom, top die Grenzen (In)
+ * @param znear, zfar die Abstaende der Clipping-Ebenen (In)
+ */
+void matrix_ortho(CGMatrix4f m, float left, float right, float bottom, float top, float znear, float zfar);
+
+/**
+ * Erzeugt eine Kameramatrix (wie gluLookAt).
+ *
+ * @param m die Matrix (Out)
+ * @param eyeX, eyeY, eyeZ der Augpunkt (In)
+ * @param centerX, centerY, centerZ der betrachtete Punkt (In)
+ * @param upX, upY, upZ der Up-Vektor (In)
+ */
+void matrix_lookAt(CGMatrix4f m,
+                   float eyeX, float eyeY, float eyeZ,
+                   float centerX, float centerY, float centerZ,
+                   float upX, float upY, float upZ);
+
+/**
+ * Invertiert eine Matrix. res darf m sein.
+ *
+ * @param res die Inverse (Out)
+ * @param m die zu invertierende Matrix (In)
+ *
+ * @return 0, wenn die Matrix nicht invertierbar ist (res bleibt dann unveraendert)
+ */
+int matrix_invert(CGMatrix4f res, const CGMatrix4f m);
+
+/**
+ * Berechnet die Normalenmatrix (Inverse-Transponierte des oberen linken
+ * 3x3-Teils) einer Modelview-Matrix.
+ *
+ * @param res die Normalenmatrix (Out)
+ * @param m die Modelview-Matrix (In)
+ *
+ * @return 0, wenn der 3x3-Teil nicht invertierbar ist
+ */
+int matrix_normal(CGMatrix3f res, const CGMatrix4f m);
+
+/**
+ * Bestimmt die Ebenen des Sichtvolumens aus einer Matrix. Ist m eine
+ * Projektionsmatrix, liegen die Ebenen im Kamerasystem, ist m
+ * Projektion * Modelview, im Objektsystem. Die Normalen zeigen nach innen
+ * und sind normiert, Abstaende sind also euklidisch.
+ *
+ * @param planes die sechs Ebenen, Reihenfolge siehe FrustumPlane (Out)
+ * @param m die Matrix (In)
+ */
+void matrix_frustumPlanes(CGVector4f planes[PLANE_COUNT], const CGMatrix4f m);
+
+/**
+ * Prueft, ob eine Kugel (zumindest teilweise) im Sichtvolumen liegt.
+ *
+ * @param planes die Ebenen aus matrix_frustumPlanes (In)
+ * @param x, y, z der Mittelpunkt (In)
+ * @param radius der Radius (In)
+ *
+ * @return 1, wenn die Kugel sichtbar sein kann, sonst 0
+ */
+int matrix_sphereInFrustum(CGVector4f planes[PLANE_COUNT], float x, float y, float z, float radius);
+
+/**
+ * Transformiert einen Vektor: res = m * v. res darf v sein.
+ *
+ * @param res das Ergebnis (Out)
+ * @param m die Matrix (In)
+ * @param v der Vektor (In)
+ */
+void matrix_transform(CGVector4f res, const CGMatrix4f m, const CGVector4f v);
+
+/**
+ * Transformiert viele Vektoren mit derselben Matrix: res[i] = m * v[i].
+ * res darf v sein.
+ *
+ * @param res die Ergebnisse (Out)
+ * @param m die Matrix (In)
+ * @param v die Vektoren (In)
+ * @param count die Anzahl der Vektoren (In)
+ */
+void matrix_transformArray(CGVector4f *res, const CGMatrix4f m, CGVector4f *v, int count);
+
+#endif
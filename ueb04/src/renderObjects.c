@@ -39,25 +39,46 @@
 // Anzahl der Komponenten, aus denen die Insel besteht.
 #define ISLE_PARTS (12)
 
+/* Einstellungen, von denen die Objekte abhaengen, als Bitmaske */
+#define RO_VARIANT_NORMALS (1u << 0) /* Normalen werden angezeigt */
+
+/* Anzahl der moeglichen Varianten eines Objekts */
+#define RO_VARIANT_COUNT (2)
+
 /* ---- Globale Variablen ---- */
 
+/**
+ * Einstellungen, von denen die Objekte abhaengen (RO_VARIANT_...). Nur
+ * diese gehen in die Variante ein, Wasserkugel und Himmel werden also nur
+ * einmal aufgezeichnet.
+ */
+static const unsigned g_dependencies[RO_SIZE] = {
+	0,                   /* RO_SPHERE */
+	RO_VARIANT_NORMALS,  /* RO_ISLE_TOP */
+	RO_VARIANT_NORMALS,  /* RO_ISLE_RING */
+	0                    /* RO_SKY */
+};
+
 /** 
- * Speichert die erste Displayliste und macht
- * damit alle weiteren Zugreifbar.
+ * Displaylisten je Objekt und Variante, 0 solange die Variante
+ * noch nicht aufgezeichnet wurde.
  */
-GLuint g_renderObjects = 0;
+static GLuint g_renderObjects[RO_SIZE][RO_VARIANT_COUNT];
 
 /* ---- Interne Funktionen ---- */
 
 /**
- * Gibt die ID einer Displayliste anhand eines Objektes zurueck.
+ * Gibt die Displayliste eines Objektes fuer die aktuellen Einstellungen zurueck.
  * 
  * @param renderObject das gewuenschte Objekt (In)
- * @return die ID der Displayliste
+ * @return Zeiger auf die ID der Displayliste, die ID ist 0, wenn sie noch
+ *         nicht aufgezeichnet wurde
  */
-static GLuint getRenderObject(RenderObject renderObject)
+static GLuint *getRenderObject(RenderObject renderObject)
 {
-	return g_renderObjects + renderObject;
+	unsigned variant = getNormalState() ? RO_VARIANT_NORMALS : 0u;
+
+	return &g_renderObjects[renderObject][variant & g_dependencies[renderObject]];
 }
 
 /** 
@@ -165,6 +186,32 @@ static void drawSkySphere(void)
 	gluDeleteQuadric(quadric);
 }
 
+/**
+ * Zeichnet ein Objekt direkt, beim Aufzeichnen seiner Displayliste.
+ * 
+ * @param object das Objekt (In)
+ */
+static void drawRenderObject(RenderObject object)
+{
+	switch (object)
+	{
+		case RO_SPHERE:
+			drawWaterSphere();
+			break;
+		case RO_ISLE_TOP:
+			drawIsleTop();
+			break;
+		case RO_ISLE_RING:
+			drawIsleRing();
+			break;
+		case RO_SKY:
+			drawSkySphere();
+			break;
+		case RO_SIZE:
+			break;
+	}
+}
+
 /* ---- Oeffentliche Funktionen ---- */
 
 void drawSquare(int subDivs)
@@ -203,46 +250,38 @@ void drawSquare(int subDivs)
 
 void initDisplayList(void) 
 {
-	if (g_renderObjects != 0)
+	for (int object = 0; object < RO_SIZE; object++)
 	{
-		glDeleteLists(g_renderObjects, (GLsizei) RO_SIZE);
-	}
-
-    // Alle benoetigten Listen auf einmal erzeugen
-	g_renderObjects = glGenLists((GLsizei) RO_SIZE);
-	if (g_renderObjects != 0) {
-		for (GLuint index = 0; index < RO_SIZE; index++)
+		for (int variant = 0; variant < RO_VARIANT_COUNT; variant++)
 		{
-            // Displayliste bereit machen
-			glNewList(g_renderObjects + index, GL_COMPILE);
-			
-			switch (index)
+			if (g_renderObjects[object][variant] != 0)
 			{
-				case RO_SPHERE:
-					drawWaterSphere();
-					break;
-				case RO_ISLE_TOP:
-					drawIsleTop();
-					break;
-				case RO_ISLE_RING:
-					drawIsleRing();
-					break;
-				case RO_SKY:
-					drawSkySphere();
-					break;
+				glDeleteLists(g_renderObjects[object][variant], 1);
+				g_renderObjects[object][variant] = 0;
 			}
-
-            // Displayliste abschliessen
-			glEndList();
 		}
-	} else {
-		CG_ERROR(("Konnte Displaylisten nicht erzeugen\n"));
 	}
 }
 
 void renderObject(RenderObject object)
 {
-    glCallList(getRenderObject(object));
+	GLuint *list = getRenderObject(object);
+
+	/* Erst beim ersten Zeichnen der Variante aufzeichnen */
+	if (*list == 0)
+	{
+		*list = glGenLists(1);
+		if (*list == 0)
+		{
+			CG_ERROR(("Konnte Displaylisten nicht erzeugen\n"));
+		}
+
+		glNewList(*list, GL_COMPILE);
+		drawRenderObject(object);
+		glEndList();
+	}
+
+	glCallList(*list);
 }
 
 void setDiffuseMaterialAlpha(float r, float g, float b, float a)
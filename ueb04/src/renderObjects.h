@@ -34,12 +34,16 @@ typedef enum {
 void drawSquare(int subDivs);
 
 /**
- * Initialisiert die Display Liste mit allen Objekten.
+ * Verwirft alle aufgezeichneten Display Listen. Jedes Objekt wird erst beim
+ * ersten Zeichnen aufgezeichnet, und zwar nur fuer die Einstellungen, von
+ * denen es abhaengt. Die Listen aller Varianten bleiben danach erhalten, ein
+ * Umschalten der Normalen zeichnet also nichts neu auf.
  */
 void initDisplayList(void);
 
 /**
- * Rendert ein Objekt aus einer Display Liste.
+ * Rendert ein Objekt aus einer Display Liste. Fehlt die Liste fuer die
+ * aktuellen Einstellungen, wird sie vorher aufgezeichnet.
  * 
  * @param object das Objekt, das gerendert werden soll (In)
  */
@@ -26,6 +26,7 @@
 #include "renderObjects.h"
 #include "logic.h"
 #include "debugGL.h"
+#include "matrix.h"
 #include "water.h"
 #include "texture.h"
 
@@ -229,9 +230,12 @@ void drawPickingScene()
 		GLfloat eyeX, eyeY, eyeZ;
 		getEyePosition(gamestate, &eyeX, &eyeY, &eyeZ);
 
-		gluLookAt(eyeX, eyeY, eyeZ, /* Augpunkt */ 
-				0.0f, 0.0f, 0.0f,   /* Mittelpunkt */ 
-				0.0f, 1.0f, 0.0f);  /* Up-Vektor */
+		CGMatrix4f view;
+		matrix_lookAt(view,
+		              eyeX, eyeY, eyeZ, /* Augpunkt */
+		              0.0f, 0.0f, 0.0f, /* Mittelpunkt */
+		              0.0f, 1.0f, 0.0f); /* Up-Vektor */
+		glMultMatrixf(view);
 
 		glPushMatrix();
 		{
@@ -260,9 +264,12 @@ void drawScene(AnaglyphEye eye)
 		GLfloat eyeX, eyeY, eyeZ;
 		getEyePosition(gamestate, &eyeX, &eyeY, &eyeZ);
 
-		gluLookAt(eyeX, eyeY, eyeZ, /* Augpunkt */ 
-				0.0f, 0.0f, 0.0f,   /* Mittelpunkt */ 
-				0.0f, 1.0f, 0.0f);  /* Up-Vektor */
+		CGMatrix4f view;
+		matrix_lookAt(view,
+		              eyeX, eyeY, eyeZ, /* Augpunkt */
+		              0.0f, 0.0f, 0.0f, /* Mittelpunkt */
+		              0.0f, 1.0f, 0.0f); /* Up-Vektor */
+		glMultMatrixf(view);
 		
 		renderSkymap(eyeX, eyeY, eyeZ);
 
@@ -355,9 +362,6 @@ void togglePointlight(void)
 void toggleNormal(void)
 {
 	g_sceneFlags.showNormals = !g_sceneFlags.showNormals;
-
-	/* Displaylisten mit/ohne Normalen neu erzeugen */
-	initDisplayList();
 }
 
 GLboolean getNormalState(void)
@@ -386,7 +390,7 @@ int initScene(void)
 	/* Linienbreite */
 	glLineWidth(1.f);
 
-	/* Objekte in Displaylisten rendern */
+	/* Objekte werden beim ersten Zeichnen in Displaylisten aufgezeichnet */
 	initDisplayList();
 
 	/* Beleuchtung initialisieren */
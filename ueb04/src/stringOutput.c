@@ -1,12 +1,21 @@
 /**
  * @file
  * Einfache Funktion zum Zeichnen von Text fuer GLUT-Programme.
+ *
+ * Die Zeichen werden einmal mit <code>glutBitmapCharacter(...)</code> in
+ * einen Schriftatlas (eine Alpha-Textur) gerastert. Texte zwischen
+ * beginStringBatch und endStringBatch werden als texturierte Rechtecke in
+ * einem Vertex-Array gesammelt und mit einem Aufruf gezeichnet. Die
+ * Vertices eines Textes werden nur neu berechnet, wenn er sich gegenueber
+ * dem letzten Stapel geaendert hat.
  */
 
 /* ---- System Header einbinden ---- */
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdarg.h>
+#include <math.h>
 
 #ifdef __APPLE__
 #include <GLUT/glut.h>
@@ -17,18 +26,93 @@
 /* ---- Eigene Header einbinden ---- */
 
 #include "stringOutput.h"
+#include "headless.h"
 
-/* ---- Oeffentliche Funktionen ---- */
+/* ---- Konstanten ---- */
 
-void drawString (GLfloat x, GLfloat y, GLfloat * color, const char *format, ...)
+/* Die verwendete Schrift */
+#define STRING_FONT (GLUT_BITMAP_9_BY_15)
+
+/* Maximale Laenge eines formatierten Textes */
+#define STRING_LENGTH (255)
+
+/* Erstes und letztes Zeichen im Atlas (druckbares ASCII) */
+#define ATLAS_FIRST_CHAR (32)
+#define ATLAS_LAST_CHAR (126)
+
+/* Kantenlaenge einer Zelle im Atlas in Pixeln, jedes Zeichen der Schrift passt hinein */
+#define ATLAS_CELL (16)
+
+/* Abstand der Grundlinie vom unteren Rand einer Zelle, Platz fuer Unterlaengen */
+#define ATLAS_BASELINE (4)
+
+/* Zellen je Zeile und Groesse des Atlas in Pixeln */
+#define ATLAS_COLUMNS (16)
+#define ATLAS_WIDTH (ATLAS_COLUMNS * ATLAS_CELL)
+#define ATLAS_HEIGHT (128)
+
+/* Hoechstens so viele Texte werden in einem Stapel gesammelt */
+#define BATCH_STRINGS (64)
+
+/* ---- Typen ---- */
+
+/** Ein Vertex im Format GL_T2F_C3F_V3F. */
+typedef struct {
+    GLfloat s, t;
+    GLfloat r, g, b;
+    GLfloat x, y, z;
+} GlyphVertex;
+
+/** Ein gesammelter Text, aus dem die Vertices berechnet wurden. */
+typedef struct {
+    GLfloat x, y;
+    GLfloat color[3];
+    char text[STRING_LENGTH];
+} BatchString;
+
+/* ---- Globale Daten ---- */
+
+/* Textur des Schriftatlas, 0 solange er nicht erzeugt wurde */
+static GLuint g_atlas = 0;
+
+/* Vorschub je Zeichen des Atlas in Pixeln */
+static int g_advance[ATLAS_LAST_CHAR - ATLAS_FIRST_CHAR + 1];
+
+/* Werden gerade Texte gesammelt? */
+static GLboolean g_collecting = GL_FALSE;
+
+/* Texte des aktuellen Stapels, bis g_builtCount mit berechneten Vertices */
+static BatchString g_strings[BATCH_STRINGS];
+static int g_stringCount = 0;
+static int g_builtCount = 0;
+
+/* Anzahl der bereits gezeichneten Texte des aktuellen Stapels */
+static int g_drawnCount = 0;
+
+/* Viewport, fuer den die Vertices berechnet wurden */
+static GLint g_builtViewport[4] = {0, 0, 0, 0};
+
+/* Erster Vertex jedes Textes, g_vertexStart[i + 1] ist das Ende von Text i */
+static int g_vertexStart[BATCH_STRINGS + 1] = {0};
+
+/* Die Vertices aller Texte */
+static GlyphVertex *g_vertices = NULL;
+static int g_vertexCapacity = 0;
+
+/* ---- Interne Funktionen ---- */
+
+/**
+ * Zeichnet einen Text direkt mit <code>glutBitmapCharacter(...)</code>.
+ *
+ * @param x x-Position des ersten Zeichens 0 bis 1 (In).
+ * @param y y-Position des ersten Zeichens 0 bis 1 (In).
+ * @param color Textfarbe (In).
+ * @param text der Text (In).
+ */
+static void drawStringDirect (GLfloat x, GLfloat y, GLfloat * color, const char *text)
 {
     GLint matrixMode;             /* Zwischenspeicher akt. Matrixmode */
-    va_list args;                 /* variabler Teil der Argumente */
-    char buffer[255];             /* der formatierte String */
-    char *s;                      /* Zeiger/Laufvariable */
-    va_start (args, format);
-    vsnprintf (buffer, 255, format, args);
-    va_end (args);
+    const char *s;                /* Zeiger/Laufvariable */
 
     /* aktuelle Zeichenfarbe (u.a. Werte) sichern */
     glPushAttrib (GL_COLOR_BUFFER_BIT | GL_CURRENT_BIT | GL_ENABLE_BIT);
@@ -76,9 +160,9 @@ void drawString (GLfloat x, GLfloat y, GLfloat * color, const char *format, ...)
     glRasterPos2f (x, y);
 
     /* Zeichenfolge zeichenweise zeichnen */
-    for (s = buffer; *s; s++)
+    for (s = text; *s; s++)
     {
-        glutBitmapCharacter(GLUT_BITMAP_9_BY_15, *s);
+        glutBitmapCharacter(STRING_FONT, *s);
     }
 
     /* alte ModelView-Matrix laden */
@@ -94,3 +178,350 @@ void drawString (GLfloat x, GLfloat y, GLfloat * color, const char *format, ...)
     /* alte Zeichenfarbe und Co. laden */
     glPopAttrib ();
 }
+
+/**
+ * Sichert die Matrizen und setzt eine orthogonale Projektion in Pixeln.
+ *
+ * @param width Breite in Pixeln (In).
+ * @param height Hoehe in Pixeln (In).
+ * @param matrixMode der bisherige Matrixmode (Out).
+ */
+static void pushPixelProjection (GLint width, GLint height, GLint *matrixMode)
+{
+    glGetIntegerv (GL_MATRIX_MODE, matrixMode);
+
+    glMatrixMode (GL_PROJECTION);
+    glPushMatrix ();
+    glLoadIdentity ();
+    glOrtho (0.0, width, 0.0, height, -1.0, 1.0);
+
+    glMatrixMode (GL_MODELVIEW);
+    glPushMatrix ();
+    glLoadIdentity ();
+}
+
+/**
+ * Stellt die mit pushPixelProjection gesicherten Matrizen wieder her.
+ *
+ * @param matrixMode der bisherige Matrixmode (In).
+ */
+static void popPixelProjection (GLint matrixMode)
+{
+    glPopMatrix ();
+    glMatrixMode (GL_PROJECTION);
+    glPopMatrix ();
+    glMatrixMode (matrixMode);
+}
+
+/**
+ * Stellt sicher, dass das Vertex-Array Platz fuer eine Anzahl Vertices hat.
+ *
+ * @param count die benoetigte Anzahl (In).
+ * @return 1, wenn genug Platz vorhanden ist.
+ */
+static int reserveVertices (int count)
+{
+    if (count > g_vertexCapacity)
+    {
+        int capacity = (g_vertexCapacity > 0) ? g_vertexCapacity : 1024;
+        GlyphVertex *vertices;
+
+        while (capacity < count)
+        {
+            capacity *= 2;
+        }
+
+        vertices = realloc (g_vertices, (size_t) capacity * sizeof (GlyphVertex));
+        if (vertices == NULL)
+        {
+            return 0;
+        }
+
+        g_vertices = vertices;
+        g_vertexCapacity = capacity;
+    }
+
+    return 1;
+}
+
+/**
+ * Berechnet die Vertices eines Textes im Stapel. Sie schliessen an die
+ * Vertices des vorherigen Textes an.
+ *
+ * @param index der Index des Textes im Stapel (In).
+ * @return 1, wenn die Vertices berechnet werden konnten.
+ */
+static int buildString (int index)
+{
+    const BatchString *string = &g_strings[index];
+    int first = g_vertexStart[index];
+    int count = first;
+
+    if (!reserveVertices (first + 4 * (int) strlen (string->text)))
+    {
+        return 0;
+    }
+
+    /* Wie bei glRasterPos liegt die Grundlinie auf der Position */
+    GLfloat penX = floorf (string->x * g_builtViewport[2] + 0.5f);
+    GLfloat bottom = floorf ((1.0f - string->y) * g_builtViewport[3] + 0.5f) - ATLAS_BASELINE;
+
+    for (const char *s = string->text; *s; s++)
+    {
+        int c = (unsigned char) *s;
+
+        if (c < ATLAS_FIRST_CHAR || c > ATLAS_LAST_CHAR)
+        {
+            continue;
+        }
+
+        int cell = c - ATLAS_FIRST_CHAR;
+        GLfloat s0 = (GLfloat) (cell % ATLAS_COLUMNS * ATLAS_CELL) / ATLAS_WIDTH;
+        GLfloat t0 = (GLfloat) (cell / ATLAS_COLUMNS * ATLAS_CELL) / ATLAS_HEIGHT;
+        GLfloat s1 = s0 + (GLfloat) ATLAS_CELL / ATLAS_WIDTH;
+        GLfloat t1 = t0 + (GLfloat) ATLAS_CELL / ATLAS_HEIGHT;
+
+        /* Leerzeichen ruecken nur vor */
+        if (c != ' ')
+        {
+            GlyphVertex *quad = &g_vertices[count];
+            GLfloat corners[4][4] = {
+                { s0, t0, penX,              bottom              },
+                { s1, t0, penX + ATLAS_CELL, bottom              },
+                { s1, t1, penX + ATLAS_CELL, bottom + ATLAS_CELL },
+                { s0, t1, penX,              bottom + ATLAS_CELL }
+            };
+
+            for (int i = 0; i < 4; i++)
+            {
+                quad[i].s = corners[i][0];
+                quad[i].t = corners[i][1];
+                quad[i].r = string->color[0];
+                quad[i].g = string->color[1];
+                quad[i].b = string->color[2];
+                quad[i].x = corners[i][2];
+                quad[i].y = corners[i][3];
+                quad[i].z = 0.0f;
+            }
+
+            count += 4;
+        }
+
+        penX += g_advance[cell];
+    }
+
+    g_vertexStart[index + 1] = count;
+
+    return 1;
+}
+
+/**
+ * Prueft, ob ein Text im Stapel dem entspricht, aus dem die Vertices an
+ * dieser Stelle berechnet wurden.
+ *
+ * @param string der neue Text (In).
+ * @param index der Index im Stapel (In).
+ * @return 1, wenn die Vertices weiter gelten.
+ */
+static int isBuilt (const BatchString *string, int index)
+{
+    const BatchString *built = &g_strings[index];
+
+    return index < g_builtCount
+           && built->x == string->x && built->y == string->y
+           && memcmp (built->color, string->color, sizeof (built->color)) == 0
+           && strcmp (built->text, string->text) == 0;
+}
+
+/* ---- Oeffentliche Funktionen ---- */
+
+int initStringOutput (void)
+{
+    GLint viewport[4];
+    GLint matrixMode;
+    GLubyte *pixels;
+
+    /* ohne Fenster stehen die Bitmap-Schriften von GLUT nicht zur Verfuegung */
+    if (g_atlas != 0 || headless_active ())
+    {
+        return g_atlas != 0;
+    }
+
+    /* Der Atlas wird im Backbuffer gezeichnet, der gross genug sein muss */
+    glGetIntegerv (GL_VIEWPORT, viewport);
+    if (viewport[2] < ATLAS_WIDTH || viewport[3] < ATLAS_HEIGHT)
+    {
+        return 0;
+    }
+
+    pixels = malloc (ATLAS_WIDTH * ATLAS_HEIGHT);
+    if (pixels == NULL)
+    {
+        return 0;
+    }
+
+    glPushAttrib (GL_COLOR_BUFFER_BIT | GL_CURRENT_BIT | GL_ENABLE_BIT
+                  | GL_VIEWPORT_BIT | GL_TEXTURE_BIT);
+    glPushClientAttrib (GL_CLIENT_PIXEL_STORE_BIT);
+
+    glViewport (0, 0, ATLAS_WIDTH, ATLAS_HEIGHT);
+    pushPixelProjection (ATLAS_WIDTH, ATLAS_HEIGHT, &matrixMode);
+
+    glDisable (GL_DEPTH_TEST);
+    glDisable (GL_LIGHTING);
+    glDisable (GL_FOG);
+    glDisable (GL_BLEND);
+    glDisable (GL_SCISSOR_TEST);
+    glDisable (GL_TEXTURE_1D);
+    glDisable (GL_TEXTURE_2D);
+    glColorMask (GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+    /* Zeichen weiss auf schwarz, je Zelle auf deren Grundlinie */
+    glClearColor (0.0f, 0.0f, 0.0f, 0.0f);
+    glClear (GL_COLOR_BUFFER_BIT);
+    glColor3f (1.0f, 1.0f, 1.0f);
+
+    for (int c = ATLAS_FIRST_CHAR; c <= ATLAS_LAST_CHAR; c++)
+    {
+        int cell = c - ATLAS_FIRST_CHAR;
+
+        glRasterPos2i (cell % ATLAS_COLUMNS * ATLAS_CELL,
+                       cell / ATLAS_COLUMNS * ATLAS_CELL + ATLAS_BASELINE);
+        glutBitmapCharacter (STRING_FONT, c);
+
+        g_advance[cell] = glutBitmapWidth (STRING_FONT, c);
+    }
+
+    /* Die Helligkeit wird zur Deckkraft der Textur */
+    glPixelStorei (GL_PACK_ALIGNMENT, 1);
+    glPixelStorei (GL_UNPACK_ALIGNMENT, 1);
+    glReadPixels (0, 0, ATLAS_WIDTH, ATLAS_HEIGHT, GL_RED, GL_UNSIGNED_BYTE, pixels);
+
+    /* Den Backbuffer loescht der Frame ohnehin */
+    glClear (GL_COLOR_BUFFER_BIT);
+
+    glGenTextures (1, &g_atlas);
+    glBindTexture (GL_TEXTURE_2D, g_atlas);
+    glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+    glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+    glTexImage2D (GL_TEXTURE_2D, 0, GL_ALPHA, ATLAS_WIDTH, ATLAS_HEIGHT, 0,
+                  GL_ALPHA, GL_UNSIGNED_BYTE, pixels);
+
+    popPixelProjection (matrixMode);
+    glPopClientAttrib ();
+    glPopAttrib ();
+
+    free (pixels);
+
+    return 1;
+}
+
+void beginStringBatch (void)
+{
+    GLint viewport[4];
+
+    g_collecting = (g_atlas != 0);
+    g_stringCount = 0;
+    g_drawnCount = 0;
+
+    /* Die Positionen haengen von der Groesse des Viewports ab */
+    glGetIntegerv (GL_VIEWPORT, viewport);
+    if (memcmp (viewport, g_builtViewport, sizeof (viewport)) != 0)
+    {
+        memcpy (g_builtViewport, viewport, sizeof (viewport));
+        g_builtCount = 0;
+    }
+}
+
+void flushStringBatch (void)
+{
+    GLint matrixMode;
+
+    if (!g_collecting || g_drawnCount == g_stringCount)
+    {
+        return;
+    }
+
+    glPushAttrib (GL_COLOR_BUFFER_BIT | GL_CURRENT_BIT | GL_ENABLE_BIT
+                  | GL_POLYGON_BIT | GL_TEXTURE_BIT);
+    glPushClientAttrib (GL_CLIENT_VERTEX_ARRAY_BIT);
+
+    pushPixelProjection (g_builtViewport[2], g_builtViewport[3], &matrixMode);
+
+    glDisable (GL_DEPTH_TEST);
+    glDisable (GL_LIGHTING);
+    glDisable (GL_FOG);
+    glDisable (GL_BLEND);
+    glDisable (GL_CULL_FACE);
+    glDisable (GL_TEXTURE_1D);
+    glPolygonMode (GL_FRONT_AND_BACK, GL_FILL);
+
+    /* Farbe aus den Vertices, Deckkraft aus dem Atlas */
+    glEnable (GL_TEXTURE_2D);
+    glBindTexture (GL_TEXTURE_2D, g_atlas);
+    glTexEnvi (GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+    glEnable (GL_ALPHA_TEST);
+    glAlphaFunc (GL_GREATER, 0.5f);
+
+    glInterleavedArrays (GL_T2F_C3F_V3F, 0, g_vertices);
+    glDrawArrays (GL_QUADS, g_vertexStart[g_drawnCount],
+                  g_vertexStart[g_stringCount] - g_vertexStart[g_drawnCount]);
+
+    popPixelProjection (matrixMode);
+    glPopClientAttrib ();
+    glPopAttrib ();
+
+    g_drawnCount = g_stringCount;
+}
+
+void endStringBatch (void)
+{
+    flushStringBatch ();
+    g_collecting = GL_FALSE;
+}
+
+void drawString (GLfloat x, GLfloat y, GLfloat * color, const char *format, ...)
+{
+    va_list args;                 /* variabler Teil der Argumente */
+    BatchString string;           /* der formatierte String */
+
+    /* ohne Fenster stehen die Bitmap-Schriften von GLUT nicht zur Verfuegung */
+    if (headless_active ())
+    {
+        return;
+    }
+
+    va_start (args, format);
+    vsnprintf (string.text, STRING_LENGTH, format, args);
+    va_end (args);
+
+    /* Ausserhalb eines Stapels, ohne Atlas oder bei vollem Stapel direkt zeichnen */
+    if (!g_collecting || g_stringCount == BATCH_STRINGS)
+    {
+        drawStringDirect (x, y, color, string.text);
+        return;
+    }
+
+    string.x = x;
+    string.y = y;
+    memcpy (string.color, color, sizeof (string.color));
+
+    /* Nur einen geaenderten Text neu berechnen, die folgenden verschieben sich dann */
+    if (!isBuilt (&string, g_stringCount))
+    {
+        g_strings[g_stringCount] = string;
+        g_builtCount = g_stringCount;
+
+        if (!buildString (g_stringCount))
+        {
+            drawStringDirect (x, y, color, string.text);
+            return;
+        }
+
+        g_builtCount = g_stringCount + 1;
+    }
+
+    g_stringCount++;
+}
@@ -3,6 +3,8 @@
 /**
  * @file
  * Einfache Funktion zum Zeichnen von Text fuer GLUT-Programme.
+ * Texte eines Frames koennen gesammelt und aus einem Schriftatlas mit einem
+ * Aufruf gezeichnet werden.
  */
 
 /* ---- System Header einbinden ---- */
@@ -14,9 +16,37 @@
 
 /* ---- Funktionsprototypen ---- */
 
+/**
+ * Rastert die Zeichen der Schrift einmalig in einen Schriftatlas. Zeichnet
+ * dazu in den Backbuffer und muss deshalb vor dem Loeschen der Buffer eines
+ * Frames aufgerufen werden, im sichtbaren Fenster. Weitere Aufrufe nach
+ * dem Erzeugen sind ohne Wirkung.
+ *
+ * @return 1, wenn der Atlas zur Verfuegung steht.
+ */
+int initStringOutput(void);
+
+/**
+ * Beginnt einen Stapel: Texte werden ab jetzt nur gesammelt. Ohne Atlas
+ * wird weiter jeder Text direkt gezeichnet.
+ */
+void beginStringBatch(void);
+
+/**
+ * Zeichnet die bisher gesammelten Texte mit einem Aufruf, der Stapel
+ * bleibt offen. Noetig, wenn danach etwas ueber die Texte gezeichnet wird.
+ */
+void flushStringBatch(void);
+
+/**
+ * Zeichnet die restlichen gesammelten Texte und beendet den Stapel.
+ */
+void endStringBatch(void);
+
 /**
  * Zeichnen einer Zeichfolge in den Vordergrund. Gezeichnet wird mit Hilfe von
- * <code>glutBitmapCharacter(...)</code>. Kann wie <code>printf</code> genutzt werden.
+ * <code>glutBitmapCharacter(...)</code>, innerhalb eines Stapels aus dem
+ * Schriftatlas. Kann wie <code>printf</code> genutzt werden.
  * 
  * @param x x-Position des ersten Zeichens 0 bis 1 (In).
  * @param y y-Position des ersten Zeichens 0 bis 1 (In).
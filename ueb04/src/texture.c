@@ -21,10 +21,17 @@
 #include <GL/glu.h>
 #endif
 
+#ifdef __APPLE__
+#include <GLUT/glut.h>
+#else
+#include <GL/glut.h>
+#endif
+
 #include <stdlib.h>
 
 /* ---- Eigene Header einbinden ---- */
 #include "texture.h"
+#include "pack.h"
 #include "debugGL.h"
 
 /* Bibliothek um Bilddateien zu laden. Es handelt sich um eine
@@ -108,7 +115,59 @@ static unsigned int calculateGLBitmapMode(int n)
 }
 
 /**
- * Laedt die Texturen.
+ * Laedt eine Textur samt Mipmaps aus dem Asset-Archiv in die aktuell
+ * gebundene Textur. Die Daten werden direkt aus dem eingeblendeten Archiv
+ * an OpenGL uebergeben.
+ *
+ * @param filename der Dateiname der Textur. (In)
+ *
+ * @return 1, wenn die Textur im Archiv lag und geladen wurde, sonst 0.
+ */
+static int uploadPackedTexture(const char *filename)
+{
+	const PackEntry *entry = pack_find(filename);
+
+	if (entry == NULL || entry->type != PACK_TEXTURE
+	    || entry->channels < 1 || entry->channels > 4)
+	{
+		return 0;
+	}
+
+	const unsigned char *data = pack_data(entry);
+	GLint format = calculateGLBitmapMode(entry->channels);
+	GLsizei width = entry->width;
+	GLsizei height = entry->height;
+	size_t offset = 0;
+
+	/* Kleine Stufen haben keine auf 4 Byte ausgerichteten Zeilen mehr */
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	for (GLuint i = 0; i < entry->levels; i++)
+	{
+		size_t levelSize = (size_t)width * height * entry->channels;
+
+		if (offset + levelSize > entry->size)
+		{
+			INFO(("Textur %s im Archiv ist unvollstaendig!\n", filename));
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+			return 0;
+		}
+
+		glTexImage2D(GL_TEXTURE_2D, i, format, width, height, 0, format, GL_UNSIGNED_BYTE, data + offset);
+
+		offset += levelSize;
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	return 1;
+}
+
+/**
+ * Laedt die Texturen. Liegt eine Textur im Asset-Archiv, wird sie von dort
+ * geladen, sonst aus der einzelnen Bilddatei.
  * 
  * @return 0, wenn ein Fehler aufgetreten ist
  */
@@ -123,32 +182,45 @@ static int loadTextures(void)
 		/* Alle Texturen nacheinander laden. */
 		for (int i = 0; i < TEX_COUNT; i++)
 		{
-			/* Die 0 erlaubt es, Bilder mit beliebig vielen Kanaelen zu laden. */
-			data = stbi_load(g_textures[i].filename, &width, &height, &channels, 0);
-
-			if (data != NULL)
-			{
-				glBindTexture(GL_TEXTURE_2D, g_textures[i].id);
-
-				gluBuild2DMipmaps(GL_TEXTURE_2D,
-									channels,
-									width,
-									height,
-									calculateGLBitmapMode(channels),
-									GL_UNSIGNED_BYTE, data);
+#ifdef DEBUG
+			int start = glutGet(GLUT_ELAPSED_TIME);
+#endif
 
-				glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-				glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-				glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-				glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+			glBindTexture(GL_TEXTURE_2D, g_textures[i].id);
 
-				stbi_image_free(data);
+			if (uploadPackedTexture(g_textures[i].filename))
+			{
+				INFO(("Textur %s aus dem Archiv in %d ms geladen.\n", g_textures[i].filename,
+				      glutGet(GLUT_ELAPSED_TIME) - start));
 			}
 			else
 			{
-				INFO(("Textur %s konnte nicht geladen werden!\n", g_textures[i].filename));
-				return 0;
+				/* Jedes Bild wird mit vier Kanaelen geladen, channels gibt an,
+				 * wie viele die Datei selbst hat. */
+				data = stbi_load(g_textures[i].filename, &width, &height, &channels, STBI_rgb_alpha);
+
+				if (data == NULL)
+				{
+					INFO(("Textur %s konnte nicht geladen werden!\n", g_textures[i].filename));
+					return 0;
+				}
+
+				/* RGBA-Pixel kann OpenGL unveraendert uebernehmen, RGB muesste es fuer
+				 * jede Stufe umwandeln. Graustufen behalten ihr kleineres Format. */
+				gluBuild2DMipmaps(GL_TEXTURE_2D,
+				                  (channels >= 3) ? GL_RGBA : (GLint)calculateGLBitmapMode(channels),
+				                  width, height, GL_RGBA, GL_UNSIGNED_BYTE, data);
+
+				stbi_image_free(data);
+
+				INFO(("Textur %s (%dx%d) in %d ms geladen, Mipmaps erzeugt.\n", g_textures[i].filename,
+				      width, height, glutGet(GLUT_ELAPSED_TIME) - start));
 			}
+
+			glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+			glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+			glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 		}
 	
 		/* Alles in Ordnung? */
@@ -1,5 +1,10 @@
 #version 330 core
 
+/*
+ * Die Szenen-Schalter werden beim Erzeugen des Programms als Definitionen
+ * eingefuegt (TEXTURES, SINES, HEIGHTMAP, PHONG, BUMPMAP), siehe terrain.vert.
+ */
+
 /**
  * Interpolierte Textur-Koordinate des Fragments.
  */
@@ -40,11 +45,6 @@ out vec4 FragColor;
  */
 uniform vec3 CameraPos;
 
-/**
- * Szenen-Schalter.
- */
-uniform uint SceneFlags;
-
 /**
  * View-Matrix. 
  */
@@ -96,13 +96,12 @@ vec4 calcPhong()
 {
     vec3 normal = normalize(fNormal); // Renormalisieren um Interpolation entgegen zu wirken.
 
-    // Pruefen, ob Bumpmap aktiviert ist.
-    if (((SceneFlags >> 4u) & 1u) == 1u)
-    {
-        vec3 bumpMap = texture(NormalTex, fTexCoord).rgb;
-        bumpMap = (bumpMap * 2.0) - 1.0;
-        normal = normalize(normal + bumpMap.x * fTangent + bumpMap.y * fBinormal);
-    }
+    // Bumpmap
+#ifdef BUMPMAP
+    vec3 bumpMap = texture(NormalTex, fTexCoord).rgb;
+    bumpMap = (bumpMap * 2.0) - 1.0;
+    normal = normalize(normal + bumpMap.x * fTangent + bumpMap.y * fBinormal);
+#endif
 
     vec3 lightVec = normalize(lightPosition - fFragPos.xyz);
     vec3 reflectVec = reflect(-lightVec, normal);
@@ -122,23 +121,19 @@ void main(void)
 {
     vec4 preColor = vec4(1, 1, 1, 1);
 
-    // Pruefen, ob Texturen aktiviert sind.
-    if (((SceneFlags >> 0u) & 1u) == 1u)
-    {
-        vec4 rockColor = texture(RockTex, fTexCoord);
-        vec4 snowColor = texture(SnowTex, fTexCoord);
-
-        float alpha = smoothstep(rockMaxHeight, snowMinHeight, fFragPos.y);
-        preColor = mix(rockColor, snowColor, alpha);
-    }
-
-    // Preufen, ob Phong aktiviert ist.
-    if (((SceneFlags >> 3u) & 1u) == 1u)
-    {
-        FragColor = preColor * calcPhong();
-    }
-    else 
-    {
-        FragColor = preColor * fIntensity;
-    }
+    // Texturen
+#ifdef TEXTURES
+    vec4 rockColor = texture(RockTex, fTexCoord);
+    vec4 snowColor = texture(SnowTex, fTexCoord);
+
+    float alpha = smoothstep(rockMaxHeight, snowMinHeight, fFragPos.y);
+    preColor = mix(rockColor, snowColor, alpha);
+#endif
+
+    // Phong oder Gouraud
+#ifdef PHONG
+    FragColor = preColor * calcPhong();
+#else
+    FragColor = preColor * fIntensity;
+#endif
 }
@@ -1,5 +1,11 @@
 #version 330 core
 
+/*
+ * Die Szenen-Schalter werden beim Erzeugen des Programms als Definitionen
+ * eingefuegt (TEXTURES, SINES, HEIGHTMAP, PHONG, BUMPMAP). Fuer jede
+ * Kombination entsteht so ein eigenes, spezialisiertes Programm.
+ */
+
 /** 
  * Position des Vertex. 
  */
@@ -60,11 +66,6 @@ uniform float Time;
  */
 uniform vec3 CameraPos;
 
-/** 
- * Die Szenen-Schalter. 
- */
-uniform uint SceneFlags;
-
 /**
  * Heightmap.
  */
@@ -134,18 +135,16 @@ vec4 calcElevatedPosition(vec2 offset)
     elevatedPosition.z = vPosition.z + offset.y;
     elevatedPosition.w = vPosition.w;
 
-    // Pruefen, ob Sinuswelle aktiv ist.
-    if (((SceneFlags >> 1u) & 1u) == 1u)
-    {
-        elevatedPosition.y += sineAmplitude * sin(Time + sineFreq * (elevatedPosition.x + elevatedPosition.z));
-    }
+    // Sinuswelle
+#ifdef SINES
+    elevatedPosition.y += sineAmplitude * sin(Time + sineFreq * (elevatedPosition.x + elevatedPosition.z));
+#endif
     
-    // Pruefen, ob Heightmap aktiv ist.
-    if (((SceneFlags >> 2u) & 1u) == 1u)
-    {
-        vec4 height = texture(Heightmap, vTexCoord - offset);
-        elevatedPosition.y += height.y * heightmapFactor;
-    }
+    // Heightmap
+#ifdef HEIGHTMAP
+    vec4 height = texture(Heightmap, vTexCoord - offset);
+    elevatedPosition.y += height.y * heightmapFactor;
+#endif
 
     return elevatedPosition;
 }
@@ -180,15 +179,12 @@ void main(void)
     vec4 elevatedPosition = calcElevatedPosition(vec2(0, 0));
     vec3 vertNormal = calcNormal();
 
-    // Preufen, ob Gouraud aktiviert ist.
-    if (((SceneFlags >> 3u) & 1u) == 0u)
-    {
-        fIntensity = calcGouraud(elevatedPosition, vertNormal);
-    }
-    else 
-    {
-        fIntensity = vec4(0, 0, 0, 0);
-    }
+    // Gouraud nur, wenn nicht Phong verwendet wird.
+#ifdef PHONG
+    fIntensity = vec4(0, 0, 0, 0);
+#else
+    fIntensity = calcGouraud(elevatedPosition, vertNormal);
+#endif
 
     fNormal = vertNormal;
     fTexCoord = vTexCoord;
@@ -0,0 +1,59 @@
+#ifndef __FRAMETIME_H__
+#define __FRAMETIME_H__
+/**
+ * @file
+ * Schnittstelle des Frametime-Moduls.
+ * Das Modul misst die Dauer jedes einzelnen Frames mit einem hochaufloesenden
+ * Timer, sammelt die Werte in Histogrammen und gibt beim Beenden des Programms
+ * die Perzentile p50/p95/p99 und das Maximum aus. Optional werden alle Frames
+ * einzeln in eine CSV-Datei geschrieben.
+ *
+ * Ist FRAMETIME_GPU definiert (nur mit GLEW), wird zusaetzlich die GPU-Zeit
+ * jedes Frames ueber GL_TIME_ELAPSED-Queries gemessen.
+ *
+ * Bestandteil einer Uebung im Rahmen des Moduls Praktikum Grundlagen der Computergrafik
+ * an der FH Wedel.
+ *
+ * @author Nicolas Hollmann, Daniel Klintworth
+ */
+
+/* ---- System Header einbinden ---- */
+#include <stdint.h>
+
+/* ---- Funktionen ---- */
+
+/**
+ * Initialisiert die Zeitmessung und meldet die Ausgabe der Statistik beim
+ * Programmende an. Benoetigt noch keinen OpenGL-Kontext.
+ *
+ * @param csvFilename Datei fuer die Werte aller Frames oder NULL (In)
+ */
+void frametime_init(const char *csvFilename);
+
+/**
+ * Markiert den Beginn eines Frames. Wird zu Beginn des Display-Callbacks
+ * aufgerufen.
+ */
+void frametime_beginFrame(void);
+
+/**
+ * Markiert das Ende eines Frames. Wird direkt nach dem Tauschen der Buffer
+ * aufgerufen.
+ */
+void frametime_endFrame(void);
+
+/**
+ * Liefert die ueber etwa eine Sekunde gemittelte Framerate.
+ *
+ * @return aktuelle Framerate
+ */
+float frametime_fps(void);
+
+/**
+ * Liefert die aktuelle Zeit eines monotonen, hochaufloesenden Timers.
+ *
+ * @return Zeit in Nanosekunden seit einem beliebigen, festen Zeitpunkt
+ */
+uint64_t frametime_now(void);
+
+#endif
@@ -35,6 +35,8 @@
 #include "texture.h"
 #include "logic.h"
 #include "scene.h"
+#include "frametime.h"
+#include "headless.h"
 #include "debugGL.h"
 
 /* ---- Konstanten ---- */
@@ -45,43 +47,6 @@
 
 /* ---- Interne Funktionen ---- */
 
-/**
- * Berechnung der Frames pro Sekunde.
- * 
- * @return aktuelle Framerate.
- */
-static GLfloat frameRate(void)
-{
-	/* Zeitpunkt der letzten Neuberechnung */
-	static int timebase = 0;
-	/* Anzahl der Aufrufe seit letzter Neuberechnung */
-	static int frameCount = 0;
-	/* Zuletzt berechneter FPS-Wert */
-	static float fps = 0.0;
-	/* aktuelle "Zeit" */
-	static int time = 0;
-
-	/* Diesen Aufruf hinzuzaehlen */
-	frameCount++;
-
-	/* seit dem Start von GLUT vergangene Zeit ermitteln */
-	time = glutGet (GLUT_ELAPSED_TIME);
-
-	/* Eine Sekunde ist vergangen */
-	if (time - timebase > 1000)
-	{
-		/* FPS-Wert neu berechnen */
-		fps = frameCount * 1000.0f / (time - timebase);
-
-		/* Zureuecksetzen */
-		timebase = time;
-		frameCount = 0;
-	}
-
-	/* Aktuellen FPS-Wert zurueckgeben */
-	return fps;
-}
-
 /**
  * Mouse-Button-Callback.
  * 
@@ -169,6 +134,22 @@ static void cbSpecialUp(int key, int x, int y)
 	handleKeyboardEvent(key, GLUT_UP, GL_TRUE, x, y);
 }
 
+/**
+ * Aktualisiert die Spiellogik um einen Zeitschritt.
+ * 
+ * @param interval seit dem letzten Schritt vergangene Zeit in Sekunden (In)
+ */
+static void stepLogic(double interval)
+{
+	if (isPaused())
+	{
+		interval = 0.0;
+	}
+
+	/* Spiellogik updaten */
+	updateLogic(interval);
+}
+
 /**
  * Timer-Callback.
  * Initiiert Neuzeichnen und setzt sich selbst erneut als Timer-Callback.
@@ -184,13 +165,7 @@ static void cbTimer(int lastCallTime)
 	/* Seit dem letzten Funktionsaufruf vergangene Zeit in Sekunden */
 	double interval = (double)(thisCallTime - lastCallTime) / 1000.0f;
 
-	if (isPaused())
-	{
-		interval = 0.0;
-	}
-
-	/* Spiellogik updaten */
-	updateLogic(interval);
+	stepLogic(interval);
 
 	/* Wieder als Timer-Funktion registrieren */
 	glutTimerFunc(1000 / TIMER_CALLS_PS, cbTimer, thisCallTime);
@@ -200,33 +175,45 @@ static void cbTimer(int lastCallTime)
 }
 
 /**
- * Zeichen-Callback.
- * Loescht die Buffer, ruft das Zeichnen der Szene auf und tauscht den Front-
- * und Backbuffer.
+ * Zeichnet einen Frame in den aktuellen Framebuffer.
+ * 
+ * @param width Breite des Framebuffers (In)
+ * @param height Hoehe des Framebuffers (In)
+ * @param time Zeit seit dem Programmstart in Sekunden (In)
  */
-static void cbDisplay(void)
+static void drawFrame(int width, int height, float time)
 {
-	/* Fensterdimensionen auslesen */
-	int width = glutGet(GLUT_WINDOW_WIDTH);
-	int height = glutGet(GLUT_WINDOW_HEIGHT);
-
 	/* Seitenverhaeltnis bestimmen */
 	double aspect = (double)width / height;
 
-	/* Zeit abfragen */
-	float time = (float) glutGet(GLUT_ELAPSED_TIME) / 1000;
-
 	/* Buffer zuruecksetzen */
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	drawScene(aspect, time);
+}
+
+/**
+ * Zeichen-Callback.
+ * Loescht die Buffer, ruft das Zeichnen der Szene auf und tauscht den Front-
+ * und Backbuffer.
+ */
+static void cbDisplay(void)
+{
+	frametime_beginFrame();
+
+	/* Fensterdimensionen und Zeit abfragen */
+	drawFrame(glutGet(GLUT_WINDOW_WIDTH), glutGet(GLUT_WINDOW_HEIGHT),
+	          (float) glutGet(GLUT_ELAPSED_TIME) / 1000);
 	
 	/* Objekte anzeigen */
 	glutSwapBuffers();
 
+	/* Dauer des Frames messen */
+	frametime_endFrame();
+
 	/* Framerate anzeigen */
 	char fpsBuffer[100];
-	snprintf(fpsBuffer, 100, "Aufgabe 5: Shader | Daniel & Nico | %.2f FPS", frameRate());
+	snprintf(fpsBuffer, 100, "Aufgabe 5: Shader | Daniel & Nico | %.2f FPS", frametime_fps());
 	glutSetWindowTitle(fpsBuffer);
 }
 
@@ -406,3 +393,72 @@ int initAndStartIO(char *title, int width, int height)
 
 	return windowID;
 }
+
+int runHeadless(int frames, int width, int height, const char *dumpDir)
+{
+	int success = 0;
+
+	INFO(("Erzeuge Kontext ohne Fenster...\n"));
+
+	if (headless_init(width, height, 3, 3, 1))
+	{
+		INFO(("...fertig.\n\n"));
+		INFO(("Initialisiere GLEW...\n"));
+		glewExperimental = GL_TRUE;
+		GLenum error = glewInit();
+
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+		/* Ohne X11 kann GLEW nur die GLX-Erweiterungen nicht laden, die
+		 * OpenGL-Funktionen stehen trotzdem zur Verfuegung */
+		if (error == GLEW_ERROR_NO_GLX_DISPLAY)
+		{
+			error = GLEW_OK;
+		}
+#endif
+
+		GLGETERROR; // Verschluckt OpenGL Fehlermeldung durch glewExperimental
+
+		if (error == GLEW_OK && initScene() && initTextures())
+		{
+			INFO(("...fertig.\n\n"));
+
+			printf("OpenGL-Version: %s\n", glGetString(GL_VERSION));
+
+
+			uint64_t start = frametime_now();
+
+			for (int frame = 0; frame < frames; frame++)
+			{
+				stepLogic(HEADLESS_DT);
+
+				frametime_beginFrame();
+				drawFrame(width, height, (float)(frame * HEADLESS_DT));
+				headless_finishFrame();
+				frametime_endFrame();
+
+				if (dumpDir != NULL)
+				{
+					headless_dumpFrame(dumpDir, frame);
+				}
+			}
+
+			double seconds = (frametime_now() - start) / 1e9;
+			printf("%d Frames (%dx%d) in %.3f s, %.2f FPS\n",
+			       frames, width, height, seconds, frames / seconds);
+
+			success = 1;
+		}
+		else
+		{
+			INFO(("...fehlgeschlagen.\n\n"));
+		}
+
+		headless_cleanup();
+	}
+	else
+	{
+		INFO(("...fehlgeschlagen.\n\n"));
+	}
+
+	return success;
+}
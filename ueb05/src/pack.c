@@ -0,0 +1,223 @@
+/**
+ * @file
+ * Pack-Modul.
+ * Das Modul blendet das Asset-Archiv in den Speicher ein und erlaubt das
+ * Nachschlagen einzelner Eintraege. Unter Unix wird mmap verwendet, unter
+ * Windows eine File-Mapping.
+ *
+ * Bestandteil einer Uebung im Rahmen des Moduls Praktikum Grundlagen der Computergrafik
+ * an der FH Wedel.
+ *
+ * @author Nicolas Hollmann, Daniel Klintworth
+ */
+
+/* ---- System Header einbinden ---- */
+#ifdef WIN32
+#include <windows.h>
+#else
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <stddef.h>
+#include <string.h>
+
+/* ---- Eigene Header einbinden ---- */
+#include "pack.h"
+#include "debugGL.h"
+
+/* ---- Globale Daten ---- */
+
+/* Das eingeblendete Archiv, NULL wenn nicht vorhanden */
+static const unsigned char *g_pack = NULL;
+
+/* Groesse des Archivs in Bytes */
+static size_t g_packSize = 0;
+
+/* Wurde bereits versucht, das Archiv zu oeffnen? */
+static int g_packTried = 0;
+
+/* ---- Interne Funktionen ---- */
+
+/**
+ * Blendet eine Datei nur lesend in den Speicher ein.
+ *
+ * @param filename der Dateiname. (In)
+ * @param size die Groesse der Datei. (Out)
+ *
+ * @return Zeiger auf den Anfang der Datei oder NULL bei einem Fehler.
+ */
+static const unsigned char *mapFile(const char *filename, size_t *size)
+{
+	const unsigned char *data = NULL;
+
+#ifdef WIN32
+	HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+	                          OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file != INVALID_HANDLE_VALUE)
+	{
+		LARGE_INTEGER fileSize;
+		HANDLE mapping = NULL;
+
+		if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+		{
+			mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		}
+
+		if (mapping != NULL)
+		{
+			data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			*size = (size_t)fileSize.QuadPart;
+
+			/* Die View haelt die Mapping selbst am Leben */
+			CloseHandle(mapping);
+		}
+
+		CloseHandle(file);
+	}
+#else
+	int fd = open(filename, O_RDONLY);
+	if (fd >= 0)
+	{
+		struct stat info;
+
+		if (fstat(fd, &info) == 0 && info.st_size > 0)
+		{
+			void *mapped = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+			if (mapped != MAP_FAILED)
+			{
+				/* Das Archiv wird beim Start komplett gelesen, also darf das
+				 * System die Seiten schon vorab einlesen. */
+				posix_madvise(mapped, (size_t)info.st_size, POSIX_MADV_WILLNEED);
+
+				data = mapped;
+				*size = (size_t)info.st_size;
+			}
+		}
+
+		/* Die Einblendung bleibt auch ohne offenen Deskriptor bestehen */
+		close(fd);
+	}
+#endif
+
+	return data;
+}
+
+/**
+ * Blendet eine per mapFile eingeblendete Datei wieder aus.
+ *
+ * @param data Zeiger auf den Anfang der Datei. (In)
+ * @param size die Groesse der Datei. (In)
+ */
+static void unmapFile(const unsigned char *data, size_t size)
+{
+#ifdef WIN32
+	(void)size;
+	UnmapViewOfFile(data);
+#else
+	munmap((void *)data, size);
+#endif
+}
+
+/**
+ * Prueft, ob das eingeblendete Archiv gueltig ist. Alle Eintraege muessen
+ * vollstaendig innerhalb der Datei liegen.
+ *
+ * @param data das Archiv. (In)
+ * @param size die Groesse des Archivs. (In)
+ *
+ * @return 1, wenn das Archiv gueltig ist, sonst 0.
+ */
+static int validatePack(const unsigned char *data, size_t size)
+{
+	const PackHeader *header = (const PackHeader *)data;
+
+	if (size < sizeof(PackHeader)
+	    || memcmp(header->magic, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0
+	    || header->byteOrder != PACK_BYTE_ORDER
+	    || header->entryCount > (size - sizeof(PackHeader)) / sizeof(PackEntry))
+	{
+		return 0;
+	}
+
+	const PackEntry *entries = (const PackEntry *)(data + sizeof(PackHeader));
+
+	for (uint32_t i = 0; i < header->entryCount; i++)
+	{
+		if (memchr(entries[i].name, '\0', PACK_NAME_LENGTH) == NULL
+		    || entries[i].offset > size
+		    || entries[i].size > size - entries[i].offset)
+		{
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * Oeffnet das Archiv, falls das noch nicht versucht wurde.
+ */
+static void openPack(void)
+{
+	if (!g_packTried)
+	{
+		g_packTried = 1;
+		g_pack = mapFile(PACK_FILENAME, &g_packSize);
+
+		if (g_pack != NULL && !validatePack(g_pack, g_packSize))
+		{
+			INFO(("Archiv %s ist ungueltig und wird ignoriert.\n", PACK_FILENAME));
+			unmapFile(g_pack, g_packSize);
+			g_pack = NULL;
+			g_packSize = 0;
+		}
+		else if (g_pack == NULL)
+		{
+			INFO(("Kein Archiv %s gefunden, es werden einzelne Dateien geladen.\n", PACK_FILENAME));
+		}
+	}
+}
+
+/* ---- Oeffentliche Funktionen ---- */
+
+const PackEntry *pack_find(const char *filename)
+{
+	openPack();
+
+	if (g_pack == NULL)
+	{
+		return NULL;
+	}
+
+	/* Der Name im Archiv ist relativ zum content-Verzeichnis */
+	size_t prefixLength = strlen(PACK_CONTENT_PREFIX);
+	if (strncmp(filename, PACK_CONTENT_PREFIX, prefixLength) == 0)
+	{
+		filename += prefixLength;
+	}
+
+	const PackHeader *header = (const PackHeader *)g_pack;
+	const PackEntry *entries = (const PackEntry *)(g_pack + sizeof(PackHeader));
+
+	for (uint32_t i = 0; i < header->entryCount; i++)
+	{
+		if (strcmp(entries[i].name, filename) == 0)
+		{
+			return &entries[i];
+		}
+	}
+
+	return NULL;
+}
+
+const unsigned char *pack_data(const PackEntry *entry)
+{
+	return g_pack + entry->offset;
+}
@@ -0,0 +1,103 @@
+#ifndef __PACK_H__
+#define __PACK_H__
+/**
+ * @file
+ * Schnittstelle des Pack-Moduls.
+ * Das Modul liest das Asset-Archiv "assets.pack", das vom Werkzeug
+ * tools/assetpack erzeugt wird. Das Archiv enthaelt Texturen mit bereits
+ * dekodierter, vollstaendiger Mipmap-Kette sowie beliebige weitere Dateien
+ * (z.B. Shader-Quellen). Es wird in den Speicher eingeblendet, die Daten
+ * koennen also direkt aus den eingeblendeten Seiten verwendet werden.
+ *
+ * Aufbau des Archivs (Bytereihenfolge des erzeugenden Rechners):
+ * - PackHeader
+ * - entryCount mal PackEntry
+ * - die Daten der Eintraege, jeweils auf PACK_ALIGNMENT ausgerichtet.
+ *   Texturen liegen als Stufe 0 bis levels-1 direkt hintereinander vor.
+ *
+ * Bestandteil einer Uebung im Rahmen des Moduls Praktikum Grundlagen der Computergrafik
+ * an der FH Wedel.
+ *
+ * @author Nicolas Hollmann, Daniel Klintworth
+ */
+
+/* ---- System Header einbinden ---- */
+#include <stdint.h>
+
+/* ---- Konstanten ---- */
+
+/** Kennung am Anfang jedes Archivs */
+#define PACK_MAGIC "CGPACK1"
+
+/** Wird zur Erkennung einer fremden Bytereihenfolge mitgespeichert */
+#define PACK_BYTE_ORDER (0x01020304u)
+
+/** Maximale Laenge eines Namens inklusive abschliessender 0 */
+#define PACK_NAME_LENGTH (48)
+
+/** Ausrichtung der Daten im Archiv in Bytes */
+#define PACK_ALIGNMENT (16)
+
+/** Pfad des Archivs relativ zum Arbeitsverzeichnis */
+#define PACK_FILENAME "../content/assets.pack"
+
+/** Praefix, das beim Nachschlagen von Dateinamen entfernt wird */
+#define PACK_CONTENT_PREFIX "../content/"
+
+/* ---- Datentypen ---- */
+
+/** Art eines Eintrags */
+typedef enum {
+	PACK_RAW = 0,
+	PACK_TEXTURE = 1
+} PackEntryType;
+
+/** Kopf des Archivs */
+typedef struct {
+	char magic[8];
+	uint32_t byteOrder;
+	uint32_t entryCount;
+} PackHeader;
+
+/** Ein Eintrag im Inhaltsverzeichnis des Archivs */
+typedef struct {
+	/** Name relativ zum content-Verzeichnis, z.B. "textures/sky.png" */
+	char name[PACK_NAME_LENGTH];
+	uint32_t type;
+
+	/* Nur bei Texturen gesetzt */
+	uint32_t width;
+	uint32_t height;
+	uint32_t channels;
+	uint32_t levels;
+	uint32_t srgb;
+
+	uint64_t offset;
+	uint64_t size;
+} PackEntry;
+
+/* ---- Funktionen ---- */
+
+/**
+ * Sucht einen Eintrag im Archiv. Beim ersten Aufruf wird das Archiv
+ * geoeffnet; fehlt es oder ist es ungueltig, liefern alle Aufrufe NULL und
+ * die Dateien muessen einzeln geladen werden. Das Archiv bleibt bis zum
+ * Programmende eingeblendet.
+ *
+ * @param filename der Dateiname, wie er auch zum Laden der einzelnen Datei
+ *        verwendet wuerde, z.B. "../content/textures/sky.png". (In)
+ *
+ * @return der Eintrag oder NULL, wenn er nicht im Archiv liegt.
+ */
+const PackEntry *pack_find(const char *filename);
+
+/**
+ * Liefert die Daten eines Eintrags.
+ *
+ * @param entry der Eintrag aus pack_find(). (In)
+ *
+ * @return Zeiger in das eingeblendete Archiv.
+ */
+const unsigned char *pack_data(const PackEntry *entry);
+
+#endif
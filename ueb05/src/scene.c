@@ -17,6 +17,8 @@
 
 #include <GL/glew.h>
 
+#include <string.h>
+
 #ifdef __APPLE__
 #include <OpenGL/gl.h>
 #else
@@ -56,6 +58,12 @@ typedef struct
 /* Defaultwerte fuer die Flags der Optionen */
 #define SCENE_FLAGS_DEFAULT {1, 1, 1, 1, 0}
 
+/** Anzahl der Flags, die den Shader beeinflussen */
+#define SHADER_FLAG_COUNT (5)
+
+/** Anzahl der moeglichen Shader-Varianten (eine pro Kombination der Flags) */
+#define SHADER_VARIANT_COUNT (1 << SHADER_FLAG_COUNT)
+
 /**
  * Aufzaehlung aller Uniforms im Terrain Shader.
  */
@@ -69,24 +77,33 @@ typedef enum
 	UNI_NORMAL_TEX,
 	UNI_TIME,
 	UNI_CAM_POS,
-	UNI_SCENE_FLAGS,
 
 	UNI_SIZE
 } UniformLocations;
 
 /**
- * Terrain Shader Daten
+ * Eine spezialisierte Variante des Terrain Shaders.
  */
 typedef struct
 {
 	GLuint shaderId;
+	GLint uniformLocations[UNI_SIZE];
+} ShaderVariant;
+
+/**
+ * Terrain Shader Daten
+ */
+typedef struct
+{
+	/* Varianten, Index ist die Kombination der Flags (siehe variantIndex) */
+	ShaderVariant variants[SHADER_VARIANT_COUNT];
+	ShaderVariant *current;
+
 	GLuint vertexArrayObject;
 	GLuint indexBuffer;
-
-	GLint uniformLocations[UNI_SIZE];
 } ShaderData;
 
-#define SHADER_DATA_DEFAULT { 0, 0, 0, { 0 } }
+#define SHADER_DATA_DEFAULT { { { 0, { 0 } } }, NULL, 0, 0 }
 
 /**
  * Alle Daten eines Vertex.
@@ -110,20 +127,56 @@ static ShaderData g_shaderData = SHADER_DATA_DEFAULT;
 
 /* ---- Macros ---- */
 
-/** Einfacher Zugriff auf Uniform Locations */
-#define UNI_LOC(x) (g_shaderData.uniformLocations[(x)])
+/** Einfacher Zugriff auf Uniform Locations der aktuellen Variante */
+#define UNI_LOC(x) (g_shaderData.current->uniformLocations[(x)])
 
 /* ---- Interne Funktionen ---- */
 
 /**
- * Laedt den Vertex- und Fragment-Shader fuer die Darstellung des Terrains
- * und bestimmt die Uniform Locations.
+ * Berechnet den Index der Shader-Variante fuer die aktuellen Flags.
+ *
+ * @return der Index, Bit n entspricht dem n-ten Flag.
+ */
+static int variantIndex(void)
+{
+	return g_sceneFlags.textures
+		| g_sceneFlags.sines << 1
+		| g_sceneFlags.heightmap << 2
+		| g_sceneFlags.phong << 3
+		| g_sceneFlags.bumpmap << 4;
+}
+
+/**
+ * Laedt eine Variante des Vertex- und Fragment-Shaders fuer die Darstellung
+ * des Terrains und bestimmt ihre Uniform Locations. Die Flags der Variante
+ * werden als Definitionen in die Quelltexte eingefuegt.
+ *
+ * @param index der Index der Variante. (In)
+ * @param variant die zu fuellende Variante. (Out)
  */
-static void loadShader(void)
+static void loadShader(int index, ShaderVariant *variant)
 {
-	g_shaderData.shaderId = createProgram(
+	const char *flagDefines[SHADER_FLAG_COUNT] = {
+		"#define TEXTURES\n",
+		"#define SINES\n",
+		"#define HEIGHTMAP\n",
+		"#define PHONG\n",
+		"#define BUMPMAP\n"
+	};
+
+	char defines[128] = "";
+	for (int i = 0; i < SHADER_FLAG_COUNT; i++)
+	{
+		if (index & (1 << i))
+		{
+			strcat(defines, flagDefines[i]);
+		}
+	}
+
+	variant->shaderId = createProgramWithDefines(
 		"../content/shaders/terrain.vert", 
-		"../content/shaders/terrain.frag"
+		"../content/shaders/terrain.frag",
+		defines
 	);
 
 	const char *uniformNames[UNI_SIZE] = {
@@ -134,16 +187,32 @@ static void loadShader(void)
 		"SnowTex",
 		"NormalTex",
 		"Time",
-		"CameraPos",
-		"SceneFlags"
+		"CameraPos"
 	};
 
 	for (int i = 0; i < UNI_SIZE; i++)
 	{
-		UNI_LOC(i) = glGetUniformLocation(g_shaderData.shaderId, uniformNames[i]);
+		variant->uniformLocations[i] = glGetUniformLocation(variant->shaderId, uniformNames[i]);
 	}
 }
 
+/**
+ * Waehlt die Shader-Variante, die zu den aktuellen Flags passt. Varianten
+ * werden erst beim ersten Gebrauch erzeugt und danach wiederverwendet.
+ */
+static void selectShader(void)
+{
+	int index = variantIndex();
+	ShaderVariant *variant = &g_shaderData.variants[index];
+
+	if (variant->shaderId == 0)
+	{
+		loadShader(index, variant);
+	}
+
+	g_shaderData.current = variant;
+}
+
 /**
  * Erstellt einen Array Buffer (Vertex Buffer) fuer ein Grid.
  */
@@ -291,15 +360,6 @@ static void drawWorld(float time)
 	/* Aktuelle Zeit setzen */
 	glUniform1f(UNI_LOC(UNI_TIME), time);
 
-	/* Szenen-Flags setzen */
-	GLuint flags = 0;
-	flags |= g_sceneFlags.textures;
-	flags |= g_sceneFlags.sines << 1;
-	flags |= g_sceneFlags.heightmap << 2;
-	flags |= g_sceneFlags.phong << 3;
-	flags |= g_sceneFlags.bumpmap << 4;
-	glUniform1ui(UNI_LOC(UNI_SCENE_FLAGS), flags);
-
 	/* Aktivieren des Vertex-Array-Objekts (VAO). */
 	glBindVertexArray(g_shaderData.vertexArrayObject);
 
@@ -320,7 +380,7 @@ void drawScene(float aspect, float time)
 
 	glEnable(GL_DEPTH_TEST);
 
-	glUseProgram(g_shaderData.shaderId);
+	glUseProgram(g_shaderData.current->shaderId);
 
 	float projectionMatrix[16];
     /* Perspektivische Darstellung */
@@ -374,26 +434,31 @@ void toggleWireframeMode(void)
 void toggleTextures(void)
 {
 	g_sceneFlags.textures = !g_sceneFlags.textures;
+	selectShader();
 }
 
 void toggleHeightmap(void)
 {
 	g_sceneFlags.heightmap = !g_sceneFlags.heightmap;
+	selectShader();
 }
 
 void toggleSines(void)
 {
 	g_sceneFlags.sines = !g_sceneFlags.sines;
+	selectShader();
 }
 
 void togglePhong(void)
 {
 	g_sceneFlags.phong = !g_sceneFlags.phong;
+	selectShader();
 }
 
 void toggleBumpmap(void)
 {
 	g_sceneFlags.bumpmap = !g_sceneFlags.bumpmap;
+	selectShader();
 }
 
 int initScene(void)
@@ -408,7 +473,7 @@ int initScene(void)
 	/* Linienbreite */
 	glLineWidth(1.f);
 
-	loadShader();
+	selectShader();
 	createVAO();
 
 	/* Alles in Ordnung? */
@@ -28,6 +28,7 @@
 
 /* ---- Eigene Header einbinden ---- */
 #include "texture.h"
+#include "pack.h"
 #include "debugGL.h"
 
 /* Bibliothek um Bilddateien zu laden. Es handelt sich um eine
@@ -76,7 +77,9 @@ static int initTextureArray(void)
 
 	g_textures[texHeightmap].filename = "../content/textures/heightmap.png";
 	g_textures[texHeightmap].mipmap = GL_FALSE;
-	g_textures[texRock].filename = "../content/textures/rock.jpg";
+	/* rock.jpg ist nicht Teil des Repositories, bis dahin nutzt auch das
+	   Gestein die Schneetextur */
+	g_textures[texRock].filename = "../content/textures/snow.jpg";
 	g_textures[texRock].mipmap = GL_TRUE;
 	g_textures[texSnow].filename = "../content/textures/snow.jpg";
 	g_textures[texSnow].mipmap = GL_TRUE;
@@ -111,7 +114,61 @@ static unsigned int calculateGLBitmapMode(int n)
 }
 
 /**
- * Laedt die Texturen.
+ * Laedt eine Textur aus dem Asset-Archiv in die aktuell gebundene Textur.
+ * Die Daten werden direkt aus dem eingeblendeten Archiv an OpenGL
+ * uebergeben. Mit Mipmaps werden die im Archiv vorberechneten Stufen
+ * verwendet, glGenerateMipmap entfaellt also.
+ *
+ * @param texture die zu ladende Textur. (In)
+ *
+ * @return 1, wenn die Textur im Archiv lag und geladen wurde, sonst 0.
+ */
+static int uploadPackedTexture(const Texture *texture)
+{
+	const PackEntry *entry = pack_find(texture->filename);
+
+	if (entry == NULL || entry->type != PACK_TEXTURE
+	    || entry->channels < 1 || entry->channels > 4)
+	{
+		return 0;
+	}
+
+	const unsigned char *data = pack_data(entry);
+	GLint format = calculateGLBitmapMode(entry->channels);
+	GLsizei width = entry->width;
+	GLsizei height = entry->height;
+	GLuint levels = texture->mipmap ? entry->levels : 1;
+	size_t offset = 0;
+
+	/* Kleine Stufen haben keine auf 4 Byte ausgerichteten Zeilen mehr */
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	for (GLuint i = 0; i < levels; i++)
+	{
+		size_t levelSize = (size_t)width * height * entry->channels;
+
+		if (offset + levelSize > entry->size)
+		{
+			INFO(("Textur %s im Archiv ist unvollstaendig!\n", texture->filename));
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+			return 0;
+		}
+
+		glTexImage2D(GL_TEXTURE_2D, i, format, width, height, 0, format, GL_UNSIGNED_BYTE, data + offset);
+
+		offset += levelSize;
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	return 1;
+}
+
+/**
+ * Laedt die Texturen. Liegt eine Textur im Asset-Archiv, wird sie von dort
+ * geladen, sonst aus der einzelnen Bilddatei.
  * 
  * @return 0, wenn ein Fehler aufgetreten ist
  */
@@ -126,39 +183,44 @@ static int loadTextures(void)
 		/* Alle Texturen nacheinander laden. */
 		for (int i = 0; i < TEX_COUNT; i++)
 		{
-			/* Die 0 erlaubt es, Bilder mit beliebig vielen Kanaelen zu laden. */
-			data = stbi_load(g_textures[i].filename, &width, &height, &channels, 0);
+			glBindTexture(GL_TEXTURE_2D, g_textures[i].id);
 
-			if (data != NULL)
+			if (!uploadPackedTexture(&g_textures[i]))
 			{
-				glBindTexture(GL_TEXTURE_2D, g_textures[i].id);
+				/* Die 0 erlaubt es, Bilder mit beliebig vielen Kanaelen zu laden. */
+				data = stbi_load(g_textures[i].filename, &width, &height, &channels, 0);
+
+				if (data == NULL)
+				{
+					INFO(("Textur %s konnte nicht geladen werden!\n", g_textures[i].filename));
+					return 0;
+				}
 
 				GLint format = calculateGLBitmapMode(channels);
 
 				glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-				
+
 				if (g_textures[i].mipmap)
 				{
 					glGenerateMipmap(GL_TEXTURE_2D);
-					glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-				}
-				else
-				{
-					glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 				}
 
-				glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-				
-				glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-				glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-				
 				stbi_image_free(data);
 			}
+
+			if (g_textures[i].mipmap)
+			{
+				glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+			}
 			else
 			{
-				INFO(("Textur %s konnte nicht geladen werden!\n", g_textures[i].filename));
-				return 0;
+				glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 			}
+
+			glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			
+			glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+			glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 		}
 	
 		/* Alles in Ordnung? */
@@ -11,12 +11,45 @@
 /* ---- System Header einbinden ---- */
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <stdint.h>
 #include <math.h>
 #include <GL/glew.h>
 
+#ifdef WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
 /* ---- Eigene Header einbinden ---- */
 #include "utility.h"
 #include "types.h"
+#include "pack.h"
+#include "matrix.h"
+#include "debugGL.h"
+
+/* ---- Konstanten ---- */
+
+/** Verzeichnis fuer den Cache der Program-Binaries (relativ zum Arbeitsverzeichnis) */
+#define PROGRAM_CACHE_DIR "shadercache"
+
+/** Kennung am Anfang jeder Cache-Datei */
+#define PROGRAM_CACHE_MAGIC "CGSHBIN"
+
+/** Obergrenze fuer die Groesse eines Binaries, groessere Eintraege gelten als defekt */
+#define PROGRAM_CACHE_MAX_LENGTH (64 * 1024 * 1024)
+
+/* ---- Typen ---- */
+
+/** Kopf einer Cache-Datei, danach folgen length Bytes Binary */
+typedef struct {
+	char magic[8];
+	uint64_t key;
+	uint32_t format;
+	uint32_t length;
+	uint64_t checksum;
+} ProgramCacheHeader;
 
 /* ---- Makros ---- */
 
@@ -28,13 +61,23 @@
 /* ---- Interne Funktionen ---- */
 
 /**
- * Liest den Inhalt einer Datei in einen String.
+ * Liest den Inhalt einer Datei in einen String. Liegt die Datei im
+ * Asset-Archiv, wird sie von dort kopiert.
  *
  * @param filepath Pfad zur Datei. (In)
  * @return Neuer String mit dem Inhalt der Datei. Muss freigegeben
  *         werden!
  */
 static char* readfile(const char* filepath) {
+	const PackEntry *entry = pack_find(filepath);
+	if (entry != NULL) {
+		char* packed = (char*)malloc(entry->size + 1);
+		memcpy(packed, pack_data(entry), entry->size);
+		packed[entry->size] = 0;
+
+		return packed;
+	}
+
 	FILE *f;
 	fopen_s(&f, filepath, "rb");
 
@@ -61,59 +104,253 @@ static char* readfile(const char* filepath) {
 }
 
 /**
- * Berechnet ein normiertes Kreuzprodukt.
+ * Fuegt Praeprozessor-Definitionen direkt hinter der #version-Zeile in
+ * einen Shader-Quelltext ein. Ohne #version-Zeile werden sie vorangestellt.
  *
- * @param lhs[XYZ] Linker Operant. (In)
- * @param rhs[XYZ] Rechter Operant. (In)
- * @param res Pointer auf das Resultat. (Out)
+ * @param source Der Shader-Quelltext. (In)
+ * @param defines Die Definitionen, eine pro Zeile, oder NULL. (In)
+ * @return Neuer String mit dem Ergebnis. Muss freigegeben werden!
  */
-static void unitCross(float lhsX, float lhsY, float lhsZ, float rhsX, float rhsY, float rhsZ, float* resX, float* resY, float* resZ)
-{
-	float x = lhsY * rhsZ - lhsZ * rhsY;
-	float y = lhsZ * rhsX - lhsX * rhsZ;
-	float z = lhsX * rhsY - lhsY * rhsX;
+static char* injectDefines(const char* source, const char* defines) {
+	if (defines == NULL) {
+		defines = "";
+	}
+
+	size_t sourceLength = strlen(source);
+	size_t definesLength = strlen(defines);
+
+	/* Platz fuer Quelltext, Definitionen und eine #line-Direktive */
+	char* result = (char*)malloc(sourceLength + definesLength + 32);
+
+	size_t split = 0;
+	int lineNumber = 1;
+	const char* version = strstr(source, "#version");
+	if (version != NULL) {
+		const char* lineEnd = strchr(version, '\n');
+		split = (lineEnd != NULL) ? (size_t)(lineEnd - source) + 1 : sourceLength;
+
+		for (size_t i = 0; i < split; i++) {
+			lineNumber += (source[i] == '\n');
+		}
+	}
+
+	memcpy(result, source, split);
+	memcpy(result + split, defines, definesLength);
+	size_t offset = split + definesLength;
+
+	/* Die #line-Direktive haelt die Zeilennummern in Fehlermeldungen korrekt */
+	if (version != NULL && definesLength > 0) {
+		offset += (size_t)sprintf(result + offset, "#line %d\n", lineNumber);
+	}
+
+	memcpy(result + offset, source + split, sourceLength - split + 1);
+
+	return result;
+}
 
-	float length = sqrtf(x * x + y * y + z * z);
+/**
+ * Fuehrt einen FNV-1a-Hash (64 Bit) ueber einen Speicherbereich fort.
+ *
+ * @param hash Der bisherige Hashwert. (In)
+ * @param data Die Daten. (In)
+ * @param length Die Laenge der Daten in Bytes. (In)
+ * @return Der neue Hashwert.
+ */
+static uint64_t hashBytes(uint64_t hash, const void* data, size_t length) {
+	const unsigned char* bytes = (const unsigned char*)data;
 
-	*resX = x / length;
-	*resY = y / length;
-	*resZ = z / length;
+	for (size_t i = 0; i < length; i++) {
+		hash ^= bytes[i];
+		hash *= 0x100000001b3ULL;
+	}
+
+	return hash;
 }
 
 /**
- * Erzeugt eine perspektivische Projektions-Matrix.
+ * Fuehrt einen FNV-1a-Hash ueber einen String inklusive der abschliessenden
+ * 0 fort, damit z.B. "ab"+"c" und "a"+"bc" verschiedene Hashes ergeben.
  *
- * @param left Linke Grenze des View-Frustums an der Near-Plane. (In)
- * @param right Rechte Grenze des View-Frustums an der Near-Plane. (In)
- * @param top Obere Grenze des View-Frustums an der Near-Plane. (In)
- * @param bottom Untere Grenze des View-Frustums an der Near-Plane. (In)
- * @param znear Abstand zur Near-Plane. (In)
- * @param zfar Abstand zur Far-plane. (In)
- * @param m Pointer auf die Matrix, die mit Werten gefüllt werden soll. (Out)
+ * @param hash Der bisherige Hashwert. (In)
+ * @param string Der String oder NULL. (In)
+ * @return Der neue Hashwert.
+ */
+static uint64_t hashString(uint64_t hash, const char* string) {
+	if (string == NULL) {
+		string = "";
+	}
+
+	return hashBytes(hash, string, strlen(string) + 1);
+}
+
+/**
+ * Prueft, ob der Treiber Program-Binaries liefern und laden kann.
  *
- * @remarks Diese Funktion entspricht funktional glFrustum.
+ * @return GL_TRUE, wenn Program-Binaries genutzt werden koennen.
  */
-static void frustum(float left, float right, float top, float bottom, float znear, float zfar, float* m)
-{
-	m[0]  = 2 * znear / (right - left);
-	m[1]  = 0.0f;
-	m[2]  = 0.0f;
-	m[3]  = 0.0f;
+static GLboolean programBinarySupported(void) {
+	static int supported = -1;
 
-	m[4]  = 0.0f;
-	m[5]  = 2 * znear / (top - bottom);
-	m[6]  = 0.0f;
-	m[7]  = 0.0f;
+	if (supported < 0) {
+		GLint formats = 0;
 
-	m[8]  = (right + left) / (right - left);
-	m[9]  = (top + bottom) / (top - bottom);
-	m[10] = -(zfar + znear) / (zfar - znear);
-	m[11] = -1.0f;
+		if (GLEW_ARB_get_program_binary || GLEW_VERSION_4_1) {
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+		}
 
-	m[12] = 0.0f;
-	m[13] = 0.0f;
-	m[14] = -2 * zfar*znear / (zfar - znear);
-	m[15] = 0.0f;
+		supported = formats > 0;
+	}
+
+	return supported ? GL_TRUE : GL_FALSE;
+}
+
+/**
+ * Berechnet den Schluessel eines Programms fuer den Cache. Er haengt von
+ * den Quelltexten, den eingefuegten Definitionen und dem Treiber ab, so
+ * dass ein Treiber-Update alle alten Eintraege ungueltig macht.
+ *
+ * @param vertexSource Quelltext des Vertex-Shaders. (In)
+ * @param fragmentSource Quelltext des Fragment-Shaders. (In)
+ * @param defines Eingefuegte Definitionen oder NULL. (In)
+ * @return Der Schluessel.
+ */
+static uint64_t programCacheKey(const char* vertexSource, const char* fragmentSource, const char* defines) {
+	uint64_t key = 0xcbf29ce484222325ULL;
+
+	key = hashString(key, vertexSource);
+	key = hashString(key, fragmentSource);
+	key = hashString(key, defines);
+	key = hashString(key, (const char*)glGetString(GL_VERSION));
+	key = hashString(key, (const char*)glGetString(GL_RENDERER));
+	key = hashString(key, (const char*)glGetString(GL_VENDOR));
+
+	return key;
+}
+
+/**
+ * Bestimmt den Dateinamen eines Cache-Eintrags.
+ *
+ * @param key Der Schluessel des Programms. (In)
+ * @param path Puffer fuer den Dateinamen. (Out)
+ * @param size Groesse des Puffers. (In)
+ */
+static void programCachePath(uint64_t key, char* path, size_t size) {
+	snprintf(path, size, "%s/%016llx.bin", PROGRAM_CACHE_DIR, (unsigned long long)key);
+}
+
+/**
+ * Versucht, ein Programm aus dem Cache zu laden. Veraltete oder defekte
+ * Eintraege (falscher Schluessel, falsche Laenge, falsche Pruefsumme oder
+ * vom Treiber abgelehnt) werden geloescht.
+ *
+ * @param key Der Schluessel des Programms. (In)
+ * @return Id des Program-Objekts oder 0, wenn nichts geladen wurde.
+ */
+static GLuint loadCachedProgram(uint64_t key) {
+	char path[64];
+	programCachePath(key, path, sizeof(path));
+
+	FILE *f;
+	fopen_s(&f, path, "rb");
+	if (f == NULL) {
+		return 0;
+	}
+
+	ProgramCacheHeader header;
+	void* binary = NULL;
+	GLboolean valid = fread(&header, sizeof(header), 1, f) == 1
+		&& memcmp(header.magic, PROGRAM_CACHE_MAGIC, sizeof(PROGRAM_CACHE_MAGIC)) == 0
+		&& header.key == key
+		&& header.length > 0
+		&& header.length <= PROGRAM_CACHE_MAX_LENGTH;
+
+	if (valid) {
+		char extra;
+		binary = malloc(header.length);
+		valid = fread(binary, header.length, 1, f) == 1
+			&& fread(&extra, 1, 1, f) == 0
+			&& hashBytes(0xcbf29ce484222325ULL, binary, header.length) == header.checksum;
+	}
+	fclose(f);
+
+	GLuint program = 0;
+	if (valid) {
+		GLint linked = GL_FALSE;
+
+		program = glCreateProgram();
+		glProgramBinary(program, header.format, binary, (GLsizei)header.length);
+		glGetProgramiv(program, GL_LINK_STATUS, &linked);
+
+		if (!linked) {
+			glDeleteProgram(program);
+			program = 0;
+		}
+	}
+	free(binary);
+
+	if (program == 0) {
+		INFO(("Cache-Eintrag %s ist veraltet oder defekt und wird verworfen.\n", path));
+		remove(path);
+	}
+
+	return program;
+}
+
+/**
+ * Schreibt das Binary eines gelinkten Programms in den Cache. Die Datei
+ * wird erst unter einem temporaeren Namen geschrieben und dann umbenannt,
+ * damit ein abgebrochener Schreibvorgang keinen halben Eintrag hinterlaesst.
+ *
+ * @param key Der Schluessel des Programms. (In)
+ * @param program Id des Program-Objekts. (In)
+ */
+static void storeCachedProgram(uint64_t key, GLuint program) {
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0 || length > PROGRAM_CACHE_MAX_LENGTH) {
+		return;
+	}
+
+	ProgramCacheHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, PROGRAM_CACHE_MAGIC, sizeof(PROGRAM_CACHE_MAGIC));
+	header.key = key;
+
+	void* binary = malloc(length);
+	GLsizei written = 0;
+	GLenum format = 0;
+	glGetProgramBinary(program, length, &written, &format, binary);
+	header.format = format;
+	header.length = (uint32_t)written;
+	header.checksum = hashBytes(0xcbf29ce484222325ULL, binary, (size_t)written);
+
+#ifdef WIN32
+	_mkdir(PROGRAM_CACHE_DIR);
+#else
+	mkdir(PROGRAM_CACHE_DIR, 0755);
+#endif
+
+	char path[64];
+	char tempPath[72];
+	programCachePath(key, path, sizeof(path));
+	snprintf(tempPath, sizeof(tempPath), "%s.tmp", path);
+
+	FILE *f;
+	fopen_s(&f, tempPath, "wb");
+	if (f != NULL) {
+		int ok = written > 0
+			&& fwrite(&header, sizeof(header), 1, f) == 1
+			&& fwrite(binary, (size_t)written, 1, f) == 1;
+
+		if (fclose(f) == 0 && ok) {
+			remove(path);
+			rename(tempPath, path);
+		} else {
+			remove(tempPath);
+		}
+	}
+
+	free(binary);
 }
 
 /**
@@ -141,15 +378,14 @@ static void checkShaderLog(const char* filename, GLuint shader) {
  * Erzeugt ein neues Shader-Objekt.
  *
  * @param shaderType Typ des zu erstellenden Shaders (In)
- * @param filename Shader-Datei. (In)
+ * @param filename Shader-Datei, nur fuer Fehlermeldungen. (In)
+ * @param source Quelltext des Shaders. (In)
  * @return Id des neu erstellten Shader-Objekts.
  */
-static GLuint createShader(GLenum shaderType, const char* filename) {
+static GLuint createShader(GLenum shaderType, const char* filename, const char* source) {
 	GLuint shader = glCreateShader(shaderType);
 
-	const char* source = readfile(filename);
 	glShaderSource(shader, 1, &source, NULL);
-	free((void*)source);
 
 	glCompileShader(shader);
 	checkShaderLog(filename, shader);
@@ -180,68 +416,63 @@ static void checkProgramLog(GLuint program) {
 /* ---- Oeffentliche Funktionen ---- */
 
 void perspective(float fov, float aspect, float znear, float zfar, float* m) {
+	/* fov ist hier der horizontale Öffnungswinkel */
 	float right = znear * (float)(tan(TO_RADIANS(fov / 2.0f)));
-	float left = -right;
 	float top = right / aspect;
-	float bottom = -top;
-	frustum(left, right, top, bottom, znear, zfar, m);
+	matrix_frustum(m, -right, right, -top, top, znear, zfar);
 }
 
 void lookAt(float centerX, float centerY, float centerZ, float targetX, float targetY, float targetZ, float upX, float upY, float upZ, float* m)
 {
-	float viewX = targetX - centerX;
-	float viewY = targetY - centerY;
-	float viewZ = targetZ - centerZ;
-
-	float length = sqrtf(viewX * viewX + viewY * viewY + viewZ * viewZ);
-
-	float fX = viewX / length;
-	float fY = viewY / length;
-	float fZ = viewZ / length;
-
-	float sX, sY, sZ;
-	float uX, uY, uZ;
-	unitCross(fX, fY, fZ, upX, upY, upZ, &sX, &sY, &sZ);
-	unitCross(sX, sY, sZ, fX, fY, fZ, &uX, &uY, &uZ);
-
-	m[0]  =  sX;
-	m[1]  =  uX;
-	m[2]  = -fX;
-	m[3]  = 0.0f;
-
-	m[4]  =  sY;
-	m[5]  =  uY;
-	m[6]  = -fY;
-	m[7]  = 0.0f;
-
-	m[8]  =  sZ;
-	m[9]  =  uZ;
-	m[10] = -fZ;
-	m[11] = 0.0f;
-
-	m[12] = -(sX * centerX + sY * centerY + sZ * centerZ);
-	m[13] = -(uX * centerX + uY * centerY + uZ * centerZ);
-	m[14] =  (fX * centerX + fY * centerY + fZ * centerZ);
-	m[15] = 1.0f;
+	matrix_lookAt(m, centerX, centerY, centerZ, targetX, targetY, targetZ, upX, upY, upZ);
 }
 
 GLuint createProgram(const char* vertexShaderFilename, const char* fragmentShaderFilename) {
-	/* Erstellen der Shader-Objekte */
-	GLuint vertexShader = createShader(GL_VERTEX_SHADER, vertexShaderFilename);
-	GLuint fragmentShader = createShader(GL_FRAGMENT_SHADER, fragmentShaderFilename);
-
-	/* Erstellen des Programms */
-	GLuint program = glCreateProgram();
-	glAttachShader(program, vertexShader);
-	glAttachShader(program, fragmentShader);
-
-	glLinkProgram(program);
-	checkProgramLog(program);
-
-	/* Nach dem Linken des Programms können die Shader-Objekte wieder
-	 * gelöscht werden. */
-	glDeleteShader(vertexShader);
-	glDeleteShader(fragmentShader);
+	return createProgramWithDefines(vertexShaderFilename, fragmentShaderFilename, NULL);
+}
+
+GLuint createProgramWithDefines(const char* vertexShaderFilename, const char* fragmentShaderFilename, const char* defines) {
+	char* vertexFile = readfile(vertexShaderFilename);
+	char* fragmentFile = readfile(fragmentShaderFilename);
+	char* vertexSource = injectDefines(vertexFile, defines);
+	char* fragmentSource = injectDefines(fragmentFile, defines);
+	free(vertexFile);
+	free(fragmentFile);
+
+	/* Liegt das Programm bereits fertig im Cache, entfaellt das Kompilieren */
+	GLboolean useCache = programBinarySupported();
+	uint64_t key = useCache ? programCacheKey(vertexSource, fragmentSource, defines) : 0;
+	GLuint program = useCache ? loadCachedProgram(key) : 0;
+
+	if (program == 0) {
+		/* Erstellen der Shader-Objekte */
+		GLuint vertexShader = createShader(GL_VERTEX_SHADER, vertexShaderFilename, vertexSource);
+		GLuint fragmentShader = createShader(GL_FRAGMENT_SHADER, fragmentShaderFilename, fragmentSource);
+
+		/* Erstellen des Programms */
+		program = glCreateProgram();
+		glAttachShader(program, vertexShader);
+		glAttachShader(program, fragmentShader);
+
+		if (useCache) {
+			glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		}
+
+		glLinkProgram(program);
+		checkProgramLog(program);
+
+		/* Nach dem Linken des Programms können die Shader-Objekte wieder
+		 * gelöscht werden. */
+		glDeleteShader(vertexShader);
+		glDeleteShader(fragmentShader);
+
+		if (useCache) {
+			storeCachedProgram(key, program);
+		}
+	}
+
+	free(vertexSource);
+	free(fragmentSource);
 
 	return program;
 }
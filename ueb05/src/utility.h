@@ -27,13 +27,14 @@
 /**
  * Erzeugt eine perspektivische Projektions-Matrix.
  *
- * @param fov Öffnungswinkel des View-Frustums in deg. (In)
+ * @param fov Horizontaler Öffnungswinkel des View-Frustums in deg. (In)
  * @param aspect Verhältnis zwischen Breite und Höhe des View-Frustums. (In)
  * @param znear Abstand zur Near-Plane. (In)
  * @param zfar Abstand zur Far-Plane. (In)
  * @param m Pointer auf die Matrix, die mit Werten gefüllt werden soll. (Out)
  *
- * @remarks Diese Funktion entspricht funktional gluPerspective.
+ * @remarks Diese Funktion entspricht gluPerspective, nur dass fov
+ *          horizontal statt vertikal gemessen wird.
  */
 void perspective(float fov, float aspect, float znear, float zfar, float* m);
 
@@ -58,4 +59,21 @@ void lookAt(float centerX, float centerY, float centerZ, float targetX, float ta
  */
 GLuint createProgram(const char* vertexShaderFilename, const char* fragmentShaderFilename);
 
+/**
+ * Erstellt ein neues Program, wobei hinter der #version-Zeile beider
+ * Shader zusaetzliche Praeprozessor-Definitionen eingefuegt werden.
+ *
+ * Unterstuetzt der Treiber Program-Binaries, wird das gelinkte Programm im
+ * Verzeichnis "shadercache" abgelegt und beim naechsten Start von dort
+ * geladen. Der Schluessel haengt von den Quelltexten, den Definitionen und
+ * der Treiberversion ab; veraltete oder defekte Eintraege werden verworfen
+ * und neu erzeugt.
+ *
+ * @param vertexShaderFilename Dateiname des Vertex-Shaders. (In)
+ * @param fragmentShaderFilename Dateiname des Fragment-Shaders. (In)
+ * @param defines Definitionen, z.B. "#define PHONG\n", oder NULL. (In)
+ * @return Id des neu erstellten Programm-Objekts.
+ */
+GLuint createProgramWithDefines(const char* vertexShaderFilename, const char* fragmentShaderFilename, const char* defines);
+
 #endif